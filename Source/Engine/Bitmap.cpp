@@ -22,12 +22,11 @@ Bitmap::~Bitmap()
 
 unique_ptr<Bitmap> Bitmap::load(string const& filename)
 {
-    std::string path = GetGlobalContext()->m_PlatformIO->ResolvePath(filename);
-
     auto bmp = make_unique<Bitmap>();
-    bmp->m_FileName = path;
+    bmp->m_FileName = filename;
 
-    FromFileResourceParameters params{ path };
+    // Keep the res: path, the texture is mapped through the VFS so packed images are found as well
+    FromFileResourceParameters params{ filename };
     bmp->m_Resource = ResourceLoader::instance()->load<TextureHandle>(params, false, true);
 
     // for now we don't support async bitmap loading and we assume in our rendering that bitmaps are always loaded and ready to render
@@ -2,6 +2,7 @@
 #include "GameEngine.h"
 #include "MetricsOverlay.h"
 #include "Memory.h"
+#include "Allocators.h"
 
 #include <inttypes.h>
 
@@ -60,20 +61,37 @@ void MetricsOverlay::RenderOverlay()
 
 		if(ImGui::CollapsingHeader("Memory", ImGuiTreeNodeFlags_DefaultOpen))
 		{
-			MemoryTracker* tracker = get_memory_tracker();
-			ImGui::Text("Usage: %.4f (MB)", (double)tracker->_total_memory_usage / 1'000'000.0);
-			ImGui::Text("Allocations: %" PRIi64, (s64)tracker->_current_allocs);
+			MemoryStats stats = get_memory_tracker()->get_stats();
+			ImGui::Text("Usage: %.4f (MB)", (double)stats.total_memory_usage / 1'000'000.0);
+			ImGui::Text("Allocations: %" PRIi64, stats.current_allocs);
 
 			std::vector<std::pair<MemoryCategory, size_t>> data{};
 			for(u32 i = 0; i < *MemoryCategory::Count; ++i)
 			{
-				data.push_back({ (MemoryCategory)i, tracker->_total_per_category[i] });
+				data.push_back({ (MemoryCategory)i, stats.total_per_category[i] });
 			}
 			std::sort(data.begin(), data.end(),[](auto const& lhs, auto const& rhs) { return lhs.second > rhs.second; });
 			for(auto const& d : data)
 			{
 				ImGui::Text("\t%s (KB): %.4f", MemoryCategoryToString(d.first), (double)d.second / 1'000);
 			}
+
+			if (MemoryAllocators::is_initialised())
+			{
+				LinearArena const& arena = MemoryAllocators::get_frame_arena();
+				MemoryBudgetStats frameStats = MemoryAllocators::get_budget_stats(MemoryCategory::Frame);
+				ImGui::Text("Frame Arena (KB): %.4f / %.4f (peak %.4f, overflows %" PRIu64 ")",
+						(double)arena.get_used() / 1'000, (double)arena.get_capacity() / 1'000, (double)arena.get_high_water_mark() / 1'000, frameStats.failed_allocations);
+
+				for (u32 i = 0; i < *MemoryCategory::Count; ++i)
+				{
+					MemoryBudgetStats budget = MemoryAllocators::get_budget_stats((MemoryCategory)i);
+					if (budget.budget > 0)
+					{
+						ImGui::Text("\t%s budget (KB): %.4f / %.4f (refused %" PRIu64 ")", MemoryCategoryToString((MemoryCategory)i), (double)budget.used / 1'000, (double)budget.budget / 1'000, budget.failed_allocations);
+					}
+				}
+			}
 		}
 
 
@@ -85,6 +103,7 @@ void MetricsOverlay::RenderOverlay()
 			ImGui::Text("RenderCPU:  %.4f ms", m_Times[Timer::RenderCPU].last());
 			ImGui::Text("RenderGPU:  %.4f ms", m_Times[Timer::RenderGPU].last());
 			ImGui::Text("PresentCPU:  %.4f ms", m_Times[Timer::PresentCPU].last());
+			ImGui::Text("InputLatency:  %.4f ms (avg %.4f ms, %d frames in flight)", m_Times[Timer::InputLatency].last(), m_Times[Timer::InputLatency].average(), engine->m_GraphicsThread.GetFramesInFlight());
 		}
 
 		ImGui::End();
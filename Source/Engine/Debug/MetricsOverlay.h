@@ -66,6 +66,7 @@ public:
 		PresentCPU,
 		RenderCPU,
 		RenderGPU,
+		InputLatency,
 		Num
 	};
 
@@ -2,8 +2,13 @@
 #include "singleton.h"
 
 // #TODO: Make common render context interface to avoid having to do this
+#ifdef USE_NULL_RHI
+struct NullRenderContext;
+using RenderContext = NullRenderContext;
+#else
 struct Dx11RenderContext;
 using RenderContext = Dx11RenderContext;
+#endif
 
 struct ENGINE_API IOverlay
 {
@@ -42,8 +42,6 @@ using Microsoft::WRL::ComPtr;
 #include <box2d/b2_world_callbacks.h>
 #include <box2d/box2d.h>
 
-#include <TaskScheduler.h>
-
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include <imgui.h>
 #include <imgui_internal.h>
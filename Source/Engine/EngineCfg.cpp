@@ -15,6 +15,7 @@ SERIALIZE_FN(EngineCfg)
 	SERIALIZE_PROPERTY(UseD3D);
 	SERIALIZE_PROPERTY(MSAA);
 	SERIALIZE_PROPERTY(MaxFrametime);
+	SERIALIZE_PROPERTY(FramesInFlight);
 	SERIALIZE_PROPERTY(GraphicsSettings);
 	SERIALIZE_CONTAINER(Values);
 }
@@ -28,6 +28,9 @@ struct EngineCfg
 
 	f64 m_MaxFrametime;
 
+	// Amount of frames the simulation can run ahead of rendering (1-3). Higher values increase throughput at the cost of input latency.
+	u32 m_FramesInFlight = 1;
+
 	GraphicsSettings m_GraphicsSettings;
 
 	std::vector<u32> m_Values;
@@ -2,6 +2,7 @@
 #include "EngineLoop.h"
 #include "GameEngine.h"
 #include "AbstractGame.h"
+#include "Core/Allocators.h"
 
 REGISTER_TYPE("/Types/EngineLoop", EngineLoop);
 REGISTER_TYPE("/Types/EditorLoop", EditorLoop);
@@ -13,7 +14,22 @@ int EngineLoop::Run(cli::CommandLine cmdLine)
 {
     cli::set(cmdLine);
 
-    MemoryTracker::init();
+    // Per address tracking is only needed when inspecting individual allocations
+    MemoryTrackingMode trackingMode = MemoryTrackingMode::Sharded;
+    if (cli::has_arg("-memtrack-callsites"))
+    {
+        trackingMode = MemoryTrackingMode::CallSites;
+    }
+    else if (cli::has_arg("-memtrack-detailed"))
+    {
+        trackingMode = MemoryTrackingMode::Detailed;
+    }
+    MemoryTracker::init(trackingMode);
+
+    // Route MEMORY_TAG scoped allocations to the per category pools and frame arenas
+    MemoryAllocatorCfg allocatorCfg{};
+    allocatorCfg.m_EnablePools = !cli::has_arg("-no-mem-pools");
+    MemoryAllocators::init(allocatorCfg);
 
     // Create global singletons
     // #TODO: Get rid of GameEngine instance 
@@ -65,6 +81,9 @@ int EngineLoop::Run(cli::CommandLine cmdLine)
     }
 
     Shutdown();
+
+    get_memory_tracker()->DumpLeakInfo();
+    MemoryAllocators::deinit();
     return 0;
 }
 
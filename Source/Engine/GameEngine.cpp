@@ -10,6 +10,7 @@
 
 #include "Core/Logging.h"
 #include "Core/Memory.h"
+#include "Core/Allocators.h"
 
 #include "Engine/Core/ResourceLoader.h"
 #include "Engine/Core/Material.h"
@@ -38,7 +39,6 @@ int g_DebugMode = 0;
 static constexpr uint32_t max_task_threads = 8;
 
 // Static task scheduler used for loading assets and executing multi threaded work loads
-enki::TaskScheduler* GameEngine::s_TaskScheduler;
 
 // Thread ID used to identify if we are on the main thread.
 std::thread::id GameEngine::s_MainThreadID;
@@ -99,6 +99,7 @@ GameEngine::GameEngine()
 	, m_Renderer(nullptr)
 	, m_SignalGraphicsToMain({0})
 	, m_SignalMainToGraphics({0})
+	, m_InputSampleTime(0)
 {
 	ASSERT(!GetGlobalContext()->m_Engine);
 	GetGlobalContext()->m_Engine = this;
@@ -143,6 +144,12 @@ bool GameEngine::Startup()
 
 	// Validate engine settings
 	ASSERTMSG(!(m_EngineCfg.m_UseD2D && (m_EngineCfg.m_UseD3D && m_EngineCfg.m_MSAA != MSAAMode::Off)), " Currently the engine does not support rendering D2D with MSAA because DrawText does not respond correctly!");
+	m_EngineCfg.m_FramesInFlight = std::clamp<u32>(m_EngineCfg.m_FramesInFlight, 1, GraphicsThread::c_MaxFramesInFlight);
+#ifdef USE_NULL_RHI
+	// D2D draws into a DXGI surface which the null backend doesn't have
+	m_EngineCfg.m_UseD2D = false;
+#endif
+	m_GraphicsThread.SetFramesInFlight(m_EngineCfg.m_FramesInFlight);
 
 	s_MainThreadID = std::this_thread::get_id();
 
@@ -158,32 +165,8 @@ bool GameEngine::Startup()
 	m_OverlayManager->register_overlay(new ImGuiDemoOverlay());
 	m_OverlayManager->register_overlay(new ImGuiAboutOverlay());
 
-	struct InitTask : enki::IPinnedTask
-	{
-		InitTask(uint32_t threadNum)
-				: IPinnedTask(threadNum) {}
-
-		void Execute() override
-		{
-			LOG_INFO(System, "Initializing Task thread {}.", threadNum - 1);
-
-			std::wstring name = fmt::format(L"TaskThread {}", threadNum - 1);
-			::SetThreadDescription(GetCurrentThread(), name.c_str());
-			SUCCEEDED(::CoInitialize(NULL));
-		}
-	};
 	::SetThreadDescription(GetCurrentThread(), L"MainThread");
 
-	enki::TaskScheduler* taskScheduler = GetGlobalContext()->m_TaskScheduler;
-	std::vector<std::unique_ptr<InitTask>> tasks;
-	for (uint32_t i = 1; i < taskScheduler->GetNumTaskThreads(); ++i)
-	{
-		tasks.push_back(std::make_unique<InitTask>(i));
-		taskScheduler->AddPinnedTask(tasks.back().get());
-	}
-	taskScheduler->RunPinnedTasks();
-	taskScheduler->WaitforAll();
-
 	// Initialize the high precision timers
 	m_FrameTimer = make_unique<PrecisionTimer>();
 	m_FrameTimer->reset();
@@ -338,6 +321,10 @@ bool GameEngine::Startup()
 
 		// #TODO: Build ImGui on top of the RI abstraction instead
         GetRI()->ImGui_Init();
+#ifdef USE_NULL_RHI
+		// No renderer backend uploads the font texture, build the atlas on the CPU so ImGui frames still run
+		ImGui::GetIO().Fonts->Build();
+#endif
 	}
 
 #pragma region Box2D
@@ -399,7 +386,7 @@ bool GameEngine::Startup()
 
 	// Wait until graphics stage is initialized
 	m_GraphicsThread.WaitForStage(GraphicsThread::Stage::Running);
-	m_SignalGraphicsToMain.release();
+	m_SignalGraphicsToMain.release(m_GraphicsThread.GetFramesInFlight());
 
 	m_IsRunning = true;
 	m_TimeAccum = 0.0;
@@ -416,6 +403,8 @@ void GameEngine::Update(f64 dt)
 
 		Timer t{};
 		t.Start();
+		::QueryPerformanceCounter((LARGE_INTEGER*)&m_InputSampleTime);
+
 		// Process all window messages
 
 		SDL_Event e;
@@ -492,7 +481,9 @@ void GameEngine::Update(f64 dt)
 		// Recreating the game viewport texture needs to happen before running IMGUI and the actual rendering
 		{
 			JONO_EVENT("DebugUI");
+#ifndef USE_NULL_RHI
 			ImGui_ImplDX11_NewFrame();
+#endif
 
 			// ImVec2 displaySize = { (float)m_Renderer->GetDrawableWidth(), (float)m_Renderer->GetDrawableHeight() };
 			ImGui_ImplSDL2_NewFrame(nullptr);
@@ -516,9 +507,13 @@ void GameEngine::Update(f64 dt)
 
 	ResourceLoader::instance()->update();
 
-	// First sync our game update to the RT
+	// First sync our game update to the RT, this waits until one of the frames in flight has been presented
 	m_SignalGraphicsToMain.acquire();
 	Sync();
+
+	// The graphics thread finished the frame that last used this slot, this is the only point where frame memory can be recycled
+	MemoryAllocators::begin_frame();
+	get_memory_tracker()->end_frame();
 	m_SignalMainToGraphics.release();
 }
 
@@ -537,14 +532,16 @@ void GameEngine::Shutdown()
 	m_Game.reset();
 
 	// Make sure all tasks have finished before shutting down
-	Tasks::get_scheduler()->WaitforAllAndShutdown();
+	Tasks::get_scheduler()->shutdown();
 
 	Perf::shutdown();
 
 	ResourceLoader::instance()->unload_all();
 	ResourceLoader::shutdown();
 
+#ifndef USE_NULL_RHI
 	ImGui_ImplDX11_Shutdown();
+#endif
 	ImGui_ImplSDL2_Shutdown();
 
 	ImGui::DestroyContext();
@@ -587,6 +584,13 @@ bool GameEngine::InitSubSystems()
 		// Now we can start logging information and we mount our resources volume.
 		m_PlatformIO->Mount("Resources");
 
+		// Packed resources (see PackTool) are preferred over the loose files when they are available
+		constexpr char const* c_ResourcePack = "Resources.pak";
+		if (m_PlatformIO->Exists(c_ResourcePack))
+		{
+			m_PlatformIO->Mount(c_ResourcePack, 1);
+		}
+
 		GetGlobalContext()->m_PlatformIO = m_PlatformIO.get();
 	}
 
@@ -598,28 +602,20 @@ bool GameEngine::InitSubSystems()
 		constexpr char const* c_ConfigPath = "res:/Config/Engine.cfg";
 		constexpr char const* c_GameConfigPath = "res:/Config/Game.cfg";
 
-		std::string configPath = m_PlatformIO->ResolvePath(c_ConfigPath);
-		if (IO::IFileRef file = m_PlatformIO->OpenFile(configPath.c_str(), IO::Mode::Read); file)
+		if (IO::IMappedFileRef file = m_PlatformIO->MapFile(c_ConfigPath); file)
 		{
-			u32 fileSize = (u32)file->GetSize();
-			char* data = new char[fileSize];
-
-			u32 bytesRead = file->read(data, fileSize);
+			Span<u8 const> data = file->get_data();
 
-			SharedPtr<IFileStream> readStream = SharedPtr<IFileStream>(new YamlStream(data, bytesRead));
+			SharedPtr<IFileStream> readStream = SharedPtr<IFileStream>(new YamlStream(reinterpret_cast<const char*>(data.begin()), (u32)data.size()));
 			TypeManager* manager = GetGlobalContext()->m_TypeManager;
 			manager->SerializeObject("/Types/Core/EngineCfg", &m_EngineCfg, readStream.Get());
 		}
 
-		std::string gameConfigPath = m_PlatformIO->ResolvePath(c_GameConfigPath);
-		if (IO::IFileRef file = m_PlatformIO->OpenFile(gameConfigPath.c_str(), IO::Mode::Read); file)
+		if (IO::IMappedFileRef file = m_PlatformIO->MapFile(c_GameConfigPath); file)
 		{
-			u32 fileSize = (u32)file->GetSize();
-			char* data = new char[fileSize];
+			Span<u8 const> data = file->get_data();
 
-			u32 bytesRead = file->read(data, fileSize);
-
-			SharedPtr<IFileStream> readStream = SharedPtr<IFileStream>(new YamlStream(data, bytesRead));
+			SharedPtr<IFileStream> readStream = SharedPtr<IFileStream>(new YamlStream(reinterpret_cast<const char*>(data.begin()), (u32)data.size()));
 			TypeManager* manager = GetGlobalContext()->m_TypeManager;
 			manager->SerializeObject("/Types/Core/GameCfg", &m_GameCfg, readStream.Get());
 		}
@@ -628,11 +624,21 @@ bool GameEngine::InitSubSystems()
 
 	ResourceLoader::create();
 
-	// Initialize enkiTS
+	// Initialize the job system, workers need COM for WIC texture loading
 	GlobalContext* globalContext = GetGlobalContext();
 	ASSERT(!globalContext->m_TaskScheduler);
 	globalContext->m_TaskScheduler = Tasks::get_scheduler();
-	globalContext->m_TaskScheduler->Initialize();
+
+	Tasks::JobSystemCfg jobCfg{};
+	jobCfg.m_OnWorkerStart = [](u32 worker)
+	{
+		LOG_INFO(System, "Initializing Task thread {}.", worker);
+
+		std::wstring name = fmt::format(L"TaskThread {}", worker);
+		::SetThreadDescription(GetCurrentThread(), name.c_str());
+		SUCCEEDED(::CoInitialize(NULL));
+	};
+	globalContext->m_TaskScheduler->init(jobCfg);
 
 	return true;
 }
@@ -1239,7 +1245,11 @@ void GameEngine::BuildViewportUI(ImGuiID* dockID)
 		max_uv.y = s_vp_size.y / m_Renderer->GetDrawableHeight();
 
 		m_ViewportPos = float2(ImGui::GetCursorScreenPos().x, ImGui::GetCursorScreenPos().y);
+#ifdef USE_NULL_RHI
+		ImGui::Image(nullptr, s_vp_size, ImVec2(0, 0), max_uv);
+#else
 		ImGui::Image(GetRI()->GetRawSRV(m_Renderer->get_raw_output_non_msaa_srv()), s_vp_size, ImVec2(0, 0), max_uv);
+#endif
 
 		//ImGuizmo::SetDrawlist();
 		//ImGuizmo::SetRect(_viewport_pos.x, _viewport_pos.y, float1(_viewport_width), float1(_viewport_height));
@@ -8,7 +8,6 @@
 #include "PlatformIO.h"
 #include "Framework/World.h"
 #include "EngineCfg.h"
-#include <TaskScheduler.h>
 #include "Graphics/Perf.h"
 #include "Graphics/RenderWorld.h"
 #include "Graphics/GraphicsThread.h"
@@ -182,7 +181,6 @@ private:
 private:
 	static constexpr const char* s_RootImguiID = "RootWindow##Root";
 
-	static enki::TaskScheduler* s_TaskScheduler;
 	static std::thread::id s_MainThreadID;
 
 	struct GpuTimer
@@ -252,8 +250,15 @@ private:
 	SharedPtr<class Graphics::D2DRenderContext> m_D2DRenderContext;
 
 	GraphicsThread m_GraphicsThread;
-	std::binary_semaphore m_SignalMainToGraphics;
-	std::binary_semaphore m_SignalGraphicsToMain;
+
+	// Counts the frames ready to be rendered and the free frame slots, see GraphicsThread::SetFramesInFlight.
+	//	Shutdown wakes the graphics thread with one release on top of the frames in flight.
+	static constexpr std::ptrdiff_t c_MaxFrameSignals = GraphicsThread::c_MaxFramesInFlight + 1;
+	std::counting_semaphore<c_MaxFrameSignals> m_SignalMainToGraphics;
+	std::counting_semaphore<c_MaxFrameSignals> m_SignalGraphicsToMain;
+
+	// Performance counter value of the last input poll, used to measure the input to present latency
+	u64 m_InputSampleTime;
 
 	f64 m_TimeAccum;
 	f64 m_TimeT;
@@ -0,0 +1,574 @@
+#include "engine.pch.h"
+#include "CookedModel.h"
+
+#include "ModelResource.h"
+#include "VertexFormat.h"
+
+#include <assimp/DefaultIOSystem.h>
+
+namespace
+{
+
+u32 align_offset(size_t offset)
+{
+	return u32((offset + 15) & ~size_t(15));
+}
+
+// Helper to flatten an assimp scene and its transforms
+void flatten_transforms(aiMatrix4x4 parent, aiNode* node, std::map<int, aiMatrix4x4>& result)
+{
+	aiMatrix4x4 t = node->mTransformation * parent;
+	for (unsigned int i = 0; i < node->mNumMeshes; ++i)
+	{
+		result[node->mMeshes[i]] = t;
+	}
+
+	for (unsigned int i = 0; i < node->mNumChildren; ++i)
+	{
+		flatten_transforms(t, node->mChildren[i], result);
+	}
+}
+
+VertexLayoutFlags get_layout_flags(aiMesh const* mesh)
+{
+	// Construct the vertex layout flags to track compatibility with material/shaders
+	VertexLayoutFlags flags = VertexLayoutFlags::Position | VertexLayoutFlags::Normal;
+	for (unsigned int j = 0; j < std::min(mesh->GetNumUVChannels(), 4u); ++j)
+	{
+		if (mesh->HasTextureCoords(j))
+		{
+			flags |= (VertexLayoutFlags::UV0 << j);
+		}
+
+		if (mesh->HasTangentsAndBitangents())
+		{
+			flags |= (VertexLayoutFlags::Tangent0 << (j * 2));
+			flags |= (VertexLayoutFlags::Tangent0 << (j * 2 + 1));
+		}
+	}
+
+	for (unsigned int j = 0; j < std::min(mesh->GetNumColorChannels(), 4u); ++j)
+	{
+		if (mesh->HasVertexColors(j))
+		{
+			flags |= (VertexLayoutFlags::Colour0 << j);
+		}
+	}
+	return flags;
+}
+
+bool get_file_stamp(std::filesystem::path const& file, u64& size, u64& write_time)
+{
+	std::error_code ec;
+	size = u64(std::filesystem::file_size(file, ec));
+	if (ec)
+	{
+		return false;
+	}
+
+	write_time = u64(std::filesystem::last_write_time(file, ec).time_since_epoch().count());
+	return !ec;
+}
+
+// Reads from disk like the default IO system and remembers every file the importer opened (e.g. the buffers of a .gltf)
+class DependencyIOSystem final : public Assimp::DefaultIOSystem
+{
+public:
+	Assimp::IOStream* Open(const char* file, const char* mode) override
+	{
+		Assimp::IOStream* stream = DefaultIOSystem::Open(file, mode);
+		if (stream && std::find(_files.begin(), _files.end(), file) == _files.end())
+		{
+			_files.push_back(file);
+		}
+		return stream;
+	}
+
+	std::vector<std::string> const& get_files() const { return _files; }
+
+private:
+	std::vector<std::string> _files;
+};
+
+} // namespace
+
+bool CookedModel::open(u8 const* data, size_t size)
+{
+	_header = nullptr;
+	_data = data;
+	if (!data || size < sizeof(CookedModelHeader))
+	{
+		return false;
+	}
+
+	CookedModelHeader const* header = reinterpret_cast<CookedModelHeader const*>(data);
+	if (header->magic != CookedModelHeader::c_Magic || header->version != CookedModelHeader::c_Version)
+	{
+		return false;
+	}
+
+	auto fits = [size](u32 offset, u64 count, u64 stride)
+	{
+		return offset <= size && count * stride <= size - offset;
+	};
+
+	bool valid = (header->index_stride == sizeof(u16) || header->index_stride == sizeof(u32))
+			&& fits(header->vertices_offset, header->vertices_size, 1)
+			&& fits(header->indices_offset, header->n_indices, header->index_stride)
+			&& fits(header->meshes_offset, header->n_meshes, sizeof(CookedMesh))
+			&& fits(header->lods_offset, header->n_lods, sizeof(CookedMeshLod))
+			&& fits(header->materials_offset, header->n_materials, sizeof(CookedMaterial))
+			&& fits(header->dependencies_offset, header->n_dependencies, sizeof(CookedDependency))
+			&& fits(header->string_table_offset, header->string_table_size, 1)
+			&& header->string_table_size > 0
+			&& data[header->string_table_offset + header->string_table_size - 1] == '\0'
+			&& header->base_material < header->string_table_size;
+	if (!valid)
+	{
+		return false;
+	}
+
+	CookedMeshLod const* lods = reinterpret_cast<CookedMeshLod const*>(data + header->lods_offset);
+	for (u32 i = 0; i < header->n_lods; ++i)
+	{
+		if (u64(lods[i].first_index) + lods[i].index_count > header->n_indices)
+		{
+			return false;
+		}
+	}
+
+	CookedMesh const* meshes = reinterpret_cast<CookedMesh const*>(data + header->meshes_offset);
+	for (u32 i = 0; i < header->n_meshes; ++i)
+	{
+		// A stride that doesn't match the flags means the stream was written by an older vertex format
+		CookedMesh const& mesh = meshes[i];
+		if (mesh.n_lods == 0 || mesh.n_lods > Mesh::c_MaxLods || u64(mesh.first_lod) + mesh.n_lods > header->n_lods
+				|| mesh.material_index >= header->n_materials
+				|| mesh.vertex_stride == 0 || mesh.vertex_stride != VertexFormat::get_stride(VertexLayoutFlags(mesh.layout_flags))
+				|| (u64(mesh.first_vertex) + mesh.vertex_count) * mesh.vertex_stride > header->vertices_size)
+		{
+			return false;
+		}
+	}
+
+	CookedMaterial const* materials = reinterpret_cast<CookedMaterial const*>(data + header->materials_offset);
+	for (u32 i = 0; i < header->n_materials; ++i)
+	{
+		for (u32 texture : materials[i].textures)
+		{
+			if (texture != CookedMaterial::c_NoTexture && texture >= header->string_table_size)
+			{
+				return false;
+			}
+		}
+	}
+
+	CookedDependency const* dependencies = reinterpret_cast<CookedDependency const*>(data + header->dependencies_offset);
+	for (u32 i = 0; i < header->n_dependencies; ++i)
+	{
+		if (dependencies[i].path >= header->string_table_size)
+		{
+			return false;
+		}
+	}
+
+	_header = header;
+	return true;
+}
+
+u32 CookedModelBuilder::add_string(std::string_view str)
+{
+	u32 offset = u32(strings.size());
+	strings.insert(strings.end(), str.begin(), str.end());
+	strings.push_back('\0');
+	return offset;
+}
+
+bool CookedModelBuilder::add_dependency(std::filesystem::path const& file, std::string_view name)
+{
+	auto same_name = [this, name](CookedDependency const& dep) { return name == strings.data() + dep.path; };
+	if (std::any_of(dependencies.begin(), dependencies.end(), same_name))
+	{
+		return true;
+	}
+
+	CookedDependency dep{};
+	if (!get_file_stamp(file, dep.size, dep.write_time))
+	{
+		return false;
+	}
+
+	dep.path = add_string(name);
+	dependencies.push_back(dep);
+	return true;
+}
+
+void CookedModelBuilder::write(std::vector<u8>& out) const
+{
+	// Indices are local to their mesh as meshes are drawn with a base vertex
+	u32 max_vertex_count = 0;
+	for (CookedMesh const& mesh : meshes)
+	{
+		max_vertex_count = std::max(max_vertex_count, mesh.vertex_count);
+	}
+
+	CookedModelHeader header{};
+	header.magic = CookedModelHeader::c_Magic;
+	header.version = CookedModelHeader::c_Version;
+	header.vertices_size = u32(vertices.size());
+	header.index_stride = max_vertex_count <= u32(std::numeric_limits<u16>::max()) + 1 ? sizeof(u16) : sizeof(u32);
+	header.n_vertices = n_vertices;
+	header.n_indices = u32(indices.size());
+	header.n_meshes = u32(meshes.size());
+	header.n_materials = u32(materials.size());
+	header.n_lods = u32(lods.size());
+	header.n_dependencies = u32(dependencies.size());
+	header.base_material = base_material;
+	header.string_table_size = u32(strings.size());
+	std::copy(std::begin(aabb_min), std::end(aabb_min), header.aabb_min);
+	std::copy(std::begin(aabb_max), std::end(aabb_max), header.aabb_max);
+
+	size_t offset = sizeof(CookedModelHeader);
+	auto reserve = [&offset](size_t size)
+	{
+		u32 result = align_offset(offset);
+		offset = result + size;
+		return result;
+	};
+	header.vertices_offset = reserve(vertices.size());
+	header.indices_offset = reserve(indices.size() * header.index_stride);
+	header.meshes_offset = reserve(meshes.size() * sizeof(CookedMesh));
+	header.lods_offset = reserve(lods.size() * sizeof(CookedMeshLod));
+	header.materials_offset = reserve(materials.size() * sizeof(CookedMaterial));
+	header.dependencies_offset = reserve(dependencies.size() * sizeof(CookedDependency));
+	header.string_table_offset = reserve(strings.size());
+
+	out.assign(offset, 0);
+	memcpy(out.data(), &header, sizeof(header));
+
+	auto copy = [&out](u32 dst_offset, auto const& src)
+	{
+		if (!src.empty())
+		{
+			memcpy(out.data() + dst_offset, src.data(), src.size() * sizeof(src[0]));
+		}
+	};
+	copy(header.vertices_offset, vertices);
+	copy(header.meshes_offset, meshes);
+	copy(header.lods_offset, lods);
+	copy(header.materials_offset, materials);
+	copy(header.dependencies_offset, dependencies);
+	copy(header.string_table_offset, strings);
+
+	if (header.index_stride == sizeof(u16))
+	{
+		u16* dst = reinterpret_cast<u16*>(out.data() + header.indices_offset);
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			dst[i] = u16(indices[i]);
+		}
+	}
+	else
+	{
+		copy(header.indices_offset, indices);
+	}
+}
+
+bool is_cooked_model_current(std::string const& path, CookedModel const& model)
+{
+	std::error_code ec;
+	std::filesystem::path source = IO::get()->ResolvePath(path);
+	if (!std::filesystem::is_regular_file(source, ec))
+	{
+		return true;
+	}
+
+	// Cooked from memory while there is a loose source, nothing to compare against
+	CookedModelHeader const& header = model.get_header();
+	if (header.n_dependencies == 0)
+	{
+		return false;
+	}
+
+	std::filesystem::path dir = source.parent_path();
+	CookedDependency const* dependencies = model.get_dependencies();
+	for (u32 i = 0; i < header.n_dependencies; ++i)
+	{
+		u64 size = 0;
+		u64 write_time = 0;
+		if (!get_file_stamp(dir / model.get_string(dependencies[i].path), size, write_time)
+				|| size != dependencies[i].size || write_time != dependencies[i].write_time)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool cook_model(std::string const& path, std::vector<u8>& out, MeshOptimizer::Options const& options, MeshOptimizer::Report* report)
+{
+	JONO_EVENT();
+
+	std::string final_path = IO::get()->ResolvePath(path);
+
+	using namespace Assimp;
+	Importer importer = Importer();
+	aiScene const* scene = nullptr;
+
+	// Loose sources are imported from disk so external buffers resolve, packed sources only exist in memory.
+	//	The importer owns the IO system.
+	DependencyIOSystem* io = nullptr;
+	std::error_code ec;
+	if (std::filesystem::is_regular_file(final_path, ec))
+	{
+		io = new DependencyIOSystem();
+		importer.SetIOHandler(io);
+		scene = importer.ReadFile(final_path.c_str(), 0);
+	}
+	else if (IO::IMappedFileRef source = IO::get()->MapFile(path.c_str()); source)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		Span<u8 const> data = source->get_data();
+		scene = importer.ReadFileFromMemory(data.begin(), data.size(), 0, extension.empty() ? "" : extension.c_str() + 1);
+	}
+	scene = importer.ApplyPostProcessing(aiProcess_PreTransformVertices);
+	scene = importer.ApplyPostProcessing(aiProcess_Triangulate);
+	scene = importer.ApplyPostProcessing(aiProcess_GenNormals);
+	scene = importer.ApplyPostProcessing(aiProcess_GenUVCoords);
+	scene = importer.ApplyPostProcessing(aiProcess_CalcTangentSpace);
+	scene = importer.ApplyPostProcessing(aiProcess_ConvertToLeftHanded | aiProcessPreset_TargetRealtime_Fast);
+	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	{
+		LOG_ERROR(IO, importer.GetErrorString());
+		return false;
+	}
+
+	CookedModelBuilder builder{};
+	std::vector<u8>& vertex_data = builder.vertices;
+	std::vector<u32>& indices = builder.indices;
+	std::vector<CookedMesh>& meshes = builder.meshes;
+	std::vector<CookedMeshLod>& lods = builder.lods;
+	std::vector<CookedMaterial>& materials = builder.materials;
+
+	// Full precision mesh being cooked, optimized and packed once it is complete
+	std::vector<ModelVertex> vertices;
+	std::vector<u32> mesh_indices;
+	std::vector<MeshOptimizer::Lod> mesh_lods;
+
+	for (u32 k = 0; k < 3; ++k)
+	{
+		builder.aabb_min[k] = std::numeric_limits<float>::max();
+		builder.aabb_max[k] = -std::numeric_limits<float>::max();
+	}
+
+	std::map<int, aiMatrix4x4> transforms;
+	flatten_transforms(aiMatrix4x4(), scene->mRootNode, transforms);
+
+	for (unsigned int i = 0; i < scene->mNumMeshes; ++i)
+	{
+		aiMesh const* mesh = scene->mMeshes[i];
+		ASSERT(mesh->HasPositions() && mesh->HasNormals());
+
+		aiMatrix4x4 const& transform = transforms[i];
+		aiMatrix3x3 normalTransform = aiMatrix3x3{
+			transform.a1, transform.a2, transform.a3,
+			transform.b1, transform.b2, transform.b3,
+			transform.c1, transform.c2, transform.c3
+		};
+
+		VertexLayoutFlags flags = VertexFormat::get_supported_flags(get_layout_flags(mesh));
+
+		CookedMesh meshlet{};
+		meshlet.material_index = mesh->mMaterialIndex;
+		meshlet.layout_flags = u32(flags);
+
+		vertices.clear();
+		vertices.reserve(mesh->mNumVertices);
+		mesh_indices.clear();
+		mesh_indices.reserve(size_t(mesh->mNumFaces) * 3);
+
+		for (unsigned int j = 0; j < mesh->mNumVertices; ++j)
+		{
+			aiVector3D pos = mesh->mVertices[j];
+			pos *= transform;
+
+			ModelVertex v{};
+			v.position.x = pos.x;
+			v.position.y = pos.y;
+			v.position.z = pos.z;
+
+			for (u32 k = 0; k < 3; ++k)
+			{
+				builder.aabb_min[k] = std::min(builder.aabb_min[k], pos[k]);
+				builder.aabb_max[k] = std::max(builder.aabb_max[k], pos[k]);
+			}
+
+			for (unsigned int k = 0; k < std::min(mesh->GetNumColorChannels(), 4u); ++k)
+			{
+				if (mesh->HasVertexColors(k))
+				{
+					v.color[k].x = mesh->mColors[k][j].r;
+					v.color[k].y = mesh->mColors[k][j].g;
+					v.color[k].z = mesh->mColors[k][j].b;
+					v.color[k].w = mesh->mColors[k][j].a;
+				}
+			}
+
+			for (unsigned int k = 0; k < std::min(mesh->GetNumUVChannels(), 4u); ++k)
+			{
+				v.uv[k].x = mesh->mTextureCoords[k][j].x;
+				v.uv[k].y = mesh->mTextureCoords[k][j].y;
+			}
+
+			if (mesh->HasNormals())
+			{
+				aiVector3D normal = mesh->mNormals[j];
+				normal *= normalTransform;
+
+				v.normal.x = normal.x;
+				v.normal.y = normal.y;
+				v.normal.z = normal.z;
+			}
+
+			if (mesh->HasTangentsAndBitangents())
+			{
+				aiVector3D tangent = mesh->mTangents[j];
+				tangent *= normalTransform;
+
+				aiVector3D bitangent = mesh->mBitangents[j];
+				bitangent *= normalTransform;
+
+				v.tangent[0].x = tangent.x;
+				v.tangent[0].y = tangent.y;
+				v.tangent[0].z = tangent.z;
+
+				v.tangent[1].x = bitangent.x;
+				v.tangent[1].y = bitangent.y;
+				v.tangent[1].z = bitangent.z;
+			}
+
+			vertices.push_back(v);
+		}
+
+		for (unsigned int k = 0; k < mesh->mNumFaces; ++k)
+		{
+			aiFace const& f = mesh->mFaces[k];
+			for (unsigned int idx = 0; idx < f.mNumIndices; ++idx)
+			{
+				mesh_indices.push_back(f.mIndices[idx]);
+			}
+		}
+
+		MeshOptimizer::Report mesh_report = MeshOptimizer::optimize(vertices, mesh_indices, options);
+		if (report)
+		{
+			report->before.add(mesh_report.before);
+			report->after.add(mesh_report.after);
+		}
+
+		mesh_lods.clear();
+		if (options.lods)
+		{
+			MeshOptimizer::generate_lods(vertices, mesh_indices, Mesh::c_MaxLods, options.lod_max_error, mesh_lods);
+		}
+
+		// The full resolution mesh is the first LOD, the simplified ones index the same vertices
+		meshlet.first_lod = u32(lods.size());
+		meshlet.n_lods = u32(mesh_lods.size() + 1);
+		lods.push_back({ u32(indices.size()), u32(mesh_indices.size()), 0.0f });
+		indices.insert(indices.end(), mesh_indices.begin(), mesh_indices.end());
+		for (MeshOptimizer::Lod const& lod : mesh_lods)
+		{
+			lods.push_back({ u32(indices.size()), u32(lod.indices.size()), lod.error });
+			indices.insert(indices.end(), lod.indices.begin(), lod.indices.end());
+		}
+
+		if (report)
+		{
+			report->lod_triangles.resize(std::max<size_t>(report->lod_triangles.size(), meshlet.n_lods), 0);
+			for (u32 lod = 0; lod < meshlet.n_lods; ++lod)
+			{
+				report->lod_triangles[lod] += lods[meshlet.first_lod + lod].index_count / 3;
+			}
+		}
+
+		// Pad the stream start to a multiple of the stride so the mesh can be drawn with a base vertex
+		meshlet.vertex_stride = VertexFormat::get_stride(flags);
+		meshlet.vertex_count = u32(vertices.size());
+		meshlet.first_vertex = u32((vertex_data.size() + meshlet.vertex_stride - 1) / meshlet.vertex_stride);
+		vertex_data.resize(size_t(meshlet.first_vertex + meshlet.vertex_count) * meshlet.vertex_stride);
+		VertexFormat::encode(flags, vertices.data(), meshlet.vertex_count, vertex_data.data() + size_t(meshlet.first_vertex) * meshlet.vertex_stride);
+
+		builder.n_vertices += meshlet.vertex_count;
+		meshes.push_back(meshlet);
+	}
+
+	// #TODO: Data-drive from the model meta information or somehow pick the right defines for our material based on what the model provides
+	std::string_view base_material = "res:/Engine/default.material";
+	if (strstr(path.c_str(), "Box.gltf"))
+	{
+		base_material = "res:/Engine/untextured.material";
+	}
+
+	if (scene->HasMaterials())
+	{
+		materials.resize(scene->mNumMaterials);
+		for (u32 j = 0; j < scene->mNumMaterials; ++j)
+		{
+			aiMaterial* material = scene->mMaterials[j];
+			CookedMaterial& cooked = materials[j];
+
+			bool double_sided = false;
+			material->Get(AI_MATKEY_TWOSIDED, double_sided);
+			cooked.double_sided = double_sided ? 1 : 0;
+
+			aiString textures[CookedMaterial::Slot_Count];
+			aiReturn found[CookedMaterial::Slot_Count] = {
+				material->GetTexture(AI_MATKEY_BASE_COLOR_TEXTURE, &textures[CookedMaterial::Slot_Albedo]),
+				material->GetTexture(AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLICROUGHNESS_TEXTURE, &textures[CookedMaterial::Slot_MetalnessRoughness]),
+				material->GetTexture(aiTextureType_NORMALS, 0, &textures[CookedMaterial::Slot_Normal]),
+				material->GetTexture(aiTextureType_AMBIENT_OCCLUSION, 0, &textures[CookedMaterial::Slot_AO]),
+				material->GetTexture(aiTextureType_EMISSIVE, 0, &textures[CookedMaterial::Slot_Emissive]),
+			};
+
+			for (u32 slot = 0; slot < CookedMaterial::Slot_Count; ++slot)
+			{
+				cooked.textures[slot] = found[slot] == aiReturn_SUCCESS ? builder.add_string(textures[slot].C_Str()) : CookedMaterial::c_NoTexture;
+			}
+		}
+	}
+
+	builder.base_material = builder.add_string(base_material);
+	if (builder.n_vertices == 0)
+	{
+		std::fill(std::begin(builder.aabb_min), std::end(builder.aabb_min), 0.0f);
+		std::fill(std::begin(builder.aabb_max), std::end(builder.aabb_max), 0.0f);
+	}
+
+	// Everything the importer read (e.g. the .bin of a .gltf) and the textures the materials point at decide when to re-cook
+	if (io)
+	{
+		std::filesystem::path dir = std::filesystem::path(final_path).parent_path();
+		for (std::string const& file : io->get_files())
+		{
+			std::filesystem::path relative = std::filesystem::proximate(file, dir, ec);
+			builder.add_dependency(file, ec ? file : relative.generic_string());
+		}
+
+		for (CookedMaterial const& material : materials)
+		{
+			for (u32 texture : material.textures)
+			{
+				// Embedded textures ('*0') are part of the model file
+				const char* texture_path = texture != CookedMaterial::c_NoTexture ? builder.strings.data() + texture : nullptr;
+				if (texture_path && texture_path[0] != '*')
+				{
+					builder.add_dependency(dir / texture_path, std::string(texture_path));
+				}
+			}
+		}
+	}
+
+	builder.write(out);
+	return true;
+}
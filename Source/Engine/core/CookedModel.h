@@ -0,0 +1,161 @@
+#pragma once
+
+#include "MeshOptimizer.h"
+
+// GPU ready binary form of a model, written by the model cooker next to the source file (e.g. 'Box.gltf.cmesh').
+//	The vertices and indices are stored in the layout the GPU buffers use so loading only maps the file and
+//	uploads the arrays. Every mesh has its own packed vertex stream (see VertexFormat.h) with only the attributes
+//	it provides. Meshes reference a range of the LOD table, every LOD is an index range over the same vertices.
+//	The files the model was imported from are recorded with their size and write time, see is_cooked_model_current.
+//	Every array starts 16 byte aligned, offsets are relative to the start of the file.
+struct CookedModelHeader
+{
+	static constexpr u32 c_Magic = 0x4C444D4A; // 'JMDL'
+	static constexpr u32 c_Version = 5;
+
+	u32 magic;
+	u32 version;
+
+	// Size of the vertex streams in bytes and the size of a single index
+	u32 vertices_size;
+	u32 index_stride;
+
+	u32 n_vertices;
+	u32 n_indices;
+	u32 n_meshes;
+	u32 n_materials;
+	u32 n_lods;
+	u32 n_dependencies;
+
+	f32 aabb_min[3];
+	f32 aabb_max[3];
+
+	// Offset of the base material path in the string table
+	u32 base_material;
+	u32 string_table_size;
+
+	u32 vertices_offset;
+	u32 indices_offset;
+	u32 meshes_offset;
+	u32 lods_offset;
+	u32 materials_offset;
+	u32 dependencies_offset;
+	u32 string_table_offset;
+
+	u32 padding[3];
+};
+static_assert(sizeof(CookedModelHeader) % 16 == 0);
+
+struct CookedMesh
+{
+	// Streams start at a multiple of their stride so 'first_vertex' is counted in vertices of this mesh
+	u32 first_vertex;
+	u32 vertex_count;
+	u32 vertex_stride;
+	u32 material_index;
+
+	// VertexLayoutFlags of the attributes stored in the vertex stream
+	u32 layout_flags;
+
+	// Range in the LOD table from fine to coarse, the first LOD is the full resolution mesh
+	u32 first_lod;
+	u32 n_lods;
+	u32 padding;
+};
+
+struct CookedMeshLod
+{
+	u32 first_index;
+	u32 index_count;
+
+	// Object space distance to the full resolution surface
+	f32 error;
+	u32 padding;
+};
+
+struct CookedMaterial
+{
+	// Texture slots that are filled from the source material
+	enum Slot : u32
+	{
+		Slot_Albedo,
+		Slot_MetalnessRoughness,
+		Slot_Normal,
+		Slot_AO,
+		Slot_Emissive,
+		Slot_Count
+	};
+	static constexpr u32 c_NoTexture = ~0u;
+	static constexpr const char* c_SlotNames[Slot_Count] = { "Albedo", "MetalnessRoughness", "Normal", "AO", "Emissive" };
+
+	// String offsets of the texture paths relative to the model directory or c_NoTexture
+	u32 textures[Slot_Count];
+	u32 double_sided;
+	u32 padding[2];
+};
+
+struct CookedDependency
+{
+	// Offset of the path in the string table, relative to the directory of the model
+	u32 path;
+	u32 padding;
+
+	// Size and last write time of the file when the model was cooked
+	u64 size;
+	u64 write_time;
+};
+
+// Read only view over a cooked model
+class ENGINE_API CookedModel final
+{
+public:
+	static constexpr const char* c_Extension = ".cmesh";
+
+	// Validates the data, 'data' has to outlive the view
+	bool open(u8 const* data, size_t size);
+
+	CookedModelHeader const& get_header() const { return *_header; }
+
+	void const* get_vertices() const { return _data + _header->vertices_offset; }
+	void const* get_indices() const { return _data + _header->indices_offset; }
+	CookedMesh const* get_meshes() const { return reinterpret_cast<CookedMesh const*>(_data + _header->meshes_offset); }
+	CookedMeshLod const* get_lods() const { return reinterpret_cast<CookedMeshLod const*>(_data + _header->lods_offset); }
+	CookedMaterial const* get_materials() const { return reinterpret_cast<CookedMaterial const*>(_data + _header->materials_offset); }
+	CookedDependency const* get_dependencies() const { return reinterpret_cast<CookedDependency const*>(_data + _header->dependencies_offset); }
+	const char* get_string(u32 offset) const { return reinterpret_cast<const char*>(_data + _header->string_table_offset) + offset; }
+
+private:
+	u8 const* _data = nullptr;
+	CookedModelHeader const* _header = nullptr;
+};
+
+// Arrays of a model being cooked, write lays them out in the cooked form
+class ENGINE_API CookedModelBuilder final
+{
+public:
+	u32 add_string(std::string_view str);
+
+	// Records the size and write time of 'file', 'name' is the path relative to the model directory
+	bool add_dependency(std::filesystem::path const& file, std::string_view name);
+
+	void write(std::vector<u8>& out) const;
+
+	std::vector<u8> vertices;
+	std::vector<u32> indices;
+	std::vector<CookedMesh> meshes;
+	std::vector<CookedMeshLod> lods;
+	std::vector<CookedMaterial> materials;
+	std::vector<CookedDependency> dependencies;
+	std::vector<char> strings;
+
+	u32 n_vertices = 0;
+	u32 base_material = 0;
+	f32 aabb_min[3] = {};
+	f32 aabb_max[3] = {};
+};
+
+// Returns false when a file the model was cooked from changed since, models without a loose source file are always current
+ENGINE_API bool is_cooked_model_current(std::string const& path, CookedModel const& model);
+
+// Imports a model through Assimp and writes the cooked form, the optimizer stats of all meshes are added to 'report'
+ENGINE_API bool cook_model(std::string const& path, std::vector<u8>& out, MeshOptimizer::Options const& options = {}, MeshOptimizer::Report* report = nullptr);
@@ -84,15 +84,15 @@ std::unique_ptr<Material> Material::load(std::string const& path)
 			// Get pixel shader
 			ShaderCreateParams create_params{};
 			create_params.params = params;
-			create_params.path = IO::get()->ResolvePath(pixel_path);
+			create_params.path = pixel_path;
 			auto pixel_shader = ShaderCache::instance()->find_or_create(create_params);
 
 			create_params.params = params;
-			create_params.path = IO::get()->ResolvePath(debug_pixel_path);
+			create_params.path = debug_pixel_path;
 			auto debug_shader = ShaderCache::instance()->find_or_create(create_params);
 
 			create_params.params.stage = ShaderStage::Vertex;
-			create_params.path = IO::get()->ResolvePath(vertex_shader_path);
+			create_params.path = vertex_shader_path;
 			auto vertex_shader = ShaderCache::instance()->find_or_create(create_params);
 
 			if (!pixel_shader)
@@ -10,7 +10,7 @@
 
 #include "Graphics/ShaderCompiler.h"
 
-bool MaterialHandle::load(enki::ITaskSet* parent)
+bool MaterialHandle::load(Tasks::JobCounter* parent)
 {
 	using namespace Graphics;
 
@@ -64,7 +64,7 @@ public:
 	}
 	~MaterialHandle() { }
 
-	bool load(enki::ITaskSet* parent) override;
+	bool load(Tasks::JobCounter* parent) override;
 
 };
 
@@ -35,22 +35,97 @@ void transform_frustum(FrustumCorners& corners, float4x4 matrix)
 
 bool test_frustum_sphere(Frustum const& frustum, float3 pos, f32 radius)
 {
-	bool inside = true;
-	for(int i = 0; i < frustum._planes.size(); ++i)
+	for (FrustumPlane const& plane : frustum._planes)
 	{
-		float3 normal = frustum._planes[i].normal;
-		float3 to_plane_center = pos - frustum._planes[i].p[0].xyz;
+		if (plane.distance(pos) > radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+CullResult test_frustum_aabb(Frustum const& frustum, AABB const& box, u32* plane_mask)
+{
+	u32 mask = plane_mask ? *plane_mask : Frustum::c_AllPlanes;
+
+	float3 center = box.center();
+	float3 extents = box.size() / 2.0f;
+
+	for (u32 i = 0; i < Frustum::FrustumPlane_Count; ++i)
+	{
+		if ((mask & (1 << i)) == 0)
+		{
+			continue;
+		}
+
+		// Projecting the extents on the normal gives the distance of the n- and p-vertex without selecting them per axis
+		FrustumPlane const& plane = frustum._planes[i];
+		f32 dist = plane.distance(center);
+		f32 radius = hlslpp::dot(extents, hlslpp::abs(plane.normal));
+		if (dist - radius > 0.0f)
+		{
+			return CullResult::Outside;
+		}
+
+		if (dist + radius <= 0.0f)
+		{
+			mask &= ~(1 << i);
+		}
+	}
+
+	if (plane_mask)
+	{
+		*plane_mask = mask;
+	}
+	return mask == 0 ? CullResult::Inside : CullResult::Intersect;
+}
+
+CullResult test_frustum_obb(Frustum const& frustum, AABB const& box, float4x4 const& transform)
+{
+	float3 center = hlslpp::mul(float4(box.center(), 1.0f), transform).xyz;
+	float3 extents = box.size() / 2.0f;
 
-		// Distance to plane
-		float d = hlslpp::dot(to_plane_center, normal);
-		if(d > radius)
+	// Scaled box axes in world space
+	float3 axis_x = transform._11_12_13 * extents.x;
+	float3 axis_y = transform._21_22_23 * extents.y;
+	float3 axis_z = transform._31_32_33 * extents.z;
+
+	bool intersecting = false;
+	for (FrustumPlane const& plane : frustum._planes)
+	{
+		f32 dist = plane.distance(center);
+		f32 radius = hlslpp::abs(hlslpp::dot(axis_x, plane.normal)) + hlslpp::abs(hlslpp::dot(axis_y, plane.normal)) + hlslpp::abs(hlslpp::dot(axis_z, plane.normal));
+		if (dist - radius > 0.0f)
 		{
-			inside = false;
-			break;
+			return CullResult::Outside;
 		}
+		intersecting |= dist + radius > 0.0f;
 	}
+	return intersecting ? CullResult::Intersect : CullResult::Inside;
+}
+
+Sphere compute_bounding_sphere(AABB const& box, float4x4 const& transform)
+{
+	float3 center = hlslpp::mul(float4(box.center(), 1.0f), transform).xyz;
 
-	return inside;
+	// Scale the local radius by the largest axis scale so the sphere stays conservative under non uniform scale
+	f32 scale_sq = hlslpp::max(hlslpp::max(hlslpp::dot(transform._11_12_13, transform._11_12_13), hlslpp::dot(transform._21_22_23, transform._21_22_23)), hlslpp::dot(transform._31_32_33, transform._31_32_33));
+	f32 radius = hlslpp::length(box.size() / 2.0f) * sqrtf(scale_sq);
+	return { center, radius };
+}
+
+AABB transform_aabb(AABB const& box, float4x4 const& matrix)
+{
+	// Transform the center and project the extents onto the world axes instead of transforming all 8 corners
+	float3 center = hlslpp::mul(float4(box.center(), 1.0f), matrix).xyz;
+	float3 extents = box.size() / 2.0f;
+
+	float3 world_extents = extents.x * hlslpp::abs(matrix._11_12_13);
+	world_extents += extents.y * hlslpp::abs(matrix._21_22_23);
+	world_extents += extents.z * hlslpp::abs(matrix._31_32_33);
+
+	return { center - world_extents, center + world_extents };
 }
 
 Frustum Frustum::from_fov(f32 n, f32 f, f32 fov, f32 vertical_fov)
@@ -134,24 +209,35 @@ void Frustum::calculate_planes()
 
 	_planes[FrustumPlane_Top] = FrustumPlane(_corners[1], _corners[5], _corners[4], _corners[0]);
 	_planes[FrustumPlane_Bottom] = FrustumPlane(_corners[7], _corners[3], _corners[2], _corners[6]);
+
+	for (u32 i = 0; i < FrustumPlane_Count; ++i)
+	{
+		_planes_soa.nx[i] = _planes[i].normal.x;
+		_planes_soa.ny[i] = _planes[i].normal.y;
+		_planes_soa.nz[i] = _planes[i].normal.z;
+		_planes_soa.d[i] = _planes[i].d;
+	}
 }
 
 // Plane passed in as follows:
 //  a ---- b 
 //  |      |
-//  d ---- c
- FrustumPlane::FrustumPlane(float4 a, float4 b, float4 c, float4 d)
+//  e ---- c
+ FrustumPlane::FrustumPlane(float4 a, float4 b, float4 c, float4 e)
 {
 	p[0] = a;
 	p[1] = b;
 	p[2] = c;
-	p[3] = d;
+	p[3] = e;
 
 	float3 aVec = hlslpp::normalize(b - a).xyz;
-	float3 bVec = hlslpp::normalize(d - a).xyz;
-	normal = hlslpp::cross(aVec, bVec);
+	float3 bVec = hlslpp::normalize(e - a).xyz;
+
+	// The edges are not perpendicular for the side planes of a perspective frustum, the cross product has to be normalized
+	normal = hlslpp::normalize(hlslpp::cross(aVec, bVec));
+	d = -hlslpp::dot(a.xyz, normal);
 
-	center = (a + b + c + d) / 4.0f;
+	center = (a + b + c + e) / 4.0f;
 }
 
 } // namespace math
@@ -30,15 +30,34 @@ struct AABB
 	float3 max;
 };
 
+struct Sphere
+{
+	float3 center;
+	f32 radius;
+};
+
 struct FrustumPlane
 {
 	float4 p[4]; // Points of the plane
 	float4 center;
+
+	// Normalized plane equation with the normal pointing out of the frustum, points outside have a positive distance
 	float3 normal;
+	f32 d;
 
 	FrustumPlane() = default;
 
-	FrustumPlane(float4 a, float4 b, float4 c, float4 d);
+	FrustumPlane(float4 a, float4 b, float4 c, float4 e);
+
+	f32 distance(float3 pos) const { return hlslpp::dot(pos, normal) + d; }
+};
+
+// Result of a culling test, 'Inside' means the volume is fully contained and its children don't need further tests
+enum class CullResult
+{
+	Outside,
+	Intersect,
+	Inside
 };
 
 struct Frustum
@@ -60,8 +79,22 @@ struct Frustum
 		FrustumPlane_Count
 	};
 
+	// Plane equations laid out for testing 4 volumes at a time
+	struct PlanesSoA
+	{
+		f32 nx[FrustumPlane_Count];
+		f32 ny[FrustumPlane_Count];
+		f32 nz[FrustumPlane_Count];
+		f32 d[FrustumPlane_Count];
+	};
+
+	PlanesSoA const& get_planes_soa() const { return _planes_soa; }
+
+	static constexpr u32 c_AllPlanes = (1 << FrustumPlane_Count) - 1;
+
 	std::array<FrustumPlane, FrustumPlane_Count> _planes; 
 	std::array<float4, 8> _corners;
+	PlanesSoA _planes_soa;
 
 
 	private:
@@ -86,6 +119,19 @@ void transform_frustum(FrustumCorners& corners, float4x4 matrix);
 
 bool test_frustum_sphere(Frustum const& frustum, float3 pos, f32 radius);
 
+// Tests a world space box against the frustum.
+// 'plane_mask' selects the planes to test, planes the box is fully inside of are cleared so the children in a hierarchy can skip them.
+CullResult test_frustum_aabb(Frustum const& frustum, AABB const& box, u32* plane_mask = nullptr);
+
+// Tests a local space box transformed by 'transform' without computing the enclosing world space box first
+CullResult test_frustum_obb(Frustum const& frustum, AABB const& box, float4x4 const& transform);
+
+// Computes the world space sphere enclosing a local space box, accounts for rotation and non uniform scale
+Sphere compute_bounding_sphere(AABB const& box, float4x4 const& transform);
+
+// Computes the axis aligned box enclosing 'box' after it has been transformed by 'matrix'
+AABB transform_aabb(AABB const& box, float4x4 const& matrix);
+
 }
 
 namespace hlslpp_helpers
@@ -0,0 +1,695 @@
+#include "engine.pch.h"
+#include "MeshOptimizer.h"
+
+#include "ModelResource.h"
+
+#include <numeric>
+
+namespace MeshOptimizer
+{
+
+namespace
+{
+
+constexpr u32 c_Invalid = ~0u;
+
+// Triangles that use a vertex, stored as one flat array with offsets per vertex
+struct Adjacency
+{
+	Adjacency(std::vector<u32> const& indices, u32 n_vertices)
+			: offsets(n_vertices + 1, 0)
+			, triangles(indices.size())
+	{
+		for (u32 index : indices)
+		{
+			++offsets[index + 1];
+		}
+
+		for (u32 i = 0; i < n_vertices; ++i)
+		{
+			offsets[i + 1] += offsets[i];
+		}
+
+		std::vector<u32> cursor(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			triangles[cursor[indices[i]]++] = u32(i / 3);
+		}
+	}
+
+	std::vector<u32> offsets;
+	std::vector<u32> triangles;
+};
+
+struct Vector3
+{
+	f32 x, y, z;
+
+	Vector3 operator+(Vector3 const& rhs) const { return { x + rhs.x, y + rhs.y, z + rhs.z }; }
+	Vector3 operator-(Vector3 const& rhs) const { return { x - rhs.x, y - rhs.y, z - rhs.z }; }
+	Vector3 operator*(f32 rhs) const { return { x * rhs, y * rhs, z * rhs }; }
+
+	f32 dot(Vector3 const& rhs) const { return x * rhs.x + y * rhs.y + z * rhs.z; }
+	Vector3 cross(Vector3 const& rhs) const { return { y * rhs.z - z * rhs.y, z * rhs.x - x * rhs.z, x * rhs.y - y * rhs.x }; }
+};
+
+Vector3 get_position(ModelVertex const& v)
+{
+	return { v.position.x, v.position.y, v.position.z };
+}
+
+// Sum of the squared distances to a set of planes, stored as the symmetric 4x4 matrix with the total plane weight
+struct Quadric
+{
+	f64 a00, a11, a22, a01, a02, a12;
+	f64 b0, b1, b2;
+	f64 c;
+	f64 weight;
+
+	void add_plane(Vector3 const& normal, f32 distance, f64 w)
+	{
+		f64 x = normal.x, y = normal.y, z = normal.z, d = distance;
+		a00 += w * x * x;
+		a11 += w * y * y;
+		a22 += w * z * z;
+		a01 += w * x * y;
+		a02 += w * x * z;
+		a12 += w * y * z;
+		b0 += w * x * d;
+		b1 += w * y * d;
+		b2 += w * z * d;
+		c += w * d * d;
+		weight += w;
+	}
+
+	void add(Quadric const& rhs)
+	{
+		a00 += rhs.a00;
+		a11 += rhs.a11;
+		a22 += rhs.a22;
+		a01 += rhs.a01;
+		a02 += rhs.a02;
+		a12 += rhs.a12;
+		b0 += rhs.b0;
+		b1 += rhs.b1;
+		b2 += rhs.b2;
+		c += rhs.c;
+		weight += rhs.weight;
+	}
+
+	// Weighted mean of the squared distances from 'p' to the planes
+	f64 evaluate(Vector3 const& p) const
+	{
+		f64 x = p.x, y = p.y, z = p.z;
+		f64 result = a00 * x * x + a11 * y * y + a22 * z * z
+				+ 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+				+ 2.0 * (b0 * x + b1 * y + b2 * z)
+				+ c;
+		return weight > 0.0 ? std::max(result, 0.0) / weight : 0.0;
+	}
+};
+
+Vector3 get_normal(Vector3 const& p0, Vector3 const& p1, Vector3 const& p2)
+{
+	return (p1 - p0).cross(p2 - p0);
+}
+
+// Meshes below this triangle count don't get further LODs, the draw call costs more than the triangles
+constexpr u32 c_MinLodTriangles = 64;
+
+// A level that keeps more than this fraction of the previous level's triangles isn't worth storing
+constexpr f32 c_MinLodReduction = 0.8f;
+
+} // namespace
+
+Report optimize(std::vector<ModelVertex>& vertices, std::vector<u32>& indices, Options const& options)
+{
+	JONO_EVENT();
+
+	Report report{};
+	report.before = analyze_vertex_cache(indices, u32(vertices.size()));
+
+	if (options.weld)
+	{
+		weld_vertices(vertices, indices);
+	}
+
+	if (options.vertex_cache)
+	{
+		optimize_vertex_cache(indices, u32(vertices.size()));
+
+		if (options.overdraw)
+		{
+			optimize_overdraw(indices, vertices, options.overdraw_threshold);
+		}
+	}
+
+	if (options.vertex_fetch)
+	{
+		optimize_vertex_fetch(vertices, indices);
+	}
+
+	report.after = analyze_vertex_cache(indices, u32(vertices.size()));
+	return report;
+}
+
+u32 weld_vertices(std::vector<ModelVertex>& vertices, std::vector<u32>& indices)
+{
+	JONO_EVENT();
+
+	auto hash = [&vertices](u32 i) { return size_t(Hash::fnv1a(vertices[i])); };
+	auto equal = [&vertices](u32 lhs, u32 rhs) { return memcmp(&vertices[lhs], &vertices[rhs], sizeof(ModelVertex)) == 0; };
+	std::unordered_set<u32, decltype(hash), decltype(equal)> unique(vertices.size(), hash, equal);
+
+	// Every vertex maps to the first identical vertex
+	std::vector<u32> remap(vertices.size());
+	std::vector<ModelVertex> result;
+	result.reserve(vertices.size());
+	for (u32 i = 0; i < u32(vertices.size()); ++i)
+	{
+		auto [it, inserted] = unique.insert(i);
+		if (inserted)
+		{
+			remap[i] = u32(result.size());
+			result.push_back(vertices[i]);
+		}
+		else
+		{
+			remap[i] = remap[*it];
+		}
+	}
+	vertices = std::move(result);
+
+	for (u32& index : indices)
+	{
+		index = remap[index];
+	}
+	return u32(vertices.size());
+}
+
+void optimize_vertex_cache(std::vector<u32>& indices, u32 n_vertices, u32 cache_size)
+{
+	JONO_EVENT();
+
+	ASSERTMSG(indices.size() % 3 == 0, "Index count {} isn't a multiple of 3.", indices.size());
+	u32 const n_triangles = u32(indices.size() / 3);
+	if (n_triangles == 0)
+	{
+		return;
+	}
+
+	Adjacency adjacency{ indices, n_vertices };
+
+	// Triangles that still have to be emitted per vertex
+	std::vector<u32> live(n_vertices);
+	for (u32 i = 0; i < n_vertices; ++i)
+	{
+		live[i] = adjacency.offsets[i + 1] - adjacency.offsets[i];
+	}
+
+	std::vector<u32> cache_time(n_vertices, 0);
+	std::vector<bool> emitted(n_triangles, false);
+	std::vector<u32> dead_end;
+	std::vector<u32> candidates;
+
+	std::vector<u32> result;
+	result.reserve(indices.size());
+
+	u32 time = cache_size + 1;
+	u32 cursor = 0;
+
+	// Fallback when the candidates have no live triangles left, recently used vertices first and then in input order
+	auto skip_dead_end = [&]() -> u32
+	{
+		while (!dead_end.empty())
+		{
+			u32 v = dead_end.back();
+			dead_end.pop_back();
+			if (live[v] > 0)
+			{
+				return v;
+			}
+		}
+
+		for (; cursor < n_vertices; ++cursor)
+		{
+			if (live[cursor] > 0)
+			{
+				return cursor;
+			}
+		}
+		return c_Invalid;
+	};
+
+	u32 fan = skip_dead_end();
+	while (fan != c_Invalid)
+	{
+		// Emit every remaining triangle around the fanning vertex
+		candidates.clear();
+		for (u32 i = adjacency.offsets[fan]; i < adjacency.offsets[fan + 1]; ++i)
+		{
+			u32 triangle = adjacency.triangles[i];
+			if (emitted[triangle])
+			{
+				continue;
+			}
+
+			for (u32 k = 0; k < 3; ++k)
+			{
+				u32 v = indices[triangle * 3 + k];
+				result.push_back(v);
+				dead_end.push_back(v);
+				candidates.push_back(v);
+				--live[v];
+
+				if (time - cache_time[v] > cache_size)
+				{
+					cache_time[v] = time++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+
+		// Continue with the candidate that stays in the cache the longest while its remaining triangles are emitted
+		u32 best = c_Invalid;
+		s64 best_priority = -1;
+		for (u32 v : candidates)
+		{
+			if (live[v] == 0)
+			{
+				continue;
+			}
+
+			s64 priority = 0;
+			if (time - cache_time[v] + 2 * live[v] <= cache_size)
+			{
+				priority = s64(time - cache_time[v]);
+			}
+
+			if (priority > best_priority)
+			{
+				best_priority = priority;
+				best = v;
+			}
+		}
+
+		fan = best != c_Invalid ? best : skip_dead_end();
+	}
+
+	ASSERT(result.size() == indices.size());
+	indices = std::move(result);
+}
+
+void optimize_overdraw(std::vector<u32>& indices, std::vector<ModelVertex> const& vertices, f32 threshold, u32 cache_size)
+{
+	JONO_EVENT();
+
+	u32 const n_triangles = u32(indices.size() / 3);
+	if (n_triangles == 0)
+	{
+		return;
+	}
+
+	// Split the triangles into clusters where the cache restarts, reordering whole clusters keeps most of the cache efficiency
+	std::vector<u32> clusters;
+	{
+		std::vector<u32> cache_time(vertices.size(), 0);
+		u32 time = cache_size + 1;
+		for (u32 t = 0; t < n_triangles; ++t)
+		{
+			u32 n_misses = 0;
+			for (u32 k = 0; k < 3; ++k)
+			{
+				u32 v = indices[t * 3 + k];
+				if (time - cache_time[v] > cache_size)
+				{
+					cache_time[v] = time++;
+					++n_misses;
+				}
+			}
+
+			if (t == 0 || n_misses == 3)
+			{
+				clusters.push_back(t);
+			}
+		}
+	}
+
+	if (clusters.size() < 2)
+	{
+		return;
+	}
+	clusters.push_back(n_triangles);
+
+	// Area weighted centroid and normal per cluster
+	u32 const n_clusters = u32(clusters.size() - 1);
+	std::vector<Vector3> centroids(n_clusters, Vector3{});
+	std::vector<Vector3> normals(n_clusters, Vector3{});
+	std::vector<f32> areas(n_clusters, 0.0f);
+
+	Vector3 mesh_centroid{};
+	f32 mesh_area = 0.0f;
+	for (u32 c = 0; c < n_clusters; ++c)
+	{
+		for (u32 t = clusters[c]; t < clusters[c + 1]; ++t)
+		{
+			Vector3 p0 = get_position(vertices[indices[t * 3 + 0]]);
+			Vector3 p1 = get_position(vertices[indices[t * 3 + 1]]);
+			Vector3 p2 = get_position(vertices[indices[t * 3 + 2]]);
+
+			Vector3 normal = (p1 - p0).cross(p2 - p0);
+			f32 area = sqrtf(normal.dot(normal));
+
+			centroids[c] = centroids[c] + (p0 + p1 + p2) * (area / 3.0f);
+			normals[c] = normals[c] + normal;
+			areas[c] += area;
+		}
+
+		mesh_centroid = mesh_centroid + centroids[c];
+		mesh_area += areas[c];
+	}
+
+	if (mesh_area <= 0.0f)
+	{
+		return;
+	}
+	mesh_centroid = mesh_centroid * (1.0f / mesh_area);
+
+	// Clusters facing away from the center are likely to occlude the rest of the mesh so they go first
+	std::vector<f32> sort_keys(n_clusters, 0.0f);
+	for (u32 c = 0; c < n_clusters; ++c)
+	{
+		f32 normal_length = sqrtf(normals[c].dot(normals[c]));
+		if (areas[c] > 0.0f && normal_length > 0.0f)
+		{
+			Vector3 centroid = centroids[c] * (1.0f / areas[c]);
+			sort_keys[c] = (centroid - mesh_centroid).dot(normals[c]) / normal_length;
+		}
+	}
+
+	std::vector<u32> order(n_clusters);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&sort_keys](u32 lhs, u32 rhs) { return sort_keys[lhs] > sort_keys[rhs]; });
+
+	std::vector<u32> result;
+	result.reserve(indices.size());
+	for (u32 c : order)
+	{
+		result.insert(result.end(), indices.begin() + size_t(clusters[c]) * 3, indices.begin() + size_t(clusters[c + 1]) * 3);
+	}
+
+	f32 acmr = analyze_vertex_cache(indices, u32(vertices.size()), cache_size).get_acmr();
+	f32 new_acmr = analyze_vertex_cache(result, u32(vertices.size()), cache_size).get_acmr();
+	if (new_acmr <= acmr * threshold)
+	{
+		indices = std::move(result);
+	}
+}
+
+u32 optimize_vertex_fetch(std::vector<ModelVertex>& vertices, std::vector<u32>& indices)
+{
+	JONO_EVENT();
+
+	std::vector<u32> remap(vertices.size(), c_Invalid);
+	std::vector<ModelVertex> result;
+	result.reserve(vertices.size());
+	for (u32& index : indices)
+	{
+		if (remap[index] == c_Invalid)
+		{
+			remap[index] = u32(result.size());
+			result.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	vertices = std::move(result);
+	return u32(vertices.size());
+}
+
+f32 simplify(std::vector<ModelVertex> const& vertices, std::vector<u32> const& indices, u32 target_index_count, f32 target_error, std::vector<u32>& result)
+{
+	JONO_EVENT();
+
+	ASSERTMSG(indices.size() % 3 == 0, "Index count {} isn't a multiple of 3.", indices.size());
+	result = indices;
+
+	u32 const n_vertices = u32(vertices.size());
+	std::vector<Vector3> positions(n_vertices);
+	for (u32 i = 0; i < n_vertices; ++i)
+	{
+		positions[i] = get_position(vertices[i]);
+	}
+
+	// Edges that aren't shared by exactly two triangles are on a border or a seam where the vertices are split
+	std::vector<bool> locked(n_vertices, false);
+	{
+		std::unordered_map<u64, u32> edges;
+		edges.reserve(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (u32 k = 0; k < 3; ++k)
+			{
+				u32 a = indices[i + k];
+				u32 b = indices[i + (k + 1) % 3];
+				++edges[(u64(std::min(a, b)) << 32) | std::max(a, b)];
+			}
+		}
+
+		for (auto const& [edge, count] : edges)
+		{
+			if (count != 2)
+			{
+				locked[u32(edge >> 32)] = true;
+				locked[u32(edge)] = true;
+			}
+		}
+	}
+
+	// Every vertex starts with the area weighted planes of its triangles
+	std::vector<Quadric> quadrics(n_vertices, Quadric{});
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		Vector3 const& p0 = positions[indices[i + 0]];
+		Vector3 normal = get_normal(p0, positions[indices[i + 1]], positions[indices[i + 2]]);
+		f32 length = sqrtf(normal.dot(normal));
+		if (length <= 0.0f)
+		{
+			continue;
+		}
+
+		normal = normal * (1.0f / length);
+		f32 distance = -normal.dot(p0);
+		for (u32 k = 0; k < 3; ++k)
+		{
+			quadrics[indices[i + k]].add_plane(normal, distance, length * 0.5f);
+		}
+	}
+
+	struct Collapse
+	{
+		f64 cost;
+		u32 from;
+		u32 to;
+	};
+	std::vector<Collapse> collapses;
+	std::vector<u32> remap(n_vertices);
+	std::vector<bool> touched(n_vertices);
+
+	f64 const max_cost = f64(target_error) * f64(target_error);
+	f64 error = 0.0;
+
+	// Every pass collapses the cheapest edges whose neighbourhoods don't overlap, the quadrics are merged as vertices collapse
+	while (result.size() > target_index_count)
+	{
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			for (u32 k = 0; k < 3; ++k)
+			{
+				u32 a = result[i + k];
+				u32 b = result[i + (k + 1) % 3];
+				if (a == b)
+				{
+					continue;
+				}
+
+				for (u32 from : { a, b })
+				{
+					u32 to = from == a ? b : a;
+					if (!locked[from])
+					{
+						Quadric q = quadrics[from];
+						q.add(quadrics[to]);
+						collapses.push_back({ q.evaluate(positions[to]), from, to });
+					}
+				}
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](Collapse const& lhs, Collapse const& rhs) { return lhs.cost < rhs.cost; });
+
+		Adjacency adjacency{ result, n_vertices };
+		std::iota(remap.begin(), remap.end(), 0);
+		std::fill(touched.begin(), touched.end(), false);
+
+		u32 const n_to_remove = u32((result.size() - target_index_count) / 3);
+		u32 n_removed = 0;
+		u32 n_collapsed = 0;
+		for (Collapse const& collapse : collapses)
+		{
+			if (collapse.cost > max_cost || n_removed >= n_to_remove)
+			{
+				break;
+			}
+
+			u32 const from = collapse.from;
+			u32 const to = collapse.to;
+			if (touched[from] || touched[to])
+			{
+				continue;
+			}
+
+			// Triangles sharing the edge disappear, the others must not flip or fold over
+			bool flipped = false;
+			u32 n_degenerate = 0;
+			for (u32 j = adjacency.offsets[from]; j < adjacency.offsets[from + 1] && !flipped; ++j)
+			{
+				u32 const* triangle = result.data() + size_t(adjacency.triangles[j]) * 3;
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+				{
+					++n_degenerate;
+					continue;
+				}
+
+				Vector3 p[3];
+				for (u32 k = 0; k < 3; ++k)
+				{
+					p[k] = positions[triangle[k]];
+				}
+				Vector3 old_normal = get_normal(p[0], p[1], p[2]);
+				for (u32 k = 0; k < 3; ++k)
+				{
+					p[k] = triangle[k] == from ? positions[to] : p[k];
+				}
+				Vector3 new_normal = get_normal(p[0], p[1], p[2]);
+
+				flipped = old_normal.dot(new_normal) <= 0.25f * sqrtf(old_normal.dot(old_normal) * new_normal.dot(new_normal));
+			}
+
+			if (flipped)
+			{
+				continue;
+			}
+
+			remap[from] = to;
+			quadrics[to].add(quadrics[from]);
+			error = std::max(error, collapse.cost);
+			n_removed += n_degenerate;
+			++n_collapsed;
+
+			// Positions around the collapse changed so its neighbours can't collapse again in this pass
+			touched[to] = true;
+			for (u32 j = adjacency.offsets[from]; j < adjacency.offsets[from + 1]; ++j)
+			{
+				u32 const* triangle = result.data() + size_t(adjacency.triangles[j]) * 3;
+				touched[triangle[0]] = true;
+				touched[triangle[1]] = true;
+				touched[triangle[2]] = true;
+			}
+		}
+
+		if (n_collapsed == 0)
+		{
+			break;
+		}
+
+		// Neighbours of a collapsed vertex are touched so the remap never chains
+		size_t n_indices = 0;
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			u32 a = remap[result[i + 0]];
+			u32 b = remap[result[i + 1]];
+			u32 c = remap[result[i + 2]];
+			if (a != b && b != c && c != a)
+			{
+				result[n_indices++] = a;
+				result[n_indices++] = b;
+				result[n_indices++] = c;
+			}
+		}
+		result.resize(n_indices);
+	}
+
+	return f32(sqrt(error));
+}
+
+void generate_lods(std::vector<ModelVertex> const& vertices, std::vector<u32> const& indices, u32 max_lods, f32 max_error, std::vector<Lod>& lods)
+{
+	JONO_EVENT();
+
+	lods.clear();
+	if (vertices.empty())
+	{
+		return;
+	}
+
+	Vector3 min = get_position(vertices[0]);
+	Vector3 max = min;
+	for (ModelVertex const& v : vertices)
+	{
+		min = { std::min(min.x, v.position.x), std::min(min.y, v.position.y), std::min(min.z, v.position.z) };
+		max = { std::max(max.x, v.position.x), std::max(max.y, v.position.y), std::max(max.z, v.position.z) };
+	}
+	Vector3 size = max - min;
+	f32 const target_error = max_error * std::max({ size.x, size.y, size.z });
+
+	// Every level is simplified from the full resolution mesh so its error is measured against the original surface
+	size_t n_indices = indices.size();
+	f32 error = 0.0f;
+	for (u32 i = 1; i < max_lods; ++i)
+	{
+		if (n_indices / 3 < c_MinLodTriangles * 2)
+		{
+			break;
+		}
+
+		Lod lod{};
+		u32 target_index_count = u32(n_indices / 6) * 3;
+		f32 lod_error = simplify(vertices, indices, target_index_count, target_error, lod.indices);
+		if (lod.indices.empty() || f32(lod.indices.size()) > f32(n_indices) * c_MinLodReduction)
+		{
+			break;
+		}
+
+		optimize_vertex_cache(lod.indices, u32(vertices.size()));
+
+		// Selection expects the error to grow with every level
+		error = std::max(error, lod_error);
+		lod.error = error;
+		n_indices = lod.indices.size();
+		lods.push_back(std::move(lod));
+	}
+}
+
+VertexCacheStats analyze_vertex_cache(std::vector<u32> const& indices, u32 n_vertices, u32 cache_size)
+{
+	VertexCacheStats stats{};
+	stats.n_triangles = u32(indices.size() / 3);
+	stats.n_vertices = n_vertices;
+
+	// A vertex is in the cache when fewer than 'cache_size' vertices were added after it
+	std::vector<u32> cache_time(n_vertices, 0);
+	u32 time = cache_size + 1;
+	for (u32 index : indices)
+	{
+		if (time - cache_time[index] > cache_size)
+		{
+			cache_time[index] = time++;
+			++stats.n_transformed;
+		}
+	}
+	return stats;
+}
+
+} // namespace MeshOptimizer
@@ -0,0 +1,99 @@
+#pragma once
+
+struct ModelVertex;
+
+// CPU mesh optimization passes that run on a single mesh while cooking.
+//	Indices are local to the mesh's vertex array. The optimization passes don't change what is rendered, only the order
+//	vertices and triangles are stored in. Simplification builds coarser index lists over the same vertices for LODs.
+namespace MeshOptimizer
+{
+
+// Size of the FIFO cache used to optimize and measure the post transform cache
+constexpr u32 c_CacheSize = 16;
+
+// Raw counts so the stats of several meshes can be added up
+struct VertexCacheStats
+{
+	u32 n_triangles = 0;
+	u32 n_vertices = 0;
+
+	// Vertices that had to be transformed because they weren't in the cache
+	u32 n_transformed = 0;
+
+	// Average cache miss ratio, transformed vertices per triangle (0.5 is the best possible for large meshes, 3 the worst)
+	f32 get_acmr() const { return n_triangles > 0 ? f32(n_transformed) / f32(n_triangles) : 0.0f; }
+
+	// Average transform to vertex ratio, 1 means every vertex is transformed once
+	f32 get_atvr() const { return n_vertices > 0 ? f32(n_transformed) / f32(n_vertices) : 0.0f; }
+
+	void add(VertexCacheStats const& other)
+	{
+		n_triangles += other.n_triangles;
+		n_vertices += other.n_vertices;
+		n_transformed += other.n_transformed;
+	}
+};
+
+struct Options
+{
+	bool weld = true;
+	bool vertex_cache = true;
+
+	// Overdraw ordering only runs after vertex cache ordering, it may raise the ACMR up to the threshold
+	bool overdraw = true;
+	f32 overdraw_threshold = 1.05f;
+
+	bool vertex_fetch = true;
+
+	// Simplified LODs stop once the error would exceed 'lod_max_error' times the size of the mesh
+	bool lods = true;
+	f32 lod_max_error = 0.05f;
+};
+
+struct Lod
+{
+	std::vector<u32> indices;
+
+	// Object space distance between the simplified and the full resolution surface
+	f32 error;
+};
+
+struct Report
+{
+	VertexCacheStats before;
+	VertexCacheStats after;
+
+	// Triangles per LOD level summed over the meshes that have that level
+	std::vector<u32> lod_triangles;
+};
+
+// Runs the enabled passes in order: weld, vertex cache, overdraw and vertex fetch
+ENGINE_API Report optimize(std::vector<ModelVertex>& vertices, std::vector<u32>& indices, Options const& options = {});
+
+// Merges bitwise identical vertices and remaps the indices, returns the new vertex count
+ENGINE_API u32 weld_vertices(std::vector<ModelVertex>& vertices, std::vector<u32>& indices);
+
+// Orders triangles for the post transform cache (Tipsify, Sander et al. 2007)
+ENGINE_API void optimize_vertex_cache(std::vector<u32>& indices, u32 n_vertices, u32 cache_size = c_CacheSize);
+
+// Orders clusters of triangles so outward facing parts of the mesh are drawn first.
+//	The order is only kept when the ACMR stays within 'threshold' times the ACMR of the input.
+ENGINE_API void optimize_overdraw(std::vector<u32>& indices, std::vector<ModelVertex> const& vertices, f32 threshold, u32 cache_size = c_CacheSize);
+
+// Stores vertices in the order they are first referenced and drops unreferenced ones, returns the new vertex count
+ENGINE_API u32 optimize_vertex_fetch(std::vector<ModelVertex>& vertices, std::vector<u32>& indices);
+
+// Collapses edges in order of their quadric error (Garland and Heckbert 1997) until the index count reaches 'target_index_count'
+//	or the next collapse would move the surface further than 'target_error'. Vertices only collapse onto existing vertices so
+//	the result indexes the same vertex array. Vertices on borders and attribute seams are locked to keep the outline intact.
+//	Returns the error of the result in object space.
+ENGINE_API f32 simplify(std::vector<ModelVertex> const& vertices, std::vector<u32> const& indices, u32 target_index_count, f32 target_error, std::vector<u32>& result);
+
+// Builds up to 'max_lods' - 1 simplified levels after the full resolution mesh, each with about half the triangles of the previous one.
+//	'max_error' is relative to the size of the mesh. The chain ends early when a level can't be reduced enough within that error.
+ENGINE_API void generate_lods(std::vector<ModelVertex> const& vertices, std::vector<u32> const& indices, u32 max_lods, f32 max_error, std::vector<Lod>& lods);
+
+// Simulates a FIFO post transform cache
+ENGINE_API VertexCacheStats analyze_vertex_cache(std::vector<u32> const& indices, u32 n_vertices, u32 cache_size = c_CacheSize);
+
+} // namespace MeshOptimizer
@@ -11,7 +11,7 @@ class TextureHandle;
 using MaterialRef = std::shared_ptr<class MaterialHandle>;
 class MaterialInstance;
 
-// This needs to match VS_IN for the shaders we are trying to use
+// Full precision vertex used while cooking, the GPU streams are packed from this (see VertexFormat.h)
 struct ModelVertex
 {
 	Shaders::float3 position;
@@ -25,17 +25,27 @@ struct ModelVertex
 
 	// Uvs
 	Shaders::float2 uv[4];
+};
 
+struct MeshLod
+{
+	u32 firstIndex;
+	u32 indexCount;
 
-	static const std::size_t InputElementCount = 9;
-	static const D3D11_INPUT_ELEMENT_DESC InputElements[InputElementCount];
+	// Object space distance between this LOD and the full resolution surface
+	f32 error;
 };
 
 struct Mesh
 {
-	// First vertex offset this mesh starts at in the vertex buffer
+	static constexpr u32 c_MaxLods = 4;
+
+	// First vertex offset this mesh starts at in the vertex buffer, in vertices of this mesh
 	u64 firstVertex;
 
+	// Size of a vertex in the packed stream of this mesh
+	u32 vertexStride;
+
 	// First index location offset this mesh starts at in the index buffer
 	u64 firstIndex;
 
@@ -44,6 +54,21 @@ struct Mesh
 
 	// Index of the material in the model owned material array
 	u32 material_index;
+
+	// Index ranges from fine to coarse over the same vertices, lods[0] matches firstIndex and indexCount
+	MeshLod lods[c_MaxLods];
+	u32 n_lods;
+
+	// Coarsest LOD whose error stays within 'max_error' once scaled by 'error_scale', e.g. pixels per object space unit
+	u32 select_lod(f32 error_scale, f32 max_error) const
+	{
+		u32 lod = 0;
+		while (lod + 1 < n_lods && lods[lod + 1].error * error_scale <= max_error)
+		{
+			++lod;
+		}
+		return lod;
+	}
 };
 
 struct InputLayout
@@ -62,11 +87,14 @@ public:
 
 	~Model();
 
-	bool Load(enki::ITaskSet* parent, std::string const& path);
+	bool Load(Tasks::JobCounter* parent, std::string const& path);
 
 	GraphicsResourceHandle GetVertexBuffer() const { return m_VertexBuffer; }
 	GraphicsResourceHandle GetIndexBuffer() const { return m_IndexBuffer; }
 
+	// Size of a single index in bytes, cooked models use 16 bit indices when every mesh allows it
+	u32 GetIndexStride() const { return m_IndexStride; }
+
 	std::vector<Mesh> const& GetMeshes() const { return m_Meshes; }
 
 	inline MaterialInstance* GetMaterial(u32 idx) const 
@@ -92,6 +120,7 @@ public:
 
 private:
 	u64 _index_count;
+	u32 m_IndexStride;
 
 	std::vector<std::unique_ptr<MaterialInstance>> m_Materials;
 	std::vector<Mesh> m_Meshes;
@@ -112,5 +141,5 @@ public:
 
 	~ModelHandle();
 
-	bool load(enki::ITaskSet* parent) override;
+	bool load(Tasks::JobCounter* parent) override;
 };
\ No newline at end of file
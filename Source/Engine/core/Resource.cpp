@@ -24,8 +24,13 @@ void Resource::SetStatus(ResourceStatus status)
 		return;
 	}
 
-	m_Status = status;
-	if (status == ResourceStatus::Loaded)
+	// Waiters check the status under the lock, updating it under the lock as well means a wake up can't be missed
+	{
+		std::lock_guard<std::mutex> lk{ m_LoadedMtx };
+		m_Status = status;
+	}
+
+	if (status != ResourceStatus::Loading)
 	{
 		m_LoadedCV.notify_all();
 	}
@@ -33,9 +38,6 @@ void Resource::SetStatus(ResourceStatus status)
 
 void Resource::WaitForLoad()
 {
-	if (m_Status != ResourceStatus::Loaded)
-	{
-		std::unique_lock<std::mutex> lk{ m_LoadedMtx };
-		m_LoadedCV.wait(lk);
-	}
+	std::unique_lock<std::mutex> lk{ m_LoadedMtx };
+	m_LoadedCV.wait(lk, [this]() { return m_Status != ResourceStatus::Loading; });
 }
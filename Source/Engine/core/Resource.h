@@ -18,12 +18,14 @@ public:
 		return m_Status == ResourceStatus::Loaded;
 	}
 
-	virtual bool load(enki::ITaskSet* parent) = 0;
+	// Loads the resource on a job. Additional jobs can be scheduled on 'parent', the resource is only marked as loaded once they finish.
+	virtual bool load(Tasks::JobCounter* parent) = 0;
 
 	virtual std::string get_name() const { return ""; }
 
 	void SetStatus(ResourceStatus status);
 
+	// Blocks until the resource finished loading, successfully or not
 	void WaitForLoad();
 
 private:
@@ -33,5 +35,4 @@ private:
 	std::condition_variable m_LoadedCV;
 
 	friend class ResourceLoader;
-	friend struct CompletionActionMarkLoaded;
 };
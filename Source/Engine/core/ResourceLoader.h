@@ -31,9 +31,6 @@ public:
 private:
     std::mutex m_CacheLock;
     ResourceCache m_Cache;
-
-    std::mutex m_TaskLock;
-    std::list<std::unique_ptr<enki::ITaskSet>> m_Tasks;
 };
 
 #include "ResourceLoader.inl"
@@ -16,23 +16,29 @@ std::shared_ptr<T> ResourceLoader::load(typename T::init_parameters params, bool
             if (blocking)
             {
                 it->second->WaitForLoad();
+                if (it->second->get_status() == ResourceStatus::Error)
+                {
+                    return nullptr;
+                }
             }
 
             return std::static_pointer_cast<T>(it->second);
         }
     }
 
+    // Marked as loading before it is visible in the cache, otherwise a blocking request could see the initial Error status
     std::shared_ptr<T> res = std::make_shared<T>(params);
+    res->SetStatus(ResourceStatus::Loading);
     {
         std::lock_guard lock{ m_CacheLock };
         m_Cache[h] = res;
     }
 
-    res->SetStatus(ResourceStatus::Loading);
-
     if (blocking)
     {
-        bool result = res->load(nullptr);
+        Tasks::JobCounter subJobs;
+        bool result = res->load(&subJobs);
+        Tasks::get_scheduler()->wait(subJobs);
         if(!result)
         {
             res->SetStatus(ResourceStatus::Error);
@@ -42,13 +48,7 @@ std::shared_ptr<T> ResourceLoader::load(typename T::init_parameters params, bool
     }
     else
     {
-        std::unique_ptr<enki::ITaskSet> set = std::make_unique<LoadResourceTask<T>>(res);
-        Tasks::get_scheduler()->AddTaskSetToPipe(set.get());
-
-        {
-            std::lock_guard<std::mutex> l{ m_TaskLock };
-            m_Tasks.push_back(std::move(set));
-        }
+        Tasks::get_scheduler()->run(LoadResourceTask<T>{ res });
     }
 
     return res;
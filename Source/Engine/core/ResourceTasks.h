@@ -1,35 +1,29 @@
 #pragma once
 
-struct CompletionActionMarkLoaded : enki::ICompletable
-{
-	enki::Dependency _dependency;
-
-	// Resource to mark as loaded
-	std::shared_ptr<Resource> _resource;
-
-	void OnDependenciesComplete(enki::TaskScheduler* pTaskScheduler_, uint32_t threadNum_) override;
-};
-
+// Job that loads a resource. Jobs the resource schedules on the counter passed to load finish before it is marked as loaded,
+// a failed load marks the resource as Error and skips the completion callback.
 template <typename T>
-struct LoadResourceTask : public enki::ITaskSet
+struct LoadResourceTask
 {
-	LoadResourceTask(std::shared_ptr<T> resource)
-	  : _resource(resource)
-	{
-	}
-
-	~LoadResourceTask()
-	{
-	}
-
 	std::shared_ptr<T> _resource;
 	std::function<void(std::shared_ptr<T>)> _complete;
 
-	void ExecuteRange(enki::TaskSetPartition range_, uint32_t threadnum_) override
+	void operator()() const
 	{
 		MEMORY_TAG(MemoryCategory::ResourceLoading);
 		_resource->SetStatus(ResourceStatus::Loading);
-		_resource->load(this);
+
+		Tasks::JobCounter subJobs;
+		bool result = _resource->load(&subJobs);
+		Tasks::get_scheduler()->wait(subJobs);
+
+		if (!result)
+		{
+			LOG_ERROR(IO, "Failed to load \"{}\"", _resource->get_name());
+			_resource->SetStatus(ResourceStatus::Error);
+			return;
+		}
+
 		_resource->SetStatus(ResourceStatus::Loaded);
 
 		if (_complete)
@@ -83,7 +83,7 @@ TextureHandle TextureHandle::default_roughness()
 	return s_tex;
 }
 
-bool TextureHandle::load(enki::ITaskSet* parent)
+bool TextureHandle::load(Tasks::JobCounter* parent)
 {
 	std::string const& path = get_init_parameters().path;
 	_resource = std::make_shared<Texture>();
@@ -188,8 +188,12 @@ bool Texture::Load(std::string const& path)
 {
 	int x, y, comp;
 
-	std::string p = GetGlobalContext()->m_PlatformIO->ResolvePath(path);
-	stbi_uc* data = stbi_load(p.c_str(), &x, &y, &comp, 4);
+	// Decode straight from the mapped file
+	IO::IMappedFileRef file = GetGlobalContext()->m_PlatformIO->MapFile(path.c_str());
+	ASSERTMSG(file, "Failed to open image {}", path);
+
+	Span<u8 const> encoded = file->get_data();
+	stbi_uc* data = stbi_load_from_memory(encoded.begin(), int(encoded.size()), &x, &y, &comp, 4);
 	ASSERTMSG(data, "Failed to  load image from {}", path);
 
 	this->LoadFromMemory(x, y, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, TextureType::Tex2D, (void*)data, path.c_str());
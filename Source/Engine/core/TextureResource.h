@@ -74,7 +74,7 @@ public:
 	static TextureHandle default_normal();
 	static TextureHandle default_roughness();
 
-	bool load(enki::ITaskSet* parent) override;
+	bool load(Tasks::JobCounter* parent) override;
 
 	void create_from_memory(uint32_t width, uint32_t height, DXGI_FORMAT format, TextureType type, void* data);
 
@@ -0,0 +1,265 @@
+#include "engine.pch.h"
+#include "VertexFormat.h"
+
+#include "ModelResource.h"
+
+namespace VertexFormat
+{
+
+namespace
+{
+
+VertexLayoutFlags const c_SupportedFlags = VertexLayoutFlags::Position | VertexLayoutFlags::Normal
+		| VertexLayoutFlags::Tangent0 | VertexLayoutFlags::Tangent1
+		| VertexLayoutFlags::Colour0 | VertexLayoutFlags::Colour1 | VertexLayoutFlags::Colour2 | VertexLayoutFlags::Colour3
+		| VertexLayoutFlags::UV0 | VertexLayoutFlags::UV1 | VertexLayoutFlags::UV2 | VertexLayoutFlags::UV3;
+
+u32 to_unorm8(f32 value)
+{
+	return u32(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+u32 to_snorm16(f32 value)
+{
+	return u32(u16(s16(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f))));
+}
+
+f32 from_snorm16(u32 value)
+{
+	return std::max(f32(s16(u16(value))) / 32767.0f, -1.0f);
+}
+
+f32 sign_not_zero(f32 value)
+{
+	return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+template <typename T>
+u8* write(u8* dst, T const& value)
+{
+	memcpy(dst, &value, sizeof(T));
+	return dst + sizeof(T);
+}
+
+} // namespace
+
+VertexLayoutFlags get_supported_flags(VertexLayoutFlags flags)
+{
+	return flags & c_SupportedFlags;
+}
+
+u32 get_stride(VertexLayoutFlags flags)
+{
+	u32 stride = 0;
+	if (any(flags & VertexLayoutFlags::Position))
+	{
+		stride += sizeof(f32) * 3;
+	}
+
+	if (any(flags & VertexLayoutFlags::Normal))
+	{
+		stride += sizeof(u32);
+	}
+
+	for (u32 t = 0; t < 2; ++t)
+	{
+		if (any(flags & (VertexLayoutFlags::Tangent0 << t)))
+		{
+			stride += sizeof(u32);
+		}
+	}
+
+	for (u32 t = 0; t < 4; ++t)
+	{
+		if (any(flags & (VertexLayoutFlags::Colour0 << t)))
+		{
+			stride += sizeof(u32);
+		}
+
+		if (any(flags & (VertexLayoutFlags::UV0 << t)))
+		{
+			stride += sizeof(u16) * 2;
+		}
+	}
+	return stride;
+}
+
+void encode(VertexLayoutFlags flags, ModelVertex const* vertices, u32 count, u8* dst)
+{
+	for (u32 i = 0; i < count; ++i)
+	{
+		ModelVertex const& v = vertices[i];
+		if (any(flags & VertexLayoutFlags::Position))
+		{
+			dst = write(dst, v.position);
+		}
+
+		if (any(flags & VertexLayoutFlags::Normal))
+		{
+			dst = write(dst, encode_octahedral(v.normal.x, v.normal.y, v.normal.z));
+		}
+
+		for (u32 t = 0; t < 2; ++t)
+		{
+			if (any(flags & (VertexLayoutFlags::Tangent0 << t)))
+			{
+				dst = write(dst, encode_octahedral(v.tangent[t].x, v.tangent[t].y, v.tangent[t].z));
+			}
+		}
+
+		for (u32 t = 0; t < 4; ++t)
+		{
+			if (any(flags & (VertexLayoutFlags::Colour0 << t)))
+			{
+				Shaders::float4 const& c = v.color[t];
+				dst = write(dst, to_unorm8(c.x) | (to_unorm8(c.y) << 8) | (to_unorm8(c.z) << 16) | (to_unorm8(c.w) << 24));
+			}
+		}
+
+		for (u32 t = 0; t < 4; ++t)
+		{
+			if (any(flags & (VertexLayoutFlags::UV0 << t)))
+			{
+				dst = write(dst, float_to_half(v.uv[t].x));
+				dst = write(dst, float_to_half(v.uv[t].y));
+			}
+		}
+	}
+}
+
+void get_input_elements(VertexLayoutFlags flags, std::vector<D3D11_INPUT_ELEMENT_DESC>& elements)
+{
+	// Offsets are implied by the order, the stream only contains what the flags ask for
+	elements.clear();
+	if (any(flags & VertexLayoutFlags::Position))
+	{
+		elements.push_back({ "SV_Position", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+	}
+
+	if (any(flags & VertexLayoutFlags::Normal))
+	{
+		elements.push_back({ "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+	}
+
+	for (u32 t = 0; t < 2; ++t)
+	{
+		if (any(flags & (VertexLayoutFlags::Tangent0 << t)))
+		{
+			elements.push_back({ "TANGENT", t, DXGI_FORMAT_R16G16_SNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+		}
+	}
+
+	for (u32 t = 0; t < 4; ++t)
+	{
+		if (any(flags & (VertexLayoutFlags::Colour0 << t)))
+		{
+			elements.push_back({ "COLOR", t, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+		}
+	}
+
+	for (u32 t = 0; t < 4; ++t)
+	{
+		if (any(flags & (VertexLayoutFlags::UV0 << t)))
+		{
+			elements.push_back({ "TEXCOORD", t, DXGI_FORMAT_R16G16_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+		}
+	}
+}
+
+u32 encode_octahedral(f32 x, f32 y, f32 z)
+{
+	// Project on the octahedron and fold the lower hemisphere over the diagonals
+	f32 l1 = fabsf(x) + fabsf(y) + fabsf(z);
+	if (l1 <= 0.0f)
+	{
+		return 0;
+	}
+
+	x /= l1;
+	y /= l1;
+	if (z < 0.0f)
+	{
+		f32 folded_x = (1.0f - fabsf(y)) * sign_not_zero(x);
+		f32 folded_y = (1.0f - fabsf(x)) * sign_not_zero(y);
+		x = folded_x;
+		y = folded_y;
+	}
+	return to_snorm16(x) | (to_snorm16(y) << 16);
+}
+
+void decode_octahedral(u32 value, f32& x, f32& y, f32& z)
+{
+	x = from_snorm16(value & 0xFFFF);
+	y = from_snorm16(value >> 16);
+	z = 1.0f - fabsf(x) - fabsf(y);
+
+	f32 t = std::max(-z, 0.0f);
+	x += x >= 0.0f ? -t : t;
+	y += y >= 0.0f ? -t : t;
+
+	f32 length = sqrtf(x * x + y * y + z * z);
+	x /= length;
+	y /= length;
+	z /= length;
+}
+
+u16 float_to_half(f32 value)
+{
+	u32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	u32 sign = (bits >> 16) & 0x8000;
+	u32 magnitude = bits & 0x7FFFFFFF;
+
+	// Infinity and NaN
+	if (magnitude >= 0x7F800000)
+	{
+		return u16(sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0));
+	}
+
+	// Values from 65520 upwards round to infinity
+	if (magnitude >= 0x477FF000)
+	{
+		return u16(sign | 0x7C00);
+	}
+
+	// Below the smallest normal half, the mantissa is the value in units of 2^-24
+	if (magnitude < 0x38800000)
+	{
+		f32 abs_value;
+		memcpy(&abs_value, &magnitude, sizeof(abs_value));
+		return u16(sign | u32(std::nearbyint(abs_value * 16777216.0f)));
+	}
+
+	// Rebias the exponent and round the mantissa to nearest even, a carry moves into the exponent
+	magnitude += 0xC8000FFF + ((magnitude >> 13) & 1);
+	return u16(sign | (magnitude >> 13));
+}
+
+f32 half_to_float(u16 value)
+{
+	u32 sign = u32(value & 0x8000) << 16;
+	u32 exponent = (value >> 10) & 0x1F;
+	u32 mantissa = value & 0x3FF;
+
+	u32 bits;
+	if (exponent == 0)
+	{
+		f32 result = f32(mantissa) / 16777216.0f;
+		return sign ? -result : result;
+	}
+	else if (exponent == 0x1F)
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+
+	f32 result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+} // namespace VertexFormat
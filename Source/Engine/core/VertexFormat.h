@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Graphics/VertexLayout.h"
+
+struct ModelVertex;
+
+// Packed vertex streams used by cooked models.
+//	A stream only stores the attributes in its layout flags, interleaved in this order:
+//		position	R32G32B32_FLOAT
+//		normal		R16G16_SNORM, octahedral
+//		tangent0/1	R16G16_SNORM, octahedral tangent and bitangent
+//		colour0-3	R8G8B8A8_UNORM
+//		uv0-3		R16G16_FLOAT
+//	Octahedral attributes are decoded in the vertex shader, everything else is expanded by the input assembler.
+namespace VertexFormat
+{
+
+// Removes the attributes the packed format can't store (tangent slots 2 and 3)
+ENGINE_API VertexLayoutFlags get_supported_flags(VertexLayoutFlags flags);
+
+ENGINE_API u32 get_stride(VertexLayoutFlags flags);
+
+// Writes 'count' vertices of 'get_stride(flags)' bytes each to 'dst'
+ENGINE_API void encode(VertexLayoutFlags flags, ModelVertex const* vertices, u32 count, u8* dst);
+
+ENGINE_API void get_input_elements(VertexLayoutFlags flags, std::vector<D3D11_INPUT_ELEMENT_DESC>& elements);
+
+// Unit vector to two snorm16 values, x in the low bits
+ENGINE_API u32 encode_octahedral(f32 x, f32 y, f32 z);
+ENGINE_API void decode_octahedral(u32 value, f32& x, f32& y, f32& z);
+
+ENGINE_API u16 float_to_half(f32 value);
+ENGINE_API f32 half_to_float(u16 value);
+
+} // namespace VertexFormat
@@ -0,0 +1,329 @@
+#include "engine.pch.h"
+#include "WorldSnapshot.h"
+
+#include "Framework/Entity.h"
+#include "Graphics/RenderWorld.h"
+#include "Parsing/Yaml.h"
+
+#include <charconv>
+
+namespace
+{
+	u32 align_offset(size_t offset)
+	{
+		return u32((offset + 15) & ~size_t(15));
+	}
+
+	// Parses 'x,y,z', missing components are left untouched
+	void parse_float3(std::string const& str, f32 out[3])
+	{
+		std::vector<std::string_view> result;
+		Helpers::split_string(str, ",", result);
+		for (size_t i = 0; i < std::min<size_t>(result.size(), 3); ++i)
+		{
+			std::from_chars(result[i].data(), result[i].data() + result[i].size(), out[i]);
+		}
+	}
+
+	float4x4 get_transform(WorldSnapshotLocal const& local)
+	{
+		// Rotation isn't applied to the render instances, matching how scenes were loaded before snapshots
+		float4x4 t = float4x4::translation(float3(local.position[0], local.position[1], local.position[2]));
+		float4x4 s = float4x4::scale(local.scale[0], local.scale[1], local.scale[2]);
+		return hlslpp::mul(s, t);
+	}
+}
+
+bool WorldSnapshot::open(void const* data, size_t size)
+{
+	_header = nullptr;
+	_data = static_cast<u8 const*>(data);
+	if (!data || size < sizeof(WorldSnapshotHeader))
+	{
+		return false;
+	}
+
+	WorldSnapshotHeader const* header = reinterpret_cast<WorldSnapshotHeader const*>(data);
+	if (header->magic != WorldSnapshotHeader::c_Magic || header->version != WorldSnapshotHeader::c_Version)
+	{
+		LOG_ERROR(IO, "World snapshot has an unsupported version {} (expected {}).", header->version, WorldSnapshotHeader::c_Version);
+		return false;
+	}
+
+	// Every section has to be within the data, strings are validated through the terminator at the end of the table
+	auto fits = [size](u32 offset, u64 count, u64 stride)
+	{
+		return offset <= size && count * stride <= size - offset;
+	};
+
+	bool valid = fits(header->transforms_offset, header->n_instances, sizeof(f32) * 16)
+			&& fits(header->locals_offset, header->n_instances, sizeof(WorldSnapshotLocal))
+			&& fits(header->mesh_indices_offset, header->n_instances, sizeof(u32))
+			&& fits(header->names_offset, header->n_instances, sizeof(u32))
+			&& fits(header->meshes_offset, header->n_meshes, sizeof(u32))
+			&& fits(header->lights_offset, header->n_lights, sizeof(WorldSnapshotLight))
+			&& fits(header->string_table_offset, header->string_table_size, 1)
+			&& header->string_table_size > 0
+			&& _data[header->string_table_offset + header->string_table_size - 1] == '\0';
+
+	auto all_below = [this](u32 offset, u32 count, u32 limit)
+	{
+		u32 const* values = section<u32>(offset);
+		return std::all_of(values, values + count, [limit](u32 v) { return v < limit; });
+	};
+	valid = valid
+			&& all_below(header->mesh_indices_offset, header->n_instances, header->n_meshes)
+			&& all_below(header->names_offset, header->n_instances, header->string_table_size)
+			&& all_below(header->meshes_offset, header->n_meshes, header->string_table_size);
+	if (!valid)
+	{
+		LOG_ERROR(IO, "World snapshot is truncated or corrupt.");
+		return false;
+	}
+
+	_header = header;
+	return true;
+}
+
+bool WorldSnapshot::load(const char* path)
+{
+	JONO_EVENT();
+
+	_file = IO::get()->MapFile(path);
+	if (!_file)
+	{
+		return false;
+	}
+
+	Span<u8 const> data = _file->get_data();
+	return open(data.begin(), data.size());
+}
+
+void WorldSnapshot::instantiate(RenderWorld& world) const
+{
+	JONO_EVENT();
+	ASSERT(is_valid());
+
+	std::vector<std::string> meshes;
+	meshes.reserve(get_num_meshes());
+	for (u32 i = 0; i < get_num_meshes(); ++i)
+	{
+		meshes.push_back(get_mesh(i));
+	}
+
+	// hlsl++ matrices are SIMD aligned, copy them out of the file
+	std::vector<float4x4> transforms(get_num_instances());
+	static_assert(sizeof(float4x4) == sizeof(f32) * 16);
+	memcpy(transforms.data(), get_transforms(), transforms.size() * sizeof(float4x4));
+
+	world.create_instances(get_num_instances(), transforms.data(), get_mesh_indices(), meshes);
+
+	WorldSnapshotLight const* lights = get_lights();
+	for (u32 i = 0; i < get_num_lights(); ++i)
+	{
+		WorldSnapshotLight const& src = lights[i];
+		RenderWorldLightRef light = world.create_light(RenderWorldLight::LightType(src.type));
+		light->set_colour(float3(src.colour[0], src.colour[1], src.colour[2]));
+		light->set_casts_shadow(src.casts_shadow != 0);
+		light->set_range(src.range);
+		light->set_cone_angle(src.cone_angle);
+		light->set_outer_cone_angle(src.outer_cone_angle);
+
+		RenderWorldCamera::CameraSettings settings{};
+		settings.aspect = 1.0f;
+		settings.fov = src.shadow_fov;
+		settings.width = src.shadow_width;
+		settings.height = src.shadow_height;
+		settings.near_clip = src.shadow_near;
+		settings.far_clip = src.shadow_far;
+		settings.projection_type = RenderWorldCamera::Projection(src.shadow_projection);
+		light->set_settings(settings);
+		light->set_view(float4x4::look_at(float3(src.position[0], src.position[1], src.position[2]), float3(src.target[0], src.target[1], src.target[2]), float3(0.0f, 1.0f, 0.0f)));
+	}
+}
+
+void WorldSnapshot::instantiate(framework::World& world, std::vector<framework::EntityHandle>* out) const
+{
+	JONO_EVENT();
+	ASSERT(is_valid());
+
+	std::vector<framework::EntityHandle> entities;
+	world.create_entities(get_num_instances(), entities);
+
+	WorldSnapshotLocal const* locals = get_locals();
+	for (u32 i = 0; i < get_num_instances(); ++i)
+	{
+		WorldSnapshotLocal const& local = locals[i];
+		framework::Entity* ent = world.get_entity(entities[i]);
+		ent->set_name(get_instance_name(i));
+		ent->set_local_position(float3(local.position[0], local.position[1], local.position[2]));
+		ent->set_local_scale(float3(local.scale[0], local.scale[1], local.scale[2]));
+		ent->set_rotation(quaternion::rotation_euler_zxy(float3(local.rotation[0], local.rotation[1], local.rotation[2])));
+		world.attach_to_root(entities[i]);
+	}
+
+	if (out)
+	{
+		out->insert(out->end(), entities.begin(), entities.end());
+	}
+}
+
+void WorldSnapshotBuilder::add_instance(std::string_view name, std::string_view mesh, WorldSnapshotLocal const& local)
+{
+	auto it = _mesh_lookup.find(std::string(mesh));
+	if (it == _mesh_lookup.end())
+	{
+		it = _mesh_lookup.emplace(std::string(mesh), u32(_meshes.size())).first;
+		_meshes.push_back(add_string(mesh));
+	}
+
+	_locals.push_back(local);
+	_mesh_indices.push_back(it->second);
+	_names.push_back(add_string(name));
+}
+
+void WorldSnapshotBuilder::add_light(std::string_view name, WorldSnapshotLight light)
+{
+	light.name = add_string(name);
+	_lights.push_back(light);
+}
+
+u32 WorldSnapshotBuilder::add_string(std::string_view str)
+{
+	u32 offset = u32(_strings.size());
+	_strings.insert(_strings.end(), str.begin(), str.end());
+	_strings.push_back('\0');
+	return offset;
+}
+
+void WorldSnapshotBuilder::write(std::vector<u8>& out) const
+{
+	u32 n_instances = u32(_locals.size());
+
+	WorldSnapshotHeader header{};
+	header.magic = WorldSnapshotHeader::c_Magic;
+	header.version = WorldSnapshotHeader::c_Version;
+	header.n_instances = n_instances;
+	header.n_meshes = u32(_meshes.size());
+	header.n_lights = u32(_lights.size());
+	header.string_table_size = std::max<u32>(u32(_strings.size()), 1);
+	header.source_hash = _source_hash;
+
+	size_t offset = sizeof(WorldSnapshotHeader);
+	auto reserve = [&offset](size_t size)
+	{
+		u32 result = align_offset(offset);
+		offset = result + size;
+		return result;
+	};
+	header.transforms_offset = reserve(n_instances * sizeof(f32) * 16);
+	header.locals_offset = reserve(n_instances * sizeof(WorldSnapshotLocal));
+	header.mesh_indices_offset = reserve(n_instances * sizeof(u32));
+	header.names_offset = reserve(n_instances * sizeof(u32));
+	header.meshes_offset = reserve(_meshes.size() * sizeof(u32));
+	header.lights_offset = reserve(_lights.size() * sizeof(WorldSnapshotLight));
+	header.string_table_offset = reserve(header.string_table_size);
+
+	out.assign(offset, 0);
+	memcpy(out.data(), &header, sizeof(header));
+
+	f32* transforms = reinterpret_cast<f32*>(out.data() + header.transforms_offset);
+	for (u32 i = 0; i < n_instances; ++i)
+	{
+		float4x4 transform = get_transform(_locals[i]);
+		memcpy(transforms + i * 16, &transform, sizeof(f32) * 16);
+	}
+
+	auto copy = [&out](u32 dst_offset, auto const& src)
+	{
+		if (!src.empty())
+		{
+			memcpy(out.data() + dst_offset, src.data(), src.size() * sizeof(src[0]));
+		}
+	};
+	copy(header.locals_offset, _locals);
+	copy(header.mesh_indices_offset, _mesh_indices);
+	copy(header.names_offset, _names);
+	copy(header.meshes_offset, _meshes);
+	copy(header.lights_offset, _lights);
+	copy(header.string_table_offset, _strings);
+}
+
+bool hash_scene(const char* scene_path, u64& hash)
+{
+	IO::IMappedFileRef file = IO::get()->MapFile(scene_path);
+	if (!file)
+	{
+		return false;
+	}
+
+	Span<u8 const> data = file->get_data();
+	hash = Hash::fnv1a64(data.begin(), data.size());
+	return true;
+}
+
+bool convert_scene(const char* scene_path, std::vector<u8>& out)
+{
+	JONO_EVENT();
+
+	u64 source_hash = 0;
+	if (!hash_scene(scene_path, source_hash))
+	{
+		return false;
+	}
+
+	yaml::Document doc = yaml::Document(scene_path);
+	if (!doc.IsValid())
+	{
+		return false;
+	}
+
+	WorldSnapshotBuilder builder{};
+	builder.set_source_hash(source_hash);
+
+	Yaml::Node& root = doc.GetRoot();
+	Yaml::Node& models = root["Models"];
+	for (auto it = models.Begin(); it != models.End(); it++)
+	{
+		Yaml::Node& node = (*it).second;
+
+		WorldSnapshotLocal local{ { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f } };
+		parse_float3(node["position"].As<std::string>(), local.position);
+		parse_float3(node["scale"].As<std::string>(), local.scale);
+		parse_float3(node["rotation"].As<std::string>(), local.rotation);
+
+		builder.add_instance(node["name"].As<std::string>(), node["mesh"].As<std::string>(), local);
+	}
+
+	Yaml::Node& lights = root["Lights"];
+	for (auto it = lights.Begin(); it != lights.End(); it++)
+	{
+		Yaml::Node& node = (*it).second;
+
+		WorldSnapshotLight light{};
+		std::string type = node["type"].As<std::string>("Directional");
+		light.type = u32(type == "Spot" ? RenderWorldLight::LightType::Spot : type == "Point" ? RenderWorldLight::LightType::Point : RenderWorldLight::LightType::Directional);
+		light.casts_shadow = node["casts_shadow"].As<bool>(false) ? 1 : 0;
+		light.colour[0] = light.colour[1] = light.colour[2] = 1.0f;
+		parse_float3(node["colour"].As<std::string>(), light.colour);
+		parse_float3(node["position"].As<std::string>(), light.position);
+		parse_float3(node["target"].As<std::string>(), light.target);
+		light.range = node["range"].As<f32>(0.0f);
+		light.cone_angle = node["cone_angle"].As<f32>(0.0f);
+		light.outer_cone_angle = node["outer_cone_angle"].As<f32>(0.0f);
+
+		// Defaults match the lights the scene viewer creates, directional lights use an orthographic shadow camera
+		bool directional = light.type == u32(RenderWorldLight::LightType::Directional);
+		light.shadow_projection = u32(directional ? RenderWorldCamera::Projection::Ortographic : RenderWorldCamera::Projection::Perspective);
+		light.shadow_fov = node["shadow_fov"].As<f32>(hlslpp::radians(float1(60.0f)));
+		light.shadow_width = node["shadow_width"].As<f32>(10.0f);
+		light.shadow_height = node["shadow_height"].As<f32>(20.0f);
+		light.shadow_near = node["shadow_near"].As<f32>(directional ? 0.0f : 0.01f);
+		light.shadow_far = node["shadow_far"].As<f32>(directional ? 25.0f : 50.0f);
+
+		builder.add_light(node["name"].As<std::string>(), light);
+	}
+
+	builder.write(out);
+	return true;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "Framework/World.h"
+
+class RenderWorld;
+
+// Compiled binary form of a .scene file.
+//	The file is a header followed by flat arrays that are used in place, a snapshot can be opened directly on a file buffer
+//	or a memory mapped view. Every array starts 16 byte aligned, offsets are relative to the start of the file.
+struct WorldSnapshotHeader
+{
+	static constexpr u32 c_Magic = 0x4E53574A; // 'JWSN'
+	static constexpr u32 c_Version = 3;
+
+	u32 magic;
+	u32 version;
+
+	u32 n_instances;
+	u32 n_meshes;
+	u32 n_lights;
+	u32 string_table_size;
+
+	// f32[16] per instance, row major local to world matrix used for the render instances
+	u32 transforms_offset;
+
+	// WorldSnapshotLocal per instance, used for the entities
+	u32 locals_offset;
+
+	// u32 per instance, index in the mesh table
+	u32 mesh_indices_offset;
+
+	// u32 per instance, offset of the name in the string table
+	u32 names_offset;
+
+	// u32 per mesh, offset of the mesh path in the string table
+	u32 meshes_offset;
+
+	// WorldSnapshotLight per light
+	u32 lights_offset;
+
+	// Null terminated strings
+	u32 string_table_offset;
+
+	u32 padding;
+
+	// Hash of the .scene file the snapshot was compiled from, see hash_scene
+	u64 source_hash;
+};
+static_assert(sizeof(WorldSnapshotHeader) % 16 == 0);
+
+struct WorldSnapshotLocal
+{
+	f32 position[3];
+	f32 scale[3];
+
+	// Euler angles in radians, same as the .scene format
+	f32 rotation[3];
+};
+
+struct WorldSnapshotLight
+{
+	u32 type;
+	u32 casts_shadow;
+	u32 name;
+	f32 colour[3];
+	f32 position[3];
+	f32 target[3];
+	f32 range;
+	f32 cone_angle;
+	f32 outer_cone_angle;
+
+	// Shadow camera, see RenderWorldCamera::CameraSettings. Shadow maps are square so the aspect is always 1.
+	u32 shadow_projection;
+	f32 shadow_fov;
+	f32 shadow_width;
+	f32 shadow_height;
+	f32 shadow_near;
+	f32 shadow_far;
+};
+
+// Read only view over a snapshot
+class ENGINE_API WorldSnapshot final
+{
+public:
+	static constexpr const char* c_Extension = ".wsnap";
+
+	WorldSnapshot() = default;
+	~WorldSnapshot() = default;
+
+	WorldSnapshot(WorldSnapshot const&) = delete;
+	WorldSnapshot& operator=(WorldSnapshot const&) = delete;
+
+	// Validates the data and points the snapshot at it, 'data' has to outlive the snapshot
+	bool open(void const* data, size_t size);
+
+	// Maps the file and keeps the mapping alive for the lifetime of the snapshot
+	bool load(const char* path);
+
+	bool is_valid() const { return _header != nullptr; }
+
+	u32 get_num_instances() const { return _header->n_instances; }
+	u32 get_num_meshes() const { return _header->n_meshes; }
+	u32 get_num_lights() const { return _header->n_lights; }
+	u64 get_source_hash() const { return _header->source_hash; }
+
+	f32 const* get_transforms() const { return section<f32>(_header->transforms_offset); }
+	WorldSnapshotLocal const* get_locals() const { return section<WorldSnapshotLocal>(_header->locals_offset); }
+	u32 const* get_mesh_indices() const { return section<u32>(_header->mesh_indices_offset); }
+	WorldSnapshotLight const* get_lights() const { return section<WorldSnapshotLight>(_header->lights_offset); }
+
+	const char* get_instance_name(u32 instance) const { return get_string(section<u32>(_header->names_offset)[instance]); }
+	const char* get_mesh(u32 mesh) const { return get_string(section<u32>(_header->meshes_offset)[mesh]); }
+	const char* get_string(u32 offset) const { return section<char>(_header->string_table_offset) + offset; }
+
+	// Bulk inserts the instances and lights into the render world
+	void instantiate(RenderWorld& world) const;
+
+	// Creates an entity per instance under the root of the world
+	void instantiate(framework::World& world, std::vector<framework::EntityHandle>* out = nullptr) const;
+
+private:
+	template<typename T>
+	T const* section(u32 offset) const
+	{
+		return reinterpret_cast<T const*>(_data + offset);
+	}
+
+	u8 const* _data = nullptr;
+	WorldSnapshotHeader const* _header = nullptr;
+
+	// Only used when the snapshot was loaded from a file
+	IO::IMappedFileRef _file;
+};
+
+// Collects the contents of a world and writes them as a snapshot
+class ENGINE_API WorldSnapshotBuilder final
+{
+public:
+	void add_instance(std::string_view name, std::string_view mesh, WorldSnapshotLocal const& local);
+	void add_light(std::string_view name, WorldSnapshotLight light);
+	void set_source_hash(u64 hash) { _source_hash = hash; }
+
+	void write(std::vector<u8>& out) const;
+
+private:
+	u32 add_string(std::string_view str);
+
+	std::vector<WorldSnapshotLocal> _locals;
+	std::vector<u32> _mesh_indices;
+	std::vector<u32> _names;
+	std::vector<u32> _meshes;
+	std::vector<WorldSnapshotLight> _lights;
+
+	std::unordered_map<std::string, u32> _mesh_lookup;
+	std::vector<char> _strings;
+
+	u64 _source_hash = 0;
+};
+
+// Hashes the contents of a .scene file, a snapshot whose source hash differs is stale
+ENGINE_API bool hash_scene(const char* scene_path, u64& hash);
+
+// Parses a .scene file and compiles it into a snapshot
+ENGINE_API bool convert_scene(const char* scene_path, std::vector<u8>& out);
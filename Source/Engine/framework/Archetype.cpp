@@ -0,0 +1,258 @@
+#include "engine.pch.h"
+#include "Archetype.h"
+
+#include <deque>
+
+using namespace framework;
+
+namespace
+{
+	struct DataTypeRegistry
+	{
+		std::mutex lock;
+		std::unordered_map<std::type_index, u32> ids;
+
+		// Deque so references handed out stay valid while new types are registered
+		std::deque<DataTypeInfo> infos;
+	};
+
+	DataTypeRegistry& get_registry()
+	{
+		static DataTypeRegistry s_registry;
+		return s_registry;
+	}
+
+	size_t align_up(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+DataTypeInfo const& framework::register_data_type(std::type_index const& type, DataTypeInfo const& info)
+{
+	DataTypeRegistry& registry = get_registry();
+
+	std::lock_guard l{ registry.lock };
+	if (auto it = registry.ids.find(type); it != registry.ids.end())
+	{
+		return registry.infos[it->second];
+	}
+
+	u32 id = u32(registry.infos.size());
+	ASSERTMSG(id < c_MaxDataTypes, "Too many data types registered, only {} are supported!", c_MaxDataTypes);
+
+	DataTypeInfo& result = registry.infos.emplace_back(info);
+	result.id = id;
+	registry.ids[type] = id;
+	return result;
+}
+
+DataTypeInfo const& framework::get_data_type(u32 id)
+{
+	DataTypeRegistry& registry = get_registry();
+
+	std::lock_guard l{ registry.lock };
+	return registry.infos[id];
+}
+
+Archetype::Archetype(DataTypeMask mask)
+		: _mask(mask)
+{
+	_column_index.fill(c_NoColumn);
+
+	u32 row_size = sizeof(u64);
+	for (u32 type = 0; type < c_MaxDataTypes; ++type)
+	{
+		if (has(type))
+		{
+			DataTypeInfo const& info = get_data_type(type);
+			_column_index[type] = u8(_columns.size());
+			_columns.push_back({ type, 0, info.size, &info });
+			row_size += info.size;
+		}
+	}
+
+	// Start from the unpadded estimate and shrink until the aligned columns fit
+	_capacity = std::max<u32>(c_ChunkSize / row_size, 1);
+	while (true)
+	{
+		size_t offset = sizeof(u64) * _capacity;
+		for (Column& column : _columns)
+		{
+			offset = align_up(offset, column.info->alignment);
+			column.offset = u32(offset);
+			offset += size_t(column.size) * _capacity;
+		}
+
+		if (offset <= c_ChunkSize || _capacity == 1)
+		{
+			break;
+		}
+		--_capacity;
+	}
+}
+
+Archetype::~Archetype()
+{
+	clear();
+}
+
+EntityLocation Archetype::allocate(u64 entity)
+{
+	u32 chunk = _count / _capacity;
+	u32 row = _count % _capacity;
+	if (chunk == _chunks.size())
+	{
+		u32 size = std::max<u32>(c_ChunkSize, _columns.empty() ? sizeof(u64) : _columns.back().offset + _columns.back().size * _capacity);
+		_chunks.push_back({ std::make_unique<std::byte[]>(size), 0 });
+	}
+
+	get_entities(chunk)[row] = entity;
+	++_chunks[chunk].count;
+	++_count;
+	return { this, chunk, row };
+}
+
+u64 Archetype::release(u32 chunk, u32 row)
+{
+	ASSERT(_count > 0);
+
+	u32 last = _count - 1;
+	u32 last_chunk = last / _capacity;
+	u32 last_row = last % _capacity;
+
+	u64 moved = c_InvalidEntity;
+	if (last_chunk != chunk || last_row != row)
+	{
+		for (Column const& column : _columns)
+		{
+			column.info->relocate(get(chunk, row, column.type), get(last_chunk, last_row, column.type));
+		}
+
+		moved = get_entities(last_chunk)[last_row];
+		get_entities(chunk)[row] = moved;
+	}
+
+	--_chunks[last_chunk].count;
+	--_count;
+	return moved;
+}
+
+void Archetype::clear()
+{
+	for (Column const& column : _columns)
+	{
+		for (u32 chunk = 0; chunk < _chunks.size(); ++chunk)
+		{
+			for (u32 row = 0; row < _chunks[chunk].count; ++row)
+			{
+				column.info->destroy(get(chunk, row, column.type));
+			}
+		}
+	}
+
+	_chunks.clear();
+	_count = 0;
+}
+
+ArchetypeStorage::~ArchetypeStorage()
+{
+	clear();
+}
+
+void ArchetypeStorage::remove_entity(u64 entity)
+{
+	EntityLocation loc = get_location(entity);
+	if (loc.archetype)
+	{
+		move_entity(entity, 0);
+	}
+}
+
+void ArchetypeStorage::instantiate(u64 src, u64 const* dst, u32 count)
+{
+	EntityLocation src_loc = get_location(src);
+	Archetype* archetype = src_loc.archetype;
+	if (!archetype || count == 0)
+	{
+		return;
+	}
+
+	u64 max_entity = *std::max_element(dst, dst + count);
+	if (max_entity >= _locations.size())
+	{
+		_locations.resize(max_entity + 1);
+	}
+
+	for (u32 i = 0; i < count; ++i)
+	{
+		ASSERTMSG(!_locations[dst[i]].archetype, "Entity {} already has data!", dst[i]);
+
+		EntityLocation loc = archetype->allocate(dst[i]);
+		for (Archetype::Column const& column : archetype->_columns)
+		{
+			ASSERTMSG(column.info->copy, "Data type {} can't be copied!", column.info->name);
+			column.info->copy(archetype->get(loc.chunk, loc.row, column.type), archetype->get(src_loc.chunk, src_loc.row, column.type));
+		}
+		_locations[dst[i]] = loc;
+	}
+}
+
+void ArchetypeStorage::clear()
+{
+	_archetype_lookup.clear();
+	_archetypes.clear();
+	_locations.clear();
+}
+
+Archetype* ArchetypeStorage::find_or_create(DataTypeMask mask)
+{
+	if (auto it = _archetype_lookup.find(mask); it != _archetype_lookup.end())
+	{
+		return it->second;
+	}
+
+	Archetype* archetype = _archetypes.emplace_back(std::make_unique<Archetype>(mask)).get();
+	_archetype_lookup[mask] = archetype;
+	return archetype;
+}
+
+EntityLocation ArchetypeStorage::move_entity(u64 entity, DataTypeMask mask)
+{
+	if (entity >= _locations.size())
+	{
+		_locations.resize(entity + 1);
+	}
+
+	EntityLocation old_loc = _locations[entity];
+	EntityLocation new_loc{};
+	if (mask != 0)
+	{
+		new_loc = find_or_create(mask)->allocate(entity);
+	}
+
+	if (Archetype* old_archetype = old_loc.archetype)
+	{
+		for (Archetype::Column const& column : old_archetype->_columns)
+		{
+			void* src = old_archetype->get(old_loc.chunk, old_loc.row, column.type);
+			if (mask & (1ull << column.type))
+			{
+				column.info->relocate(new_loc.archetype->get(new_loc.chunk, new_loc.row, column.type), src);
+			}
+			else
+			{
+				column.info->destroy(src);
+			}
+		}
+
+		u64 moved = old_archetype->release(old_loc.chunk, old_loc.row);
+		if (moved != Archetype::c_InvalidEntity)
+		{
+			_locations[moved] = old_loc;
+		}
+	}
+
+	_locations[entity] = new_loc;
+	return new_loc;
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <typeindex>
+
+namespace framework
+{
+	// Data components are plain structs stored outside of the entities.
+	//	Every combination of data types is an archetype, the data of an archetype is stored in fixed size chunks
+	//	where each type has its own contiguous array (SoA). Types are limited to 64 so an archetype is identified by a mask.
+	constexpr u32 c_MaxDataTypes = 64;
+	using DataTypeMask = u64;
+
+	struct DataTypeInfo
+	{
+		// Dense index, also the bit of the type in a DataTypeMask
+		u32 id;
+		u32 size;
+		u32 alignment;
+
+		// Move constructs 'dst' from 'src' and destroys 'src'
+		void (*relocate)(void* dst, void* src);
+		void (*destroy)(void* ptr);
+
+		// Copy constructs 'dst' from 'src', nullptr for types that can't be copied
+		void (*copy)(void* dst, void const* src);
+
+		const char* name;
+	};
+
+	// Assigns the id of a data type, registering the same type again returns the existing info
+	ENGINE_API DataTypeInfo const& register_data_type(std::type_index const& type, DataTypeInfo const& info);
+	ENGINE_API DataTypeInfo const& get_data_type(u32 id);
+
+	template<typename T>
+	auto get_copy_fn() -> void (*)(void*, void const*)
+	{
+		if constexpr (std::is_copy_constructible_v<T>)
+		{
+			return [](void* dst, void const* src)
+			{
+				new (dst) T(*static_cast<T const*>(src));
+			};
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+
+	template<typename T>
+	DataTypeInfo const& get_data_type()
+	{
+		static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Chunks don't support over aligned data types!");
+
+		static DataTypeInfo const& s_info = register_data_type(typeid(T), {
+			0,
+			u32(sizeof(T)),
+			u32(alignof(T)),
+			[](void* dst, void* src)
+			{
+				new (dst) T(std::move(*static_cast<T*>(src)));
+				static_cast<T*>(src)->~T();
+			},
+			[](void* ptr)
+			{
+				static_cast<T*>(ptr)->~T();
+			},
+			get_copy_fn<T>(),
+			typeid(T).name() });
+		return s_info;
+	}
+
+	template<typename T>
+	DataTypeMask get_data_mask()
+	{
+		return 1ull << get_data_type<T>().id;
+	}
+
+	class Archetype;
+
+	struct EntityLocation
+	{
+		Archetype* archetype = nullptr;
+		u32 chunk = 0;
+		u32 row = 0;
+	};
+
+	// Storage for all entities that have exactly the same set of data types.
+	//	Rows are kept dense, every chunk is full except for the last one.
+	class ENGINE_API Archetype final
+	{
+	public:
+		static constexpr u32 c_ChunkSize = 16 * 1024;
+
+		explicit Archetype(DataTypeMask mask);
+		~Archetype();
+
+		Archetype(Archetype const&) = delete;
+		Archetype& operator=(Archetype const&) = delete;
+
+		DataTypeMask get_mask() const { return _mask; }
+		bool has(u32 type) const { return (_mask & (1ull << type)) != 0; }
+
+		u32 get_chunk_capacity() const { return _capacity; }
+		u32 get_num_chunks() const { return u32(_chunks.size()); }
+		u32 get_num_entities() const { return _count; }
+
+		// Number of used rows in a chunk
+		u32 get_count(u32 chunk) const { return _chunks[chunk].count; }
+
+		// Entity of each row in the chunk
+		u64* get_entities(u32 chunk) { return reinterpret_cast<u64*>(_chunks[chunk].data.get()); }
+
+		// Start of the array of a data type in the chunk
+		void* get_column(u32 chunk, u32 type)
+		{
+			ASSERT(has(type));
+			return _chunks[chunk].data.get() + _columns[_column_index[type]].offset;
+		}
+
+		template<typename T>
+		T* get_column(u32 chunk)
+		{
+			return static_cast<T*>(get_column(chunk, get_data_type<T>().id));
+		}
+
+		void* get(u32 chunk, u32 row, u32 type)
+		{
+			return static_cast<std::byte*>(get_column(chunk, type)) + size_t(row) * _columns[_column_index[type]].size;
+		}
+
+		// Adds a row at the end, the data of the new row is left unconstructed
+		EntityLocation allocate(u64 entity);
+
+		// Removes a row of which all data has already been destroyed or moved out, the last row is moved into the hole.
+		// Returns the entity that now lives in the row, c_InvalidEntity when the last row was removed.
+		static constexpr u64 c_InvalidEntity = ~0ull;
+		u64 release(u32 chunk, u32 row);
+
+		// Destroys the data of every row
+		void clear();
+
+	private:
+		friend class ArchetypeStorage;
+
+		struct Column
+		{
+			u32 type;
+			u32 offset;
+			u32 size;
+			DataTypeInfo const* info;
+		};
+
+		struct Chunk
+		{
+			std::unique_ptr<std::byte[]> data;
+			u32 count = 0;
+		};
+
+		static constexpr u8 c_NoColumn = 0xFF;
+
+		DataTypeMask _mask;
+		u32 _capacity = 0;
+		u32 _count = 0;
+
+		std::vector<Column> _columns;
+		std::array<u8, c_MaxDataTypes> _column_index;
+
+		std::vector<Chunk> _chunks;
+	};
+
+	// Maps entities to their archetype and row, all accesses by entity index are O(1).
+	//	Adding or removing data moves the entity to another archetype, this invalidates pointers to the data of other entities
+	//	in both archetypes. Structural changes are not allowed while iterating.
+	class ENGINE_API ArchetypeStorage final
+	{
+	public:
+		ArchetypeStorage() = default;
+		~ArchetypeStorage();
+
+		ArchetypeStorage(ArchetypeStorage const&) = delete;
+		ArchetypeStorage& operator=(ArchetypeStorage const&) = delete;
+
+		template<typename T, typename... Args>
+		T& add(u64 entity, Args&&... args)
+		{
+			u32 type = get_data_type<T>().id;
+			EntityLocation loc = get_location(entity);
+			if (loc.archetype && loc.archetype->has(type))
+			{
+				T* value = static_cast<T*>(loc.archetype->get(loc.chunk, loc.row, type));
+				*value = T(std::forward<Args>(args)...);
+				return *value;
+			}
+
+			DataTypeMask mask = (loc.archetype ? loc.archetype->get_mask() : 0) | (1ull << type);
+			loc = move_entity(entity, mask);
+			return *new (loc.archetype->get(loc.chunk, loc.row, type)) T(std::forward<Args>(args)...);
+		}
+
+		template<typename T>
+		void remove(u64 entity)
+		{
+			EntityLocation loc = get_location(entity);
+			DataTypeMask mask = get_data_mask<T>();
+			if (loc.archetype && (loc.archetype->get_mask() & mask))
+			{
+				move_entity(entity, loc.archetype->get_mask() & ~mask);
+			}
+		}
+
+		template<typename T>
+		T* get(u64 entity)
+		{
+			if (entity >= _locations.size())
+			{
+				return nullptr;
+			}
+
+			u32 type = get_data_type<T>().id;
+			EntityLocation const& loc = _locations[entity];
+			if (!loc.archetype || !loc.archetype->has(type))
+			{
+				return nullptr;
+			}
+			return static_cast<T*>(loc.archetype->get(loc.chunk, loc.row, type));
+		}
+
+		template<typename T>
+		bool has(u64 entity) const
+		{
+			return entity < _locations.size() && _locations[entity].archetype && _locations[entity].archetype->has(get_data_type<T>().id);
+		}
+
+		// Calls fn(count, entities, T0*, T1*, ...) for every chunk of the archetypes that contain all requested types
+		template<typename... Ts, typename Fn>
+		void for_each_chunk(Fn&& fn)
+		{
+			DataTypeMask required = (get_data_mask<Ts>() | ...);
+			for (std::unique_ptr<Archetype> const& archetype : _archetypes)
+			{
+				if ((archetype->get_mask() & required) != required)
+				{
+					continue;
+				}
+
+				for (u32 chunk = 0; chunk < archetype->get_num_chunks(); ++chunk)
+				{
+					u32 count = archetype->get_count(chunk);
+					if (count > 0)
+					{
+						fn(count, static_cast<u64 const*>(archetype->get_entities(chunk)), archetype->get_column<Ts>(chunk)...);
+					}
+				}
+			}
+		}
+
+		// Calls fn(entity, T0&, T1&, ...) for every entity that has all requested types
+		template<typename... Ts, typename Fn>
+		void for_each(Fn&& fn)
+		{
+			for_each_chunk<Ts...>([&fn](u32 count, u64 const* entities, Ts*... columns)
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					fn(entities[i], columns[i]...);
+				}
+			});
+		}
+
+		// Destroys all data of an entity
+		void remove_entity(u64 entity);
+
+		// Copies all data of 'src' to each of the 'dst' entities, the destination entities can't have any data yet
+		void instantiate(u64 src, u64 const* dst, u32 count);
+
+		void clear();
+
+		u32 get_num_archetypes() const { return u32(_archetypes.size()); }
+
+	private:
+		EntityLocation get_location(u64 entity) const
+		{
+			return entity < _locations.size() ? _locations[entity] : EntityLocation{};
+		}
+
+		Archetype* find_or_create(DataTypeMask mask);
+
+		// Moves the entity to the archetype of 'mask'. Data that exists in both is moved, data missing from the new archetype is destroyed
+		// and new data is left unconstructed.
+		EntityLocation move_entity(u64 entity, DataTypeMask mask);
+
+		std::vector<std::unique_ptr<Archetype>> _archetypes;
+		std::unordered_map<DataTypeMask, Archetype*> _archetype_lookup;
+
+		// Indexed by the entity index
+		std::vector<EntityLocation> _locations;
+	};
+}
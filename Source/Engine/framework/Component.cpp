@@ -10,9 +10,6 @@ RTTR_REGISTRATION
 {
 	using namespace rttr;
 	registration::class_<Component>("Component")
-		.constructor<>()(
-				rttr::policy::ctor::as_raw_ptr
-		)
 		.property("Active", &Component::_active);
 }
 #endif
@@ -28,5 +25,11 @@ Component::Component()
 		, _parent(nullptr)
 {
 }
+
+Component::Component(Component const& other)
+		: _active(other._active)
+		, _parent(nullptr)
+{
+}
 }
 
@@ -3,6 +3,10 @@
 #include <rttr/registration>
 #endif
 
+#include "System.h"
+
+class FixedBlockPool;
+
 namespace framework
 {
 	class Entity;
@@ -21,22 +25,40 @@ namespace framework
 
 		virtual ~Component();
 
+		// Creates a copy of this component on 'ent', used when instantiating prefabs. Implement with Entity::clone_component.
+		virtual Component* clone(Entity* ent) const = 0;
+
 		virtual void on_attach(Entity* _ent) { _parent = _ent; }
 		virtual void on_detach(Entity* _ent) { _parent = nullptr; }
 
 		virtual void update(float dt) {}
 		virtual void render() {}
 
+		// Data touched by update(), components of a type are updated in parallel when they only touch their own entity.
+		//	Components that don't override this are updated serially.
+		virtual SystemAccess get_update_access() const { return SystemAccess::exclusive(); }
+
 		bool is_active() const { return _active; }
 		Entity* get_entity() const
 		{
 			return _parent;
 		}
 
+	protected:
+		// Copies only the settings, the copy still has to be attached to an entity
+		Component(Component const& other);
+		Component& operator=(Component const&) = delete;
+
 	private:
 		bool _active;
 		Entity* _parent;
 
+		// Index in the component array of the world, see World::get_components
+		u32 _storage_index = ~0u;
+
+		// Pool the component was allocated from, nullptr for components allocated with new
+		FixedBlockPool* _pool = nullptr;
+
 
 		friend class EntityDebugOverlay;
 
@@ -49,17 +49,21 @@ Entity::Entity(float2 pos)
 
 void Entity::set_local_position(float4 pos) {
 	_pos = pos;
+	mark_transform_dirty();
 }
 void Entity::set_local_position(float3 pos) {
 	_pos = float4(pos, 1.0f);
+	mark_transform_dirty();
 }
 
 void Entity::set_local_scale(float3 scale) {
 	_scale = scale;
+	mark_transform_dirty();
 }
 
 void Entity::set_rotation(hlslpp::quaternion quat) {
 	_rot = quat;
+	mark_transform_dirty();
 }
 
 using hlslpp::float3;
@@ -70,14 +74,30 @@ void Entity::set_rotation(float angle) {
 }
 
 float4x4 Entity::get_world_transform() const {
-	float4x4 curr = get_local_transform();
-	if (_parent) {
-		curr = hlslpp::mul(curr, _parent->get_world_transform());
+	if (!_transform_dirty) {
+		return _world_transform;
 	}
 
+	// Own changes are applied on top of the parent's cached transform, see the contract in Entity.h
+	float4x4 curr = get_local_transform();
+	if (Entity* parent = get_parent_entity()) {
+		curr = hlslpp::mul(curr, parent->_world_transform);
+	}
 	return curr;
 }
 
+void Entity::mark_transform_dirty() {
+	_transform_dirty = true;
+}
+
+Entity* Entity::get_parent_entity() const {
+	// Resolve through the world directly, going through the handle would lock the world for every level
+	if (_world && _world->is_handle_valid(_parent)) {
+		return _world->get_entity(_parent);
+	}
+	return nullptr;
+}
+
 float4x4 Entity::get_local_transform() const {
 	float4x4 m = float4x4::identity();
 
@@ -97,7 +117,10 @@ hlslpp::float4 Entity::get_world_position() const {
 Entity::~Entity() {
 	for (auto comp : _components) {
 		comp->on_detach(this);
-		delete comp;
+		if (_world) {
+			_world->unregister_component(comp);
+		}
+		World::destroy_component(comp);
 	}
 	_components.clear();
 }
@@ -112,6 +135,7 @@ void Entity::update(float dt) {
 
 void Entity::set_local_position(float2 pos) {
 	_pos = { pos.x, pos.y, 0.0, 1.0f };
+	mark_transform_dirty();
 }
 
 void Entity::set_local_position(float x, float y) {
@@ -132,7 +156,7 @@ framework::Component* Entity::create_component(rttr::type const& t)
 		obj.convert<Component*>();
 	}
 	Component* comp = obj.get_value<Component*>();
-	_components.push_back(comp);
+	add_component(comp);
 
 	comp->on_attach(this);
 
@@ -142,6 +166,9 @@ framework::Component* Entity::create_component(rttr::type const& t)
 
 void Entity::add_component(Component* component) {
 	_components.push_back(component);
+	if (_world) {
+		_world->register_component(component);
+	}
 }
 
 #ifdef ENABLE_RTTR
@@ -39,7 +39,7 @@ namespace framework
 		virtual ~Entity();
 
 		// Helper to update the entire entities and it's component
-		// #TODO: This should be managed by systems instead
+		// The world doesn't use this anymore, components are updated per type by the systems of the world
 		virtual void update(float dt);
 
 		// Create a component from a type
@@ -53,6 +53,10 @@ namespace framework
 		template<typename T, typename...Args>
 		T* create_component( Args...args);
 
+		// Creates a copy of 'src' on this entity, see Component::clone
+		template<typename T>
+		T* clone_component(T const& src);
+
 		void add_component(Component* component);
 
 		std::vector<Component*> get_components() const { return _components; }
@@ -75,8 +79,13 @@ namespace framework
 		hlslpp::float4 get_local_position() const;
 		hlslpp::float4 get_world_position() const;
 		hlslpp::float4x4 get_local_transform() const;
+		// Local to world transform as of the last World::update_transforms, reads are O(1).
+		//	Changes to this entity show up immediately, changes to one of its parents only once the transforms were updated.
 		hlslpp::float4x4 get_world_transform() const;
 
+		// Invalidates the cached world transform of this entity, World::update_transforms propagates it to the children
+		void mark_transform_dirty();
+
 		void set_name(std::string const& name)
 		{
 			_name = name;
@@ -100,6 +109,16 @@ namespace framework
 		std::vector<EntityHandle> _children;
 		std::vector<Component*> _components;
 
+		// World that owns this entity, components are registered with it
+		World* _world = nullptr;
+
+		// Refreshed by World::update_transforms, only valid while the entity isn't dirty.
+		//	Both are only written by the entity itself and World::update_transforms, so entities can be moved in parallel.
+		hlslpp::float4x4 _world_transform = hlslpp::float4x4::identity();
+		bool _transform_dirty = true;
+
+		Entity* get_parent_entity() const;
+
 		hlslpp::quaternion _rot;
 
 		WrapperFloat4 get_pos() {
@@ -108,6 +127,7 @@ namespace framework
 
 		void set_pos(WrapperFloat4 pos) {
 			_pos = pos;
+			mark_transform_dirty();
 		};
 
 		WrapperFloat3 get_scale() const {
@@ -116,6 +136,7 @@ namespace framework
 
 		void set_scale(WrapperFloat3 v) {
 			_scale = v;
+			mark_transform_dirty();
 		};
 
 		WrapperQuat get_rot_euler() const {
@@ -125,6 +146,7 @@ namespace framework
 			//_rot_euler = v;
 			//_rot = hlslpp::euler({ _rot_euler.x, _rot_euler.y, _rot_euler.z });
 			_rot = v.value;
+			mark_transform_dirty();
 		};
 
 
@@ -137,8 +159,9 @@ namespace framework
 	template<typename T, typename...Args>
 	T* Entity::create_component(Args...args)
 	{
-		T* comp = new T(args...);
-		_components.push_back(comp);
+		// Entities owned by a world allocate their components from the pool of the component type
+		T* comp = _world ? _world->allocate_component<T>(args...) : new T(args...);
+		add_component(comp);
 
 		comp->on_attach(this);
 
@@ -146,14 +169,30 @@ namespace framework
 	}
 
 
-	#ifdef ENABLE_RTTR
+	template<typename T>
+	T* Entity::clone_component(T const& src)
+	{
+		T* comp = _world ? _world->allocate_component<T>(src) : new T(src);
+		add_component(comp);
+
+		comp->on_attach(this);
+
+		return comp;
+	}
+
 	template<typename T>
 	T* Entity::get_component() const
 	{
-		rttr::type const& info = rttr::type::get<T>();
-		return static_cast<T*>(get_component(info));
+		// Exact type match like the rttr lookup, without going through the type registry
+		for (Component* c : _components)
+		{
+			if (typeid(*c) == typeid(T))
+			{
+				return static_cast<T*>(c);
+			}
+		}
+		return nullptr;
 	}
-	#endif
 
 
 
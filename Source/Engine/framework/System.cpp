@@ -0,0 +1,164 @@
+#include "engine.pch.h"
+#include "System.h"
+
+#include "Component.h"
+#include "World.h"
+
+using namespace framework;
+
+AccessMask framework::get_component_access(std::type_index const& type)
+{
+	static std::mutex s_lock;
+	static std::unordered_map<std::type_index, AccessMask> s_bits;
+
+	std::lock_guard l{ s_lock };
+	if (auto it = s_bits.find(type); it != s_bits.end())
+	{
+		return it->second;
+	}
+
+	// Component types beyond the available bits share the last one, this only adds false dependencies
+	u32 bit = std::min<u32>(c_NumBuiltinAccessBits + u32(s_bits.size()), 63);
+	AccessMask mask = 1ull << bit;
+	s_bits[type] = mask;
+	return mask;
+}
+
+ComponentUpdateSystem::ComponentUpdateSystem(std::string name, SystemAccess access, std::vector<Component*> const* components)
+		: System(std::move(name), access)
+		, _components(components)
+{
+}
+
+void ComponentUpdateSystem::update(World& world, float dt)
+{
+	std::vector<Component*> const& components = *_components;
+	if (!get_access().per_entity || components.size() <= c_ComponentsPerJob)
+	{
+		// Index based, serial components are allowed to add new components of their own type
+		for (size_t i = 0; i < components.size(); ++i)
+		{
+			Component* comp = components[i];
+			if (comp->is_active())
+			{
+				comp->update(dt);
+			}
+		}
+		return;
+	}
+
+	Component* const* data = components.data();
+	Tasks::JobCounter counter{};
+	Tasks::get_scheduler()->parallel_for(u32(components.size()), c_ComponentsPerJob, [data, dt](u32 begin, u32 end)
+	{
+		for (u32 i = begin; i < end; ++i)
+		{
+			if (data[i]->is_active())
+			{
+				data[i]->update(dt);
+			}
+		}
+	}, &counter);
+	Tasks::get_scheduler()->wait(counter);
+}
+
+System* SystemScheduler::add(std::unique_ptr<System> system)
+{
+	_systems.push_back(std::move(system));
+	_dirty = true;
+	return _systems.back().get();
+}
+
+void SystemScheduler::clear()
+{
+	_systems.clear();
+	_dirty = true;
+}
+
+void SystemScheduler::build()
+{
+	u32 n = u32(_systems.size());
+	_levels.assign(n, 0);
+
+	u32 num_levels = 0;
+	for (u32 i = 0; i < n; ++i)
+	{
+		SystemAccess const& access = _systems[i]->get_access();
+		for (u32 j = 0; j < i; ++j)
+		{
+			if (access.conflicts_with(_systems[j]->get_access()))
+			{
+				_levels[i] = std::max(_levels[i], _levels[j] + 1);
+			}
+		}
+		num_levels = std::max(num_levels, _levels[i] + 1);
+	}
+
+	// Counting sort on the level, systems within a level keep the order they were added in
+	_level_offsets.assign(num_levels + 1, 0);
+	for (u32 level : _levels)
+	{
+		++_level_offsets[level + 1];
+	}
+	for (u32 i = 1; i <= num_levels; ++i)
+	{
+		_level_offsets[i] += _level_offsets[i - 1];
+	}
+
+	_order.resize(n);
+	std::vector<u32> cursor(_level_offsets.begin(), _level_offsets.end() - 1);
+	for (u32 i = 0; i < n; ++i)
+	{
+		_order[cursor[_levels[i]]++] = _systems[i].get();
+	}
+
+	_dirty = false;
+}
+
+void SystemScheduler::run(World& world, float dt)
+{
+	JONO_EVENT();
+
+	if (_dirty)
+	{
+		build();
+	}
+
+	Tasks::JobSystem* jobs = Tasks::get_scheduler();
+	for (u32 level = 0; level + 1 < _level_offsets.size(); ++level)
+	{
+		u32 first = _level_offsets[level];
+		u32 count = _level_offsets[level + 1] - first;
+
+		// The first system of a level runs on the calling thread while the others are picked up by the workers
+		Tasks::JobCounter counter{};
+		for (u32 i = 1; i < count; ++i)
+		{
+			System* system = _order[first + i];
+			jobs->run([system, &world, dt]()
+			{
+				system->update(world, dt);
+			}, &counter);
+		}
+		_order[first]->update(world, dt);
+		jobs->wait(counter);
+	}
+}
+
+u32 SystemScheduler::get_level(u32 system)
+{
+	if (_dirty)
+	{
+		build();
+	}
+	return _levels[system];
+}
+
+u32 SystemScheduler::get_num_levels()
+{
+	if (_dirty)
+	{
+		build();
+	}
+	return u32(_level_offsets.size() - 1);
+}
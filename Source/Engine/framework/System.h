@@ -0,0 +1,139 @@
+#pragma once
+
+#include <typeindex>
+
+namespace framework
+{
+	class World;
+	class Component;
+
+	// One bit per piece of data that systems can read or write.
+	//	The first bits are reserved for engine data, component types get a bit assigned the first time they are used.
+	using AccessMask = u64;
+
+	enum BuiltinAccess : AccessMask
+	{
+		// Entity transforms and the entity hierarchy
+		Access_Transform = 1ull << 0,
+
+		// Input manager state
+		Access_Input = 1ull << 1,
+
+		// Game side render world
+		Access_RenderWorld = 1ull << 2,
+
+		Access_All = ~0ull
+	};
+
+	constexpr u32 c_NumBuiltinAccessBits = 3;
+
+	// Returns the access bit of a component type
+	ENGINE_API AccessMask get_component_access(std::type_index const& type);
+
+	template<typename T>
+	AccessMask get_component_access()
+	{
+		return get_component_access(std::type_index(typeid(T)));
+	}
+
+	// Declares the data touched by a system, systems that don't conflict are executed in parallel
+	struct SystemAccess
+	{
+		AccessMask reads = 0;
+		AccessMask writes = Access_All;
+
+		// The update of an entity only touches the entity itself and its own components, the entities can be updated in parallel
+		bool per_entity = false;
+
+		// Writes everything, used for components that don't declare their access
+		static SystemAccess exclusive() { return {}; }
+
+		static SystemAccess parallel(AccessMask reads, AccessMask writes)
+		{
+			return { reads, writes, true };
+		}
+
+		// Two systems conflict when one of them writes data the other reads or writes
+		bool conflicts_with(SystemAccess const& rhs) const
+		{
+			return (writes & (rhs.reads | rhs.writes)) || (reads & rhs.writes);
+		}
+	};
+
+	class ENGINE_API System
+	{
+	public:
+		System(std::string name, SystemAccess access)
+				: _name(std::move(name))
+				, _access(access)
+		{
+		}
+
+		virtual ~System() = default;
+
+		System(System const&) = delete;
+		System& operator=(System const&) = delete;
+
+		virtual void update(World& world, float dt) = 0;
+
+		SystemAccess const& get_access() const { return _access; }
+		const char* get_name() const { return _name.c_str(); }
+
+	private:
+		std::string _name;
+		SystemAccess _access;
+	};
+
+	// Calls Component::update on every active component of a single type.
+	//	The components are kept in a contiguous array by the world, per entity components are split in batches over the job system.
+	class ENGINE_API ComponentUpdateSystem final : public System
+	{
+	public:
+		static constexpr u32 c_ComponentsPerJob = 64;
+
+		ComponentUpdateSystem(std::string name, SystemAccess access, std::vector<Component*> const* components);
+
+		void update(World& world, float dt) override;
+
+	private:
+		std::vector<Component*> const* _components;
+	};
+
+	// Runs systems as a dependency graph.
+	//	Every system depends on the systems added before it that it conflicts with. Systems are grouped in levels
+	//	where a level only depends on the levels before it, the systems of a level run in parallel.
+	class ENGINE_API SystemScheduler final
+	{
+	public:
+		SystemScheduler() = default;
+		~SystemScheduler() = default;
+
+		SystemScheduler(SystemScheduler const&) = delete;
+		SystemScheduler& operator=(SystemScheduler const&) = delete;
+
+		System* add(std::unique_ptr<System> system);
+
+		void clear();
+
+		// Executes all systems, returns once every system has finished
+		void run(World& world, float dt);
+
+		u32 get_num_systems() const { return u32(_systems.size()); }
+
+		// Level each system was scheduled in, indexed in the order the systems were added
+		u32 get_level(u32 system);
+		u32 get_num_levels();
+
+	private:
+		void build();
+
+		std::vector<std::unique_ptr<System>> _systems;
+
+		// Systems sorted by level, '_level_offsets' holds the first system of each level followed by the total count
+		std::vector<u32> _levels;
+		std::vector<System*> _order;
+		std::vector<u32> _level_offsets;
+
+		bool _dirty = true;
+	};
+}
@@ -6,20 +6,50 @@
 
 using namespace framework;
 
-EntityHandle::EntityHandle(uint64_t id, uint64_t generation, std::weak_ptr<World> world)
+namespace
+{
+	// Every live world has a slot, handles resolve through the slot instead of holding a reference to the world.
+	//	The generation is bumped when a world is destroyed so handles to it stop resolving.
+	//	Slots are written under the registry lock but read without it when resolving handles.
+	struct WorldSlot
+	{
+		std::atomic<World*> world = nullptr;
+		std::atomic<u32> generation = 0;
+	};
+
+	constexpr u32 c_MaxWorlds = 64;
+
+	std::array<WorldSlot, c_MaxWorlds> s_world_registry;
+	std::mutex s_world_registry_lock;
+}
+
+EntityHandle::EntityHandle(uint64_t id, uint64_t generation, u32 world_index, u32 world_generation)
 		: id(id)
 		, generation(generation)
-		, world(world)
+		, world_index(world_index)
+		, world_generation(world_generation)
 {
 }
 
-bool EntityHandle::is_valid() const
+World* EntityHandle::get_world() const
 {
-	if (world.expired())
-		return false;
+	if (world_index >= c_MaxWorlds)
+	{
+		return nullptr;
+	}
 
-	auto p_world = world.lock();
-	return p_world->is_handle_valid(*this);
+	WorldSlot const& slot = s_world_registry[world_index];
+	if (slot.generation.load(std::memory_order_acquire) != world_generation)
+	{
+		return nullptr;
+	}
+	return slot.world.load(std::memory_order_acquire);
+}
+
+bool EntityHandle::is_valid() const
+{
+	World* w = get_world();
+	return w && w->is_handle_valid(*this);
 }
 
 Entity* EntityHandle::operator->() const
@@ -29,10 +59,10 @@ Entity* EntityHandle::operator->() const
 
 Entity* EntityHandle::get() const
 {
-	if (is_valid())
+	World* w = get_world();
+	if (w && w->is_handle_valid(*this))
 	{
-		auto p_world = world.lock();
-		return p_world->get_entity(*this);
+		return w->_entities[id];
 	}
 	return nullptr;
 }
@@ -42,39 +72,225 @@ World::World()
 {
 	_entities.reserve(1000);
 	_generation.reserve(1000);
+
+	// Keep the entities 16 byte aligned, the pages of the pool are
+	_entity_pool.init((sizeof(Entity) + 15) & ~size_t(15));
+
+	std::lock_guard l{ s_world_registry_lock };
+	auto it = std::find_if(s_world_registry.begin(), s_world_registry.end(), [](WorldSlot const& slot)
+	{
+		return slot.world.load(std::memory_order_relaxed) == nullptr;
+	});
+	if (it == s_world_registry.end())
+	{
+		LOG_FATAL(System, "Too many worlds alive, only {} are supported!", c_MaxWorlds);
+		std::abort();
+	}
+
+	_registry_index = u32(it - s_world_registry.begin());
+	_registry_generation = it->generation.load(std::memory_order_relaxed);
+	it->world.store(this, std::memory_order_release);
 }
 
 World::~World()
 {
 	for (Entity* it : _entities)
 	{
-		delete it;
+		destroy_entity(it);
 	}
 
 	_entities.clear();
 	_generation.clear();
+
+	std::lock_guard l{ s_world_registry_lock };
+	// Bump the generation first so lock-free lookups stop matching before the world pointer goes away
+	WorldSlot& slot = s_world_registry[_registry_index];
+	slot.generation.fetch_add(1, std::memory_order_release);
+	slot.world.store(nullptr, std::memory_order_release);
 }
 
 void World::update(float dt)
 {
 	for (uint64_t const& id : _deletion_list)
 	{
+		// Children lose their parent transform
+		for (EntityHandle const& child : _entities[id]->_children)
+		{
+			if (is_handle_valid(child))
+			{
+				_entities[child.id]->mark_transform_dirty();
+			}
+		}
+
 		// Free the entity
-		delete _entities[id];
+		destroy_entity(_entities[id]);
 		_entities[id] = nullptr;
+		_data.remove_entity(id);
 
 		// Add this slot to the free list
 		_free_list.push_back(id);
 	}
+	if (!_deletion_list.empty())
+	{
+		_hierarchy_dirty = true;
+	}
 	_deletion_list.clear();
 
-	for (auto it : _entities)
+	_scheduler.run(*this, dt);
+
+	update_transforms();
+}
+
+void World::update_transforms()
+{
+	JONO_EVENT();
+
+	if (_hierarchy_dirty)
+	{
+		build_transform_order();
+	}
+
+	auto update_range = [this](u32 begin, u32 end)
+	{
+		for (u32 i = begin; i < end; ++i)
+		{
+			Entity* ent = _transform_order[i];
+			u32 parent = _transform_parents[i];
+
+			// Parents are a level earlier, their changes are final by the time their children are visited
+			bool changed = ent->_transform_dirty || (parent != c_NoParent && _transform_changed[parent]);
+			if (changed)
+			{
+				float4x4 transform = ent->get_local_transform();
+				if (parent != c_NoParent)
+				{
+					transform = hlslpp::mul(transform, _world_transforms[parent]);
+				}
+
+				ent->_world_transform = transform;
+				ent->_transform_dirty = false;
+			}
+			_transform_changed[i] = changed;
+			_world_transforms[i] = ent->_world_transform;
+		}
+	};
+
+	Tasks::JobSystem* jobs = Tasks::get_scheduler();
+	for (u32 level = 0; level + 1 < _transform_levels.size(); ++level)
+	{
+		u32 first = _transform_levels[level];
+		u32 count = _transform_levels[level + 1] - first;
+		if (count <= c_TransformsPerJob)
+		{
+			update_range(first, first + count);
+			continue;
+		}
+
+		Tasks::JobCounter counter{};
+		jobs->parallel_for(count, c_TransformsPerJob, [&update_range, first](u32 begin, u32 end)
+		{
+			update_range(first + begin, first + end);
+		}, &counter);
+		jobs->wait(counter);
+	}
+}
+
+void World::build_transform_order()
+{
+	_transform_order.clear();
+	_transform_parents.clear();
+	_transform_levels.clear();
+
+	// Every entity without a parent starts a hierarchy
+	for (Entity* ent : _entities)
+	{
+		if (ent && !is_handle_valid(ent->_parent))
+		{
+			_transform_order.push_back(ent);
+			_transform_parents.push_back(c_NoParent);
+		}
+	}
+
+	u32 level_begin = 0;
+	while (level_begin < _transform_order.size())
 	{
-		if (it)
+		u32 level_end = u32(_transform_order.size());
+		_transform_levels.push_back(level_begin);
+		for (u32 i = level_begin; i < level_end; ++i)
 		{
-			it->update(dt);
+			for (EntityHandle const& child : _transform_order[i]->_children)
+			{
+				if (is_handle_valid(child))
+				{
+					_transform_order.push_back(_entities[child.id]);
+					_transform_parents.push_back(i);
+				}
+			}
 		}
+		level_begin = level_end;
 	}
+	_transform_levels.push_back(u32(_transform_order.size()));
+
+	_world_transforms.resize(_transform_order.size());
+	_transform_changed.resize(_transform_order.size());
+	_hierarchy_dirty = false;
+}
+
+System* World::add_system(std::unique_ptr<System> system)
+{
+	return _scheduler.add(std::move(system));
+}
+
+std::vector<Component*> const& World::get_components(std::type_index const& type) const
+{
+	static const std::vector<Component*> s_empty;
+
+	auto it = _components_by_type.find(type);
+	return it != _components_by_type.end() ? it->second : s_empty;
+}
+
+void World::register_component(Component* component)
+{
+	if (component->_storage_index != ~0u)
+	{
+		return;
+	}
+
+	std::type_index type = typeid(*component);
+	auto it = _components_by_type.find(type);
+	if (it == _components_by_type.end())
+	{
+		it = _components_by_type.emplace(type, std::vector<Component*>{}).first;
+
+		// The first component of a type decides the access of the update system for that type.
+		// References to the map elements stay valid when the map grows, the system can keep pointing to the array.
+		SystemAccess access = component->get_update_access();
+		access.writes |= get_component_access(type);
+		_scheduler.add(std::make_unique<ComponentUpdateSystem>(type.name(), access, &it->second));
+	}
+
+	std::vector<Component*>& components = it->second;
+	component->_storage_index = u32(components.size());
+	components.push_back(component);
+}
+
+void World::unregister_component(Component* component)
+{
+	if (component->_storage_index == ~0u)
+	{
+		return;
+	}
+
+	std::vector<Component*>& components = _components_by_type[typeid(*component)];
+	ASSERT(components[component->_storage_index] == component);
+
+	// Swap with the last component of the type
+	Component* last = components.back();
+	components[component->_storage_index] = last;
+	last->_storage_index = component->_storage_index;
+	components.pop_back();
+
+	component->_storage_index = ~0u;
 }
 
 bool World::is_handle_valid(EntityHandle const& handle)
@@ -91,17 +307,26 @@ Entity* World::get_entity(EntityHandle const& id)
 	return _entities[id.id];
 }
 
+void World::resolve(EntityHandle const* handles, u32 count, Entity** out) const
+{
+	for (u32 i = 0; i < count; ++i)
+	{
+		EntityHandle const& h = handles[i];
+		bool valid = h.world_index == _registry_index && h.world_generation == _registry_generation
+				&& h.id < _generation.size() && _generation[h.id] == h.generation;
+		out[i] = valid ? _entities[h.id] : nullptr;
+	}
+}
+
 #ifdef ENABLE_RTTR
 Component* World::find_first_component(rttr::type const& info) const
 {
-	for (std::size_t i = 0; i < _entities.size(); ++i)
+	// Only the type arrays are searched, there are far less types than entities
+	for (auto const& [type, components] : _components_by_type)
 	{
-		if (_entities[i])
+		if (!components.empty() && rttr::type::get(*components.front()) == info)
 		{
-			if (auto comp = _entities[i]->get_component(info); comp)
-			{
-				return comp;
-			}
+			return components.front();
 		}
 	}
 
@@ -111,19 +336,74 @@ Component* World::find_first_component(rttr::type const& info) const
 
 bool World::remove_entity(EntityHandle const& handle)
 {
-	// Check if this id hasn't been queued yet for debugging
-	// and then queue it up for deletion in the update loop
-	auto it = std::find(_deletion_list.begin(), _deletion_list.end(), handle.id);
-	assert(it == _deletion_list.end());
+	// The generation is bumped below, a handle that was already queued for deletion is no longer valid
+	ASSERTMSG(is_handle_valid(handle), "Entity {} is invalid or already queued for deletion!", handle.id);
 	_deletion_list.push_back(handle.id);
 
 	_entities_by_id[handle->get_id()].clear();
 
 	++_generation[handle.id];
+	_hierarchy_dirty = true;
 
 	return true;
 }
 
+void World::remove_entities(std::vector<EntityHandle> const& handles)
+{
+	_deletion_list.reserve(_deletion_list.size() + handles.size());
+	for (EntityHandle const& handle : handles)
+	{
+		remove_entity(handle);
+	}
+}
+
+Entity* World::allocate_entity()
+{
+	Entity* ent = new (_entity_pool.allocate()) Entity();
+	ent->_world = this;
+	return ent;
+}
+
+void World::destroy_entity(Entity* entity)
+{
+	if (entity)
+	{
+		entity->~Entity();
+		_entity_pool.free(entity);
+	}
+}
+
+FixedBlockPool* World::get_component_pool(std::type_index const& type, size_t size)
+{
+	// Align the blocks so the components are 16 byte aligned in the pages
+	size = (size + 15) & ~size_t(15);
+	if (size > FixedBlockPool::c_PageSize / 4)
+	{
+		return nullptr;
+	}
+
+	std::unique_ptr<FixedBlockPool>& pool = _component_pools[type];
+	if (!pool)
+	{
+		pool = std::make_unique<FixedBlockPool>();
+		pool->init(size);
+	}
+	return pool.get();
+}
+
+void World::destroy_component(Component* component)
+{
+	if (FixedBlockPool* pool = component->_pool)
+	{
+		component->~Component();
+		pool->free(component);
+	}
+	else
+	{
+		delete component;
+	}
+}
+
 bool framework::World::attach_to(EntityHandle const& attach_to, EntityHandle const& child)
 {
 	auto current_parent = _entities[child.id]->_parent;
@@ -137,6 +417,9 @@ bool framework::World::attach_to(EntityHandle const& attach_to, EntityHandle con
 	// update parent
 	_entities[attach_to.id]->_children.push_back(child);
 
+	_entities[child.id]->mark_transform_dirty();
+	_hierarchy_dirty = true;
+
 	return true;
 }
 
@@ -166,7 +449,7 @@ std::shared_ptr<framework::World> World::create()
 void framework::World::init()
 {
 	// Create the root entity
-	Entity* ent = new Entity();
+	Entity* ent = allocate_entity();
 
 	std::size_t id = _entities.size();
 
@@ -189,8 +472,7 @@ void framework::World::init()
 		_generation.resize(id + 1000, 0);
 	}
 
-	auto w = shared_from_this();
-	auto handle = EntityHandle(id, _generation[id], w);
+	auto handle = EntityHandle(id, _generation[id], _registry_index, _registry_generation);
 	_root = handle;
 	_root->set_name("Root");
 }
@@ -207,8 +489,9 @@ void framework::World::clear()
 	for (uint64_t id = 1; id < _entities.size(); ++id)
 	{
 		// Free the entity
-		delete _entities[id];
+		destroy_entity(_entities[id]);
 		_entities[id] = nullptr;
+		_data.remove_entity(id);
 
 		// Invalidate the generation for all entities
 		++_generation[id];
@@ -216,11 +499,12 @@ void framework::World::clear()
 
 	_entities_by_id.clear();
 	_entities.resize(1);
+	_hierarchy_dirty = true;
 }
 
 EntityHandle framework::World::create_entity(Identifier64 id)
 {
-	Entity* obj = new Entity();
+	Entity* obj = allocate_entity();
 	obj->_id = id;
 
 	std::size_t idx = _entities.size();
@@ -247,14 +531,71 @@ EntityHandle framework::World::create_entity(Identifier64 id)
 		_generation.resize(idx + 1000, 0);
 	}
 
-	auto w = shared_from_this();
-	auto handle = EntityHandle(idx, _generation[idx], w);
+	auto handle = EntityHandle(idx, _generation[idx], _registry_index, _registry_generation);
 
 	_entities_by_id[obj->get_id()] = handle;
+	_hierarchy_dirty = true;
 
 	return handle;
 }
 
+void framework::World::create_entities(u32 count, std::vector<EntityHandle>& out)
+{
+	JONO_EVENT();
+
+	size_t n_new_slots = count - std::min<size_t>(count, _free_list.size());
+	_entities.reserve(_entities.size() + n_new_slots);
+	if (_generation.size() < _entities.size() + n_new_slots)
+	{
+		_generation.resize(_entities.size() + n_new_slots + 1000, 0);
+	}
+	_entities_by_id.reserve(_entities_by_id.size() + count);
+
+	out.reserve(out.size() + count);
+	for (u32 i = 0; i < count; ++i)
+	{
+		out.push_back(create_entity());
+	}
+}
+
+void framework::World::instantiate(EntityHandle const& prefab, u32 count, std::vector<EntityHandle>& out)
+{
+	JONO_EVENT();
+
+	Entity* src = get_entity(prefab);
+	ASSERT(src);
+
+	size_t first = out.size();
+	create_entities(count, out);
+
+	std::vector<u64> ids;
+	ids.reserve(count);
+	for (size_t i = first; i < out.size(); ++i)
+	{
+		EntityHandle const& handle = out[i];
+		Entity* ent = _entities[handle.id];
+		ent->_name = src->_name;
+		ent->_pos = src->_pos;
+		ent->_rot = src->_rot;
+		ent->_scale = src->_scale;
+
+		if (is_handle_valid(src->_parent))
+		{
+			attach_to(src->_parent, handle);
+		}
+
+		for (Component* comp : src->_components)
+		{
+			Component* copy = comp->clone(ent);
+			ASSERTMSG(copy && copy->get_entity() == ent, "Component {} did not clone onto the new entity!", typeid(*comp).name());
+		}
+
+		ids.push_back(handle.id);
+	}
+
+	_data.instantiate(prefab.id, ids.data(), u32(ids.size()));
+}
+
 EntityHandle framework::World::find_by_id(Identifier64 const& id) const
 {
 	auto it = _entities_by_id.find(id);
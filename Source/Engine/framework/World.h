@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Identifier.h"
+#include "Core/Allocators.h"
+#include "System.h"
+#include "Archetype.h"
 
 namespace framework
 {
@@ -11,8 +14,9 @@ namespace framework
 	struct ENGINE_API EntityHandle
 	{
 		static constexpr uint64_t invalid_id = std::numeric_limits<uint64_t>::max();
+		static constexpr u32 invalid_world = std::numeric_limits<u32>::max();
 
-		EntityHandle() : id(invalid_id), generation(invalid_id) {};
+		EntityHandle() : id(invalid_id), generation(invalid_id), world_index(invalid_world), world_generation(0) {};
 		~EntityHandle() = default;
 
 		uint64_t id;
@@ -46,10 +50,14 @@ namespace framework
 		}
 
 	private:
-		EntityHandle(uint64_t id, uint64_t generation, std::weak_ptr<class World> world);
+		EntityHandle(uint64_t id, uint64_t generation, u32 world_index, u32 world_generation);
 
-		// Non-Owning pointer to the world
-		std::weak_ptr<class World> world;
+		// Looks up the owning world in the world registry, nullptr when that world has been destroyed
+		World* get_world() const;
+
+		// Slot of the owning world in the world registry, resolving doesn't touch any reference counts
+		u32 world_index;
+		u32 world_generation;
 
 		friend class World;
 	};
@@ -68,8 +76,28 @@ namespace framework
 
 		void init();
 
+		// Removes the entities queued for deletion, runs all systems and updates the world transforms
 		void update(float dt);
 
+		// Updates the cached world transform of every dirty entity.
+		//	Entities are processed breadth first so parents are always done before their children, each depth is split over the job system.
+		void update_transforms();
+
+		// Adds a system that runs every update. Systems run in parallel unless their access conflicts with a system added before them.
+		//	Every component type gets a ComponentUpdateSystem when the first component of that type is registered.
+		System* add_system(std::unique_ptr<System> system);
+
+		SystemScheduler& get_scheduler() { return _scheduler; }
+
+		// All components of a type, including inactive ones
+		std::vector<Component*> const& get_components(std::type_index const& type) const;
+
+		template<typename T>
+		std::vector<Component*> const& get_components() const
+		{
+			return get_components(std::type_index(typeid(T)));
+		}
+
 		bool is_handle_valid(EntityHandle const& handle);
 
 		EntityHandle find_by_id(Identifier64 const& id) const;
@@ -78,23 +106,98 @@ namespace framework
 
 		EntityHandle create_entity(Identifier64 id = Identifier64::create_guid());
 
+		// Creates 'count' entities at once, storage for all of them is reserved up front
+		void create_entities(u32 count, std::vector<EntityHandle>& out);
+
+		// Creates 'count' copies of 'prefab' under the same parent. The transform, name and data components are copied,
+		//	components are copied through Component::clone.
+		void instantiate(EntityHandle const& prefab, u32 count, std::vector<EntityHandle>& out);
+
 		Entity* get_entity(EntityHandle const& id);
 
-#ifdef ENABLE_RTTR
+		// Resolves a batch of handles at once, handles that are invalid or belong to another world resolve to nullptr
+		void resolve(EntityHandle const* handles, u32 count, Entity** out) const;
+
+		void resolve(std::vector<EntityHandle> const& handles, std::vector<Entity*>& out) const
+		{
+			out.resize(handles.size());
+			resolve(handles.data(), u32(handles.size()), out.data());
+		}
+
 		template<typename T>
 		T* find_first_component() const
 		{
-			auto t = rttr::type::get<T>();
-			return reinterpret_cast<T*>(find_first_component(t));
+			std::vector<Component*> const& components = get_components<T>();
+			return components.empty() ? nullptr : static_cast<T*>(components.front());
 		}
-#endif
 
 #ifdef ENABLE_RTTR
 		Component* find_first_component(rttr::type const& info) const;
 #endif
 
+		// Data components are plain structs kept in archetype chunks instead of on the entity, see ArchetypeStorage.
+		//	Adding or removing data invalidates pointers to the data of other entities.
+		template<typename T, typename... Args>
+		T& add_data(EntityHandle const& handle, Args&&... args)
+		{
+			ASSERT(is_handle_valid(handle));
+			return _data.add<T>(handle.id, std::forward<Args>(args)...);
+		}
+
+		template<typename T>
+		void remove_data(EntityHandle const& handle)
+		{
+			ASSERT(is_handle_valid(handle));
+			_data.remove<T>(handle.id);
+		}
+
+		template<typename T>
+		T* get_data(EntityHandle const& handle)
+		{
+			return is_handle_valid(handle) ? _data.get<T>(handle.id) : nullptr;
+		}
+
+		// Calls fn(entity_index, T0&, T1&, ...) for every entity that has all of the data types
+		template<typename... Ts, typename Fn>
+		void for_each(Fn&& fn)
+		{
+			_data.for_each<Ts...>(std::forward<Fn>(fn));
+		}
+
+		// Calls fn(count, entity_indices, T0*, T1*, ...) for every chunk, the arrays are contiguous
+		template<typename... Ts, typename Fn>
+		void for_each_chunk(Fn&& fn)
+		{
+			_data.for_each_chunk<Ts...>(std::forward<Fn>(fn));
+		}
+
+		ArchetypeStorage& get_data_storage() { return _data; }
+
+		// Allocates a component from the pool of its type, components are released through destroy_component
+		template<typename T, typename... Args>
+		T* allocate_component(Args&&... args)
+		{
+			static_assert(alignof(T) <= 16, "Component pools only align to 16 bytes!");
+
+			FixedBlockPool* pool = get_component_pool(typeid(T), sizeof(T));
+			if (!pool)
+			{
+				return new T(std::forward<Args>(args)...);
+			}
+
+			T* comp = new (pool->allocate()) T(std::forward<Args>(args)...);
+			static_cast<Component*>(comp)->_pool = pool;
+			return comp;
+		}
+
+		// Destroys a component and returns its memory to the pool it was allocated from
+		static void destroy_component(Component* component);
+
 		bool remove_entity(EntityHandle const& handle);
 
+		// Queues a batch of entities for deletion, they are released together on the next update
+		void remove_entities(std::vector<EntityHandle> const& handles);
+
 		void clear();
 
 		std::vector<Entity*> get_entities() const
@@ -112,9 +215,29 @@ namespace framework
 		}
 
 	private:
+		friend class Entity;
+		friend struct EntityHandle;
+
+		// Called by the entities when a component gets added or destroyed
+		void register_component(Component* component);
+		void unregister_component(Component* component);
+
+		// Returns nullptr for components too large to be pooled
+		FixedBlockPool* get_component_pool(std::type_index const& type, size_t size);
+
+		Entity* allocate_entity();
+		void destroy_entity(Entity* entity);
+
+		// Entities and components are allocated from pools segregated per type, pages are only released with the world
+		FixedBlockPool _entity_pool;
+		std::unordered_map<std::type_index, std::unique_ptr<FixedBlockPool>> _component_pools;
 
 		EntityHandle _root;
 
+		// Slot in the world registry, handed to every handle created by this world
+		u32 _registry_index;
+		u32 _registry_generation;
+
 		std::vector<uint64_t> _free_list;
 		std::vector<uint64_t> _deletion_list;
 
@@ -125,6 +248,30 @@ namespace framework
 
 		std::unordered_map<Identifier64, EntityHandle> _entities_by_id;
 
+		// Components grouped per type, each component stores its index in the array of its type
+		std::unordered_map<std::type_index, std::vector<Component*>> _components_by_type;
+
+		SystemScheduler _scheduler;
+
+		// Data components, indexed by the entity index
+		ArchetypeStorage _data;
+
+		void build_transform_order();
+
+		static constexpr u32 c_NoParent = ~0u;
+		static constexpr u32 c_TransformsPerJob = 256;
+
+		// Entities in breadth first order together with the index of their parent in the same order.
+		//	'_transform_levels' holds the first entity of each depth followed by the total count, rebuilt when the hierarchy changes.
+		std::vector<Entity*> _transform_order;
+		std::vector<u32> _transform_parents;
+		std::vector<u32> _transform_levels;
+		std::vector<float4x4> _world_transforms;
+
+		// Set for the entities whose world transform changed during the current update, children of those are recomputed as well
+		std::vector<u8> _transform_changed;
+		bool _hierarchy_dirty = true;
+
 		friend class EntityDebugOverlay;
 	};
 }
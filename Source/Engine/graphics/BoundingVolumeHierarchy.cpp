@@ -0,0 +1,446 @@
+#include "engine.pch.h"
+#include "BoundingVolumeHierarchy.h"
+
+namespace
+{
+
+Math::AABB merge(Math::AABB const& a, Math::AABB const& b)
+{
+	return { hlslpp::min(a.min, b.min), hlslpp::max(a.max, b.max) };
+}
+
+bool contains(Math::AABB const& outer, Math::AABB const& inner)
+{
+	return hlslpp::all(outer.min <= inner.min) && hlslpp::all(inner.max <= outer.max);
+}
+
+bool overlaps(Math::AABB const& a, Math::AABB const& b)
+{
+	return hlslpp::all(a.min <= b.max) && hlslpp::all(b.min <= a.max);
+}
+
+// Cost metric used to pick the insertion point, proportional to the probability of a random ray hitting the box
+f32 surface_area(Math::AABB const& box)
+{
+	float3 size = box.size();
+	return 2.0f * f32(size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+} // namespace
+
+void BoundingVolumeHierarchy::clear()
+{
+	_nodes.clear();
+	_root = c_NullNode;
+	_free_list = c_NullNode;
+	_proxy_count = 0;
+}
+
+BoundingVolumeHierarchy::ProxyId BoundingVolumeHierarchy::insert(Math::AABB const& box, void* user_data)
+{
+	s32 leaf = allocate_node();
+
+	float3 margin = float3(c_AABBMargin, c_AABBMargin, c_AABBMargin);
+	_nodes[leaf].box = { box.min - margin, box.max + margin };
+	_nodes[leaf].user_data = user_data;
+	_nodes[leaf].height = 0;
+
+	insert_leaf(leaf);
+	++_proxy_count;
+	return leaf;
+}
+
+void BoundingVolumeHierarchy::remove(ProxyId proxy)
+{
+	ASSERT(proxy >= 0 && proxy < s32(_nodes.size()) && _nodes[proxy].is_leaf());
+
+	remove_leaf(proxy);
+	free_node(proxy);
+	--_proxy_count;
+}
+
+bool BoundingVolumeHierarchy::move(ProxyId proxy, Math::AABB const& box)
+{
+	ASSERT(proxy >= 0 && proxy < s32(_nodes.size()) && _nodes[proxy].is_leaf());
+
+	if (contains(_nodes[proxy].box, box))
+	{
+		return false;
+	}
+
+	remove_leaf(proxy);
+
+	float3 margin = float3(c_AABBMargin, c_AABBMargin, c_AABBMargin);
+	_nodes[proxy].box = { box.min - margin, box.max + margin };
+
+	insert_leaf(proxy);
+	return true;
+}
+
+void BoundingVolumeHierarchy::query(Math::Frustum const& frustum, std::vector<void*>& result) const
+{
+	JONO_EVENT();
+
+	if (_root == c_NullNode)
+	{
+		return;
+	}
+
+	struct StackEntry
+	{
+		s32 node;
+		u32 mask;
+	};
+
+	std::array<StackEntry, c_MaxQueryDepth> stack;
+	u32 stack_size = 0;
+	stack[stack_size++] = { _root, Math::Frustum::c_AllPlanes };
+
+	while (stack_size > 0)
+	{
+		StackEntry entry = stack[--stack_size];
+		Node const& node = _nodes[entry.node];
+
+		Math::CullResult cull = Math::test_frustum_aabb(frustum, node.box, &entry.mask);
+		if (cull == Math::CullResult::Outside)
+		{
+			continue;
+		}
+
+		if (node.is_leaf())
+		{
+			result.push_back(node.user_data);
+		}
+		else if (cull == Math::CullResult::Inside)
+		{
+			append_leaves(entry.node, result);
+		}
+		else
+		{
+			ASSERT(stack_size + 2 <= c_MaxQueryDepth);
+			stack[stack_size++] = { node.child2, entry.mask };
+			stack[stack_size++] = { node.child1, entry.mask };
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::query(Math::AABB const& box, std::vector<void*>& result) const
+{
+	if (_root == c_NullNode)
+	{
+		return;
+	}
+
+	std::array<s32, c_MaxQueryDepth> stack;
+	u32 stack_size = 0;
+	stack[stack_size++] = _root;
+
+	while (stack_size > 0)
+	{
+		Node const& node = _nodes[stack[--stack_size]];
+		if (!overlaps(node.box, box))
+		{
+			continue;
+		}
+
+		if (node.is_leaf())
+		{
+			result.push_back(node.user_data);
+		}
+		else
+		{
+			ASSERT(stack_size + 2 <= c_MaxQueryDepth);
+			stack[stack_size++] = node.child2;
+			stack[stack_size++] = node.child1;
+		}
+	}
+}
+
+bool BoundingVolumeHierarchy::validate() const
+{
+	if (_root == c_NullNode)
+	{
+		return _proxy_count == 0;
+	}
+
+	if (_nodes[_root].parent_or_next != c_NullNode)
+	{
+		return false;
+	}
+	return validate_node(_root);
+}
+
+s32 BoundingVolumeHierarchy::allocate_node()
+{
+	if (_free_list == c_NullNode)
+	{
+		_nodes.emplace_back();
+		return s32(_nodes.size() - 1);
+	}
+
+	s32 node = _free_list;
+	_free_list = _nodes[node].parent_or_next;
+	_nodes[node] = Node{};
+	return node;
+}
+
+void BoundingVolumeHierarchy::free_node(s32 node)
+{
+	_nodes[node].parent_or_next = _free_list;
+	_nodes[node].user_data = nullptr;
+	_nodes[node].height = -1;
+	_free_list = node;
+}
+
+void BoundingVolumeHierarchy::insert_leaf(s32 leaf)
+{
+	if (_root == c_NullNode)
+	{
+		_root = leaf;
+		_nodes[leaf].parent_or_next = c_NullNode;
+		return;
+	}
+
+	// Find the best sibling by descending into the child with the lowest cost increase
+	Math::AABB const leaf_box = _nodes[leaf].box;
+	s32 index = _root;
+	while (!_nodes[index].is_leaf())
+	{
+		Node const& node = _nodes[index];
+
+		f32 area = surface_area(node.box);
+		f32 combined_area = surface_area(merge(node.box, leaf_box));
+
+		// Cost of creating a new parent for this node and the new leaf
+		f32 cost = 2.0f * combined_area;
+
+		// Minimum cost of pushing the leaf further down the tree
+		f32 inheritance_cost = 2.0f * (combined_area - area);
+
+		auto descend_cost = [&](s32 child)
+		{
+			Node const& c = _nodes[child];
+			f32 merged = surface_area(merge(leaf_box, c.box));
+			return (c.is_leaf() ? merged : merged - surface_area(c.box)) + inheritance_cost;
+		};
+
+		f32 cost1 = descend_cost(node.child1);
+		f32 cost2 = descend_cost(node.child2);
+		if (cost < cost1 && cost < cost2)
+		{
+			break;
+		}
+
+		index = cost1 < cost2 ? node.child1 : node.child2;
+	}
+
+	s32 sibling = index;
+	s32 old_parent = _nodes[sibling].parent_or_next;
+	s32 new_parent = allocate_node();
+
+	Node& parent = _nodes[new_parent];
+	parent.parent_or_next = old_parent;
+	parent.box = merge(leaf_box, _nodes[sibling].box);
+	parent.height = _nodes[sibling].height + 1;
+	parent.child1 = sibling;
+	parent.child2 = leaf;
+
+	if (old_parent != c_NullNode)
+	{
+		if (_nodes[old_parent].child1 == sibling)
+		{
+			_nodes[old_parent].child1 = new_parent;
+		}
+		else
+		{
+			_nodes[old_parent].child2 = new_parent;
+		}
+	}
+	else
+	{
+		_root = new_parent;
+	}
+
+	_nodes[sibling].parent_or_next = new_parent;
+	_nodes[leaf].parent_or_next = new_parent;
+
+	refit_ancestors(new_parent);
+}
+
+void BoundingVolumeHierarchy::remove_leaf(s32 leaf)
+{
+	if (leaf == _root)
+	{
+		_root = c_NullNode;
+		return;
+	}
+
+	// The parent of the leaf is removed as well and replaced by the sibling
+	s32 parent = _nodes[leaf].parent_or_next;
+	s32 grand_parent = _nodes[parent].parent_or_next;
+	s32 sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+	if (grand_parent != c_NullNode)
+	{
+		if (_nodes[grand_parent].child1 == parent)
+		{
+			_nodes[grand_parent].child1 = sibling;
+		}
+		else
+		{
+			_nodes[grand_parent].child2 = sibling;
+		}
+		_nodes[sibling].parent_or_next = grand_parent;
+		free_node(parent);
+
+		refit_ancestors(grand_parent);
+	}
+	else
+	{
+		_root = sibling;
+		_nodes[sibling].parent_or_next = c_NullNode;
+		free_node(parent);
+	}
+}
+
+void BoundingVolumeHierarchy::refit_ancestors(s32 index)
+{
+	while (index != c_NullNode)
+	{
+		index = balance(index);
+
+		Node& node = _nodes[index];
+		Node const& child1 = _nodes[node.child1];
+		Node const& child2 = _nodes[node.child2];
+		node.height = 1 + std::max(child1.height, child2.height);
+		node.box = merge(child1.box, child2.box);
+
+		index = node.parent_or_next;
+	}
+}
+
+s32 BoundingVolumeHierarchy::balance(s32 index)
+{
+	Node const& node = _nodes[index];
+	if (node.is_leaf() || node.height < 2)
+	{
+		return index;
+	}
+
+	s32 diff = _nodes[node.child2].height - _nodes[node.child1].height;
+	if (diff > 1)
+	{
+		return rotate_up(index, false);
+	}
+
+	if (diff < -1)
+	{
+		return rotate_up(index, true);
+	}
+
+	return index;
+}
+
+s32 BoundingVolumeHierarchy::rotate_up(s32 ia, bool rotate_child1)
+{
+	Node& a = _nodes[ia];
+	s32 const ihigh = rotate_child1 ? a.child1 : a.child2;
+	s32 const ilow = rotate_child1 ? a.child2 : a.child1;
+	Node& high = _nodes[ihigh];
+	Node const& low = _nodes[ilow];
+
+	// Of the two grand children the taller one stays below 'high', the other one moves into the slot 'high' leaves behind in 'a'
+	s32 const ikeep = _nodes[high.child1].height > _nodes[high.child2].height ? high.child1 : high.child2;
+	s32 const imove = ikeep == high.child1 ? high.child2 : high.child1;
+	Node const& keep = _nodes[ikeep];
+	Node& move = _nodes[imove];
+
+	// 'high' takes the place of 'a' in the tree
+	high.parent_or_next = a.parent_or_next;
+	if (high.parent_or_next != c_NullNode)
+	{
+		Node& parent = _nodes[high.parent_or_next];
+		if (parent.child1 == ia)
+		{
+			parent.child1 = ihigh;
+		}
+		else
+		{
+			parent.child2 = ihigh;
+		}
+	}
+	else
+	{
+		_root = ihigh;
+	}
+
+	high.child1 = ia;
+	high.child2 = ikeep;
+	a.parent_or_next = ihigh;
+
+	if (rotate_child1)
+	{
+		a.child1 = imove;
+	}
+	else
+	{
+		a.child2 = imove;
+	}
+	move.parent_or_next = ia;
+
+	a.box = merge(low.box, move.box);
+	a.height = 1 + std::max(low.height, move.height);
+	high.box = merge(a.box, keep.box);
+	high.height = 1 + std::max(a.height, keep.height);
+	return ihigh;
+}
+
+void BoundingVolumeHierarchy::append_leaves(s32 root, std::vector<void*>& result) const
+{
+	std::array<s32, c_MaxQueryDepth> stack;
+	u32 stack_size = 0;
+	stack[stack_size++] = root;
+
+	while (stack_size > 0)
+	{
+		Node const& node = _nodes[stack[--stack_size]];
+		if (node.is_leaf())
+		{
+			result.push_back(node.user_data);
+		}
+		else
+		{
+			ASSERT(stack_size + 2 <= c_MaxQueryDepth);
+			stack[stack_size++] = node.child2;
+			stack[stack_size++] = node.child1;
+		}
+	}
+}
+
+bool BoundingVolumeHierarchy::validate_node(s32 index) const
+{
+	Node const& node = _nodes[index];
+	if (node.is_leaf())
+	{
+		return node.height == 0 && node.child2 == c_NullNode;
+	}
+
+	Node const& child1 = _nodes[node.child1];
+	Node const& child2 = _nodes[node.child2];
+	if (child1.parent_or_next != index || child2.parent_or_next != index)
+	{
+		return false;
+	}
+
+	if (node.height != 1 + std::max(child1.height, child2.height))
+	{
+		return false;
+	}
+
+	if (!contains(node.box, child1.box) || !contains(node.box, child2.box))
+	{
+		return false;
+	}
+
+	return validate_node(node.child1) && validate_node(node.child2);
+}
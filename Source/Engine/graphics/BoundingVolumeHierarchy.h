@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Core/Math.h"
+
+// Dynamic AABB tree used to accelerate spatial queries on the render world.
+//	Leaves store a 'fat' bounding box that is slightly larger than the object, small movements only require a containment check.
+//	Once an object leaves its fat box the leaf is removed and re-inserted, the tree is kept balanced with AVL style rotations.
+//	Internal nodes always have two children, the tree for N leaves contains 2N - 1 nodes.
+class ENGINE_API BoundingVolumeHierarchy final
+{
+public:
+	using ProxyId = s32;
+	static constexpr ProxyId c_InvalidProxy = -1;
+
+	// Margin added to every side of the leaf boxes
+	static constexpr f32 c_AABBMargin = 0.1f;
+
+	BoundingVolumeHierarchy() = default;
+	~BoundingVolumeHierarchy() = default;
+
+	BoundingVolumeHierarchy(BoundingVolumeHierarchy const&) = default;
+	BoundingVolumeHierarchy& operator=(BoundingVolumeHierarchy const&) = default;
+
+	void clear();
+
+	// Inserts a new leaf and returns the proxy used to refer to it
+	ProxyId insert(Math::AABB const& box, void* user_data);
+	void remove(ProxyId proxy);
+
+	// Updates the bounds of a leaf. Returns true when the leaf had to be re-inserted, false when the fat box still contains the new bounds.
+	bool move(ProxyId proxy, Math::AABB const& box);
+
+	void* get_user_data(ProxyId proxy) const { return _nodes[proxy].user_data; }
+	void set_user_data(ProxyId proxy, void* user_data) { _nodes[proxy].user_data = user_data; }
+
+	Math::AABB const& get_fat_aabb(ProxyId proxy) const { return _nodes[proxy].box; }
+
+	// Appends the user data of every leaf that intersects the frustum.
+	// Subtrees that are fully inside the frustum are appended without testing the individual leaves.
+	void query(Math::Frustum const& frustum, std::vector<void*>& result) const;
+
+	// Appends the user data of every leaf that overlaps the box
+	void query(Math::AABB const& box, std::vector<void*>& result) const;
+
+	u32 get_proxy_count() const { return _proxy_count; }
+	u32 get_height() const { return _root == c_InvalidProxy ? 0 : u32(_nodes[_root].height); }
+
+	// Validates the parent links, heights and bounds of the whole tree
+	bool validate() const;
+
+private:
+	static constexpr s32 c_NullNode = -1;
+
+	// Maximum depth of a query, the balanced tree would need billions of leaves to exceed this
+	static constexpr u32 c_MaxQueryDepth = 256;
+
+	struct Node
+	{
+		bool is_leaf() const { return child1 == c_NullNode; }
+
+		Math::AABB box;
+		void* user_data = nullptr;
+
+		// Links to the parent while in the tree, to the next free node while on the free list
+		s32 parent_or_next = c_NullNode;
+		s32 child1 = c_NullNode;
+		s32 child2 = c_NullNode;
+
+		// Leaves have a height of 0, free nodes -1
+		s32 height = -1;
+	};
+
+	s32 allocate_node();
+	void free_node(s32 node);
+
+	void insert_leaf(s32 leaf);
+	void remove_leaf(s32 leaf);
+
+	// Walks from 'node' up to the root, rebalancing and refitting every ancestor
+	void refit_ancestors(s32 node);
+	s32 balance(s32 node);
+
+	// Swaps a node with its taller child, returns the index of the node that took its place
+	s32 rotate_up(s32 node, bool rotate_child1);
+
+	void append_leaves(s32 node, std::vector<void*>& result) const;
+	bool validate_node(s32 node) const;
+
+	std::vector<Node> _nodes;
+	s32 _root = c_NullNode;
+	s32 _free_list = c_NullNode;
+	u32 _proxy_count = 0;
+};
@@ -0,0 +1,161 @@
+#include "engine.pch.h"
+#include "CommandList.h"
+
+namespace Graphics
+{
+
+void CommandList::reset()
+{
+	_commands.clear();
+	n_state_changes = 0;
+	n_state_changes_skipped = 0;
+}
+
+void CommandList::set_index_buffer(GraphicsResourceHandle buffer, u32 stride)
+{
+	Command& cmd = _commands.emplace_back();
+	cmd.type = CommandType::SetIndexBuffer;
+	cmd.resource = buffer;
+	cmd.stride = stride;
+}
+
+void CommandList::set_vertex_buffer(GraphicsResourceHandle buffer, u32 stride)
+{
+	Command& cmd = _commands.emplace_back();
+	cmd.type = CommandType::SetVertexBuffer;
+	cmd.resource = buffer;
+	cmd.stride = stride;
+}
+
+void CommandList::set_material(MaterialInstance const* material, GraphicsResourceHandle layout, VertexLayoutFlags flags)
+{
+	Command& cmd = _commands.emplace_back();
+	cmd.type = CommandType::SetMaterial;
+	cmd.resource = layout;
+	cmd.material = material;
+	cmd.flags = flags;
+}
+
+void CommandList::draw_indexed_instanced(u32 index_count, u32 instance_count, u32 first_index, u32 first_vertex, u32 first_instance)
+{
+	Command& cmd = _commands.emplace_back();
+	cmd.type = CommandType::DrawIndexedInstanced;
+	cmd.index_count = index_count;
+	cmd.instance_count = instance_count;
+	cmd.first_index = first_index;
+	cmd.first_vertex = first_vertex;
+	cmd.first_instance = first_instance;
+}
+
+void CommandList::execute(ICommandBackend& backend) const
+{
+	for (Command const& cmd : _commands)
+	{
+		switch (cmd.type)
+		{
+			case CommandType::SetIndexBuffer:
+				backend.set_index_buffer(cmd.resource, cmd.stride);
+				break;
+			case CommandType::SetVertexBuffer:
+				backend.set_vertex_buffer(cmd.resource, cmd.stride);
+				break;
+			case CommandType::SetMaterial:
+				backend.set_material(cmd.material, cmd.resource, cmd.flags);
+				break;
+			case CommandType::DrawIndexedInstanced:
+				backend.draw_indexed_instanced(cmd.index_count, cmd.instance_count, cmd.first_index, cmd.first_vertex, cmd.first_instance);
+				break;
+			default:
+				FAILMSG("Unknown command type {}", u32(cmd.type));
+				break;
+		}
+	}
+}
+
+void build_draw_batches(std::vector<DrawCall> const& draws, std::vector<DrawSortItem> const& items, bool instancing, std::vector<DrawBatch>& batches)
+{
+	JONO_EVENT();
+
+	batches.clear();
+
+	u32 const n_items = u32(items.size());
+	for (u32 first = 0; first < n_items;)
+	{
+		DrawCall const& dc = draws[items[first].index];
+
+		u32 end = first + 1;
+		if (instancing)
+		{
+			while (end < n_items)
+			{
+				DrawCall const& other = draws[items[end].index];
+				if (other._material != dc._material || other._input_layout != dc._input_layout ||
+						other._vertex_buffer != dc._vertex_buffer || other._index_buffer != dc._index_buffer ||
+						other._first_index != dc._first_index || other._index_count != dc._index_count || other._first_vertex != dc._first_vertex)
+				{
+					break;
+				}
+				++end;
+			}
+		}
+
+		batches.push_back({ first, end - first });
+		first = end;
+	}
+}
+
+void record_draw_batches(CommandList& cmds, std::vector<DrawCall> const& draws, std::vector<DrawSortItem> const& items, DrawBatch const* batches, u32 count)
+{
+	GraphicsResourceHandle prev_index = GraphicsResourceHandle::Invalid();
+	GraphicsResourceHandle prev_vertex = GraphicsResourceHandle::Invalid();
+	u32 prev_vertex_stride = 0;
+	GraphicsResourceHandle prev_layout = GraphicsResourceHandle::Invalid();
+	MaterialInstance const* prev_material = nullptr;
+
+	for (u32 i = 0; i < count; ++i)
+	{
+		DrawBatch const& batch = batches[i];
+		DrawCall const& dc = draws[items[batch.first].index];
+
+		if (prev_index != dc._index_buffer)
+		{
+			cmds.set_index_buffer(dc._index_buffer, dc._index_stride);
+			prev_index = dc._index_buffer;
+			++cmds.n_state_changes;
+		}
+		else
+		{
+			++cmds.n_state_changes_skipped;
+		}
+
+		// Meshes of a model share the buffer but can have different vertex formats
+		if (prev_vertex != dc._vertex_buffer || prev_vertex_stride != dc._vertex_stride)
+		{
+			cmds.set_vertex_buffer(dc._vertex_buffer, dc._vertex_stride);
+			prev_vertex = dc._vertex_buffer;
+			prev_vertex_stride = dc._vertex_stride;
+			++cmds.n_state_changes;
+		}
+		else
+		{
+			++cmds.n_state_changes_skipped;
+		}
+
+		// The layout flags only depend on the layout so they don't need to be compared
+		if (prev_material != dc._material || prev_layout != dc._input_layout)
+		{
+			cmds.set_material(dc._material, dc._input_layout, dc._input_layout_flags);
+			prev_material = dc._material;
+			prev_layout = dc._input_layout;
+			++cmds.n_state_changes;
+		}
+		else
+		{
+			++cmds.n_state_changes_skipped;
+		}
+
+		cmds.draw_indexed_instanced(u32(dc._index_count), batch.count, u32(dc._first_index), u32(dc._first_vertex), batch.first);
+	}
+}
+
+} // namespace Graphics
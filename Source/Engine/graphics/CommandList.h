@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Graphics/GraphicsResourceHandle.h"
+#include "Graphics/VertexLayout.h"
+
+#include "DrawSort.h"
+
+class Model;
+class MaterialInstance;
+
+namespace Graphics
+{
+
+// information that is needed to represent 1 draw call
+struct DrawCall
+{
+    float4x4 _transform;
+
+    // Mesh index buffer, 16 or 32 bit indices
+    GraphicsResourceHandle _index_buffer;
+    u32 _index_stride;
+
+    // Vertex buffers
+    GraphicsResourceHandle _vertex_buffer;
+    u32 _vertex_stride;
+
+    VertexLayoutFlags _input_layout_flags;
+    GraphicsResourceHandle _input_layout;
+
+    // First vertex offset this mesh starts at in the vertex buffer
+    u64 _first_vertex;
+
+    // First index location offset this mesh starts at in the index buffer
+    u64 _first_index;
+
+    // The amount of indices associated with this mesh
+    u64 _index_count;
+
+    // Material (e.g. shaders, textures, constant buffer, input layouts)
+    MaterialInstance const* _material;
+
+	#ifdef _DEBUG
+    Model const* _model;
+	#endif
+};
+
+// Range of sorted draws that share their state and mesh, submitted as a single instanced draw.
+// 'first' indexes the sorted draws and doubles as the offset into the per pass instance data.
+struct DrawBatch
+{
+	u32 first;
+	u32 count;
+};
+
+// Executes recorded commands. The renderer implements this on top of the render context.
+class ICommandBackend
+{
+public:
+	virtual ~ICommandBackend() = default;
+
+	virtual void set_index_buffer(GraphicsResourceHandle buffer, u32 stride) = 0;
+	virtual void set_vertex_buffer(GraphicsResourceHandle buffer, u32 stride) = 0;
+	virtual void set_material(MaterialInstance const* material, GraphicsResourceHandle layout, VertexLayoutFlags flags) = 0;
+	virtual void draw_indexed_instanced(u32 index_count, u32 instance_count, u32 first_index, u32 first_vertex, u32 first_instance) = 0;
+};
+
+// Backend that only counts the commands, used to exercise command recording without a device
+class NullCommandBackend final : public ICommandBackend
+{
+public:
+	void set_index_buffer(GraphicsResourceHandle, u32) override { ++n_index_buffers; }
+	void set_vertex_buffer(GraphicsResourceHandle, u32) override { ++n_vertex_buffers; }
+	void set_material(MaterialInstance const*, GraphicsResourceHandle, VertexLayoutFlags) override { ++n_materials; }
+	void draw_indexed_instanced(u32 index_count, u32 instance_count, u32, u32, u32) override
+	{
+		++n_draws;
+		n_instances += instance_count;
+		n_primitives += (index_count / 3) * instance_count;
+	}
+
+	u32 n_index_buffers = 0;
+	u32 n_vertex_buffers = 0;
+	u32 n_materials = 0;
+	u32 n_draws = 0;
+	u32 n_instances = 0;
+	u32 n_primitives = 0;
+};
+
+// Backend agnostic list of draw commands.
+//	Lists don't touch the render context while recording so several of them can be recorded in parallel and replayed in order afterwards.
+class CommandList final
+{
+public:
+	CommandList() = default;
+	~CommandList() = default;
+
+	void reset();
+
+	void set_index_buffer(GraphicsResourceHandle buffer, u32 stride);
+	void set_vertex_buffer(GraphicsResourceHandle buffer, u32 stride);
+	void set_material(MaterialInstance const* material, GraphicsResourceHandle layout, VertexLayoutFlags flags);
+	void draw_indexed_instanced(u32 index_count, u32 instance_count, u32 first_index, u32 first_vertex, u32 first_instance);
+
+	void execute(ICommandBackend& backend) const;
+
+	u32 get_command_count() const { return u32(_commands.size()); }
+
+	// Binds recorded and binds dropped because the list already had the same state bound
+	u32 n_state_changes = 0;
+	u32 n_state_changes_skipped = 0;
+
+private:
+	enum class CommandType : u8
+	{
+		SetIndexBuffer,
+		SetVertexBuffer,
+		SetMaterial,
+		DrawIndexedInstanced
+	};
+
+	struct Command
+	{
+		CommandType type;
+
+		// Buffer or input layout
+		GraphicsResourceHandle resource;
+		MaterialInstance const* material;
+		VertexLayoutFlags flags;
+
+		u32 stride;
+		u32 index_count;
+		u32 instance_count;
+		u32 first_index;
+		u32 first_vertex;
+		u32 first_instance;
+	};
+
+	std::vector<Command> _commands;
+};
+
+// Merges consecutive sorted draws with the same state and mesh into batches. Without instancing every draw gets its own batch.
+void build_draw_batches(std::vector<DrawCall> const& draws, std::vector<DrawSortItem> const& items, bool instancing, std::vector<DrawBatch>& batches);
+
+// Records 'count' batches into the list, state that the list already has bound is not recorded again
+void record_draw_batches(CommandList& cmds, std::vector<DrawCall> const& draws, std::vector<DrawSortItem> const& items, DrawBatch const* batches, u32 count);
+
+} // namespace Graphics
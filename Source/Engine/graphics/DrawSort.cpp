@@ -0,0 +1,107 @@
+#include "engine.pch.h"
+#include "DrawSort.h"
+
+namespace Graphics
+{
+
+namespace
+{
+
+u64 hash_pointer(void const* ptr, u32 bits)
+{
+	// Finalizer of murmur3, spreads the aligned pointer bits over the whole word
+	u64 v = u64(uintptr_t(ptr));
+	v ^= v >> 33;
+	v *= 0xff51afd7ed558ccdull;
+	v ^= v >> 33;
+	return v >> (64 - bits);
+}
+
+u64 mask_bits(u64 value, u32 bits)
+{
+	return value & ((u64(1) << bits) - 1);
+}
+
+} // namespace
+
+u64 DrawSortKey::make(u32 pass, void const* shader, void const* material, u32 layout, u32 buffer, u32 mesh, f32 depth)
+{
+	u64 key = mask_bits(pass, c_PassBits);
+	key = (key << c_ShaderBits) | hash_pointer(shader, c_ShaderBits);
+	key = (key << c_MaterialBits) | hash_pointer(material, c_MaterialBits);
+	key = (key << c_LayoutBits) | mask_bits(layout, c_LayoutBits);
+	key = (key << c_BufferBits) | mask_bits(buffer, c_BufferBits);
+	key = (key << c_MeshBits) | mask_bits(mesh, c_MeshBits);
+	key = (key << c_DepthBits) | quantize_depth(depth);
+	return key;
+}
+
+u32 DrawSortKey::quantize_depth(f32 depth)
+{
+	// The bits of a positive float increase monotonically with its value, the top bits give a logarithmic distribution without a depth range
+	depth = std::max(depth, 0.0f);
+
+	u32 bits;
+	memcpy(&bits, &depth, sizeof(bits));
+	return bits >> (32 - c_DepthBits);
+}
+
+void radix_sort(std::vector<DrawSortItem>& items, std::vector<DrawSortItem>& scratch)
+{
+	JONO_EVENT();
+
+	size_t const count = items.size();
+	if (count < 2)
+	{
+		return;
+	}
+	scratch.resize(count);
+
+	constexpr u32 c_Passes = 8;
+	constexpr u32 c_Buckets = 256;
+
+	// Build the histograms of all passes in a single read
+	u32 histograms[c_Passes][c_Buckets] = {};
+	for (DrawSortItem const& item : items)
+	{
+		for (u32 pass = 0; pass < c_Passes; ++pass)
+		{
+			++histograms[pass][(item.key >> (pass * 8)) & 0xFF];
+		}
+	}
+
+	DrawSortItem* src = items.data();
+	DrawSortItem* dst = scratch.data();
+	for (u32 pass = 0; pass < c_Passes; ++pass)
+	{
+		u32* histogram = histograms[pass];
+
+		u32 const first_bucket = u32((src[0].key >> (pass * 8)) & 0xFF);
+		if (histogram[first_bucket] == count)
+		{
+			continue;
+		}
+
+		u32 offset = 0;
+		for (u32 bucket = 0; bucket < c_Buckets; ++bucket)
+		{
+			u32 n = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += n;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			u32 bucket = u32((src[i].key >> (pass * 8)) & 0xFF);
+			dst[histogram[bucket]++] = src[i];
+		}
+		std::swap(src, dst);
+	}
+
+	if (src != items.data())
+	{
+		items.swap(scratch);
+	}
+}
+
+} // namespace Graphics
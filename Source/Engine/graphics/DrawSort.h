@@ -0,0 +1,36 @@
+#pragma once
+
+namespace Graphics
+{
+
+// 64 bit draw sort key, sorting on the key groups draws that share state. From most to least significant:
+//	pass (4) | vertex shader (12) | material (14) | input layout (6) | vertex buffer (10) | mesh (8) | depth (10)
+// Shader and material fields are hashes, a collision only degrades the grouping. Redundant binds are always detected by comparing the actual state.
+// Keeping the mesh (and its LOD) above depth makes repeated meshes adjacent so they can be merged into a single instanced draw.
+struct DrawSortKey
+{
+	static constexpr u32 c_PassBits = 4;
+	static constexpr u32 c_ShaderBits = 12;
+	static constexpr u32 c_MaterialBits = 14;
+	static constexpr u32 c_LayoutBits = 6;
+	static constexpr u32 c_BufferBits = 10;
+	static constexpr u32 c_MeshBits = 8;
+	static constexpr u32 c_DepthBits = 10;
+	static_assert(c_PassBits + c_ShaderBits + c_MaterialBits + c_LayoutBits + c_BufferBits + c_MeshBits + c_DepthBits == 64);
+
+	static u64 make(u32 pass, void const* shader, void const* material, u32 layout, u32 buffer, u32 mesh, f32 depth);
+
+	// Monotonic quantization of a view space depth, closer draws get smaller values so opaque geometry is drawn front to back
+	static u32 quantize_depth(f32 depth);
+};
+
+struct DrawSortItem
+{
+	u64 key;
+	u32 index;
+};
+
+// Stable LSD radix sort on the 64 bit key, 8 bits per pass. Passes where every item falls in the same bucket are skipped.
+void radix_sort(std::vector<DrawSortItem>& items, std::vector<DrawSortItem>& scratch);
+
+} // namespace Graphics
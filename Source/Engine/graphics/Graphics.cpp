@@ -33,6 +33,12 @@ bool s_EnableCSM0 = true;
 bool s_EnableCSM1 = true;
 bool s_EnableCSM2 = true;
 bool s_EnableCSM3 = true;
+bool s_EnableInstancing = true;
+bool s_EnableLods = true;
+
+// Screen space error in pixels a mesh LOD may introduce, shadow passes scale it by the bias as they tolerate coarser geometry
+f32 s_LodErrorThreshold = 1.0f;
+f32 s_ShadowLodBias = 4.0f;
 
 void init()
 {
@@ -76,6 +76,10 @@ extern bool s_EnableCSM0;
 extern bool s_EnableCSM1;
 extern bool s_EnableCSM2;
 extern bool s_EnableCSM3;
+extern bool s_EnableInstancing;
+extern bool s_EnableLods;
+extern f32 s_LodErrorThreshold;
+extern f32 s_ShadowLodBias;
 
 
 struct DeviceContext;
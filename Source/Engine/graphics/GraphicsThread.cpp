@@ -59,6 +59,11 @@ void GraphicsThread::Run()
 	{
 		// Wait until the engine has signalled a new frame is ready
 		engine->m_SignalMainToGraphics.acquire();
+		if (!IsRunning())
+		{
+			break;
+		}
+
 		++_frame;
 		OPTICK_FRAME_EVENT(Optick::FrameType::GPU);
 		OPTICK_TAG("Frame", _frame);
@@ -70,6 +75,13 @@ void GraphicsThread::Run()
 	m_Running = false;
 }
 
+void GraphicsThread::SetFramesInFlight(u32 frames)
+{
+	ASSERT(m_SyncFrame == 0);
+	ASSERTMSG(frames >= 1 && frames <= c_MaxFramesInFlight, "Frames in flight needs to be between 1 and {}!", c_MaxFramesInFlight);
+	m_FramesInFlight = std::clamp<u32>(frames, 1, c_MaxFramesInFlight);
+}
+
 void GraphicsThread::Sync()
 {
 	if (!m_VertexShader)
@@ -88,39 +100,65 @@ void GraphicsThread::Sync()
 	GameEngine* engine = context->m_Engine;
 	ASSERT(std::this_thread::get_id() == GameEngine::s_MainThreadID);
 
-	m_FrameData.m_VSyncEnabled = engine->m_VSyncEnabled;
-	m_FrameData.m_RecreateSwapchain = engine->m_RecreateSwapchainRequested;
-	m_FrameData.m_RenderWorld = *engine->get_render_world();
-	m_FrameData.m_EngineCfg = engine->m_EngineCfg;
-	m_FrameData.m_DebugPhysicsRendering = engine->m_DebugPhysicsRendering;
+	// The main thread acquired a free slot, the graphics thread finished the frame that used it 'm_FramesInFlight' frames ago
+	FrameData& frame = m_Frames[m_SyncFrame % m_FramesInFlight];
+	frame.m_InputSampleTime = engine->m_InputSampleTime;
+
+	frame.m_VSyncEnabled = engine->m_VSyncEnabled;
+	frame.m_RecreateSwapchain = engine->m_RecreateSwapchainRequested;
 
-	m_FrameData.m_ViewportSize = uint2(engine->GetViewportSize().x, engine->GetViewportSize().y);
-	m_FrameData.m_WindowSize = uint2(engine->GetWindowSize().x, engine->GetWindowSize().y);
+	// Only the changes since the last sync are applied to the render side copy of the world.
+	//	Each slot has its own copy which was last synced 'm_FramesInFlight' frames ago, it replays the deltas of every frame since then.
+	RenderWorldRef game_world = engine->get_render_world();
+	RenderWorldDelta& delta = m_RenderWorldDeltas[m_SyncFrame % m_FramesInFlight];
+	game_world->flush_changes(delta);
+	OPTICK_TAG("RenderWorldChanges", u32(delta.get_change_count()));
+
+	u64 first_frame = m_SyncFrame + 1 >= m_FramesInFlight ? m_SyncFrame + 1 - m_FramesInFlight : 0;
+	for (u64 i = first_frame; i <= m_SyncFrame; ++i)
+	{
+		frame.m_RenderWorld.apply_changes(*game_world, m_RenderWorldDeltas[i % m_FramesInFlight]);
+	}
+	frame.m_RenderWorld.update_bounds();
+
+	frame.m_EngineCfg = engine->m_EngineCfg;
+	frame.m_DebugPhysicsRendering = engine->m_DebugPhysicsRendering;
+
+	frame.m_ViewportSize = uint2(engine->GetViewportSize().x, engine->GetViewportSize().y);
+	frame.m_WindowSize = uint2(engine->GetWindowSize().x, engine->GetWindowSize().y);
 
 	if(engine->m_D2DRenderContext.IsValid())
 	{
-		m_FrameData.m_Render2DData.m_DrawCommands = engine->m_D2DRenderContext->GetCommands();
-		m_FrameData.m_Render2DData.m_TotalIndices = engine->m_D2DRenderContext->m_TotalIndices;
-		m_FrameData.m_Render2DData.m_TotalVertices = engine->m_D2DRenderContext->m_TotalVertices;
-		m_FrameData.m_Render2DData.m_ProjectionMatrix = engine->m_D2DRenderContext->m_ProjectionMatrix;
+		frame.m_Render2DData.m_DrawCommands = engine->m_D2DRenderContext->GetCommands();
+		frame.m_Render2DData.m_TotalIndices = engine->m_D2DRenderContext->m_TotalIndices;
+		frame.m_Render2DData.m_TotalVertices = engine->m_D2DRenderContext->m_TotalVertices;
+		frame.m_Render2DData.m_ProjectionMatrix = engine->m_D2DRenderContext->m_ProjectionMatrix;
 	}
 
 	// #TODO: Fix this hacky stuff.
 	// The reason it's hacky is because of multithreading. We copy main thread imgui commands so when we resize the swapchain 
 	// we can no longer rely on those. For swapchain resizes we should somehow create a sync point before the main thread does a frame.
-	if(m_FrameData.m_RecreateSwapchain)
+	if(frame.m_RecreateSwapchain)
 	{
+		// Resizing requires the graphics thread to be idle, wait until the other frames in flight have been presented
+		for (u32 i = 1; i < m_FramesInFlight; ++i)
+		{
+			engine->m_SignalGraphicsToMain.acquire();
+		}
+
         Graphics::Renderer* renderer = GetGlobalContext()->m_Engine->m_Renderer.get();
         renderer->ResizeSwapchain(engine->m_WindowWidth, engine->m_WindowHeight);
-		m_FrameData.m_RecreateSwapchain = false;
-        ImDrawData* gtDrawData = &m_FrameData.m_DrawData;
+
+		engine->m_SignalGraphicsToMain.release(m_FramesInFlight - 1);
+		frame.m_RecreateSwapchain = false;
+        ImDrawData* gtDrawData = &frame.m_DrawData;
 		gtDrawData->Clear();
 	}
 	else
     {
         // Copy over ImDrawData for next frame
         ImDrawData* drawData = ImGui::GetDrawData();
-        ImDrawData* gtDrawData = &m_FrameData.m_DrawData;
+        ImDrawData* gtDrawData = &frame.m_DrawData;
         if (gtDrawData->CmdLists != nullptr)
         {
             for (int i = 0; i < gtDrawData->CmdListsCount; i++)
@@ -140,6 +178,8 @@ void GraphicsThread::Sync()
             }
         }
     }
+
+	++m_SyncFrame;
 }
 
 void GraphicsThread::DoFrame()
@@ -148,13 +188,12 @@ void GraphicsThread::DoFrame()
 
 	GameEngine* engine = GetGlobalContext()->m_Engine;
 	Graphics::Renderer* renderer = GetGlobalContext()->m_Engine->m_Renderer.get();
-	RenderWorld& world = m_FrameData.m_RenderWorld;
-
+	FrameData const& frame = GetRenderFrame();
 
 	RenderContext& ctx = GetRI()->BeginContext();
     Perf::begin_frame(ctx);
 
-	if (m_FrameData.m_RecreateSwapchain)
+	if (frame.m_RecreateSwapchain)
 	{
 		renderer->ResizeSwapchain(engine->m_WindowWidth, engine->m_WindowHeight);
 	}
@@ -162,6 +201,8 @@ void GraphicsThread::DoFrame()
 	this->Render(ctx);
 	this->Present(ctx);
 
+	// Hands the slot back to the main thread
+	++m_RenderFrame;
 	engine->m_SignalGraphicsToMain.release();
 }
 
@@ -170,7 +211,7 @@ void GraphicsThread::Present(RenderContext& ctx)
     RenderInterface* ri = GetRI();
 	GameEngine* engine = GetGlobalContext()->m_Engine;
 	Graphics::Renderer* renderer = GetGlobalContext()->m_Engine->m_Renderer.get();
-	RenderWorld& world = m_FrameData.m_RenderWorld;
+	FrameData const& frame = GetRenderFrame();
 
 	PrecisionTimer present_timer{};
 	present_timer.reset();
@@ -184,13 +225,13 @@ void GraphicsThread::Present(RenderContext& ctx)
 	// Present,
 	GPU_MARKER(&ctx, "DrawEnd");
 	u32 flags = 0;
-	if (!m_FrameData.m_VSyncEnabled)
+	if (!frame.m_VSyncEnabled)
 	{
 		flags |= DXGI_PRESENT_ALLOW_TEARING;
 	}
     ctx.SetTarget(GraphicsResourceHandle::Invalid(), GraphicsResourceHandle::Invalid());
 
-	ri->Present(d3d_swapchain, m_FrameData.m_VSyncEnabled ? 1 : 0, flags);
+	ri->Present(d3d_swapchain, frame.m_VSyncEnabled ? 1 : 0, flags);
 
 	auto& timer = engine->m_GpuTimings[idx];
 	timer.end(ctx);
@@ -201,13 +242,21 @@ void GraphicsThread::Present(RenderContext& ctx)
 
 	present_timer.stop();
 	engine->m_MetricsOverlay->UpdateTimer(MetricsOverlay::Timer::PresentCPU, present_timer.get_delta_time() * 1000.0);
+
+	// Time between sampling the input for this frame on the main thread and handing it to the swapchain
+	LARGE_INTEGER now, freq;
+	::QueryPerformanceCounter(&now);
+	::QueryPerformanceFrequency(&freq);
+	f64 latency = f64(now.QuadPart - frame.m_InputSampleTime) / f64(freq.QuadPart);
+	engine->m_MetricsOverlay->UpdateTimer(MetricsOverlay::Timer::InputLatency, latency * 1000.0);
 }
 
 void GraphicsThread::Render(RenderContext& ctx)
 {
 	// JonS: When recreating swapchain imgui is a bit broken at the moment. Therefore skip imgui rendering till next frame
-	bool doImgui = !m_FrameData.m_RecreateSwapchain;
-	RenderWorld& world = m_FrameData.m_RenderWorld;
+	FrameData& frame = GetRenderFrame();
+	bool doImgui = !frame.m_RecreateSwapchain;
+	RenderWorld& world = frame.m_RenderWorld;
 
 	GameEngine* engine = GetGlobalContext()->m_Engine;
 	Graphics::Renderer* renderer = engine->m_Renderer.get();
@@ -217,6 +266,7 @@ void GraphicsThread::Render(RenderContext& ctx)
 
 	// Process the previous frame gpu timers here to allow our update thread to run first
 	// #TODO: Move to graphics thread
+#ifndef USE_NULL_RHI
 	if (Perf::can_collect())
 	{
 		JONO_EVENT("PerfCollect");
@@ -237,6 +287,7 @@ void GraphicsThread::Render(RenderContext& ctx)
 			engine->m_MetricsOverlay->UpdateTimer(MetricsOverlay::Timer::RenderCPU, (float)(cpuTime * 1000.0));
 		}
 	}
+#endif
 
 	size_t idx = Perf::get_current_frame_resource_index();
 
@@ -247,7 +298,7 @@ void GraphicsThread::Render(RenderContext& ctx)
 	renderer->BeginFrame(ctx);
 
 	// Render 3D before 2D
-	EngineCfg const& cfg = m_FrameData.m_EngineCfg;
+	EngineCfg const& cfg = frame.m_EngineCfg;
 	if (cfg.m_UseD3D)
 	{
 		renderer->PreRender(ctx, world);
@@ -297,9 +348,10 @@ void GraphicsThread::RenderD2D(RenderContext& ctx)
 	// 1. Collect all the draw commands in buffers and capture the required data
 	// 2. during end_paint 'flush' draw commands and create required vertex buffers
 	// 3. Execute each draw command binding the right buffers and views
-	uint2 size = m_FrameData.m_ViewportSize;
+	FrameData& frame = GetRenderFrame();
+	uint2 size = frame.m_ViewportSize;
 
-	FrameData::Render2DData& renderData = m_FrameData.m_Render2DData;
+	FrameData::Render2DData& renderData = frame.m_Render2DData;
 	std::vector<Graphics::DrawCmd>& commands =renderData.m_DrawCommands;
 
 	// Execute all the 2D draw commands 
@@ -312,23 +364,26 @@ void GraphicsThread::RenderD2D(RenderContext& ctx)
 			std::vector<SimpleVertex2D> vertices;
 			std::vector<u32> indices;
 
-			vertices.reserve(renderData.m_TotalVertices);
-			indices.reserve(renderData.m_TotalIndices);
-
-			u32 vtx_offset = 0;
-			for (DrawCmd& cmd : commands)
+			// Only the staging arrays come from the frame arena, the RHI calls below can grow persistent state
 			{
-				cmd.m_IdxOffset = u32(indices.size());
-				cmd.m_VertexOffset = u32(vertices.size());
+				MEMORY_TAG(MemoryCategory::Frame);
+				vertices.reserve(renderData.m_TotalVertices);
+				indices.reserve(renderData.m_TotalIndices);
 
-				for (SimpleVertex2D const& vert : cmd.m_VertexBuffer)
+				for (DrawCmd& cmd : commands)
 				{
-					vertices.push_back(vert);
-				}
+					cmd.m_IdxOffset = u32(indices.size());
+					cmd.m_VertexOffset = u32(vertices.size());
 
-				for (u32 const& index : cmd.m_IdxBuffer)
-				{
-					indices.push_back(index);
+					for (SimpleVertex2D const& vert : cmd.m_VertexBuffer)
+					{
+						vertices.push_back(vert);
+					}
+
+					for (u32 const& index : cmd.m_IdxBuffer)
+					{
+						indices.push_back(index);
+					}
 				}
 			}
 
@@ -20,6 +20,9 @@ class GraphicsThread : public Threading::Thread
 	friend class Graphics::RendererDebugTool;
 
 public:
+	// Upper limit for the amount of frames the main thread can run ahead of the graphics thread
+	static constexpr u32 c_MaxFramesInFlight = 3;
+
 	GraphicsThread();
 	virtual ~GraphicsThread() {}
 
@@ -38,6 +41,11 @@ public:
 
 	void Sync();
 
+	// Each frame in flight gets its own copy of the frame data, this trades input latency for throughput.
+	//	Must be set before the first sync.
+	void SetFramesInFlight(u32 frames);
+	u32 GetFramesInFlight() const { return m_FramesInFlight; }
+
 private:
 
 	void DoFrame();
@@ -58,6 +66,9 @@ private:
 		uint2 m_ViewportSize;
 		uint2 m_WindowSize;
 
+		// Performance counter value at the moment the main thread polled the input for this frame
+		u64 m_InputSampleTime = 0;
+
 		RenderWorld m_RenderWorld;
 		ImDrawData m_DrawData;
 
@@ -81,7 +92,17 @@ private:
 		Render2DData m_Render2DData;
 	};
 
-	FrameData m_FrameData;
+	// Frame data that is currently being rendered
+	FrameData& GetRenderFrame() { return m_Frames[m_RenderFrame % m_FramesInFlight]; }
+
+	// Ring of frame data, the main thread writes slot 'm_SyncFrame' while the graphics thread reads slot 'm_RenderFrame'
+	std::array<FrameData, c_MaxFramesInFlight> m_Frames;
+	u32 m_FramesInFlight = 1;
+	u64 m_SyncFrame = 0;
+	u64 m_RenderFrame = 0;
+
+	// Changes of the game side render world for the last frames, indexed the same as 'm_Frames'
+	std::array<RenderWorldDelta, c_MaxFramesInFlight> m_RenderWorldDeltas;
 
 
 	std::mutex m_StageChangedCS;
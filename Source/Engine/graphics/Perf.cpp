@@ -16,21 +16,28 @@ s64 s_previous[s_frames] = {};
 
 void Timer::begin(RenderContext const& ctx)
 {
+	// The null backend has no queries to flush, only the CPU timer runs
+#ifndef USE_NULL_RHI
 	// When the timer is not flushed this means we haven't retrieved the data. This is not valid behaviour.
 	assert(_flushed);
 	_flushed = false;
+#endif
 
 	_timer.reset();
 	_timer.start();
 
+#ifndef USE_NULL_RHI
 	ctx.m_Context->End(_begin.Get());
+#endif
 }
 
 void Timer::end(RenderContext const& ctx)
 {
 	_timer.stop();
 
+#ifndef USE_NULL_RHI
 	ctx.m_Context->End(_end.Get());
+#endif
 }
 
 void Timer::flush(ComPtr<ID3D11DeviceContext> const& ctx, UINT64& start, UINT64& end, f64& cpuTime)
@@ -44,6 +51,11 @@ void Timer::flush(ComPtr<ID3D11DeviceContext> const& ctx, UINT64& start, UINT64&
 
 void initialize(ComPtr<ID3D11Device> const& device)
 {
+	if (!device)
+	{
+		return;
+	}
+
 	D3D11_QUERY_DESC desc{};
 	desc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
 	desc.MiscFlags = 0;
@@ -64,13 +76,17 @@ void shutdown()
 void begin_frame(RenderContext& ctx)
 {
 	// #TODO: Remove raw D3D11 usage for queries
+#ifndef USE_NULL_RHI
     ctx.m_Context->Begin(s_disjoint_query[get_current_frame_resource_index()].Get());
+#endif
 }
 
 void end_frame(RenderContext& ctx)
 {
 	// #TODO: Remove raw D3D11 usage for queries
+#ifndef USE_NULL_RHI
 	ctx.m_Context->End(s_disjoint_query[get_current_frame_resource_index()].Get());
+#endif
 
 	// Update our frame state
 	for (int i = 0; i < s_frames - 1; ++i)
@@ -88,6 +88,11 @@ public:
 
 	Timer(ComPtr<ID3D11Device> const& device)
 	{
+		if (!device)
+		{
+			return;
+		}
+
 		D3D11_QUERY_DESC desc{};
 		desc.Query = D3D11_QUERY_TIMESTAMP;
 		desc.MiscFlags = 0;
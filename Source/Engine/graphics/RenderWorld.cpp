@@ -4,59 +4,6 @@
 #include "RenderWorld.h"
 #include "Core/Material.h"
 
- RenderWorld::RenderWorld(RenderWorld const& rhs)
-{
-	_instances.reserve(rhs._instances.size());
-	_cameras.reserve(rhs._cameras.size());
-	_lights.reserve(rhs._lights.size());
-
-	for (shared_ptr<RenderWorldInstance> const& inst : rhs._instances)
-	{
-		_instances.push_back(std::make_shared<RenderWorldInstance>(*inst));
-	}
-
-	for (shared_ptr<RenderWorldCamera> const& cam : rhs._cameras)
-	{
-		_cameras.push_back(std::make_shared<RenderWorldCamera>(*cam));
-	}
-
-	for (shared_ptr<RenderWorldLight> const& light : rhs._lights)
-	{
-		_lights.push_back(std::make_shared<RenderWorldLight>(*light));
-	}
-
-	_active_camera = rhs._active_camera;
-} 
-
-RenderWorld& RenderWorld::operator=(RenderWorld const& rhs)
-{
-	_instances.reserve(rhs._instances.size());
-	_cameras.reserve(rhs._cameras.size());
-	_lights.reserve(rhs._lights.size());
-
-	_instances.clear();
-	_cameras.clear();
-	_lights.clear();
-
-	for (shared_ptr<RenderWorldInstance> const& inst : rhs._instances)
-	{
-		_instances.push_back(std::make_shared<RenderWorldInstance>(*inst));
-	}
-
-	for (shared_ptr<RenderWorldCamera> const& cam : rhs._cameras)
-	{
-		_cameras.push_back(std::make_shared<RenderWorldCamera>(*cam));
-	}
-
-	for (shared_ptr<RenderWorldLight> const& light : rhs._lights)
-	{
-		_lights.push_back(std::make_shared<RenderWorldLight>(*light));
-	}
-
-	_active_camera = rhs._active_camera;
-	return *this;
-}
-
 void RenderWorld::Init()
 {
 	_instances.reserve(c_instance_reserve);
@@ -66,9 +13,29 @@ void RenderWorld::Init()
 
 void RenderWorld::Clear()
 {
-    _instances.clear();
-    _cameras.clear();
-    _lights.clear();
+	{
+		// Everything that already reached the render side needs to be removed there as well
+		std::lock_guard l{ _changes_cs };
+		for (std::shared_ptr<RenderWorldInstance> const& inst : _instances)
+		{
+			if (inst->_owner && !(inst->_sync_flags & RenderWorldInstance::Sync_Added))
+			{
+				_removed_instances.push_back(inst.get());
+			}
+			inst->_owner = nullptr;
+			inst->_sync_flags = RenderWorldInstance::Sync_None;
+		}
+		_added_instances.clear();
+		_changed_instances.clear();
+	}
+
+	_instances.clear();
+	_cameras.clear();
+	_lights.clear();
+	_bvh.clear();
+	_pending_bounds.clear();
+	_source_lookup.clear();
+	_sources.clear();
 }
 
 std::shared_ptr<RenderWorldInstance> RenderWorld::create_instance(float4x4 transform, std::string const& mesh)
@@ -82,9 +49,52 @@ std::shared_ptr<RenderWorldInstance> RenderWorld::create_instance(float4x4 trans
 
 	_instances.push_back(inst);
 
+	std::lock_guard changes{ _changes_cs };
+	inst->_owner = this;
+	inst->_sync_flags = RenderWorldInstance::Sync_Added;
+	_added_instances.push_back(inst);
+
 	return inst;
 }
 
+void RenderWorld::create_instances(u32 count, float4x4 const* transforms, u32 const* mesh_indices, std::vector<std::string> const& meshes, std::vector<RenderWorldInstanceRef>* out)
+{
+	JONO_EVENT();
+
+	std::vector<std::shared_ptr<ModelHandle>> models;
+	models.reserve(meshes.size());
+	for (std::string const& mesh : meshes)
+	{
+		ModelHandle::init_parameters params{};
+		params.path = mesh;
+		models.push_back(ResourceLoader::instance()->load<ModelHandle>(params, false, false));
+	}
+
+	if (out)
+	{
+		out->reserve(out->size() + count);
+	}
+
+	std::lock_guard l{ _instance_cs };
+	std::lock_guard changes{ _changes_cs };
+	_instances.reserve(_instances.size() + count);
+	_added_instances.reserve(_added_instances.size() + count);
+	for (u32 i = 0; i < count; ++i)
+	{
+		std::shared_ptr<RenderWorldInstance> inst = std::make_shared<RenderWorldInstance>(transforms[i]);
+		inst->_model = models[mesh_indices[i]];
+		inst->_owner = this;
+		inst->_sync_flags = RenderWorldInstance::Sync_Added;
+
+		_instances.push_back(inst);
+		_added_instances.push_back(inst);
+		if (out)
+		{
+			out->push_back(std::move(inst));
+		}
+	}
+}
+
 std::shared_ptr<RenderWorldCamera> RenderWorld::create_camera()
 {
 	std::lock_guard l{ _camera_cs };
@@ -105,10 +115,237 @@ void RenderWorld::remove_instance(std::shared_ptr<RenderWorldInstance> const& in
 {
 	std::lock_guard l{ _instance_cs };
 	auto it = std::find(_instances.begin(), _instances.end(), instance);
-	if (it != _instances.end())
+	if (it == _instances.end())
+	{
+		return;
+	}
+
+	RenderWorldInstance* inst = it->get();
+	if (inst->_owner)
+	{
+		std::lock_guard changes{ _changes_cs };
+		if (inst->_sync_flags & RenderWorldInstance::Sync_Added)
+		{
+			// Never made it to the render side, drop the pending addition
+			std::erase(_added_instances, instance);
+		}
+		else
+		{
+			if (inst->_sync_flags != RenderWorldInstance::Sync_None)
+			{
+				std::erase(_changed_instances, inst);
+			}
+			_removed_instances.push_back(inst);
+		}
+		inst->_owner = nullptr;
+		inst->_sync_flags = RenderWorldInstance::Sync_None;
+	}
+
+	remove_instance_at(u32(it - _instances.begin()));
+}
+
+void RenderWorld::remove_instance_at(u32 idx)
+{
+	RenderWorldInstance* inst = _instances[idx].get();
+	if (inst->_bvh_proxy != BoundingVolumeHierarchy::c_InvalidProxy)
+	{
+		_bvh.remove(inst->_bvh_proxy);
+		inst->_bvh_proxy = BoundingVolumeHierarchy::c_InvalidProxy;
+	}
+	std::erase(_pending_bounds, inst);
+
+	bool has_sources = !_sources.empty();
+	if (has_sources)
+	{
+		_source_lookup.erase(_sources[idx]);
+	}
+
+	// Swap with the last instance, the draw order is decided by the draw sort
+	u32 last = u32(_instances.size() - 1);
+	if (idx != last)
+	{
+		_instances[idx] = std::move(_instances[last]);
+		if (has_sources)
+		{
+			_sources[idx] = _sources[last];
+			_source_lookup[_sources[idx]] = idx;
+		}
+	}
+
+	_instances.pop_back();
+	if (has_sources)
+	{
+		_sources.pop_back();
+	}
+}
+
+void RenderWorld::update_bounds()
+{
+	JONO_EVENT();
+
+	std::lock_guard l{ _instance_cs };
+
+	// Instances that are still loading stay in the pending list until their model is available
+	u32 pending = 0;
+	for (RenderWorldInstance* inst : _pending_bounds)
 	{
-		_instances.erase(it);
+		if (!inst->_model)
+		{
+			inst->_bounds_dirty = false;
+			continue;
+		}
+
+		if (!inst->_model->is_loaded())
+		{
+			_pending_bounds[pending++] = inst;
+			continue;
+		}
+
+		Math::AABB box = Math::transform_aabb(inst->_model->get()->get_bounding_box(), inst->_transform);
+		if (inst->_bvh_proxy == BoundingVolumeHierarchy::c_InvalidProxy)
+		{
+			inst->_bvh_proxy = _bvh.insert(box, inst);
+		}
+		else
+		{
+			_bvh.move(inst->_bvh_proxy, box);
+		}
+		inst->_bounds_dirty = false;
 	}
+	_pending_bounds.resize(pending);
+}
+
+void RenderWorld::on_instance_changed(RenderWorldInstance* inst, u8 flags)
+{
+	std::lock_guard l{ _changes_cs };
+	if (inst->_sync_flags == RenderWorldInstance::Sync_None)
+	{
+		_changed_instances.push_back(inst);
+	}
+	inst->_sync_flags |= flags;
+}
+
+void RenderWorld::flush_changes(RenderWorldDelta& delta)
+{
+	JONO_EVENT();
+
+	std::lock_guard l{ _changes_cs };
+
+	// Swap the collections so both sides keep reusing their memory
+	delta.clear();
+	std::swap(delta.removed, _removed_instances);
+	std::swap(delta.added, _added_instances);
+
+	for (std::shared_ptr<RenderWorldInstance> const& inst : delta.added)
+	{
+		inst->_sync_flags = RenderWorldInstance::Sync_None;
+	}
+
+	for (RenderWorldInstance* inst : _changed_instances)
+	{
+		if (inst->_sync_flags & RenderWorldInstance::Sync_Transform)
+		{
+			delta.transforms.push_back({ inst, inst->_transform });
+		}
+
+		if (inst->_sync_flags & RenderWorldInstance::Sync_Materials)
+		{
+			delta.materials.push_back({ inst, inst->_material_overrides });
+		}
+		inst->_sync_flags = RenderWorldInstance::Sync_None;
+	}
+	_changed_instances.clear();
+}
+
+void RenderWorld::apply_changes(RenderWorld const& src, RenderWorldDelta const& delta)
+{
+	JONO_EVENT();
+
+	{
+		std::lock_guard l{ _instance_cs };
+		for (RenderWorldInstance const* key : delta.removed)
+		{
+			if (auto it = _source_lookup.find(key); it != _source_lookup.end())
+			{
+				remove_instance_at(it->second);
+			}
+		}
+
+		for (std::shared_ptr<RenderWorldInstance> const& src_inst : delta.added)
+		{
+			RenderWorldInstance const* key = src_inst.get();
+			ASSERT(!_source_lookup.contains(key));
+
+			std::shared_ptr<RenderWorldInstance> inst = std::make_shared<RenderWorldInstance>(*src_inst);
+			inst->_bvh_proxy = BoundingVolumeHierarchy::c_InvalidProxy;
+			inst->_bounds_dirty = true;
+			_pending_bounds.push_back(inst.get());
+
+			_source_lookup[key] = u32(_instances.size());
+			_sources.push_back(key);
+			_instances.push_back(std::move(inst));
+		}
+
+		for (RenderWorldDelta::TransformUpdate const& update : delta.transforms)
+		{
+			if (auto it = _source_lookup.find(update.key); it != _source_lookup.end())
+			{
+				RenderWorldInstance* inst = _instances[it->second].get();
+				inst->_transform = update.transform;
+				if (!inst->_bounds_dirty)
+				{
+					inst->_bounds_dirty = true;
+					_pending_bounds.push_back(inst);
+				}
+			}
+		}
+
+		for (RenderWorldDelta::MaterialUpdate const& update : delta.materials)
+		{
+			if (auto it = _source_lookup.find(update.key); it != _source_lookup.end())
+			{
+				// Finalising again binds the new overrides to the model materials
+				RenderWorldInstance* inst = _instances[it->second].get();
+				inst->_material_overrides = update.overrides;
+				inst->_finalised = false;
+			}
+		}
+	}
+
+	// Existing cameras and lights are overwritten in place, new objects are only allocated when the source world grew
+	{
+		std::lock_guard l{ _camera_cs };
+		_cameras.resize(src._cameras.size());
+		for (size_t i = 0; i < _cameras.size(); ++i)
+		{
+			if (_cameras[i])
+			{
+				*_cameras[i] = *src._cameras[i];
+			}
+			else
+			{
+				_cameras[i] = std::make_shared<RenderWorldCamera>(*src._cameras[i]);
+			}
+		}
+	}
+
+	{
+		std::lock_guard l{ _lights_cs };
+		_lights.resize(src._lights.size());
+		for (size_t i = 0; i < _lights.size(); ++i)
+		{
+			if (_lights[i])
+			{
+				*_lights[i] = *src._lights[i];
+			}
+			else
+			{
+				_lights[i] = std::make_shared<RenderWorldLight>(*src._lights[i]);
+			}
+		}
+	}
+
+	_active_camera = src._active_camera;
 }
 
 void RenderWorld::remove_light(std::shared_ptr<RenderWorldLight> const& light)
@@ -209,6 +446,19 @@ RenderWorldLight::RenderWorldLight(RenderWorldLight const& light)
 {
 }
 
+RenderWorldLight& RenderWorldLight::operator=(RenderWorldLight const& light)
+{
+	// Cascades are calculated by the renderer and are not copied, same as the copy constructor
+	RenderWorldCamera::operator=(light);
+	_type = light._type;
+	_colour = light._colour;
+	_shadow_settings = light._shadow_settings;
+	_range = light._range;
+	_cone_angle = light._cone_angle;
+	_outer_cone_angle = light._outer_cone_angle;
+	return *this;
+}
+
 RenderWorldInstance::RenderWorldInstance(float4x4 const& transform)
 	: _transform(transform)
 {
@@ -217,6 +467,8 @@ RenderWorldInstance::RenderWorldInstance(float4x4 const& transform)
  RenderWorldInstance::RenderWorldInstance(RenderWorldInstance const& rhs)
 	:  _finalised(rhs._finalised)
 	 , _transform(rhs._transform)
+	 , _bvh_proxy(rhs._bvh_proxy)
+	 , _bounds_dirty(rhs._bounds_dirty)
 	 ,_model(rhs._model)
 	 , _material_overrides(rhs._material_overrides)
 {
@@ -276,6 +528,7 @@ void RenderWorldInstance::set_dynamic_material(u32 idx, shared_ptr<MaterialInsta
 {
 	_material_overrides.resize(idx + 1);
 	_material_overrides[idx] = instance;
+	mark_changed(Sync_Materials);
 }
 
 MaterialInstance const* RenderWorldInstance::GetMaterialInstance(u32 idx) const
@@ -298,6 +551,21 @@ MaterialInstance* RenderWorldInstance::GetMaterialInstance(u32 idx)
 	return _model->get()->GetMaterial(idx);
 }
 
+void RenderWorldInstance::set_transform(float4x4 const& transform)
+{
+	_transform = transform;
+	_bounds_dirty = true;
+	mark_changed(Sync_Transform);
+}
+
+void RenderWorldInstance::mark_changed(u8 flags)
+{
+	if (_owner)
+	{
+		_owner->on_instance_changed(this, flags);
+	}
+}
+
 VertexLayoutFlags RenderWorldInstance::GetElementUsages(u32 idx) const
 {
 
@@ -3,12 +3,15 @@
 #include "Graphics.h"
 #include "ConstantBuffer.h"
 #include "core/ModelResource.h"
+#include "BoundingVolumeHierarchy.h"
 
 using RenderWorldRef = std::shared_ptr<class RenderWorld>;
 using RenderWorldInstanceRef = std::shared_ptr<class RenderWorldInstance>;
 using RenderWorldCameraRef = std::shared_ptr<class RenderWorldCamera>;
 using RenderWorldLightRef = std::shared_ptr<class RenderWorldLight>;
 
+class RenderWorld;
+
 // Render world 'model' instance
 class ENGINE_API RenderWorldInstance
 {
@@ -31,15 +34,41 @@ public:
 
 	VertexLayoutFlags GetElementUsages(u32 idx) const;
 
+	// Updates the transform and flags the bounds in the render world BVH for a refit
+	void set_transform(float4x4 const& transform);
+
+	// Changes that still need to be synced to the render side copy of this instance
+	enum SyncFlags : u8
+	{
+		Sync_None = 0,
+		Sync_Added = 1 << 0,
+		Sync_Transform = 1 << 1,
+		Sync_Materials = 1 << 2,
+	};
+
 	bool _finalised = false;
 	float4x4 _transform;
 
+	// Leaf in the render world BVH, only valid once the model has finished loading
+	BoundingVolumeHierarchy::ProxyId _bvh_proxy = BoundingVolumeHierarchy::c_InvalidProxy;
+	bool _bounds_dirty = true;
+
+	// Index assigned by the visibility manager for the current frame
+	u32 _visibility_index = ~0u;
+
 	// Reference to a model
 	std::shared_ptr<ModelHandle> _model;
 
 	std::vector<std::shared_ptr<MaterialInstance>> _material_overrides;
 
+	// World that records the changes made to this instance, only set on game side instances
+	RenderWorld* _owner = nullptr;
+	u8 _sync_flags = Sync_None;
+
 	friend class RenderWorld;
+
+private:
+	void mark_changed(u8 flags);
 };
 
 class ENGINE_API RenderWorldCamera
@@ -120,6 +149,7 @@ public:
 		_settings = settings;
 		_dirty = true;
 	}
+	CameraSettings const& get_settings() const { return _settings; }
 	void set_aspect(f32 aspect);
 
 	void set_view(float4x4 view)
@@ -186,7 +216,7 @@ public:
 
 	RenderWorldLight(LightType type);
 	RenderWorldLight(RenderWorldLight const& light);
-	RenderWorldLight& operator=(RenderWorldLight const&) = delete;
+	RenderWorldLight& operator=(RenderWorldLight const& light);
 	~RenderWorldLight() {}
 
 	bool is_directional() const { return _type == LightType::Directional; }
@@ -200,7 +230,7 @@ public:
 	f32 get_outer_cone_angle() const { return _outer_cone_angle; }
 
 	void set_colour(float3 colour) { _colour = colour; }
-	void set_casts_shadow(bool cast) { _shadow_settings.casts_shadow = true; }
+	void set_casts_shadow(bool cast) { _shadow_settings.casts_shadow = cast; }
 	void set_range(f32 range) { _range = range; }
 	void set_cone_angle(f32 cone_angle) { _cone_angle = cone_angle; }
 	void set_outer_cone_angle(f32 outer_cone_angle) { _outer_cone_angle = outer_cone_angle; }
@@ -240,6 +270,45 @@ private:
 	f32 _outer_cone_angle = 0.0f;
 };
 
+// Changes made to the game side render world since the last sync.
+//	Instances are identified by the address of their game side object, which is only used as a key and never dereferenced.
+struct RenderWorldDelta
+{
+	struct TransformUpdate
+	{
+		RenderWorldInstance const* key;
+		float4x4 transform;
+	};
+
+	struct MaterialUpdate
+	{
+		RenderWorldInstance const* key;
+		std::vector<std::shared_ptr<MaterialInstance>> overrides;
+	};
+
+	// Applied in this order: removals, additions and then updates.
+	//	Added instances reference the game side object and get copied when the delta is applied.
+	std::vector<RenderWorldInstance const*> removed;
+	std::vector<std::shared_ptr<RenderWorldInstance>> added;
+	std::vector<TransformUpdate> transforms;
+	std::vector<MaterialUpdate> materials;
+
+	void clear()
+	{
+		removed.clear();
+		added.clear();
+		transforms.clear();
+		materials.clear();
+	}
+
+	size_t get_change_count() const
+	{
+		return removed.size() + added.size() + transforms.size() + materials.size();
+	}
+};
+
+// Collection of everything that gets rendered.
+//	The game owns one world and records its changes, the graphics thread keeps a persistent copy that only receives those changes.
 class ENGINE_API RenderWorld final
 {
 public:
@@ -250,8 +319,8 @@ public:
 	RenderWorld() = default;
 	~RenderWorld() = default;
 
-	RenderWorld(RenderWorld const& rhs);
-	RenderWorld& operator=(RenderWorld const& rhs);
+	RenderWorld(RenderWorld const& rhs) = delete;
+	RenderWorld& operator=(RenderWorld const& rhs) = delete;
 
 	static constexpr u32 c_instance_reserve = 512;
 	static constexpr u32 c_light_reserve = 10;
@@ -272,12 +341,28 @@ public:
 
 	// Create render world objects
 	std::shared_ptr<RenderWorldInstance> create_instance(float4x4 transform, std::string const& mesh);
+
+	// Creates 'count' instances at once. 'meshes' holds the unique mesh paths and 'mesh_indices' picks one per instance,
+	//	every mesh is only requested once from the resource loader.
+	void create_instances(u32 count, float4x4 const* transforms, u32 const* mesh_indices, std::vector<std::string> const& meshes, std::vector<RenderWorldInstanceRef>* out = nullptr);
 	std::shared_ptr<RenderWorldCamera>   create_camera();
 	std::shared_ptr<RenderWorldLight>    create_light(RenderWorldLight::LightType type);
 
 	void remove_instance(std::shared_ptr<RenderWorldInstance> const& instance);
 	void remove_light(std::shared_ptr<RenderWorldLight> const& light);
 
+	// Inserts instances that finished loading into the BVH and refits the ones that moved, call once per frame after applying the changes
+	void update_bounds();
+
+	// Moves the changes recorded since the last call into 'delta', the previous contents of 'delta' are discarded
+	void flush_changes(RenderWorldDelta& delta);
+
+	// Applies the changes of the game side world to this render side copy.
+	//	Cameras and lights are copied by value as there are only a handful of them.
+	void apply_changes(RenderWorld const& src, RenderWorldDelta const& delta);
+
+	BoundingVolumeHierarchy const& get_bvh() const { return _bvh; }
+
 	// Returns the current active view camera
 	std::shared_ptr<RenderWorldCamera> get_view_camera() const;
 
@@ -285,11 +370,34 @@ public:
 	void set_active_camera(u32 idx) { _active_camera = idx; }
 
 private:
+	friend class RenderWorldInstance;
+
+	// Records a change made to a game side instance
+	void on_instance_changed(RenderWorldInstance* inst, u8 flags);
+
+	void remove_instance_at(u32 idx);
+
 	u32 _active_camera = 0;
 
 	std::mutex _instance_cs;
 	InstanceCollection _instances;
 
+	// World space bounds of all loaded instances, the user data points to the instance
+	BoundingVolumeHierarchy _bvh;
+
+	// Instances waiting to be inserted or refitted in the BVH, either because they moved or because their model is still loading
+	std::vector<RenderWorldInstance*> _pending_bounds;
+
+	// Game side: instances added, changed or removed since the last flush, removed instances only keep their key
+	std::mutex _changes_cs;
+	std::vector<std::shared_ptr<RenderWorldInstance>> _added_instances;
+	std::vector<RenderWorldInstance*> _changed_instances;
+	std::vector<RenderWorldInstance const*> _removed_instances;
+
+	// Render side: maps the game side instance to the index of its copy in '_instances', '_sources' holds the reverse mapping
+	std::unordered_map<RenderWorldInstance const*, u32> _source_lookup;
+	std::vector<RenderWorldInstance const*> _sources;
+
 	std::mutex _camera_cs;
 	CameraCollection _cameras;
 
@@ -27,6 +27,73 @@ using Helpers::SafeRelease;
 
 static f32 s_box_size = 15.0f;
 
+namespace
+{
+
+// Replays recorded command lists on the render context
+class RenderContextCommandBackend final : public ICommandBackend
+{
+public:
+	RenderContextCommandBackend(RenderContext& ctx, ConstantBufferRef const& model_cb, ViewParams const& params)
+			: _ctx(ctx)
+			, _model_cb(model_cb)
+			, _params(params)
+	{
+	}
+
+	void set_index_buffer(GraphicsResourceHandle buffer, u32 stride) override
+	{
+		_ctx.IASetIndexBuffer(buffer, stride == sizeof(u16) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
+	}
+
+	void set_vertex_buffer(GraphicsResourceHandle buffer, u32 stride) override
+	{
+		_ctx.IASetVertexBuffers(0, { buffer }, { stride }, { 0 });
+	}
+
+	void set_material(MaterialInstance const* material, GraphicsResourceHandle layout, VertexLayoutFlags flags) override
+	{
+		// Bind anything coming from the material
+		material->apply(_ctx, layout, flags, _params);
+	}
+
+	void draw_indexed_instanced(u32 index_count, u32 instance_count, u32 first_index, u32 first_vertex, u32 first_instance) override
+	{
+		// SV_InstanceID does not include the start instance, the shaders read the offset from the model constants instead
+		ModelCB* data = (ModelCB*)_model_cb->map(_ctx);
+		data->instance_offset = first_instance;
+		_model_cb->unmap(_ctx);
+
+		_ctx.DrawIndexedInstanced(index_count, instance_count, first_index, first_vertex, 0);
+	}
+
+private:
+	RenderContext& _ctx;
+	ConstantBufferRef const& _model_cb;
+	ViewParams const& _params;
+};
+
+// Pixels covered by one object space unit of the instance at its closest point to the view, mesh LOD errors are scaled by this
+f32 get_lod_error_scale(ViewParams const& params, float4x4 const& transform, Math::AABB const& bounds)
+{
+	// The largest axis scale of the transform keeps the estimate conservative for non uniform scales
+	f32 scale = std::max({ float(hlslpp::length(transform._11_12_13)), float(hlslpp::length(transform._21_22_23)), float(hlslpp::length(transform._31_32_33)) });
+	f32 pixels_per_unit = float(params.proj._22) * params.viewport.height * 0.5f * scale;
+
+	// Orthographic projections (shadow cascades) have the same scale at every distance
+	if (fabsf(float(params.proj._44)) > 0.5f)
+	{
+		return pixels_per_unit;
+	}
+
+	float3 center = hlslpp::mul(float4(bounds.center(), 1.0f), transform).xyz;
+	f32 radius = float(hlslpp::length(bounds.size())) * 0.5f * scale;
+	f32 distance = float(hlslpp::length(center - params.view_position)) - radius;
+	return pixels_per_unit / std::max(distance, 0.01f);
+}
+
+} // namespace
+
 
 void Renderer::Init(EngineCfg const& settings, GameCfg const& game_settings, cli::CommandLine const& cmdline)
 {
@@ -43,11 +110,20 @@ void Renderer::Init(EngineCfg const& settings, GameCfg const& game_settings, cli
 
 	// #TODO: Move this out of the renderer. The driver interface should be initialized by the engine
 
+#ifdef USE_NULL_RHI
+	GetGlobalContext()->m_RenderInterface = GetGlobalContext()->m_TypeManager->CreateObject<IRenderInterface>("/Types/NullRenderInterface");
+#else
 	GetGlobalContext()->m_RenderInterface = GetGlobalContext()->m_TypeManager->CreateObject<IRenderInterface>("/Types/Dx11RenderInterface");
+#endif
 	m_RI = GetRI();
     m_RI->Init();
 
+#ifdef USE_NULL_RHI
+	// There is no device, raw D3D11 paths below are skipped when it is null
+	_device = nullptr;
+#else
     _device = m_RI->m_Device.Get();
+#endif
 
 	_debug_tool = std::make_unique<RendererDebugTool>(this);
 	GameEngine::instance()->get_overlay_manager()->register_overlay(_debug_tool.get());
@@ -61,6 +137,7 @@ void Renderer::Init(EngineCfg const& settings, GameCfg const& game_settings, cli
 	// Setup Light buffer
 	{
 		_light_buffer = GPUStructuredBuffer::create(m_RI, sizeof(ProcessedLight), c_MaxLights,true, BufferUsage::Dynamic);
+		_instance_buffer = GPUStructuredBuffer::create(m_RI, sizeof(InstanceData), c_InitialInstanceCapacity, true, BufferUsage::Dynamic);
 	}
 
 	// Create our cubemap 
@@ -230,8 +307,11 @@ void Renderer::ResizeSwapchain(u32 w, u32 h)
 			break;
 	}
 
-	UINT qualityLevels;
-	_device->CheckMultisampleQualityLevels(swapchain_format, _aa_desc.Count, &qualityLevels);
+	UINT qualityLevels = 1;
+	if (_device)
+	{
+		_device->CheckMultisampleQualityLevels(swapchain_format, _aa_desc.Count, &qualityLevels);
+	}
 	aa_desc.Quality = (_msaa != MSAAMode::Off) ? qualityLevels - 1 : 0;
 
 	// Release the textures before re-creating the swapchain
@@ -280,11 +360,10 @@ void Renderer::ResizeSwapchain(u32 w, u32 h)
 		srv_view_dim = D3D11_SRV_DIMENSION_TEXTURE2DMS;
 	}
 
-    ID3D11Texture2D* depth = m_RI->GetRawTexture2D(_output_depth);
-	auto dsv_desc = CD3D11_DEPTH_STENCIL_VIEW_DESC(depth, view_dim, DXGI_FORMAT_D16_UNORM);
+	auto dsv_desc = CD3D11_DEPTH_STENCIL_VIEW_DESC(view_dim, DXGI_FORMAT_D16_UNORM);
     _output_dsv = m_RI->CreateDepthStencilView(_output_depth, dsv_desc, "Renderer::Output Depth");
 
-	auto srv_desc = CD3D11_SHADER_RESOURCE_VIEW_DESC(depth, srv_view_dim, DXGI_FORMAT_R16_UNORM);
+	auto srv_desc = CD3D11_SHADER_RESOURCE_VIEW_DESC(srv_view_dim, DXGI_FORMAT_R16_UNORM, 0, 1);
     _output_depth_srv = m_RI->CreateShaderResourceView(_output_depth, srv_desc, "Renderer::Output Depth");
     _output_depth_srv_copy = m_RI->CreateShaderResourceView(_output_depth_copy, srv_desc, "Renderer::Output Depth(COPY)");
 
@@ -345,6 +424,7 @@ void Renderer::ResizeSwapchain(u32 w, u32 h)
 	//SUCCEEDED(_device->CreateShaderResourceView(backBuffer.Get(), NULL, &_swapchain_srv));
 	//set_debug_name(backBuffer.Get(), "Swapchain::Output");
 
+#ifndef USE_NULL_RHI
 	// Create the D2D target for 2D rendering
 	int display = SDL_GetWindowDisplayIndex(m_Window);
 
@@ -363,6 +443,7 @@ void Renderer::ResizeSwapchain(u32 w, u32 h)
 
 		_d2d_rt->SetAntialiasMode(_d2d_aa_mode);
 	}
+#endif
 }
 
 void Renderer::PreRender(RenderContext& ctx, RenderWorld const& world)
@@ -486,7 +567,7 @@ void Renderer::PreRender(RenderContext& ctx, RenderWorld const& world)
         {
 			params.frustum[VisiblityFrustum_CSM0 + i] = Math::Frustum::from_vp(directional_light->get_cascade(i).vp);
         }
-		m_Visibility->run(params);
+		m_Visibility->run(params, &world.get_bvh());
 	}
 
 	// Light culling step is scheduled here.
@@ -644,6 +725,105 @@ void Renderer::DrawView(RenderContext& ctx, RenderWorld const& world, RenderPass
 }
 
 void Renderer::DrawWorld(RenderContext& ctx, RenderWorld const& world, ViewParams const& params)
+{
+	DrawList& list = m_DrawLists[params.pass];
+	BuildDrawList(world, params, list);
+	SubmitDrawList(ctx, world, params, list);
+}
+
+void Renderer::BuildDrawList(RenderWorld const& world, ViewParams const& params, DrawList& list)
+{
+	JONO_EVENT("GenerateDrawCalls");
+
+	VisibilityFrustum frustum = VisiblityFrustum_Main;
+	if (RenderPass::IsShadowPass(params.pass))
+	{
+		frustum = (VisibilityFrustum)(VisiblityFrustum_CSM0 + (params.pass - RenderPass::Shadow_CSM0));
+	}
+
+	std::vector<RenderWorldInstance*> const& instances = m_Visibility->get_visible_instances(frustum);
+	u32 const n_instances = u32(instances.size());
+
+	// Every instance writes its meshes to a fixed range so the draw calls can be generated in parallel
+	list.offsets.resize(n_instances + 1);
+	u32 n_draws = 0;
+	for (u32 i = 0; i < n_instances; ++i)
+	{
+		list.offsets[i] = n_draws;
+		if (instances[i]->is_ready())
+		{
+			n_draws += u32(instances[i]->_model->get()->GetMeshes().size());
+		}
+	}
+	list.offsets[n_instances] = n_draws;
+	list.draw_calls.resize(n_draws);
+	list.items.resize(n_draws);
+
+	// Shadow maps tolerate coarser geometry than the main view
+	f32 const max_lod_error = RenderPass::IsShadowPass(params.pass) ? s_LodErrorThreshold * s_ShadowLodBias : s_LodErrorThreshold;
+
+	Tasks::JobSystem* scheduler = Tasks::get_scheduler();
+	Tasks::JobCounter counter{};
+	scheduler->parallel_for(n_instances, c_InstancesPerDrawJob, [&list, &instances, &params, max_lod_error](u32 begin, u32 end)
+	{
+		for (u32 i = begin; i < end; ++i)
+		{
+			u32 draw = list.offsets[i];
+			if (draw == list.offsets[i + 1])
+			{
+				continue;
+			}
+
+			RenderWorldInstance const* inst = instances[i];
+			Model const* model = inst->_model->get();
+			f32 depth = hlslpp::mul(float4(inst->_transform._41_42_43, 1.0f), params.view).z;
+			f32 lod_error_scale = get_lod_error_scale(params, inst->_transform, model->get_bounding_box());
+			for (Mesh const& mesh : model->GetMeshes())
+			{
+				// Input layouts are created per mesh as every mesh has its own vertex format
+				u32 mesh_index = u32(&mesh - model->GetMeshes().data());
+				u32 lod = s_EnableLods ? mesh.select_lod(lod_error_scale, max_lod_error) : 0;
+
+				DrawCall& dc = list.draw_calls[draw];
+				dc._transform = inst->_transform;
+				dc._index_buffer = model->GetIndexBuffer();
+				dc._index_stride = model->GetIndexStride();
+				dc._vertex_buffer = model->GetVertexBuffer();
+				dc._vertex_stride = mesh.vertexStride;
+				dc._input_layout_flags = model->GetElementUsages(mesh_index);
+				dc._input_layout = model->GetVertexLayout(mesh_index);
+				dc._material = inst->GetMaterialInstance(mesh.material_index);
+				dc._first_index = mesh.lods[lod].firstIndex;
+				dc._first_vertex = mesh.firstVertex;
+				dc._index_count = mesh.lods[lod].indexCount;
+				#ifdef _DEBUG
+				dc._model = model;
+				#endif
+
+				u64 key = DrawSortKey::make(params.pass, dc._material->get_vertex_shader().get(), dc._material, dc._input_layout.data.id, dc._vertex_buffer.data.id, mesh_index * Mesh::c_MaxLods + lod, depth);
+				list.items[draw] = { key, draw };
+				++draw;
+			}
+		}
+	}, &counter);
+	scheduler->wait(counter);
+
+	radix_sort(list.items, list.scratch);
+	build_draw_batches(list.draw_calls, list.items, s_EnableInstancing, list.batches);
+
+	// Record the batches into several command lists in parallel, submission replays them in order
+	u32 const n_batches = u32(list.batches.size());
+	list.commands.resize((n_batches + c_BatchesPerCommandList - 1) / c_BatchesPerCommandList);
+	scheduler->parallel_for(n_batches, c_BatchesPerCommandList, [&list](u32 begin, u32 end)
+	{
+		CommandList& cmds = list.commands[begin / c_BatchesPerCommandList];
+		cmds.reset();
+		record_draw_batches(cmds, list.draw_calls, list.items, list.batches.data() + begin, end - begin);
+	}, &counter);
+	scheduler->wait(counter);
+}
+
+void Renderer::SubmitDrawList(RenderContext& ctx, RenderWorld const& world, ViewParams const& params, DrawList const& list)
 {
 	std::string passName = RenderPass::ToString(params.pass);
 	GPU_SCOPED_EVENT(&ctx, passName.c_str());
@@ -735,47 +915,6 @@ void Renderer::DrawWorld(RenderContext& ctx, RenderWorld const& world, ViewParam
 
 	float4x4 vp = hlslpp::mul(params.view, params.proj);
 
-	{
-		JONO_EVENT("GenerateDrawCalls");
-
-		VisibilityFrustum frustum = VisiblityFrustum_Main;
-		if (RenderPass::IsShadowPass(params.pass))
-		{
-			frustum = (VisibilityFrustum)(VisiblityFrustum_CSM0 + (params.pass - RenderPass::Shadow_CSM0));
-		}
-
-		std::vector<RenderWorldInstance*> const& instances = m_Visibility->get_visible_instances(frustum);
-		m_DrawCalls.reserve(instances.size());
-		m_DrawCalls.clear();
-
-		// #TODO: Pull this information from visibile lists
-		for (RenderWorldInstance const* inst : instances)
-		{
-			// If the instance is ready we can consider adding it to the draw list
-			if (inst->is_ready())
-			{
-				Model const* model = inst->_model->get();
-				for (Mesh const& mesh : model->GetMeshes())
-				{
-					DrawCall dc{};
-					dc._transform = inst->_transform;
-                    dc._index_buffer = model->GetIndexBuffer();
-                    dc._vertex_buffer = model->GetVertexBuffer();
-                    dc._input_layout_flags = model->GetElementUsages(mesh.material_index);
-                    dc._input_layout = model->GetVertexLayout(mesh.material_index);
-					dc._material = inst->GetMaterialInstance(mesh.material_index);
-					dc._first_index = mesh.firstIndex;
-					dc._first_vertex = mesh.firstVertex;
-					dc._index_count = mesh.indexCount;
-					#ifdef _DEBUG
-                    dc._model = model;
-					#endif
-					m_DrawCalls.push_back(dc);
-				}
-			}
-		}
-	}
-
 	JONO_EVENT("Submit");
 
     ctx.IASetPrimitiveTopology(PrimitiveTopology::TriangleList);
@@ -799,45 +938,57 @@ void Renderer::DrawWorld(RenderContext& ctx, RenderWorld const& world, ViewParam
         ctx.SetConstantBuffers(s, 0, buffers);
 	}
 
-	GraphicsResourceHandle prev_index = GraphicsResourceHandle::Invalid();
-	GraphicsResourceHandle prev_vertex = GraphicsResourceHandle::Invalid();
+	// Upload the transforms of every draw in sorted order, instanced draws read a contiguous range of these
+	u32 const n_draws = u32(list.items.size());
+	if (n_draws > _instance_buffer->get_element_count())
+	{
+		size_t capacity = std::max<size_t>(_instance_buffer->get_element_count() * 2, n_draws);
+		_instance_buffer = GPUStructuredBuffer::create(m_RI, sizeof(InstanceData), capacity, true, BufferUsage::Dynamic);
+	}
 
-	for (DrawCall const& dc : m_DrawCalls) 
+	if (n_draws > 0)
 	{
-		ConstantBufferRef const& model_cb = m_CBModel;
-		ModelCB* data = (ModelCB*)model_cb->map(ctx);
-		data->world = dc._transform;
-		data->wv = hlslpp::mul(data->world, params.view);
-		data->wvp = hlslpp::mul(data->world, vp);
-		model_cb->unmap(ctx);
-
-		if(prev_index != dc._index_buffer)
-		{
-            ctx.IASetIndexBuffer(dc._index_buffer, DXGI_FORMAT_R32_UINT, 0);
-			prev_index = dc._index_buffer;
-		}
+		JONO_EVENT("UploadInstances");
 
-		if (prev_vertex != dc._vertex_buffer)
+		ScopedBufferAccess access{ ctx, _instance_buffer.get() };
+		InstanceData* instances = static_cast<InstanceData*>(access.get_ptr());
+
+		Tasks::JobSystem* scheduler = Tasks::get_scheduler();
+		Tasks::JobCounter counter{};
+		scheduler->parallel_for(n_draws, c_InstancesPerDrawJob, [&list, &params, &vp, instances](u32 begin, u32 end)
 		{
-            ctx.IASetVertexBuffers(0, { dc._vertex_buffer }, { sizeof(Model::VertexType) }, { 0 });
+			for (u32 i = begin; i < end; ++i)
+			{
+				float4x4 const& world = list.draw_calls[list.items[i].index]._transform;
+				instances[i].world = world;
+				instances[i].world_view = hlslpp::mul(world, params.view);
+				instances[i].world_view_projection = hlslpp::mul(world, vp);
+			}
+		}, &counter);
+		scheduler->wait(counter);
+	}
 
-			prev_vertex = dc._vertex_buffer;
-		}
+	// The model constant buffer and the global pass resources are the same for every draw
+	ConstantBufferRef const& model_cb = m_CBModel;
+	ctx.SetConstantBuffers(ShaderStage::Vertex | ShaderStage::Pixel, 2, { model_cb->get_buffer() });
+	ctx.SetShaderResources(ShaderStage::Vertex, Texture_Instances, { _instance_buffer->get_srv() });
+	setup_pass_resources(ctx, params);
 
-		GraphicsResourceHandle buffers[1] = 
-		{
-			model_cb->get_buffer()
-		};
-        ctx.SetConstantBuffers(ShaderStage::Vertex | ShaderStage::Pixel, 2, { model_cb->get_buffer() });
+	RenderContextCommandBackend backend{ ctx, model_cb, params };
+	for (CommandList const& cmds : list.commands)
+	{
+		cmds.execute(backend);
 
-		// Setup the material render state
-		{
-			setup_renderstate(ctx,dc._input_layout, dc._input_layout_flags, dc._material, params);
+		m_FrameStats.n_state_changes += cmds.n_state_changes;
+		m_FrameStats.n_state_changes_skipped += cmds.n_state_changes_skipped;
+	}
 
-			++m_FrameStats.n_draws;
-			m_FrameStats.n_primitives += u32(dc._index_count / 3);
-            ctx.DrawIndexed((u32)dc._index_count, (u32)dc._first_index, (u32)dc._first_vertex);
-		}
+	for (DrawBatch const& batch : list.batches)
+	{
+		DrawCall const& dc = list.draw_calls[list.items[batch.first].index];
+		++m_FrameStats.n_draws;
+		m_FrameStats.n_instances += batch.count;
+		m_FrameStats.n_primitives += u32(dc._index_count / 3) * batch.count;
 	}
 }
 
@@ -855,16 +1006,17 @@ void Renderer::PrepareShadowPass()
 			ASSERTMSG(false, "Failed to create the shadowmap texture");
 		}
 
+		// The view descriptors are filled in explicitly as the null backend has no native texture to query
 		for (u32 i = 0; i < num_cascades; ++i)
 		{
-            auto view_desc = CD3D11_DEPTH_STENCIL_VIEW_DESC(GetRI()->GetRawTexture2D(_shadow_map), D3D11_DSV_DIMENSION_TEXTURE2DARRAY, DXGI_FORMAT_D32_FLOAT, 0, i);
+            auto view_desc = CD3D11_DEPTH_STENCIL_VIEW_DESC(D3D11_DSV_DIMENSION_TEXTURE2DARRAY, DXGI_FORMAT_D32_FLOAT, 0, i, num_cascades - i);
             _shadow_map_dsv[i] = GetRI()->CreateDepthStencilView(_shadow_map, view_desc);
             if (!_shadow_map_dsv)
 			{
 				ASSERTMSG(false, "Failed to create the shadowmap DSV");
 			}
 
-			auto srv_desc = CD3D11_SHADER_RESOURCE_VIEW_DESC(GetRI()->GetRawTexture2D(_shadow_map), D3D11_SRV_DIMENSION_TEXTURE2DARRAY, DXGI_FORMAT_R32_FLOAT, 0, UINT(-1), i, 1);
+			auto srv_desc = CD3D11_SHADER_RESOURCE_VIEW_DESC(D3D11_SRV_DIMENSION_TEXTURE2DARRAY, DXGI_FORMAT_R32_FLOAT, 0, 1, i, 1);
             _debug_shadow_map_srv[i] = GetRI()->CreateShaderResourceView(_shadow_map, srv_desc);
             if (!_debug_shadow_map_srv[i])
 			{
@@ -872,7 +1024,7 @@ void Renderer::PrepareShadowPass()
 			}
 		}
 
-		auto srv_desc = CD3D11_SHADER_RESOURCE_VIEW_DESC(GetRI()->GetRawTexture2D(_shadow_map), D3D11_SRV_DIMENSION_TEXTURE2DARRAY, DXGI_FORMAT_R32_FLOAT);
+		auto srv_desc = CD3D11_SHADER_RESOURCE_VIEW_DESC(D3D11_SRV_DIMENSION_TEXTURE2DARRAY, DXGI_FORMAT_R32_FLOAT, 0, 1, 0, num_cascades);
 		_shadow_map_srv = GetRI()->CreateShaderResourceView(_shadow_map, srv_desc, "ShadowMap SRV");
 		if(!_shadow_map_srv)
 		{
@@ -921,12 +1073,9 @@ Math::Frustum Renderer::get_cascade_frustum(shared_ptr<RenderWorldCamera> const&
 	return frustum;
 }
 
-void Renderer::setup_renderstate(RenderContext& ctx,GraphicsResourceHandle vertexLayout, VertexLayoutFlags flags, MaterialInstance const* mat_instance, ViewParams const& params)
+void Renderer::setup_pass_resources(RenderContext& ctx, ViewParams const& params)
 {
-	// Bind anything coming from the material
-	mat_instance->apply(ctx, vertexLayout, flags, params);
-
-	// Bind the global textures coming from rendering systems
+	// Bind the global textures coming from rendering systems, these don't overlap with the material slots
 	if (params.pass == RenderPass::Opaque)
 	{
 		GraphicsResourceHandle views[] = {
@@ -1004,23 +1153,22 @@ void Renderer::DrawShadowPass(RenderContext& ctx, RenderWorld const& world)
 		float3 direction = world.get_light(0)->get_view_direction().xyz;
 		float3 position = world.get_light(0)->get_position().xyz;
 
-		// Render out the cascades shadow map for the directional light
+		// Build the draw lists of all cascades in parallel, they are submitted in order afterwards
         bool renderCascade[4] = { s_EnableCSM0, s_EnableCSM1, s_EnableCSM2, s_EnableCSM3 };
+		std::array<ViewParams, MAX_CASCADES> cascade_params{};
+
+		Tasks::JobSystem* scheduler = Tasks::get_scheduler();
+		Tasks::JobCounter counter{};
 		for (u32 i = 0; i < MAX_CASCADES; ++i)
 		{
+			if (!renderCascade[i])
+			{
+				continue;
+			}
 
-			GPU_SCOPED_EVENT(&ctx, fmt::format("Cascade {}", i).c_str());
 			CascadeInfo const& info = light->get_cascade(i);
 
-			ctx.SetTarget(GraphicsResourceHandle::Invalid(), _shadow_map_dsv[i]);
-			ctx.ClearDepthStencil(_shadow_map_dsv[i], D3D11_CLEAR_DEPTH, 1.0f, 0);
-
-            if (!renderCascade[i])
-            {
-                continue;
-			}
-
-			ViewParams params{};
+			ViewParams& params = cascade_params[i];
 #if 0 
 			params.proj = proj;
 			params.view = light_view;
@@ -1032,7 +1180,29 @@ void Renderer::DrawShadowPass(RenderContext& ctx, RenderWorld const& world)
 			params.view_direction = direction;
 			params.pass = RenderPass::Value(RenderPass::Shadow_CSM0 + i);
 			params.viewport = Viewport(0.0f, 0.0f, 2048.0f, 2048.0f);
-			DrawWorld(ctx, world, params);
+
+			scheduler->run([this, &world, &params]()
+			{
+				BuildDrawList(world, params, m_DrawLists[params.pass]);
+			}, &counter);
+		}
+		scheduler->wait(counter);
+
+		// Render out the cascades shadow map for the directional light
+		for (u32 i = 0; i < MAX_CASCADES; ++i)
+		{
+
+			GPU_SCOPED_EVENT(&ctx, fmt::format("Cascade {}", i).c_str());
+
+			ctx.SetTarget(GraphicsResourceHandle::Invalid(), _shadow_map_dsv[i]);
+			ctx.ClearDepthStencil(_shadow_map_dsv[i], D3D11_CLEAR_DEPTH, 1.0f, 0);
+
+            if (!renderCascade[i])
+            {
+                continue;
+			}
+
+			SubmitDrawList(ctx, world, cascade_params[i], m_DrawLists[cascade_params[i].pass]);
 		}
 	}
 }
@@ -1066,6 +1236,7 @@ void Renderer::DrawPost(RenderContext& ctx, RenderWorld const& world, shared_ptr
 	data->m_ViewportHeight = (f32)(m_DrawableAreaHeight);
     m_CBPost->unmap(ctx);
 
+#ifndef USE_NULL_RHI
 	if (!_states)
 	{
 		_states = std::make_unique<DirectX::CommonStates>(_device);
@@ -1102,6 +1273,7 @@ void Renderer::DrawPost(RenderContext& ctx, RenderWorld const& world, shared_ptr
 	_common_effect->SetView(xm_view);
 	_common_effect->SetProjection(xm_proj);
     _common_effect->Apply(deviceCtx);
+#endif
 
 	if(overlays)
 	{
@@ -1118,11 +1290,13 @@ void Renderer::DrawPost(RenderContext& ctx, RenderWorld const& world, shared_ptr
 	vp.maxZ = 1.0f;
 	ctx.SetViewport(vp);
 
+#ifndef USE_NULL_RHI
 	// Resolve msaa to non msaa for imgui render
     deviceCtx->ResolveSubresource(GetRI()->GetRawResource(_non_msaa_output_tex), 0, GetRI()->GetRawResource(m_OutputTexture.GetResource()), 0, _swapchain_format);
 
 	// Copy the non-msaa world render so we can sample from it in the post pass
     deviceCtx->CopyResource(GetRI()->GetRawResource(_non_msaa_output_tex_copy), GetRI()->GetRawResource(_non_msaa_output_tex));
+#endif
     ctx.SetTarget(_non_msaa_output_rtv, GraphicsResourceHandle::Invalid());
 	render_post_predebug(ctx);
 
@@ -1143,8 +1317,10 @@ void Renderer::DrawPost(RenderContext& ctx, RenderWorld const& world, shared_ptr
 		GPU_SCOPED_EVENT(&ctx, "ImGui");
 
 		ctx.SetTarget(_swapchain_rtv, GraphicsResourceHandle::Invalid());
-		ImDrawData* imguiData = &GetGlobalContext()->m_GraphicsThread->m_FrameData.m_DrawData;
+		ImDrawData* imguiData = &GetGlobalContext()->m_GraphicsThread->GetRenderFrame().m_DrawData;
+#ifndef USE_NULL_RHI
 		ImGui_ImplDX11_RenderDrawData(imguiData);
+#endif
 	}
 
 }
@@ -1152,7 +1328,9 @@ void Renderer::DrawPost(RenderContext& ctx, RenderWorld const& world, shared_ptr
 void Renderer::CopyDepth(RenderContext& ctx)
 {
 	// #TODO: Implement CopyDepth function
+#ifndef USE_NULL_RHI
 	ctx.m_Context->CopyResource(m_RI->GetRawTexture2D(_output_depth_copy), m_RI->GetRawTexture2D(_output_depth));
+#endif
 }
 
 } // namespace Graphics
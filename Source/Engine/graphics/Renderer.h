@@ -16,6 +16,8 @@
 #include <DirectXCollision.h>
 
 #include "Visibility.h"
+#include "DrawSort.h"
+#include "CommandList.h"
 #include "RendererDebug.h"
 
 #include "Shaders/CommonShared.h"
@@ -172,44 +174,14 @@ struct PostCB
 	float padding[2];
 };
 
+__declspec(align(16))
 struct ModelCB
 {
-	float4x4 world;
-	float4x4 wv;
-	float4x4 wvp;
+	u32 instance_offset;
+	u32 padding[3];
 };
 
 
-// information that is needed to represent 1 draw call
-struct DrawCall
-{
-    float4x4 _transform;
-
-    // Mesh index buffer
-    GraphicsResourceHandle _index_buffer;
-
-    // Vertex buffers
-    GraphicsResourceHandle _vertex_buffer;
-
-    VertexLayoutFlags _input_layout_flags;
-    GraphicsResourceHandle _input_layout;
-
-    // First vertex offset this mesh starts at in the vertex buffer
-    u64 _first_vertex;
-
-    // First index location offset this mesh starts at in the index buffer
-    u64 _first_index;
-
-    // The amount of indices associated with this mesh
-    u64 _index_count;
-
-    // Material (e.g. shaders, textures, constant buffer, input layouts)
-    MaterialInstance const* _material;
-
-	#ifdef _DEBUG
-    Model const* _model;
-	#endif
-};
 
 
 
@@ -218,6 +190,9 @@ class Renderer final
 	friend class RendererDebugTool;	
 
 	static constexpr u32 c_MaxLights = 2048;
+	static constexpr u32 c_InitialInstanceCapacity = 4096;
+	static constexpr u32 c_InstancesPerDrawJob = 128;
+	static constexpr u32 c_BatchesPerCommandList = 256;
 
 public:
 	void Init(EngineCfg const& settings, GameCfg const& game_settings, cli::CommandLine const& cmdline);
@@ -294,8 +269,28 @@ private:
 
 	Math::Frustum get_cascade_frustum(shared_ptr<RenderWorldCamera> const& camera, u32 cascade, u32 num_cascades) const;
 
-	// Helper to setup the render state based on material
-    void setup_renderstate(RenderContext& ctx, GraphicsResourceHandle vertexLayout, VertexLayoutFlags flags, MaterialInstance const* material, ViewParams const& params);
+	// Draws of a single pass, generated and recorded on the job system and replayed on the graphics thread
+	struct DrawList
+	{
+		std::vector<DrawCall> draw_calls;
+
+		// First draw call of every visible instance
+		std::vector<u32> offsets;
+
+		// Draw calls in submission order, sorted on their state
+		std::vector<DrawSortItem> items;
+		std::vector<DrawSortItem> scratch;
+
+		std::vector<DrawBatch> batches;
+		std::vector<CommandList> commands;
+	};
+
+	// Generates, sorts and records the draws of a pass on the job system. Doesn't touch the render context.
+	void BuildDrawList(RenderWorld const& world, ViewParams const& params, DrawList& list);
+	void SubmitDrawList(RenderContext& ctx, RenderWorld const& world, ViewParams const& params, DrawList const& list);
+
+	// Binds the resources shared by every draw in a pass
+	void setup_pass_resources(RenderContext& ctx, ViewParams const& params);
 
 	// Rendering
 	void render_post_predebug(RenderContext& ctx);
@@ -304,7 +299,12 @@ private:
 	struct PerfStats
 	{
 		u32 n_draws;
+		u32 n_instances;
 		u32 n_primitives;
+
+		// Buffer and material binds issued and skipped because the previous draw already bound the same state
+		u32 n_state_changes;
+		u32 n_state_changes_skipped;
 	};
 	PerfStats const& get_stats() const { return m_FrameStats; }
 
@@ -360,6 +360,9 @@ private:
 	GraphicsResourceHandle _debug_shadow_map_srv[MAX_CASCADES];
 
 	std::unique_ptr<GPUStructuredBuffer> _light_buffer;
+
+	// Per instance transforms of every draw in a pass, grows when a pass draws more instances
+	std::unique_ptr<GPUStructuredBuffer> _instance_buffer;
 	std::unique_ptr<GPUByteBuffer> _tile_light_index_buffer;
 	std::unique_ptr<GPUByteBuffer> _per_tile_info_buffer;
 	std::unique_ptr<ConstantBuffer> _fplus_cb;
@@ -395,7 +398,8 @@ private:
 
 	std::unique_ptr<class VisibilityManager> m_Visibility;
 
-	std::vector<DrawCall> m_DrawCalls;
+	// Draw lists of every pass, the zprepass and opaque pass draw the same instances with different keys
+	std::array<DrawList, RenderPass::Post> m_DrawLists;
 
 	// State tracking
 	struct 
@@ -26,6 +26,8 @@ void RendererDebugTool::RenderOverlay()
 
 void RendererDebugTool::Render3D(RenderContext& ctx)
 {
+	// DirectXTK batches need a device context
+#ifndef USE_NULL_RHI
 	if (!_batch)
 	{
 		_batch = std::make_shared<DirectX::PrimitiveBatch<DirectX::VertexPositionColor>>(ctx.m_Context);
@@ -56,7 +58,7 @@ void RendererDebugTool::Render3D(RenderContext& ctx)
 	Debug::DrawRay(_batch.get(), float4(0.0f), float4(0.0f, 1.0f, 0.0f, 0.0f), true, float4(0.0f, 1.0f, 0.0f, 1.0f));
 	Debug::DrawRay(_batch.get(), float4(0.0f), float4(0.0f, 0.0f, 1.0f, 0.0f), true, float4(0.0f, 0.0f, 1.0f, 1.0f));
 
-	RenderWorld const& world = GetGlobalContext()->m_GraphicsThread->m_FrameData.m_RenderWorld;
+	RenderWorld const& world = GetGlobalContext()->m_GraphicsThread->GetRenderFrame().m_RenderWorld;
 
 	// Visualize camera frustums
 	{
@@ -175,6 +177,7 @@ void RendererDebugTool::Render3D(RenderContext& ctx)
 	}
 
 	_batch->End();
+#endif
 }
 
 void RendererDebugTool::render_shader_tool()
@@ -223,6 +226,10 @@ void RendererDebugTool::render_debug_tool()
 
 		ImGui::Checkbox("Enable Shadow Debug", &_show_shadow_debug);
 		ImGui::Checkbox("Force All Visible", &s_force_all_visible);
+		ImGui::Checkbox("Enable Instancing", &Graphics::s_EnableInstancing);
+		ImGui::Checkbox("Enable LODs", &Graphics::s_EnableLods);
+		ImGui::SliderFloat("LOD Error (px)", &Graphics::s_LodErrorThreshold, 0.25f, 16.0f);
+		ImGui::SliderFloat("Shadow LOD Bias", &Graphics::s_ShadowLodBias, 1.0f, 16.0f);
 
 		if (ImGui::Button("Toggle Debug Cam"))
 		{
@@ -249,8 +256,9 @@ void RendererDebugTool::render_debug_tool()
 		}
 
 		ImGui::Text("Active Camera: %d", _renderer->_active_cam);
-		ImGui::Text("Draws: %d", _renderer->get_stats().n_draws);
+		ImGui::Text("Draws: %d (instances %d)", _renderer->get_stats().n_draws, _renderer->get_stats().n_instances);
 		ImGui::Text("Primitives: %d", _renderer->get_stats().n_primitives);
+		ImGui::Text("State changes: %d (skipped %d)", _renderer->get_stats().n_state_changes, _renderer->get_stats().n_state_changes_skipped);
 
 		//ImVec2 current_size = ImGui::GetContentRegionAvail();
 		//for (u32 i = 0; i < MAX_CASCADES; ++i)
@@ -17,6 +17,7 @@ Shader::Shader(ShaderStage type, const u8* byte_code, uint32_t size, const char*
 {
 	// #TODO: Replace with RI
 	// Think about dx12 and pipeline based APIs, these require shaders to be specified as part of the PSO
+#ifndef USE_NULL_RHI
     ComPtr<ID3D11Device> ri = GetRI()->Dx11GetDevice();
 	switch (type)
 	{
@@ -32,6 +33,7 @@ Shader::Shader(ShaderStage type, const u8* byte_code, uint32_t size, const char*
 		default:
 			throw new std::exception("ShaderType not supported!");
 	}
+#endif
 
 	if(m_Shader)
 	{
@@ -50,17 +52,24 @@ Shader::Shader(ShaderStage type, const u8* byte_code, uint32_t size, const char*
 		VertexLayoutFlags flags = VertexLayoutFlags(0);
 
 		std::vector<D3D11_INPUT_ELEMENT_DESC> inputs{};
-		inputs.resize(params);
+		inputs.reserve(params);
 		for(u32 i = 0; i < params; ++i)
 		{
 			D3D11_SIGNATURE_PARAMETER_DESC paramDesc{};
 			m_Reflection->GetInputParameterDesc(i, &paramDesc);
-			
-			inputs[i].SemanticName = paramDesc.SemanticName;
-			inputs[i].SemanticIndex = paramDesc.SemanticIndex;
-			inputs[i].InputSlot = D3D11_INPUT_PER_VERTEX_DATA;
-			inputs[i].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-			inputs[i].InstanceDataStepRate = 0;
+
+			// System generated inputs like SV_InstanceID are not fetched from the vertex buffer
+			if (paramDesc.SystemValueType == D3D_NAME_INSTANCE_ID || paramDesc.SystemValueType == D3D_NAME_VERTEX_ID)
+			{
+				continue;
+			}
+
+			D3D11_INPUT_ELEMENT_DESC& input = inputs.emplace_back();
+			input.SemanticName = paramDesc.SemanticName;
+			input.SemanticIndex = paramDesc.SemanticIndex;
+			input.InputSlot = D3D11_INPUT_PER_VERTEX_DATA;
+			input.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+			input.InstanceDataStepRate = 0;
 
 			// Determine the right vertex layout flags for this shader
 			if(strstr(paramDesc.SemanticName, "SV_Position"))
@@ -91,16 +100,16 @@ Shader::Shader(ShaderStage type, const u8* byte_code, uint32_t size, const char*
 			{
 				if(paramDesc.Mask == 0b1111)
 				{
-					inputs[i].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+					input.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
 				}
 				if(paramDesc.Mask == 0b111)
 				{
-					inputs[i].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+					input.Format = DXGI_FORMAT_R32G32B32_FLOAT;
 				}
 
 				if (paramDesc.Mask == 0b0011)
 				{
-					inputs[i].Format = DXGI_FORMAT_R32G32_FLOAT;
+					input.Format = DXGI_FORMAT_R32G32_FLOAT;
 				
 				}
 			}
@@ -108,7 +117,7 @@ Shader::Shader(ShaderStage type, const u8* byte_code, uint32_t size, const char*
 			{
 				if(paramDesc.Mask == 0b1)
 				{
-					inputs[i].Format = DXGI_FORMAT_R32_UINT;
+					input.Format = DXGI_FORMAT_R32_UINT;
 				}
 			}
             else
@@ -7,20 +7,66 @@
 namespace ShaderCompiler
 {
 
+namespace
+{
+
+// Resolves #include relative to the including file through the VFS so shaders loaded from a pack find their neighbours
+class VfsInclude final : public ID3DInclude
+{
+public:
+	VfsInclude(std::string_view path, void const* source)
+	{
+		_root = get_directory(path);
+		_directories[source] = _root;
+	}
+
+	HRESULT __stdcall Open(D3D_INCLUDE_TYPE, LPCSTR file_name, LPCVOID parent_data, LPCVOID* data, UINT* bytes) override
+	{
+		auto it = _directories.find(parent_data);
+		std::string path = (it != _directories.end() ? it->second : _root) + file_name;
+
+		IO::IMappedFileRef file = IO::get()->MapFile(path.c_str());
+		if (!file)
+		{
+			return E_FAIL;
+		}
+
+		Span<u8 const> source = file->get_data();
+		_directories[source.begin()] = get_directory(path);
+		_files.push_back(file);
+
+		*data = source.begin();
+		*bytes = static_cast<UINT>(source.size());
+		return S_OK;
+	}
+
+	// The mappings stay alive until the whole shader is preprocessed
+	HRESULT __stdcall Close(LPCVOID) override
+	{
+		return S_OK;
+	}
+
+private:
+	static std::string get_directory(std::string_view path)
+	{
+		return std::string(path.substr(0, path.find_last_of("/\\") + 1));
+	}
+
+	std::string _root;
+	std::unordered_map<void const*, std::string> _directories;
+	std::vector<IO::IMappedFileRef> _files;
+};
+
+} // namespace
+
 bool compile(const char* shader, CompileParameters const& parameters, std::vector<u8>& bytecode)
 {
 	LOG_VERBOSE(Graphics, "[SHDRCMP] {}", shader);
 
 	auto io = IO::get();
-	if (IO::IFileRef file = io->OpenFile(shader, IO::Mode::Read); file)
+	if (IO::IMappedFileRef file = io->MapFile(shader); file)
 	{
-		file->seek(0, IO::SeekMode::FromEnd);
-		u64 file_size = file->tell();
-		file->seek(0, IO::SeekMode::FromBeginning);
-
-		char* data = (char*)malloc(file_size + 1);
-		memset(data, 0, file_size + 1);
-		u32 bytes_read = file->read(data, (u32)file_size);
+		Span<u8 const> source = file->get_data();
 
 		std::vector<D3D_SHADER_MACRO> defines = {};
 
@@ -63,9 +109,13 @@ bool compile(const char* shader, CompileParameters const& parameters, std::vecto
 		std::string target = get_target(parameters.stage);
 
 
+		// Resource paths can live in a pack, the standard include handler only knows about loose files
+		VfsInclude vfs_include{ shader, source.begin() };
+		ID3DInclude* include = std::string_view(shader).starts_with("res:") ? &vfs_include : D3D_COMPILE_STANDARD_FILE_INCLUDE;
+
 		ComPtr<ID3DBlob> preprocessedData;
 		ComPtr<ID3DBlob> errorData;
-		HRESULT result = D3DPreprocess(data, bytes_read, shader, macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE, preprocessedData.ReleaseAndGetAddressOf(), errorData.ReleaseAndGetAddressOf());
+		HRESULT result = D3DPreprocess(source.begin(), source.size(), shader, macros.data(), include, preprocessedData.ReleaseAndGetAddressOf(), errorData.ReleaseAndGetAddressOf());
 		if(FAILED(result))
 		{
 
@@ -76,7 +126,6 @@ bool compile(const char* shader, CompileParameters const& parameters, std::vecto
 			}
 
 			LOG_ERROR(Graphics, "Shader preprocess failed with the following message: {}", messages);
-			free(data);
 			return false;
 		}
 
@@ -88,7 +137,6 @@ bool compile(const char* shader, CompileParameters const& parameters, std::vecto
 		//}
 
 		result = D3DCompile(preprocessedData->GetBufferPointer(), preprocessedData->GetBufferSize(), shader, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, entry_point.c_str(), target.c_str(), static_cast<u32>(parameters.flags), static_cast<u32>(parameters.effect_flags), &shadercode_result, &errors);
-		free(data);
 
 		if (FAILED(result))
 		{
@@ -76,6 +76,18 @@ void GPUByteBuffer::unmap(RenderContext& ctx)
 	_mapped = {};
 }
 
+GPUStructuredBuffer::~GPUStructuredBuffer()
+{
+	// Buffers are recreated when they need to grow, release the views before the buffer
+	for (GraphicsResourceHandle* handle : { &_srv, &_uav, &_buffer })
+	{
+		if (*handle)
+		{
+			GetRI()->ReleaseResource(*handle);
+		}
+	}
+}
+
 std::unique_ptr<GPUStructuredBuffer> GPUStructuredBuffer::create(RenderInterface* device, size_t struct_size_bytes, size_t element_count, bool cpu_write, BufferUsage buffer_usage)
 {
 	// #TODO: Expose bind flags as an API to create srv or uav
@@ -109,6 +121,9 @@ std::unique_ptr<GPUStructuredBuffer> GPUStructuredBuffer::create(RenderInterface
 
 	unique_ptr<GPUStructuredBuffer> result = std::make_unique<GPUStructuredBuffer>();
     result->_buffer = device->CreateBuffer(desc, nullptr);
+	result->_size_bytes = struct_size_bytes * element_count;
+	result->_struct_size_bytes = struct_size_bytes;
+	result->_element_count = element_count;
 
 	if(bind_flags & D3D11_BIND_SHADER_RESOURCE)
 	{
@@ -137,12 +152,10 @@ std::unique_ptr<GPUStructuredBuffer> GPUStructuredBuffer::create(RenderInterface
 
 void* GPUStructuredBuffer::map(RenderContext& ctx)
 {
-	//ctx->Map(_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &_mapped);
-	return _mapped.pData;
+	return ctx.Map(_buffer);
 }
 
 void GPUStructuredBuffer::unmap(RenderContext& ctx)
 {
-	//ctx->Unmap(_buffer.Get(), 0);
-	_mapped = {};
+	ctx.Unmap(_buffer);
 }
@@ -41,7 +41,7 @@ class GPUStructuredBuffer final : public IGPUBuffer
 public:
 
 	GPUStructuredBuffer(){};
-	~GPUStructuredBuffer() {}
+	~GPUStructuredBuffer();
 
 	static std::unique_ptr<GPUStructuredBuffer> create(RenderInterface* device, size_t struct_size_bytes, size_t element_count, bool cpu_write = false, BufferUsage usage = BufferUsage::Default);
 
@@ -54,16 +54,16 @@ public:
 	GraphicsResourceHandle const& get_srv() const override { return _srv; }
 	GraphicsResourceHandle const& get_uav() const override { return _uav; };
 
+	size_t get_element_count() const { return _element_count; }
 
 private:
-	D3D11_MAPPED_SUBRESOURCE _mapped;
-
 	GraphicsResourceHandle _buffer;
 	GraphicsResourceHandle _srv;
 	GraphicsResourceHandle _uav;
 
 	size_t _size_bytes;
 	size_t _struct_size_bytes;
+	size_t _element_count;
 
 };
 
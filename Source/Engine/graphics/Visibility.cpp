@@ -3,58 +3,201 @@
 #include "RenderWorld.h"
 #include "RendererDebug.h"
 
+#include <cfloat>
+#include <xmmintrin.h>
+
 void VisibilityManager::reset()
 {
 	_all_instances.clear();
+	_sphere_instances.clear();
+	_center_x.clear();
+	_center_y.clear();
+	_center_z.clear();
+	_radius.clear();
 	for(u32 f = 0; f < VisibilityFrustum_Count; ++f )
 	{
+		_visible_indices[f].clear();
 		_visible_instances[f].clear();
+		_bvh_results[f].clear();
 	}
 }
 
 void VisibilityManager::add_instance(RenderWorldInstance* inst)
 {
+	inst->_visibility_index = u32(_all_instances.size());
 	_all_instances.push_back(inst);
 }
 
-void VisibilityManager::run(VisibilityParams const& params)
+void VisibilityManager::run(VisibilityParams const& params, BoundingVolumeHierarchy const* bvh)
 {
 	JONO_EVENT();
 
+	u32 const n_instances = u32(_all_instances.size());
 	for(u32 f = 0; f < VisibilityFrustum_Count; ++f )
 	{
-		_visible_instances[f].reserve(_all_instances.size());
+		_visible_indices[f].reserve(n_instances);
+		_visible_instances[f].reserve(n_instances);
+	}
 
-		for (RenderWorldInstance* inst : _all_instances)
+	if (Graphics::RendererDebugTool::s_force_all_visible)
+	{
+		for (u32 f = 0; f < VisibilityFrustum_Count; ++f)
 		{
-			bool is_visible = true;
+			for (u32 i = 0; i < n_instances; ++i)
+			{
+				_visible_indices[f].push_back(i);
+			}
+			_visible_instances[f] = _all_instances;
+		}
+		return;
+	}
 
-			// Do visibility check
-			Math::AABB box = inst->_model->get()->get_bounding_box();
+	// Instances in the BVH are culled by the tree, the rest falls back to testing their bounding spheres
+	for (u32 i = 0; i < n_instances; ++i)
+	{
+		RenderWorldInstance* inst = _all_instances[i];
+		if (bvh && inst->_bvh_proxy != BoundingVolumeHierarchy::c_InvalidProxy)
+		{
+			continue;
+		}
 
-			// #TODO: Technically this is *correct* but for some reason instances still get culled to early on the left of the frustum
-			float3 radius = box.size() / 2.0f;
+		Math::Sphere sphere = Math::compute_bounding_sphere(inst->_model->get()->get_bounding_box(), inst->_transform);
+
+		_sphere_instances.push_back(i);
+		_center_x.push_back(sphere.center.x);
+		_center_y.push_back(sphere.center.y);
+		_center_z.push_back(sphere.center.z);
+		_radius.push_back(sphere.radius);
+	}
+
+	// Pad to a full SIMD lane, the padding spheres fail every plane test
+	u32 const n_spheres = u32(_sphere_instances.size());
+	while (_radius.size() % 4 != 0)
+	{
+		_center_x.push_back(0.0f);
+		_center_y.push_back(0.0f);
+		_center_z.push_back(0.0f);
+		_radius.push_back(-FLT_MAX);
+	}
 
-			// For now just do position checking of the instance
-			float3 inst_position = inst->_transform._41_42_43;
-			float3 bounding_box_center = inst->_model->get()->get_bounding_box().center();
-			inst_position += bounding_box_center;
+	std::array<Math::Frustum::PlanesSoA, VisibilityFrustum_Count> planes;
+	for (u32 f = 0; f < VisibilityFrustum_Count; ++f)
+	{
+		planes[f] = params.frustum[f].get_planes_soa();
+	}
 
-			radius = hlslpp::mul(inst->_transform, float4(radius, 0.0f)).xyz;
+	u32 const n_jobs = (n_spheres + c_InstancesPerJob - 1) / c_InstancesPerJob;
+	_job_results.resize(std::max(n_jobs, 1u));
+	for (VisibleIndices& result : _job_results)
+	{
+		for (std::vector<u32>& indices : result)
+		{
+			indices.clear();
+		}
+	}
 
-			// Do visibility test against the frustum using a sphere.
-			is_visible = Math::test_frustum_sphere(params.frustum[f], inst_position, radius.x);
+	{
+		JONO_EVENT("CullJobs");
+		Tasks::JobSystem* scheduler = Tasks::get_scheduler();
+		Tasks::JobCounter counter{};
 
-			if (Graphics::RendererDebugTool::s_force_all_visible)
+		// Every frustum walks the tree in its own job
+		if (bvh)
+		{
+			for (u32 f = 0; f < VisibilityFrustum_Count; ++f)
 			{
-				is_visible = true;
+				scheduler->run([this, bvh, &params, f]()
+				{
+					bvh->query(params.frustum[f], _bvh_results[f]);
+				}, &counter);
 			}
+		}
 
-			if (is_visible)
+		if (n_jobs > 1)
+		{
+			scheduler->parallel_for(n_spheres, c_InstancesPerJob, [this, &planes](u32 begin, u32 end)
 			{
-				_visible_instances[f].push_back(inst);
+				cull_range(planes, begin, end, _job_results[begin / c_InstancesPerJob]);
+			}, &counter);
+		}
+		else
+		{
+			cull_range(planes, 0, n_spheres, _job_results[0]);
+		}
+		scheduler->wait(counter);
+	}
+
+	for (VisibleIndices const& result : _job_results)
+	{
+		for (u32 f = 0; f < VisibilityFrustum_Count; ++f)
+		{
+			_visible_indices[f].insert(_visible_indices[f].end(), result[f].begin(), result[f].end());
+		}
+	}
+
+	if (bvh)
+	{
+		for (u32 f = 0; f < VisibilityFrustum_Count; ++f)
+		{
+			// The tree contains instances that weren't added this frame (e.g. not finalised yet), skip those
+			for (void* user_data : _bvh_results[f])
+			{
+				RenderWorldInstance* inst = (RenderWorldInstance*)user_data;
+				u32 idx = inst->_visibility_index;
+				if (idx < n_instances && _all_instances[idx] == inst)
+				{
+					_visible_indices[f].push_back(idx);
+				}
 			}
+
+			// Keep the output in the order the instances were added
+			std::sort(_visible_indices[f].begin(), _visible_indices[f].end());
 		}
 	}
 
+	for (u32 f = 0; f < VisibilityFrustum_Count; ++f)
+	{
+		for (u32 idx : _visible_indices[f])
+		{
+			_visible_instances[f].push_back(_all_instances[idx]);
+		}
+	}
+}
+
+void VisibilityManager::cull_range(std::array<Math::Frustum::PlanesSoA, VisibilityFrustum_Count> const& planes, u32 begin, u32 end, VisibleIndices& result) const
+{
+	JONO_EVENT();
+
+	// 'begin' is always a multiple of 4 and the bounds are padded, so the last block can safely read past 'end'
+	for (u32 i = begin; i < end; i += 4)
+	{
+		__m128 const cx = _mm_loadu_ps(&_center_x[i]);
+		__m128 const cy = _mm_loadu_ps(&_center_y[i]);
+		__m128 const cz = _mm_loadu_ps(&_center_z[i]);
+		__m128 const r = _mm_loadu_ps(&_radius[i]);
+
+		for (u32 f = 0; f < VisibilityFrustum_Count; ++f)
+		{
+			Math::Frustum::PlanesSoA const& frustum = planes[f];
+
+			__m128 outside = _mm_setzero_ps();
+			for (u32 p = 0; p < Math::Frustum::FrustumPlane_Count; ++p)
+			{
+				__m128 dist = _mm_mul_ps(cx, _mm_set1_ps(frustum.nx[p]));
+				dist = _mm_add_ps(dist, _mm_mul_ps(cy, _mm_set1_ps(frustum.ny[p])));
+				dist = _mm_add_ps(dist, _mm_mul_ps(cz, _mm_set1_ps(frustum.nz[p])));
+				dist = _mm_add_ps(dist, _mm_set1_ps(frustum.d[p]));
+				outside = _mm_or_ps(outside, _mm_cmpgt_ps(dist, r));
+			}
+
+			u32 visible = ~u32(_mm_movemask_ps(outside)) & 0xF;
+			for (u32 lane = 0; visible != 0; ++lane, visible >>= 1)
+			{
+				if ((visible & 1) && i + lane < end)
+				{
+					result[f].push_back(_sphere_instances[i + lane]);
+				}
+			}
+		}
+	}
 }
@@ -2,6 +2,7 @@
 #include "Core/Math.h"
 
 class RenderWorldInstance;
+class BoundingVolumeHierarchy;
 
 enum VisibilityFrustum
 {
@@ -28,17 +29,42 @@ public:
 	VisibilityManager(VisibilityManager const&) = delete;
 	VisibilityManager& operator=(VisibilityManager const&) = delete;
 
+	// Number of instances culled by a single job
+	static constexpr u32 c_InstancesPerJob = 1024;
+
 	void reset();
 	void add_instance(RenderWorldInstance* inst);
-	void run(VisibilityParams const&);
+
+	// Culls all added instances. Instances that are part of the BVH are culled hierarchically, the others are tested one by one.
+	void run(VisibilityParams const&, BoundingVolumeHierarchy const* bvh = nullptr);
 
 	std::vector<RenderWorldInstance*> const& get_visible_instances(VisibilityFrustum frustum = VisiblityFrustum_Main) const { return _visible_instances[frustum]; }
 
+	// Indices of the visible instances in the order they were added
+	std::vector<u32> const& get_visible_indices(VisibilityFrustum frustum = VisiblityFrustum_Main) const { return _visible_indices[frustum]; }
+
 private:
+	using VisibleIndices = std::array<std::vector<u32>, VisibilityFrustum_Count>;
+
+	// A sphere is outside when dot(n, center) + d > radius for any plane
+	void cull_range(std::array<Math::Frustum::PlanesSoA, VisibilityFrustum_Count> const& planes, u32 begin, u32 end, VisibleIndices& result) const;
 
 	// All instances in the world
 	std::vector<RenderWorldInstance*> _all_instances;
 
+	// World space bounding spheres of the instances that aren't in the BVH as SoA, padded to a multiple of 4 with spheres that are always culled
+	std::vector<u32> _sphere_instances;
+	std::vector<f32> _center_x;
+	std::vector<f32> _center_y;
+	std::vector<f32> _center_z;
+	std::vector<f32> _radius;
+
+	// Output of every job, merged in order once all jobs have finished
+	std::vector<VisibleIndices> _job_results;
+	std::array<std::vector<void*>, VisibilityFrustum_Count> _bvh_results;
+
+	std::array<std::vector<u32>, VisibilityFrustum_Count> _visible_indices;
+
 	// Visible instances in the main opaque pass
 	std::array<std::vector<RenderWorldInstance*>, VisibilityFrustum_Count> _visible_instances;
 
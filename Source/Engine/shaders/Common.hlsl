@@ -1,6 +1,7 @@
 #ifndef _COMMON_HLSL_
 #define _COMMON_HLSL_
 #include "CommonShared.h"
+#include "VertexDecode.hlsl"
 
 #define LIGHTING_MODEL_BLINN_PHONG 1
 #define LIGHTING_MODEL_PHONG 2
@@ -21,11 +22,12 @@
 struct VS_IN
 {
 	float3 position : SV_Position;
-	float3 normal   : NORMAL0;
+	// Octahedral encoded
+	float2 normal   : NORMAL0;
 
 #ifdef _USE_TANGENTS
-	float3 tangent : TANGENT0;
-	float3 bitangent : TANGENT1;
+	float2 tangent : TANGENT0;
+	float2 bitangent : TANGENT1;
 #endif
 
 #ifdef _USE_UV0
@@ -30,11 +30,11 @@ cbuffer DebugCB : CB_SLOT(Buffer_Debug)
 
 cbuffer ModelConstants : CB_SLOT(Buffer_Model)
 {
-	float4x4 World;
-	float4x4 WorldView;
-	float4x4 WorldViewProjection;
+	uint g_InstanceOffset; // First instance of the current draw in g_Instances
 };
 
+StructuredBuffer<InstanceData> g_Instances : SRV_SLOT(Texture_Instances);
+
 // Default Samplers
 SamplerState g_all_linear_sampler : SAMPLER_SLOT(Sampler_Linear);
 SamplerState g_point_sampler : SAMPLER_SLOT(Sampler_Point);
@@ -17,6 +17,7 @@
 #define Texture_Lights 8
 #define Texture_ForwardPlusPerTileLightIndex 9
 #define Texture_ForwardPlusTileInfo 10 
+#define Texture_Instances 11
 
 #define Sampler_Linear 0
 #define Sampler_Point 1
@@ -63,6 +64,14 @@ struct DirectionalLightInfo
 	int num_cascades;
 };
 
+// Per instance transforms, instanced draws index these with g_InstanceOffset + SV_InstanceID
+struct InstanceData
+{
+	mat4x4 world;
+	mat4x4 world_view;
+	mat4x4 world_view_projection;
+};
+
 struct Viewport_t
 {
 	float HalfWidth;
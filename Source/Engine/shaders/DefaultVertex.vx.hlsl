@@ -2,10 +2,15 @@
 
 #ifdef _VERTEX
 
-VS_OUT main(VS_IN vin)
+VS_OUT main(VS_IN vin, uint instance_id : SV_InstanceID)
 {
 	VS_OUT vout = (VS_OUT)(0);
 
+	InstanceData instance = g_Instances[g_InstanceOffset + instance_id];
+	float4x4 World = instance.world;
+	float4x4 WorldView = instance.world_view;
+	float4x4 WorldViewProjection = instance.world_view_projection;
+
 	vout.position = mul(WorldViewProjection, float4(vin.position,1.0));
 #ifdef _USE_COLOUR
 	vout.colour = vin.colour;
@@ -18,13 +23,14 @@ VS_OUT main(VS_IN vin)
 	vout.worldPosition  = mul(World, float4(vin.position, 1.0));
 	vout.viewPosition   = mul(WorldView, float4(vin.position, 1.0));
 
-	vout.normal 		= float4(vin.normal.xyz, 1.0);
-	vout.viewNormal     = mul(WorldView, float4(vin.normal.xyz, 0.0));
-	vout.worldNormal    = mul(World, float4(vin.normal.xyz, 0.0));
+	float3 normal = decode_octahedral(vin.normal);
+	vout.normal 		= float4(normal, 1.0);
+	vout.viewNormal     = mul(WorldView, float4(normal, 0.0));
+	vout.worldNormal    = mul(World, float4(normal, 0.0));
 
 #ifdef _USE_TANGENTS
-	vout.worldTangent   = mul(World, float4(vin.tangent.xyz, 0.0f));
-	vout.worldBitangent = mul(World, float4(vin.bitangent.xyz, 0.0f));
+	vout.worldTangent   = mul(World, float4(decode_octahedral(vin.tangent), 0.0f));
+	vout.worldBitangent = mul(World, float4(decode_octahedral(vin.bitangent), 0.0f));
 #endif
 
 	return vout;
@@ -1,3 +1,5 @@
+#include "VertexDecode.hlsl"
+
 struct VS_OUT
 {
 	float4 position : SV_Position;
@@ -12,33 +14,46 @@ struct VS_OUT
 struct VS_IN
 {
 	float3 position : SV_Position;
-	float3 normal : NORMAL0;
+	float2 normal : NORMAL0;
 };
 
 
 #ifdef _VERTEX
 
+struct InstanceData
+{
+	float4x4 world;
+	float4x4 world_view;
+	float4x4 world_view_projection;
+};
+
 cbuffer ModelConstants : register(b2)
 {
-	float4x4 World;
-	float4x4 WorldView;
-	float4x4 WorldViewProjection;
+	uint g_InstanceOffset;
 };
 
-VS_OUT main(VS_IN vin)
+StructuredBuffer<InstanceData> g_Instances : register(t11);
+
+VS_OUT main(VS_IN vin, uint instance_id : SV_InstanceID)
 {
 	VS_OUT vout = (VS_OUT)(0);
 
+	InstanceData instance = g_Instances[g_InstanceOffset + instance_id];
+	float4x4 World = instance.world;
+	float4x4 WorldView = instance.world_view;
+	float4x4 WorldViewProjection = instance.world_view_projection;
+
 	// Calculate the world position 
 	float4 worldPosition = mul(World, float4(vin.position, 1.0));
 
 	vout.position = mul(WorldViewProjection, float4(vin.position,1.0));
-	vout.normal = float4(vin.normal, 1.0);
+	float3 normal = decode_octahedral(vin.normal);
+	vout.normal = float4(normal, 1.0);
 	vout.worldPosition  = mul(World, float4(vin.position, 1.0));
 	vout.viewPosition   = mul(WorldView, float4(vin.position, 1.0));
 
-	vout.viewNormal     = mul(WorldView, float4(vin.normal, 0.0));
-	vout.worldNormal    = mul(World, float4(vin.normal, 0.0));
+	vout.viewNormal     = mul(WorldView, float4(normal, 0.0));
+	vout.worldNormal    = mul(World, float4(normal, 0.0));
 
 	return vout;
 }
@@ -181,7 +181,7 @@ float4 EvaluateLighting(Material material, VS_OUT vout)
 		float3 light = -normalize(g_Lights[i].direction);
 		float3 light_colour = g_Lights[i].colour;
 
-		float4 proj_pos = mul(WorldViewProjection, vout.worldPosition);
+		float4 proj_pos = mul(Projection, vout.viewPosition);
 		float4 shadow = compute_shadow(vout.worldPosition, vout.viewPosition, proj_pos, g_Lights[i], normal);
 	#ifdef DEBUG_SHADOW
 		final_colour = shadow;
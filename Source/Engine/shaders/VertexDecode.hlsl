@@ -0,0 +1,13 @@
+#ifndef _VERTEX_DECODE_HLSL_
+#define _VERTEX_DECODE_HLSL_
+
+// Decodes the octahedral normals and tangents of packed vertex streams (see VertexFormat.h)
+float3 decode_octahedral(float2 e)
+{
+	float3 n = float3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	float t = saturate(-n.z);
+	n.xy += n.xy >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
+#endif
@@ -1,16 +1,14 @@
 #include "Graphics.pch.h"
-#include "GlobalContext.h"
-#include "RenderInterface.h"
 
+// The D3D11 backend is still compiled alongside the null backend on Windows so both types stay registered
+#ifdef USE_DX11
+
+#include "RenderInterface.h"
+#include "Dx11RenderInterface.h"
 
 REGISTER_TYPE("/Types/Dx11RenderInterface", Dx11RenderInterface);
 SERIALIZE_FN(Dx11RenderInterface) {}
 
-RenderInterface* GetRI()
-{
-    return reinterpret_cast<RenderInterface*>(GetGlobalContext()->m_RenderInterface);
-}
-
 namespace Helpers
 {
 inline void SetDebugObjectName(ID3D11DeviceChild* obj, std::string_view const& name)
@@ -631,3 +629,5 @@ void Dx11RenderContext::DebugSetMarker(std::string_view name)
     sTmpString = std::wstring(name.begin(), name.end());
     owner->m_UserDefinedAnnotations->SetMarker(sTmpString.c_str());
 }
+
+#endif
@@ -4,81 +4,14 @@
 #include "Core/Containers.h"
 
 #include "GraphicsResourceHandle.h"
+#include "RenderTypes.h"
 #include "ShaderStage.h"
 
-using BufferDesc          = D3D11_BUFFER_DESC;
-using SubresourceData = D3D11_SUBRESOURCE_DATA;
-using SrvDesc             = D3D11_SHADER_RESOURCE_VIEW_DESC;
-using UavDesc             = D3D11_UNORDERED_ACCESS_VIEW_DESC;
-using DsvDesc             = D3D11_DEPTH_STENCIL_VIEW_DESC;
-using InputLayoutDesc     = std::vector<D3D11_INPUT_ELEMENT_DESC>;
-using SamplerStateDesc    = D3D11_SAMPLER_DESC;
-using RasterizerStateDesc = D3D11_RASTERIZER_DESC;
-using BlendStateDesc      = D3D11_BLEND_DESC;
-using DepthStencilDesc    = D3D11_DEPTH_STENCIL_DESC;
-using Texture1DDesc       = D3D11_TEXTURE1D_DESC;
-using Texture2DDesc       = D3D11_TEXTURE2D_DESC;
-using Texture3DDesc       = D3D11_TEXTURE3D_DESC;
-using RtvDesc = D3D11_RENDER_TARGET_VIEW_DESC;
-using SwapChainDesc = DXGI_SWAP_CHAIN_DESC;
-
-
-struct Viewport
-{
-    Viewport() = default;
-
-    Viewport(float x, float y, float width, float height)
-        : x(x), y(y), width(width), height(height), minZ(0.0f), maxZ(1.0f)
-    {
-    
-    }
-    float x;
-    float y;
-    float width;
-    float height;
-    float minZ;
-    float maxZ;
-};
-
-template<typename T>
-struct TRect
-{
-    T topLeftX;
-    T topLeftY;
-    T bottomRightX;
-    T bottomRightY;
-};
-
-using Rect = TRect<u32>;
-using RectF32 = TRect<f32>;
-
-struct ComputeItem
-{
-    Array<GraphicsResourceHandle> srvs;
-    Array<GraphicsResourceHandle> uavs;
-    Array<GraphicsResourceHandle> cbs;
-
-    ID3D11ComputeShader* shader = nullptr;
-
-    uint32_t dispatchX = 1;
-    uint32_t dispatchY = 1;
-    uint32_t dispatchZ = 1;
-};
-
-
 namespace Graphics
 {
 class Renderer;
 };
 
-enum class PrimitiveTopology
-{
-    TriangleList,
-    TriangleStrip,
-    LineList,
-    LineStrip
-};
-
 inline D3D11_PRIMITIVE_TOPOLOGY Dx11GetPrimitiveTopology(PrimitiveTopology topology)
 {
     switch(topology)
@@ -119,6 +52,7 @@ struct Dx11RenderContext
     inline void OMSetBlendState(GraphicsResourceHandle bs, std::array<float, 4> blendFactor = {}, uint32_t sampleMask = 0x0);
 
     inline void DrawIndexed(uint32_t indexCount, uint32_t indexOffset, uint32_t vertexOffset);  
+    inline void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t indexOffset, uint32_t vertexOffset, uint32_t instanceOffset);
     inline void Draw(uint32_t vertexCount, uint32_t vertexStartLocation);
 
     void ClearTargets(GraphicsResourceHandle rtv, GraphicsResourceHandle dsv, float4 color, uint32_t clearFlags, float depth, uint8_t stencil);
@@ -147,6 +147,11 @@ void Dx11RenderContext::DrawIndexed(uint32_t indexCount, uint32_t indexOffset, u
     m_Context->DrawIndexed((UINT)indexCount, (UINT)indexOffset, (UINT)vertexOffset);
 }
 
+void Dx11RenderContext::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t indexOffset, uint32_t vertexOffset, uint32_t instanceOffset)
+{
+    m_Context->DrawIndexedInstanced((UINT)indexCount, (UINT)instanceCount, (UINT)indexOffset, (INT)vertexOffset, (UINT)instanceOffset);
+}
+
 void Dx11RenderContext::Draw(uint32_t vertexCount, uint32_t vertexStartLocation)
 {
     m_Context->Draw(vertexCount, vertexStartLocation);
@@ -11,7 +11,12 @@
 #include "CLI/CLI.h"
 #include "CLI/CommandLine.h"
 
+// D3D11 is only available on Windows, other platforms always build the headless backend
+#ifdef WIN64
 #define USE_DX11
+#elif !defined(USE_NULL_RHI)
+#define USE_NULL_RHI
+#endif
 
 #ifdef USE_DX11
 #include <wrl.h>
@@ -0,0 +1,318 @@
+#include "Graphics.pch.h"
+#include "RenderInterface.h"
+#include "NullRenderInterface.h"
+
+REGISTER_TYPE("/Types/NullRenderInterface", NullRenderInterface);
+SERIALIZE_FN(NullRenderInterface) {}
+
+namespace
+{
+
+// Textures are assumed to use 32 bit texels, the same assumption the D3D11 backend makes for the initial data pitch
+constexpr uint64_t c_TexelSize = sizeof(uint32_t);
+
+} // namespace
+
+void NullRenderInterface::Init()
+{
+    MEMORY_TAG(MemoryCategory::Graphics);
+
+    // The slot vectors don't grow on demand, reserve the same capacity as every D3D11 resource type combined
+    m_Resources.Grow(4096);
+    m_SwapChains.Grow(1);
+
+    m_Stats = {};
+}
+
+void NullRenderInterface::Shutdown()
+{
+    m_Resources.Clear();
+    m_SwapChains.Clear();
+}
+
+GraphicsResourceHandle NullRenderInterface::Push(GraphicsResourceType type, uint64_t sizeBytes, std::string_view name)
+{
+    std::shared_ptr<NullResource> resource = std::make_shared<NullResource>();
+    resource->type = type;
+    resource->sizeBytes = sizeBytes;
+    resource->name = name;
+
+    ++m_Stats.n_resources_created;
+    m_Stats.bytes_allocated += sizeBytes;
+
+    SlotHandle h = m_Resources.Push(resource);
+    return GraphicsResourceHandle(type, h.gen, h.id);
+}
+
+NullRenderInterface::NullResource* NullRenderInterface::GetResource(GraphicsResourceHandle h) const
+{
+    ASSERT(IsAlive(h));
+    return m_Resources.Get({ h.data.id, h.data.gen }).get();
+}
+
+bool NullRenderInterface::IsAlive(GraphicsResourceHandle h) const
+{
+    if (!h)
+    {
+        return false;
+    }
+
+    SlotHandle slotHandle = { h.data.id, h.data.gen };
+    return m_Resources.Has(slotHandle) && m_Resources.Get(slotHandle)->type == h.data.type;
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateBuffer(BufferDesc const& desc, SubresourceData const* initialData, std::string_view debugName)
+{
+    GraphicsResourceHandle handle = Push(GRT_Buffer, desc.ByteWidth, debugName);
+
+    // Keep a CPU copy so mapped buffers always return valid memory
+    NullResource* resource = GetResource(handle);
+    resource->data.resize(desc.ByteWidth);
+    if (initialData && initialData->pSysMem)
+    {
+        memcpy(resource->data.data(), initialData->pSysMem, desc.ByteWidth);
+        m_Stats.bytes_uploaded += desc.ByteWidth;
+    }
+    return handle;
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateShaderResourceView(GraphicsResourceHandle srcBuffer, SrvDesc const& desc, std::string_view debugName)
+{
+    return CreateShaderResourceView(srcBuffer, debugName);
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateShaderResourceView(GraphicsResourceHandle srcBuffer, std::string_view debugName /*= ""*/)
+{
+    ASSERT(IsAlive(srcBuffer));
+    return Push(GRT_ShaderResourceView, 0, debugName);
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateUnorderedAccessView(GraphicsResourceHandle srcBuffer, UavDesc const& desc, std::string_view debugName)
+{
+    return CreateUnorderedAccessView(srcBuffer, debugName);
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateUnorderedAccessView(GraphicsResourceHandle srcBuffer, std::string_view debugName /*= ""*/)
+{
+    ASSERT(IsAlive(srcBuffer));
+    return Push(GRT_UnorderedAccessView, 0, debugName);
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateDepthStencilView(GraphicsResourceHandle srcBuffer, DsvDesc const& desc, std::string_view debugName /*= ""*/)
+{
+    ASSERT(IsAlive(srcBuffer));
+    return Push(GRT_DepthStencilView, 0, debugName);
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateInputLayout(InputLayoutDesc inputLayoutElements, void* shaderCode, uint32_t shaderCodeLength)
+{
+    return Push(GRT_InputLayout, 0, "");
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateSamplerState(SamplerStateDesc samplerStateDesc, std::string_view name /*= ""*/)
+{
+    return Push(GRT_SamplerState, 0, name);
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateRasterizerState(RasterizerStateDesc desc, std::string_view name /*= ""*/)
+{
+    return Push(GRT_RasterizerState, 0, name);
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateBlendState(BlendStateDesc desc, std::string_view name /*= ""*/)
+{
+    return Push(GRT_BlendState, 0, name);
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateDepthStencilState(DepthStencilDesc desc, std::string_view name /*= ""*/)
+{
+    return Push(GRT_DepthStencilState, 0, name);
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateTexture(Texture1DDesc const& desc, void* initialData, std::string_view name)
+{
+    uint64_t size = uint64_t(desc.Width) * desc.ArraySize * c_TexelSize;
+    if (initialData)
+    {
+        m_Stats.bytes_uploaded += size;
+    }
+    return Push(GRT_Texture, size, name);
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateTexture(Texture2DDesc const& desc, void* initialData, std::string_view name)
+{
+    uint64_t size = uint64_t(desc.Width) * desc.Height * desc.ArraySize * c_TexelSize;
+    if (initialData)
+    {
+        m_Stats.bytes_uploaded += size;
+    }
+
+    GraphicsResourceHandle handle = Push(GRT_Texture, size, name);
+    GetResource(handle)->desc2D = desc;
+    return handle;
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateTexture(Texture3DDesc const& desc, void* initialData, std::string_view name)
+{
+    uint64_t size = uint64_t(desc.Width) * desc.Height * desc.Depth * c_TexelSize;
+    if (initialData)
+    {
+        m_Stats.bytes_uploaded += size;
+    }
+    return Push(GRT_Texture, size, name);
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateRenderTargetView(GraphicsResourceHandle resource, RtvDesc const& desc, std::string_view debugName)
+{
+    return CreateRenderTargetView(resource, debugName);
+}
+
+GraphicsResourceHandle NullRenderInterface::CreateRenderTargetView(GraphicsResourceHandle resource, std::string_view debugName)
+{
+    ASSERT(IsAlive(resource));
+    return Push(GRT_RenderTargetView, 0, debugName);
+}
+
+SwapchainHandle NullRenderInterface::CreateSwapchain(SwapChainDesc const& desc, std::string_view debugName /*= ""*/)
+{
+    std::shared_ptr<NullSwapchain> swapchain = std::make_shared<NullSwapchain>();
+    swapchain->desc.Width = desc.BufferDesc.Width;
+    swapchain->desc.Height = desc.BufferDesc.Height;
+    swapchain->desc.MipLevels = 1;
+    swapchain->desc.ArraySize = 1;
+    swapchain->desc.Format = desc.BufferDesc.Format;
+    swapchain->desc.SampleDesc = desc.SampleDesc;
+    swapchain->desc.BindFlags = BindFlag_RenderTarget | BindFlag_ShaderResource;
+    CreateSwapchainBuffer(*swapchain);
+
+    auto h = m_SwapChains.Push(swapchain);
+    return SwapchainHandle(h.gen, h.id);
+}
+
+void NullRenderInterface::ReleaseSwapchain(SwapchainHandle h)
+{
+    auto slotHandle = SlotHandle(h.data.id, h.data.gen);
+    ReleaseSwapchainBuffer(*m_SwapChains.Get(slotHandle));
+    m_SwapChains.Erase(slotHandle);
+}
+
+void NullRenderInterface::Present(SwapchainHandle swapchainHandle, uint32_t syncInterval, uint32_t flags)
+{
+    ++m_Stats.n_presents;
+}
+
+void NullRenderInterface::ResizeSwapchain(SwapchainHandle swapchainHandle, uint32_t w, uint32_t h)
+{
+    auto slotHandle = SlotHandle(swapchainHandle.data.id, swapchainHandle.data.gen);
+    std::shared_ptr<NullSwapchain> const& swapchain = m_SwapChains.Get(slotHandle);
+    ASSERT(swapchain);
+
+    ReleaseSwapchainBuffer(*swapchain);
+    swapchain->desc.Width = w;
+    swapchain->desc.Height = h;
+    CreateSwapchainBuffer(*swapchain);
+}
+
+GraphicsResourceHandle NullRenderInterface::GetSwapchainBuffer(SwapchainHandle h, uint32_t buffer)
+{
+    auto slotHandle = SlotHandle(h.data.id, h.data.gen);
+    std::shared_ptr<NullSwapchain> const& swapchain = m_SwapChains.Get(slotHandle);
+    ASSERT(swapchain);
+
+    return swapchain->buffer;
+}
+
+void NullRenderInterface::CreateSwapchainBuffer(NullSwapchain& swapchain)
+{
+    swapchain.buffer = CreateTexture(swapchain.desc, nullptr, "Swapchain");
+    GetResource(swapchain.buffer)->swapchainBuffer = true;
+}
+
+void NullRenderInterface::ReleaseSwapchainBuffer(NullSwapchain& swapchain)
+{
+    if (IsAlive(swapchain.buffer))
+    {
+        ++m_Stats.n_resources_released;
+        m_Resources.Erase({ swapchain.buffer.data.id, swapchain.buffer.data.gen });
+    }
+    swapchain.buffer = GraphicsResourceHandle::Invalid();
+}
+
+Texture2DDesc NullRenderInterface::GetTexture2DDesc(GraphicsResourceHandle const& resource) const
+{
+    return GetResource(resource)->desc2D;
+}
+
+void NullRenderInterface::ReleaseResource(GraphicsResourceHandle& h)
+{
+    if (IsAlive(h) && !GetResource(h)->swapchainBuffer)
+    {
+        ++m_Stats.n_resources_released;
+        m_Resources.Erase({ h.data.id, h.data.gen });
+    }
+    h = GraphicsResourceHandle::Invalid();
+}
+
+void* NullRenderContext::Map(GraphicsResourceHandle buffer)
+{
+    NullRenderInterface::NullResource* resource = owner->GetResource(buffer);
+    ASSERT(resource->type == GRT_Buffer);
+
+    ++owner->m_Stats.n_maps;
+    return resource->data.data();
+}
+
+void NullRenderContext::Unmap(GraphicsResourceHandle buffer)
+{
+    // Only the CPU copy is written, the whole buffer counts as uploaded
+    owner->m_Stats.bytes_uploaded += owner->GetResource(buffer)->data.size();
+}
+
+void NullRenderContext::ClearTargets(GraphicsResourceHandle rtv, GraphicsResourceHandle dsv, float4 color, uint32_t clearFlags, float depth, uint8_t stencil)
+{
+}
+
+void NullRenderContext::SetTarget(GraphicsResourceHandle rtv, GraphicsResourceHandle dsv)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::ClearRenderTarget(GraphicsResourceHandle rtv, float4 color)
+{
+}
+
+void NullRenderContext::ClearDepthStencil(GraphicsResourceHandle dsv, uint32_t clearFlags, float depth, uint8_t stencil)
+{
+}
+
+void NullRenderContext::SetShaderResources(ShaderStage stage, uint32_t startSlot, Span<GraphicsResourceHandle> srvs)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::SetSamplers(ShaderStage stage, uint32_t startSlot, Span<GraphicsResourceHandle> samplers)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::SetConstantBuffers(ShaderStage stage, uint32_t startSlot, Span<GraphicsResourceHandle> buffers)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::BeginFrame()
+{
+}
+
+void NullRenderContext::EndFrame()
+{
+}
+
+void NullRenderContext::Flush()
+{
+}
+
+void NullRenderContext::ExecuteComputeItems(Span<ComputeItem> const& items)
+{
+    owner->m_Stats.n_dispatches += uint32_t(items.size());
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "Core/Array.h"
+#include "Core/Containers.h"
+
+#include "GraphicsResourceHandle.h"
+#include "RenderTypes.h"
+#include "ShaderStage.h"
+
+// Counters recorded by the null backend instead of executing anything on a GPU
+struct NullRenderStats
+{
+    // Draw and dispatch calls
+    uint32_t n_draws = 0;
+    uint32_t n_instances = 0;
+    uint64_t n_vertices = 0;
+    uint32_t n_dispatches = 0;
+
+    // Calls that bind pipeline state or resources
+    uint32_t n_state_changes = 0;
+
+    // Bytes uploaded through initial data and mapped buffers
+    uint32_t n_maps = 0;
+    uint64_t bytes_uploaded = 0;
+
+    // Resource lifetime
+    uint32_t n_resources_created = 0;
+    uint32_t n_resources_released = 0;
+    uint64_t bytes_allocated = 0;
+
+    uint32_t n_presents = 0;
+};
+
+// Headless render context, mirrors the Dx11RenderContext API but only updates the statistics of its owner
+struct NullRenderContext
+{
+    inline void IASetIndexBuffer(GraphicsResourceHandle const& buffer, ResourceFormat format, uint32_t offset);
+    inline void IASetVertexBuffers(uint32_t startSlot, Span<GraphicsResourceHandle const> buffers, Span<uint32_t const> strides, Span<uint32_t const> offsets);
+    inline void IASetInputLayout(GraphicsResourceHandle const& inputLayout);
+    inline void IASetPrimitiveTopology(PrimitiveTopology topology);
+
+    inline void RSSetState(GraphicsResourceHandle rs);
+
+    inline void SetViewports(Span<Viewport> vps);
+    inline void SetViewport(Viewport const& vp);
+    inline void SetScissorRects(Span<Rect> r);
+
+    inline void PSSetShader(NativePixelShader* ps);
+    inline void VSSetShader(NativeVertexShader* vs);
+
+    inline void OMSetDepthStencilState(GraphicsResourceHandle dss, uint32_t stencilRef = 0);
+    inline void OMSetBlendState(GraphicsResourceHandle bs, std::array<float, 4> blendFactor = {}, uint32_t sampleMask = 0x0);
+
+    inline void DrawIndexed(uint32_t indexCount, uint32_t indexOffset, uint32_t vertexOffset);
+    inline void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t indexOffset, uint32_t vertexOffset, uint32_t instanceOffset);
+    inline void Draw(uint32_t vertexCount, uint32_t vertexStartLocation);
+
+    void ClearTargets(GraphicsResourceHandle rtv, GraphicsResourceHandle dsv, float4 color, uint32_t clearFlags, float depth, uint8_t stencil);
+    void SetTarget(GraphicsResourceHandle rtv, GraphicsResourceHandle dsv);
+    void ClearRenderTarget(GraphicsResourceHandle rtv, float4 color);
+    void ClearDepthStencil(GraphicsResourceHandle dsv, uint32_t clearFlags, float depth, uint8_t stencil);
+
+    void SetShaderResources(ShaderStage stage, uint32_t startSlot, Span<GraphicsResourceHandle> srvs);
+    void SetSamplers(ShaderStage stage, uint32_t startSlot, Span<GraphicsResourceHandle> samplers);
+    void SetConstantBuffers(ShaderStage stage, uint32_t startSlot, Span<GraphicsResourceHandle> buffers);
+
+    // Maps return the CPU copy of the buffer, so contents persist between maps. The whole buffer counts as uploaded on unmap
+    void* Map(GraphicsResourceHandle buffer);
+    void  Unmap(GraphicsResourceHandle buffer);
+
+    void BeginFrame();
+    void EndFrame();
+    void Flush();
+
+    // Compute Shader interface
+    inline void ExecuteComputeItem(ComputeItem const& item);
+    void ExecuteComputeItems(Span<ComputeItem> const& items);
+
+    void DebugBeginEvent(std::string_view) {}
+    void DebugEndEvent() {}
+    void DebugSetMarker(std::string_view) {}
+
+    // Render interface owner
+    class NullRenderInterface* owner;
+};
+
+// Render interface that implements the resource handle API without a device.
+//	Resources only keep their size and, for buffers, a CPU copy of their contents so mapped writes stay valid.
+//	Used to measure the CPU cost of the renderer on machines without a GPU.
+class NullRenderInterface : public IRenderInterface
+{
+    CLASS(NullRenderInterface, IRenderInterface);
+
+    friend struct NullRenderContext;
+
+public:
+    NullRenderInterface() {}
+    ~NullRenderInterface() {}
+
+    void Init();
+    void Shutdown();
+
+    GraphicsResourceHandle CreateBuffer(BufferDesc const& desc, SubresourceData const* initialData = nullptr, std::string_view debugName = "");
+    GraphicsResourceHandle CreateShaderResourceView(GraphicsResourceHandle srcBuffer, SrvDesc const& desc, std::string_view debugName = "");
+    GraphicsResourceHandle CreateShaderResourceView(GraphicsResourceHandle srcBuffer, std::string_view debugName = "");
+    GraphicsResourceHandle CreateUnorderedAccessView(GraphicsResourceHandle srcBuffer, UavDesc const& desc, std::string_view debugName = "");
+    GraphicsResourceHandle CreateUnorderedAccessView(GraphicsResourceHandle srcBuffer, std::string_view debugName = "");
+    GraphicsResourceHandle CreateDepthStencilView(GraphicsResourceHandle srcBuffer, DsvDesc const& desc, std::string_view debugName = "");
+    GraphicsResourceHandle CreateInputLayout(InputLayoutDesc inputLayoutElements, void* shaderCode, uint32_t shaderCodeLength);
+    GraphicsResourceHandle CreateSamplerState(SamplerStateDesc samplerStateDesc, std::string_view name = "");
+    GraphicsResourceHandle CreateRasterizerState(RasterizerStateDesc desc, std::string_view name = "");
+    GraphicsResourceHandle CreateBlendState(BlendStateDesc desc, std::string_view name = "");
+    GraphicsResourceHandle CreateDepthStencilState(DepthStencilDesc desc, std::string_view name = "");
+
+    GraphicsResourceHandle CreateTexture(Texture1DDesc const& desc, void* initialData, std::string_view name = "");
+    GraphicsResourceHandle CreateTexture(Texture2DDesc const& desc, void* initialData, std::string_view name = "");
+    GraphicsResourceHandle CreateTexture(Texture3DDesc const& desc, void* initialData, std::string_view name = "");
+
+    GraphicsResourceHandle CreateRenderTargetView(GraphicsResourceHandle resource, RtvDesc const& desc, std::string_view name = "");
+    GraphicsResourceHandle CreateRenderTargetView(GraphicsResourceHandle resource, std::string_view name = "");
+
+    SwapchainHandle CreateSwapchain(SwapChainDesc const& desc, std::string_view debugName = "");
+    void ReleaseSwapchain(SwapchainHandle h);
+    void Present(SwapchainHandle swapchainHandle, uint32_t syncInterval = 0, uint32_t flags = 0);
+    void ResizeSwapchain(SwapchainHandle swapchainHandle, uint32_t w, uint32_t h);
+
+    // Returns the back buffer created with the swapchain, releasing the returned handle leaves the buffer alive
+    GraphicsResourceHandle GetSwapchainBuffer(SwapchainHandle swapchain, uint32_t buffer);
+
+    Texture2DDesc GetTexture2DDesc(GraphicsResourceHandle const& resource) const;
+
+    void ReleaseResource(GraphicsResourceHandle& h);
+
+    NullRenderContext& BeginContext()
+    {
+        m_ActiveRenderContext.owner = this;
+        return m_ActiveRenderContext;
+    }
+
+    void FlushContext(NullRenderContext& ctx)
+    {
+        ctx.Flush();
+    }
+
+    void Flush() {}
+
+    bool ImGui_Init() { return true; }
+
+    // Returns true while the handle refers to a live resource
+    bool IsAlive(GraphicsResourceHandle h) const;
+
+    NullRenderStats const& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+private:
+    struct NullResource
+    {
+        GraphicsResourceType type;
+
+        // Size of the resource, views and state objects have no storage of their own
+        uint64_t sizeBytes = 0;
+
+        // CPU storage backing mapped buffers
+        std::vector<uint8_t> data;
+
+        Texture2DDesc desc2D{};
+
+        // Back buffers are only released together with their swapchain
+        bool swapchainBuffer = false;
+
+        std::string name;
+    };
+
+    struct NullSwapchain
+    {
+        Texture2DDesc desc{};
+        GraphicsResourceHandle buffer;
+    };
+
+    void CreateSwapchainBuffer(NullSwapchain& swapchain);
+    void ReleaseSwapchainBuffer(NullSwapchain& swapchain);
+
+    GraphicsResourceHandle Push(GraphicsResourceType type, uint64_t sizeBytes, std::string_view name);
+    NullResource* GetResource(GraphicsResourceHandle h) const;
+
+    SlotVector<std::shared_ptr<NullResource>> m_Resources;
+    SlotVector<std::shared_ptr<NullSwapchain>> m_SwapChains;
+
+    NullRenderStats m_Stats;
+    NullRenderContext m_ActiveRenderContext;
+};
+
+#include "NullRenderInterface.inl"
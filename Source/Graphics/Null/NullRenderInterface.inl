@@ -0,0 +1,87 @@
+#pragma once
+
+void NullRenderContext::IASetIndexBuffer(GraphicsResourceHandle const& buffer, ResourceFormat format, uint32_t offset)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::IASetVertexBuffers(uint32_t startSlot, Span<GraphicsResourceHandle const> buffers, Span<uint32_t const> strides, Span<uint32_t const> offsets)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::IASetInputLayout(GraphicsResourceHandle const& inputLayout)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::IASetPrimitiveTopology(PrimitiveTopology topology)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::RSSetState(GraphicsResourceHandle rs)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::SetViewports(Span<Viewport> vps)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::SetViewport(Viewport const& vp)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::SetScissorRects(Span<Rect> r)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::PSSetShader(NativePixelShader* ps)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::VSSetShader(NativeVertexShader* vs)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::OMSetDepthStencilState(GraphicsResourceHandle dss, uint32_t stencilRef)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::OMSetBlendState(GraphicsResourceHandle bs, std::array<float, 4> blendFactor, uint32_t sampleMask)
+{
+    ++owner->m_Stats.n_state_changes;
+}
+
+void NullRenderContext::DrawIndexed(uint32_t indexCount, uint32_t indexOffset, uint32_t vertexOffset)
+{
+    DrawIndexedInstanced(indexCount, 1, indexOffset, vertexOffset, 0);
+}
+
+void NullRenderContext::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t indexOffset, uint32_t vertexOffset, uint32_t instanceOffset)
+{
+    NullRenderStats& stats = owner->m_Stats;
+    ++stats.n_draws;
+    stats.n_instances += instanceCount;
+    stats.n_vertices += uint64_t(indexCount) * instanceCount;
+}
+
+void NullRenderContext::Draw(uint32_t vertexCount, uint32_t vertexStartLocation)
+{
+    NullRenderStats& stats = owner->m_Stats;
+    ++stats.n_draws;
+    ++stats.n_instances;
+    stats.n_vertices += vertexCount;
+}
+
+void NullRenderContext::ExecuteComputeItem(ComputeItem const& item)
+{
+    ExecuteComputeItems({ item });
+}
@@ -0,0 +1,8 @@
+#include "Graphics.pch.h"
+#include "GlobalContext.h"
+#include "RenderInterface.h"
+
+RenderInterface* GetRI()
+{
+    return reinterpret_cast<RenderInterface*>(GetGlobalContext()->m_RenderInterface);
+}
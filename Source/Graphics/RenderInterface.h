@@ -8,9 +8,18 @@ private:
 };
 
 
+// The backend is selected at compile time. USE_NULL_RHI builds against the headless backend that only records statistics.
+#ifdef USE_NULL_RHI
+#include "Null/NullRenderInterface.h"
+
+using RenderInterface = NullRenderInterface;
+using RenderContext = NullRenderContext;
+#else
 #include "DX11/Dx11RenderInterface.h"
+
 using RenderInterface = Dx11RenderInterface;
 using RenderContext = Dx11RenderContext;
+#endif
 
 extern RenderInterface* GetRI();
 
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <vector>
+
+#include "Core/Array.h"
+
+#include "GraphicsResourceHandle.h"
+
+// Descriptor types shared by every backend.
+//	With D3D11 available they alias the native descriptors. Headless builds get plain structs with the same field names
+//	so the null backend compiles without the Windows SDK.
+#ifdef USE_DX11
+
+using BufferDesc          = D3D11_BUFFER_DESC;
+using SubresourceData     = D3D11_SUBRESOURCE_DATA;
+using SrvDesc             = D3D11_SHADER_RESOURCE_VIEW_DESC;
+using UavDesc             = D3D11_UNORDERED_ACCESS_VIEW_DESC;
+using DsvDesc             = D3D11_DEPTH_STENCIL_VIEW_DESC;
+using InputLayoutDesc     = std::vector<D3D11_INPUT_ELEMENT_DESC>;
+using SamplerStateDesc    = D3D11_SAMPLER_DESC;
+using RasterizerStateDesc = D3D11_RASTERIZER_DESC;
+using BlendStateDesc      = D3D11_BLEND_DESC;
+using DepthStencilDesc    = D3D11_DEPTH_STENCIL_DESC;
+using Texture1DDesc       = D3D11_TEXTURE1D_DESC;
+using Texture2DDesc       = D3D11_TEXTURE2D_DESC;
+using Texture3DDesc       = D3D11_TEXTURE3D_DESC;
+using RtvDesc             = D3D11_RENDER_TARGET_VIEW_DESC;
+using SwapChainDesc       = DXGI_SWAP_CHAIN_DESC;
+
+using ResourceFormat = DXGI_FORMAT;
+
+using NativePixelShader   = ID3D11PixelShader;
+using NativeVertexShader  = ID3D11VertexShader;
+using NativeComputeShader = ID3D11ComputeShader;
+
+#else
+
+// Values match DXGI_FORMAT
+enum ResourceFormat : uint32_t
+{
+    ResourceFormat_Unknown        = 0,
+    ResourceFormat_R8G8B8A8_UNorm = 28,
+    ResourceFormat_R32_UInt       = 42,
+    ResourceFormat_R16_UInt       = 57,
+};
+
+struct MultisampleDesc
+{
+    uint32_t Count   = 1;
+    uint32_t Quality = 0;
+};
+
+struct BufferDesc
+{
+    uint32_t ByteWidth           = 0;
+    uint32_t Usage               = 0;
+    uint32_t BindFlags           = 0;
+    uint32_t CPUAccessFlags      = 0;
+    uint32_t MiscFlags           = 0;
+    uint32_t StructureByteStride = 0;
+};
+
+struct SubresourceData
+{
+    void const* pSysMem          = nullptr;
+    uint32_t    SysMemPitch      = 0;
+    uint32_t    SysMemSlicePitch = 0;
+};
+
+struct Texture1DDesc
+{
+    uint32_t       Width          = 0;
+    uint32_t       MipLevels      = 1;
+    uint32_t       ArraySize      = 1;
+    ResourceFormat Format         = ResourceFormat_Unknown;
+    uint32_t       Usage          = 0;
+    uint32_t       BindFlags      = 0;
+    uint32_t       CPUAccessFlags = 0;
+    uint32_t       MiscFlags      = 0;
+};
+
+struct Texture2DDesc
+{
+    uint32_t        Width          = 0;
+    uint32_t        Height         = 0;
+    uint32_t        MipLevels      = 1;
+    uint32_t        ArraySize      = 1;
+    ResourceFormat  Format         = ResourceFormat_Unknown;
+    MultisampleDesc SampleDesc     = {};
+    uint32_t        Usage          = 0;
+    uint32_t        BindFlags      = 0;
+    uint32_t        CPUAccessFlags = 0;
+    uint32_t        MiscFlags      = 0;
+};
+
+struct Texture3DDesc
+{
+    uint32_t       Width          = 0;
+    uint32_t       Height         = 0;
+    uint32_t       Depth          = 0;
+    uint32_t       MipLevels      = 1;
+    ResourceFormat Format         = ResourceFormat_Unknown;
+    uint32_t       Usage          = 0;
+    uint32_t       BindFlags      = 0;
+    uint32_t       CPUAccessFlags = 0;
+    uint32_t       MiscFlags      = 0;
+};
+
+struct SwapChainDesc
+{
+    struct ModeDesc
+    {
+        uint32_t       Width  = 0;
+        uint32_t       Height = 0;
+        ResourceFormat Format = ResourceFormat_Unknown;
+    };
+
+    ModeDesc        BufferDesc   = {};
+    MultisampleDesc SampleDesc   = {};
+    uint32_t        BufferCount  = 0;
+    void*           OutputWindow = nullptr;
+    bool            Windowed     = true;
+};
+
+// Views, state objects and input layouts carry no data the headless backend reads
+struct SrvDesc {};
+struct UavDesc {};
+struct DsvDesc {};
+struct RtvDesc {};
+struct SamplerStateDesc {};
+struct RasterizerStateDesc {};
+struct BlendStateDesc {};
+struct DepthStencilDesc {};
+struct InputElementDesc {};
+using InputLayoutDesc = std::vector<InputElementDesc>;
+
+// Opaque, shaders can't be created without a device
+struct NativePixelShader;
+struct NativeVertexShader;
+struct NativeComputeShader;
+
+#endif
+
+// Values match D3D11_BIND_FLAG
+enum BindFlag : uint32_t
+{
+    BindFlag_VertexBuffer    = 0x1,
+    BindFlag_IndexBuffer     = 0x2,
+    BindFlag_ConstantBuffer  = 0x4,
+    BindFlag_ShaderResource  = 0x8,
+    BindFlag_RenderTarget    = 0x20,
+    BindFlag_DepthStencil    = 0x40,
+    BindFlag_UnorderedAccess = 0x80,
+};
+
+#ifdef USE_DX11
+static_assert(BindFlag_ConstantBuffer == D3D11_BIND_CONSTANT_BUFFER && BindFlag_RenderTarget == D3D11_BIND_RENDER_TARGET && BindFlag_UnorderedAccess == D3D11_BIND_UNORDERED_ACCESS);
+#endif
+
+struct Viewport
+{
+    Viewport() = default;
+
+    Viewport(float x, float y, float width, float height)
+        : x(x), y(y), width(width), height(height), minZ(0.0f), maxZ(1.0f)
+    {
+
+    }
+    float x;
+    float y;
+    float width;
+    float height;
+    float minZ;
+    float maxZ;
+};
+
+template<typename T>
+struct TRect
+{
+    T topLeftX;
+    T topLeftY;
+    T bottomRightX;
+    T bottomRightY;
+};
+
+using Rect = TRect<u32>;
+using RectF32 = TRect<f32>;
+
+struct ComputeItem
+{
+    Array<GraphicsResourceHandle> srvs;
+    Array<GraphicsResourceHandle> uavs;
+    Array<GraphicsResourceHandle> cbs;
+
+    NativeComputeShader* shader = nullptr;
+
+    uint32_t dispatchX = 1;
+    uint32_t dispatchY = 1;
+    uint32_t dispatchZ = 1;
+};
+
+enum class PrimitiveTopology
+{
+    TriangleList,
+    TriangleStrip,
+    LineList,
+    LineStrip
+};
@@ -0,0 +1 @@
+#include "PackTool.pch.h"
\ No newline at end of file
@@ -0,0 +1,7 @@
+#pragma once
+
+// The pack tool only depends on the core layer
+#include "CLI.h"
+#include "Core.h"
+
+#include "CommandLine.h"
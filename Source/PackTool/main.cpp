@@ -0,0 +1,87 @@
+#include "PackTool.pch.h"
+
+#include "PackFile.h"
+#include "PlatformIO.h"
+
+// Builds a pack file from a folder of loose resources
+//	usage: PackTool [input=Resources] [output=Resources.pak] [compress=true] [alignment=64]
+int main(int argcs, char** argvs)
+{
+	cli::CommandLine cmd = cli::parse(argvs, argcs);
+
+	std::string input = "Resources";
+	std::string output = "Resources.pak";
+	bool compress = true;
+	int alignment = 64;
+	cli::get_string(cmd, "input", input);
+	cli::get_string(cmd, "output", output);
+	cli::get_bool(cmd, "compress", compress);
+	cli::get_number(cmd, "alignment", alignment);
+
+	if (alignment <= 0 || (alignment & (alignment - 1)) != 0)
+	{
+		fmt::print("Alignment {} has to be a power of two.\n", alignment);
+		return 1;
+	}
+
+	std::error_code ec;
+	if (!std::filesystem::is_directory(input, ec))
+	{
+		fmt::print("Input folder '{}' doesn't exist.\n", input);
+		return 1;
+	}
+
+	IO::IPlatformIORef io = IO::create();
+	IO::set(io);
+
+	// Sorted so the same input always produces the same pack
+	std::vector<std::filesystem::path> files;
+	for (std::filesystem::directory_entry const& entry : std::filesystem::recursive_directory_iterator(input, ec))
+	{
+		if (entry.is_regular_file() && !std::filesystem::equivalent(entry.path(), output, ec))
+		{
+			files.push_back(entry.path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+
+	IO::PackWriter writer{ u32(alignment) };
+	u64 total_size = 0;
+	for (std::filesystem::path const& path : files)
+	{
+		IO::IMappedFileRef file = io->MapFile(path.string().c_str());
+		if (!file)
+		{
+			fmt::print("Failed to read '{}'.\n", path.string());
+			return 1;
+		}
+
+		writer.add(std::filesystem::relative(path, input).generic_string(), file->get_data(), compress);
+		total_size += file->get_size();
+	}
+
+	std::vector<u8> data;
+	writer.write(data);
+
+	IO::IFileRef file = io->OpenFile(output.c_str(), IO::Mode::Write, true);
+	if (!file)
+	{
+		fmt::print("Failed to open '{}' for writing.\n", output);
+		return 1;
+	}
+
+	// Files are written in chunks as the IO interface takes 32 bit sizes
+	constexpr size_t c_ChunkSize = 1 << 30;
+	for (size_t offset = 0; offset < data.size(); offset += c_ChunkSize)
+	{
+		u32 size = u32(std::min(c_ChunkSize, data.size() - offset));
+		if (file->write(data.data() + offset, size) != size)
+		{
+			fmt::print("Failed to write '{}'.\n", output);
+			return 1;
+		}
+	}
+
+	fmt::print("Packed {} files ({} bytes) into '{}' ({} bytes).\n", files.size(), total_size, output, data.size());
+	return 0;
+}
@@ -22,9 +22,13 @@ public:
 
 	~SimpleMovement2D();
 
+	framework::Component* clone(framework::Entity* ent) const override { return ent->clone_component(*this); }
+
 	void on_attach(framework::Entity* ent) override;
 	void update(float dt) override;
 
+	framework::SystemAccess get_update_access() const override { return framework::SystemAccess::parallel(0, framework::Access_Transform); }
+
 	void set_speed(float speed) { _speed = speed; }
 
 	void reset() { _speed = 0.0; }
@@ -43,6 +47,8 @@ public:
 
 	~SimpleMovement3D() = default;
 
+	framework::Component* clone(framework::Entity* ent) const override { return ent->clone_component(*this); }
+
 	void update(float dt)
 	{
 		_elapsed += dt * _speed;
@@ -56,6 +62,8 @@ public:
 		//ent->set_local_position(_offset.x + cos(_elapsed) * 100.0, _offset.y + sin(_elapsed) * 100.0);
 	}
 
+	framework::SystemAccess get_update_access() const override { return framework::SystemAccess::parallel(0, framework::Access_Transform); }
+
 	void set_speed(float speed) { _speed = speed; }
 
 	float _elapsed = 0.0f;
@@ -75,6 +83,7 @@ public:
 
 	BitmapComponent(std::string const& path)
 			: framework::Component()
+			, _path(path)
 	{
 		_bmp = Bitmap::load(path);
 	}
@@ -82,11 +91,18 @@ public:
 	{
 	}
 
+	// The bitmap can't be shared, the copy loads it again
+	framework::Component* clone(framework::Entity* ent) const override
+	{
+		return _path.empty() ? ent->create_component<BitmapComponent>() : ent->create_component<BitmapComponent>(_path);
+	}
+
 	void render()
 	{
 		//GameEngine::instance()->_d2d_ctx->draw_bitmap(_bmp.get(), (int)(-_bmp->get_width() / 2.0), (int)(-_bmp->get_height() / 2.0));
 	}
 
+	std::string _path;
 	unique_ptr<Bitmap> _bmp;
 };
 #endif
@@ -101,9 +117,15 @@ public:
 	ModelComponent();
 	virtual ~ModelComponent();
 
+	// The copy creates its own render world instance on attach
+	framework::Component* clone(framework::Entity* ent) const override { return ent->clone_component(*this); }
+
 	virtual void on_attach(Entity* ent) override;
 	virtual void on_detach(Entity* ent) override;
 
+	// Model components don't update, the render world instance is created on attach
+	framework::SystemAccess get_update_access() const override { return framework::SystemAccess::parallel(0, 0); }
+
 	bool is_loaded() const;
 	void set_model_path(std::string const& mesh);
 
@@ -132,6 +154,10 @@ public:
 
 	virtual ~LightComponent() {}
 
+	framework::Component* clone(framework::Entity* ent) const override { return ent->clone_component(*this); }
+
+	framework::SystemAccess get_update_access() const override { return framework::SystemAccess::parallel(0, 0); }
+
 	hlslpp::float3 get_color() { return _color; }
 
 private:
@@ -152,8 +178,13 @@ public:
 
 	CameraComponent& operator=(CameraComponent const&) = delete;
 
+	framework::Component* clone(framework::Entity* ent) const override { return ent->clone_component(*this); }
+
 	void update(float dt) override;
 
+	// Flying the camera reads the input and moves its own entity
+	framework::SystemAccess get_update_access() const override { return { framework::Access_Input, framework::Access_Transform }; }
+
 	void look_at(float3 eye, float3 target, float3 up = { 0.0, 0.0f, 1.0f });
 
 	float get_fov() const { return _fov; }
@@ -5,6 +5,7 @@
 #include "Engine/Core/MaterialResource.h"
 #include "Engine/Core/ModelResource.h"
 #include "Engine/Core/TextureResource.h"
+#include "Engine/Core/WorldSnapshot.h"
 
 #include "Engine/Graphics/ShaderCache.h"
 
@@ -234,51 +235,33 @@ void SceneViewer::OpenScene(const char* path)
 {
     m_ScenePath = path;
 
-    std::string resolvedPath = IO::get()->ResolvePath(path);
-    yaml::Document doc = yaml::Document(resolvedPath.c_str());
-
     auto render_world = GameEngine::instance()->get_render_world();
     render_world->Clear();
 
-    Yaml::Node& node = doc.GetRoot();
-    auto data = node["Models"][0]["name"].As<std::string>();
-    for (auto it = node["Models"].Begin(); it != node["Models"].End(); it++)
+    // Prefer the compiled snapshot next to the scene (see the cook-scene command line option), otherwise compile the scene in memory
+    std::filesystem::path snapshotPath = std::filesystem::path(path).replace_extension(WorldSnapshot::c_Extension);
+
+    WorldSnapshot snapshot{};
+    std::vector<u8> compiled;
+    bool useSnapshot = snapshot.load(snapshotPath.string().c_str());
+
+    // The snapshot is stale when the scene was edited after cooking it
+    u64 sourceHash = 0;
+    if (useSnapshot && hash_scene(path, sourceHash) && sourceHash != snapshot.get_source_hash())
+    {
+        LOG_INFO(IO, "Snapshot {} is out of date, compiling {} instead.", snapshotPath.string(), path);
+        useSnapshot = false;
+    }
+
+    if (!useSnapshot)
     {
-        // LOG_INFO(Unknown, "{}: {}", (*it).first, (*it).second.As<string>());
-        std::string name = (*it).second["name"].As<std::string>();
-        std::string type = (*it).second["type"].As<std::string>();
-        std::string position = (*it).second["position"].As<std::string>();
-        std::string scaleT = (*it).second["scale"].As<std::string>();
-        std::string rotation = (*it).second["rotation"].As<std::string>();
-        std::string mesh = (*it).second["mesh"].As<std::string>();
-
-        float pos[3];
-        float scale[3];
-        float rot[3];
-
-        std::vector<std::string_view> result;
-        Helpers::split_string(position, ",", result);
-
-        pos[0] = (float)atof(result[0].data());
-        pos[1] = (float)atof(result[1].data());
-        pos[2] = (float)atof(result[2].data());
-
-        Helpers::split_string(scaleT, ",", result);
-        scale[0] = (float)atof(result[0].data());
-        scale[1] = (float)atof(result[1].data());
-        scale[2] = (float)atof(result[2].data());
-
-        Helpers::split_string(rotation, ",", result);
-        rot[0] = (float)atof(result[0].data());
-        rot[1] = (float)atof(result[1].data());
-        rot[2] = (float)atof(result[2].data());
-
-        float4x4 t = float4x4::translation(float3(pos[0], pos[1], pos[2]));
-        float4x4 s = float4x4::scale(scale[0], scale[1], scale[2]);
-
-        float4x4 transform = hlslpp::mul(s, t);
-        render_world->create_instance(transform, mesh);
+        if (!convert_scene(path, compiled) || !snapshot.open(compiled.data(), compiled.size()))
+        {
+            LOG_ERROR(IO, "Failed to open scene {}.", path);
+            return;
+        }
     }
+    snapshot.instantiate(*render_world);
 
     ImVec2 size = GameEngine::instance()->GetViewportSize();
     const float aspect = (float)size.x / (float)size.y;
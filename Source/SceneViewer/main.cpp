@@ -8,14 +8,136 @@
 #include "Graphics/ShaderCompiler.h"
 #include "EngineLoop.h"
 
+#include "Core/WorldSnapshot.h"
+#include "Core/CookedModel.h"
+
 #define USE_ENGINE_LOOP
 
+// IO setup for the offline cooking commands
+static IO::IPlatformIORef create_cook_io()
+{
+	IO::IPlatformIORef io = IO::create();
+	IO::set(io);
+	io->Mount("Resources");
+	GetGlobalContext()->m_PlatformIO = io.get();
+	return io;
+}
+
+// Offline conversion of a .scene file into a world snapshot, runs without booting the engine
+//	usage: SceneViewer cook-scene=<path> [cook-output=<path>]
+static int cook_scene(cli::CommandLine const& cmd, std::string const& scene)
+{
+	IO::IPlatformIORef io = create_cook_io();
+
+	std::vector<u8> data;
+	if (!convert_scene(io->ResolvePath(scene).c_str(), data))
+	{
+		printf("Failed to convert scene '%s'.\n", scene.c_str());
+		return 1;
+	}
+
+	std::string output = std::filesystem::path(scene).replace_extension(WorldSnapshot::c_Extension).string();
+	cli::get_string(cmd, "cook-output", output);
+
+	IO::IFileRef file = io->OpenFile(output.c_str(), IO::Mode::Write, true);
+	if (!file || file->write(data.data(), u32(data.size())) != data.size())
+	{
+		printf("Failed to write snapshot '%s'.\n", output.c_str());
+		return 1;
+	}
+
+	printf("Wrote '%s' (%zu bytes).\n", output.c_str(), data.size());
+	return 0;
+}
+
+// Offline cooking of a model, or every model in a folder, into '<model>.cmesh' next to the source
+//	usage: SceneViewer cook-model=<path> [cook-optimize=true] [cook-overdraw=true] [cook-lods=true]
+static int cook_models(cli::CommandLine const& cmd, std::string const& path)
+{
+	IO::IPlatformIORef io = create_cook_io();
+
+	bool optimize = true;
+	MeshOptimizer::Options options{};
+	cli::get_bool(cmd, "cook-optimize", optimize);
+	cli::get_bool(cmd, "cook-overdraw", options.overdraw);
+	cli::get_bool(cmd, "cook-lods", options.lods);
+	options.weld = options.vertex_cache = options.vertex_fetch = optimize;
+	options.overdraw = options.overdraw && optimize;
+
+	std::vector<std::string> models;
+	std::error_code ec;
+	std::string resolved = io->ResolvePath(path);
+	if (std::filesystem::is_directory(resolved, ec))
+	{
+		for (std::filesystem::directory_entry const& entry : std::filesystem::recursive_directory_iterator(resolved, ec))
+		{
+			std::string extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return char(std::tolower(c)); });
+			if (entry.is_regular_file() && (extension == ".gltf" || extension == ".glb" || extension == ".fbx" || extension == ".obj"))
+			{
+				models.push_back(entry.path().string());
+			}
+		}
+	}
+	else
+	{
+		models.push_back(path);
+	}
+
+	int result = 0;
+	for (std::string const& model : models)
+	{
+		Timer timer{};
+		timer.Start();
+
+		std::vector<u8> data;
+		MeshOptimizer::Report report{};
+		if (!cook_model(model, data, options, &report))
+		{
+			printf("Failed to cook model '%s'.\n", model.c_str());
+			result = 1;
+			continue;
+		}
+
+		std::string output = model + CookedModel::c_Extension;
+		IO::IFileRef file = io->OpenFile(output.c_str(), IO::Mode::Write, true);
+		if (!file || file->write(data.data(), u32(data.size())) != data.size())
+		{
+			printf("Failed to write '%s'.\n", output.c_str());
+			result = 1;
+			continue;
+		}
+
+		timer.Stop();
+		printf("Wrote '%s' (%zu bytes) in %.2f ms.\n", output.c_str(), data.size(), timer.GetTimeInMS());
+		printf("\t%u triangles, vertices %u -> %u, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+				report.before.n_triangles, report.before.n_vertices, report.after.n_vertices,
+				report.before.get_acmr(), report.after.get_acmr(), report.before.get_atvr(), report.after.get_atvr());
+		for (size_t lod = 1; lod < report.lod_triangles.size(); ++lod)
+		{
+			printf("\tLOD%zu: %u triangles\n", lod, report.lod_triangles[lod]);
+		}
+	}
+	return result;
+}
+
 int main(int argcs, char** argvs)
 {
 #ifdef USE_ENGINE_LOOP
 	EngineLoop engine("/Types/Games/SceneViewer");
 
     cli::CommandLine cmd = cli::parse(argvs, argcs);
+
+	if (std::string scene; cli::get_string(cmd, "cook-scene", scene))
+	{
+		return cook_scene(cmd, scene);
+	}
+
+	if (std::string model; cli::get_string(cmd, "cook-model", model))
+	{
+		return cook_models(cmd, model);
+	}
+
 	return engine.Run(cmd);
 #else
 
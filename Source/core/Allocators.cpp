@@ -0,0 +1,662 @@
+#include "Core.pch.h"
+#include "Allocators.h"
+
+#include <malloc.h>
+
+// All allocator memory comes straight from malloc, going through operator new would recurse into the allocators.
+
+LinearArena::~LinearArena()
+{
+	deinit();
+}
+
+void LinearArena::init(size_t capacity)
+{
+	ASSERT(_base == nullptr);
+	_base = (u8*)std::malloc(capacity);
+	_capacity = _base ? capacity : 0;
+	_offset = 0;
+	_high_water_mark = 0;
+}
+
+void LinearArena::deinit()
+{
+	std::free(_base);
+	_base = nullptr;
+	_capacity = 0;
+	_offset = 0;
+}
+
+void* LinearArena::allocate(size_t size, size_t alignment)
+{
+	// The base is malloc aligned and every size is rounded up to 16 bytes, this keeps every offset aligned without a CAS loop.
+	ASSERT(alignment <= 16);
+	size_t const aligned_size = (size + 15) & ~size_t(15);
+
+	size_t offset = _offset.fetch_add(aligned_size, std::memory_order_relaxed);
+	if (offset + aligned_size > _capacity)
+	{
+		return nullptr;
+	}
+	return _base + offset;
+}
+
+void LinearArena::reset()
+{
+	_high_water_mark = std::max(_high_water_mark, get_used());
+	_offset.store(0, std::memory_order_relaxed);
+}
+
+PageRegion::~PageRegion()
+{
+	deinit();
+}
+
+void PageRegion::init(size_t capacity, size_t page_size)
+{
+	ASSERT(_base == nullptr && page_size > 0);
+	size_t const n_pages = capacity / page_size;
+	_base = (u8*)std::malloc(n_pages * page_size);
+	_owners = (u8*)std::malloc(n_pages);
+	if (!_base || !_owners)
+	{
+		deinit();
+		return;
+	}
+
+	std::memset(_owners, c_NoOwner, n_pages);
+	_capacity = n_pages * page_size;
+	_page_size = page_size;
+	_used = 0;
+}
+
+void PageRegion::deinit()
+{
+	std::free(_base);
+	std::free(_owners);
+	_base = nullptr;
+	_owners = nullptr;
+	_capacity = 0;
+	_used = 0;
+}
+
+u8* PageRegion::allocate_page(u8 owner)
+{
+	if (_page_size == 0)
+	{
+		return nullptr;
+	}
+
+	size_t offset = _used.fetch_add(_page_size, std::memory_order_relaxed);
+	if (offset + _page_size > _capacity)
+	{
+		return nullptr;
+	}
+
+	// Published to other threads together with the blocks of the page
+	_owners[offset / _page_size] = owner;
+	return _base + offset;
+}
+
+FixedBlockPool::~FixedBlockPool()
+{
+	deinit();
+}
+
+void FixedBlockPool::init(size_t block_size, PageRegion* region, u8 owner)
+{
+	ASSERT(block_size >= sizeof(FreeBlock) && block_size <= c_PageSize);
+	_block_size = block_size;
+	_region = region;
+	_owner = owner;
+}
+
+void FixedBlockPool::deinit()
+{
+	// Region pages outlive the pool, blocks handed out can still be freed
+	if (_region)
+	{
+		return;
+	}
+
+	std::lock_guard lock{ _lock };
+	for (size_t i = 0; i < _num_pages; ++i)
+	{
+		std::free(_pages[i]);
+	}
+	std::free(_pages);
+
+	_pages = nullptr;
+	_num_pages = 0;
+	_pages_capacity = 0;
+	_free_list = nullptr;
+	_blocks_in_use = 0;
+}
+
+void* FixedBlockPool::allocate()
+{
+	std::lock_guard lock{ _lock };
+	if (!_free_list)
+	{
+		grow();
+		if (!_free_list)
+		{
+			return nullptr;
+		}
+	}
+
+	FreeBlock* block = _free_list;
+	_free_list = block->next;
+	++_blocks_in_use;
+	return block;
+}
+
+void FixedBlockPool::free(void* mem)
+{
+	ASSERT(mem);
+
+	std::lock_guard lock{ _lock };
+	FreeBlock* block = (FreeBlock*)mem;
+	block->next = _free_list;
+	_free_list = block;
+	--_blocks_in_use;
+}
+
+u32 FixedBlockPool::allocate_batch(void** blocks, u32 count)
+{
+	std::lock_guard lock{ _lock };
+	u32 n = 0;
+	while (n < count)
+	{
+		if (!_free_list)
+		{
+			grow();
+			if (!_free_list)
+			{
+				break;
+			}
+		}
+
+		FreeBlock* block = _free_list;
+		_free_list = block->next;
+		blocks[n++] = block;
+	}
+	_blocks_in_use += n;
+	return n;
+}
+
+void FixedBlockPool::free_batch(void* const* blocks, u32 count)
+{
+	std::lock_guard lock{ _lock };
+	for (u32 i = 0; i < count; ++i)
+	{
+		FreeBlock* block = (FreeBlock*)blocks[i];
+		block->next = _free_list;
+		_free_list = block;
+	}
+	_blocks_in_use -= count;
+}
+
+void FixedBlockPool::grow()
+{
+	u8* page = nullptr;
+	if (_region)
+	{
+		page = _region->allocate_page(_owner);
+	}
+	else
+	{
+		if (_num_pages == _pages_capacity)
+		{
+			size_t new_capacity = std::max<size_t>(_pages_capacity * 2, 8);
+			u8** pages = (u8**)std::realloc(_pages, new_capacity * sizeof(u8*));
+			if (!pages)
+			{
+				return;
+			}
+			_pages = pages;
+			_pages_capacity = new_capacity;
+		}
+
+		page = (u8*)std::malloc(c_PageSize);
+		if (page)
+		{
+			_pages[_num_pages] = page;
+		}
+	}
+
+	if (!page)
+	{
+		return;
+	}
+	++_num_pages;
+
+	// Push the blocks in reverse so they are handed out in address order
+	size_t const n_blocks = c_PageSize / _block_size;
+	for (size_t i = n_blocks; i > 0; --i)
+	{
+		FreeBlock* block = (FreeBlock*)(page + (i - 1) * _block_size);
+		block->next = _free_list;
+		_free_list = block;
+	}
+}
+
+namespace
+{
+
+#ifdef CORE_DLL
+constexpr bool c_MallocOnly = true;
+#else
+constexpr bool c_MallocOnly = false;
+#endif
+
+// STL allocator on top of malloc for the allocator internals, operator new would recurse into the allocators
+template<typename T>
+struct SystemAllocator
+{
+	using value_type = T;
+
+	SystemAllocator() = default;
+	template<typename U>
+	SystemAllocator(SystemAllocator<U> const&) {}
+
+	T* allocate(size_t n)
+	{
+		if (T* mem = (T*)std::malloc(n * sizeof(T)))
+		{
+			return mem;
+		}
+		throw std::bad_alloc();
+	}
+	void deallocate(T* mem, size_t) { std::free(mem); }
+
+	template<typename U>
+	bool operator==(SystemAllocator<U> const&) const { return true; }
+};
+
+// Heap blocks of tagged categories. The block itself has no header so frees look up the category and size here.
+//	Striped by address so frees on different threads rarely share a lock, empty stripes are skipped without locking.
+class HeapBlockTable final
+{
+public:
+	struct Entry
+	{
+		size_t size;
+		MemoryCategory category;
+		bool budgeted;
+	};
+
+	void insert(void* mem, Entry const& entry)
+	{
+		Stripe& stripe = get_stripe(mem);
+		std::lock_guard lock{ stripe.lock };
+		stripe.blocks[mem] = entry;
+		stripe.count.store(stripe.blocks.size(), std::memory_order_relaxed);
+	}
+
+	bool remove(void* mem, Entry& entry)
+	{
+		// The thread that inserted 'mem' synchronised with this thread before handing over the block, so a live entry
+		// always shows up in the count
+		Stripe& stripe = get_stripe(mem);
+		if (stripe.count.load(std::memory_order_relaxed) == 0)
+		{
+			return false;
+		}
+
+		std::lock_guard lock{ stripe.lock };
+		auto it = stripe.blocks.find(mem);
+		if (it == stripe.blocks.end())
+		{
+			return false;
+		}
+		entry = it->second;
+		stripe.blocks.erase(it);
+		stripe.count.store(stripe.blocks.size(), std::memory_order_relaxed);
+		return true;
+	}
+
+private:
+	static constexpr u32 c_StripeBits = 6;
+
+	struct Stripe
+	{
+		std::mutex lock;
+		std::unordered_map<void*, Entry, std::hash<void*>, std::equal_to<void*>, SystemAllocator<std::pair<void* const, Entry>>> blocks;
+		std::atomic<size_t> count = 0;
+	};
+
+	Stripe& get_stripe(void* mem)
+	{
+		return _stripes[(u64(uintptr_t(mem) >> 4) * 0x9E3779B97F4A7C15ull) >> (64 - c_StripeBits)];
+	}
+
+	Stripe _stripes[1 << c_StripeBits];
+};
+
+struct AllocatorState
+{
+	MemoryAllocatorCfg cfg;
+
+	LinearArena frame_arenas[MemoryAllocators::c_NumFrameArenas];
+	std::atomic<u32> current_frame_arena = 0;
+
+	PageRegion pool_region;
+	FixedBlockPool pools[*MemoryCategory::Count][MemoryAllocators::c_NumPools];
+
+	HeapBlockTable heap_blocks;
+
+	std::atomic<u64> budgets[*MemoryCategory::Count] = {};
+	std::atomic<u64> used[*MemoryCategory::Count] = {};
+	std::atomic<u64> failed_allocations[*MemoryCategory::Count] = {};
+};
+static_assert(*MemoryCategory::Count * MemoryAllocators::c_NumPools < PageRegion::c_NoOwner, "Pool owners have to fit in a byte.");
+
+// Constructed in place on init, the state is never destroyed as allocations can outlive static destruction.
+alignas(AllocatorState) char g_allocator_storage[sizeof(AllocatorState)] = {};
+std::atomic<bool> s_allocators_initialised = false;
+AllocatorState* s_allocator_state = nullptr;
+
+// Blocks of every pool kept by the current thread. The shared pools are only locked once per c_Batch blocks, frees from
+// other threads simply land in the cache of the freeing thread. The blocks go back to the pools when the thread exits.
+struct ThreadPoolCache
+{
+	static constexpr u32 c_Capacity = 32;
+	static constexpr u32 c_Batch = c_Capacity / 2;
+
+	struct Bin
+	{
+		void* blocks[c_Capacity];
+		u32 count;
+	};
+
+	~ThreadPoolCache()
+	{
+		for (u32 category = 0; category < *MemoryCategory::Count; ++category)
+		{
+			for (u8 pool = 0; pool < MemoryAllocators::c_NumPools; ++pool)
+			{
+				Bin& bin = bins[category][pool];
+				s_allocator_state->pools[category][pool].free_batch(bin.blocks, bin.count);
+				bin.count = 0;
+			}
+		}
+
+		// Later frees on this thread (e.g. from other thread_local destructors) go straight to the pools
+		released = true;
+	}
+
+	Bin bins[*MemoryCategory::Count][MemoryAllocators::c_NumPools] = {};
+	bool released = false;
+};
+thread_local ThreadPoolCache t_pool_cache;
+
+void* pool_allocate(AllocatorState* state, u32 category, u8 pool)
+{
+	ThreadPoolCache& cache = t_pool_cache;
+	if (cache.released)
+	{
+		return state->pools[category][pool].allocate();
+	}
+
+	ThreadPoolCache::Bin& bin = cache.bins[category][pool];
+	if (bin.count == 0)
+	{
+		bin.count = state->pools[category][pool].allocate_batch(bin.blocks, ThreadPoolCache::c_Batch);
+		if (bin.count == 0)
+		{
+			return nullptr;
+		}
+	}
+	return bin.blocks[--bin.count];
+}
+
+void pool_free(AllocatorState* state, u32 category, u8 pool, void* mem)
+{
+	ThreadPoolCache& cache = t_pool_cache;
+	if (cache.released)
+	{
+		state->pools[category][pool].free(mem);
+		return;
+	}
+
+	// Hand the older half back when full so alternating allocate/free doesn't hit the pool every time
+	ThreadPoolCache::Bin& bin = cache.bins[category][pool];
+	if (bin.count == ThreadPoolCache::c_Capacity)
+	{
+		state->pools[category][pool].free_batch(bin.blocks, ThreadPoolCache::c_Batch);
+		std::copy(bin.blocks + ThreadPoolCache::c_Batch, bin.blocks + ThreadPoolCache::c_Capacity, bin.blocks);
+		bin.count -= ThreadPoolCache::c_Batch;
+	}
+	bin.blocks[bin.count++] = mem;
+}
+
+u8 find_pool(size_t size)
+{
+	for (u8 i = 0; i < MemoryAllocators::c_NumPools; ++i)
+	{
+		if (size <= MemoryAllocators::c_PoolBlockSizes[i])
+		{
+			return i;
+		}
+	}
+	return MemoryAllocators::c_NumPools;
+}
+
+} // namespace
+
+void MemoryAllocators::init(MemoryAllocatorCfg const& cfg)
+{
+	if (s_allocators_initialised)
+	{
+		return;
+	}
+
+	if (!s_allocator_state)
+	{
+		s_allocator_state = new (g_allocator_storage) AllocatorState();
+		s_allocator_state->pool_region.init(cfg.m_EnablePools && !c_MallocOnly ? cfg.m_PoolRegionSize : 0, FixedBlockPool::c_PageSize);
+		for (u32 category = 0; category < *MemoryCategory::Count; ++category)
+		{
+			for (u8 pool = 0; pool < c_NumPools; ++pool)
+			{
+				s_allocator_state->pools[category][pool].init(c_PoolBlockSizes[pool], &s_allocator_state->pool_region, u8(category * c_NumPools + pool));
+			}
+		}
+
+		for (LinearArena& arena : s_allocator_state->frame_arenas)
+		{
+			arena.init(c_MallocOnly ? 0 : cfg.m_FrameArenaSize);
+		}
+	}
+
+	s_allocator_state->cfg = cfg;
+	for (u32 i = 0; i < *MemoryCategory::Count; ++i)
+	{
+		set_budget(MemoryCategory(i), cfg.m_Budgets[i]);
+	}
+
+	s_allocators_initialised = true;
+}
+
+void MemoryAllocators::deinit()
+{
+	// Only stop routing new allocations, live blocks still need their pool or arena when they are freed.
+	s_allocators_initialised = false;
+}
+
+bool MemoryAllocators::is_initialised()
+{
+	return s_allocators_initialised;
+}
+
+MemoryAllocators::Allocation MemoryAllocators::allocate(MemoryCategory category, size_t size)
+{
+	AllocatorState* state = s_allocator_state;
+	u32 const cat = *category;
+
+	if (category == MemoryCategory::None)
+	{
+		void* mem = std::malloc(size);
+		return { mem, AllocatorType::System, category, mem ? get_system_size(mem) : 0, false };
+	}
+
+	if (category == MemoryCategory::Frame && !c_MallocOnly)
+	{
+		u32 arena = state->current_frame_arena.load(std::memory_order_relaxed);
+		if (void* mem = state->frame_arenas[arena].allocate(size))
+		{
+			return { mem, AllocatorType::Frame, category, size, false };
+		}
+
+		// Running out of frame memory should not take the frame down, fall back to the heap and report it.
+		state->failed_allocations[cat].fetch_add(1, std::memory_order_relaxed);
+		void* mem = std::malloc(size);
+		if (mem)
+		{
+			state->heap_blocks.insert(mem, { size, category, false });
+		}
+		return { mem, AllocatorType::Heap, category, size, false };
+	}
+
+	// Budgets are opt-in so unbudgeted categories don't pay for a shared atomic on every allocation.
+	//	Budgeted blocks always come from the heap, the side table remembers to give the bytes back.
+	if (u64 budget = state->budgets[cat].load(std::memory_order_relaxed); budget != 0)
+	{
+		u64 used = state->used[cat].fetch_add(size, std::memory_order_relaxed) + size;
+		void* mem = used <= budget ? std::malloc(size) : nullptr;
+		if (!mem)
+		{
+			state->used[cat].fetch_sub(size, std::memory_order_relaxed);
+			state->failed_allocations[cat].fetch_add(1, std::memory_order_relaxed);
+			return { nullptr, AllocatorType::Heap, category, 0, false };
+		}
+
+		state->heap_blocks.insert(mem, { size, category, true });
+		return { mem, AllocatorType::Heap, category, size, true };
+	}
+
+	if (!c_MallocOnly && state->cfg.m_EnablePools && size <= c_MaxPoolSize)
+	{
+		u8 pool = find_pool(size);
+		if (void* mem = pool_allocate(state, cat, pool))
+		{
+			return { mem, AllocatorType::Pool, category, c_PoolBlockSizes[pool], false };
+		}
+	}
+
+	void* mem = std::malloc(size);
+	if (!mem)
+	{
+		return { nullptr, AllocatorType::Heap, category, 0, false };
+	}
+
+	state->heap_blocks.insert(mem, { size, category, false });
+	return { mem, AllocatorType::Heap, category, size, false };
+}
+
+MemoryAllocators::Allocation MemoryAllocators::release(void* mem)
+{
+	AllocatorState* state = s_allocator_state;
+	if (!state)
+	{
+		return { mem, AllocatorType::System, MemoryCategory::None, get_system_size(mem), false };
+	}
+
+	if (state->pool_region.owns(mem))
+	{
+		u8 owner = state->pool_region.get_owner(mem);
+		u8 pool = owner % c_NumPools;
+		return { mem, AllocatorType::Pool, MemoryCategory(owner / c_NumPools), c_PoolBlockSizes[pool], false };
+	}
+
+	for (LinearArena const& arena : state->frame_arenas)
+	{
+		if (arena.owns(mem))
+		{
+			return { mem, AllocatorType::Frame, MemoryCategory::Frame, 0, false };
+		}
+	}
+
+	if (HeapBlockTable::Entry entry{}; state->heap_blocks.remove(mem, entry))
+	{
+		return { mem, AllocatorType::Heap, entry.category, entry.size, entry.budgeted };
+	}
+	return { mem, AllocatorType::System, MemoryCategory::None, get_system_size(mem), false };
+}
+
+void MemoryAllocators::free(Allocation const& allocation)
+{
+	AllocatorState* state = s_allocator_state;
+	if (allocation.budgeted)
+	{
+		state->used[*allocation.category].fetch_sub(allocation.size, std::memory_order_relaxed);
+	}
+
+	switch (allocation.type)
+	{
+		case AllocatorType::System:
+		case AllocatorType::Heap:
+			std::free(allocation.mem);
+			break;
+		case AllocatorType::Pool:
+			pool_free(state, *allocation.category, find_pool(allocation.size), allocation.mem);
+			break;
+		case AllocatorType::Frame:
+			// Reclaimed as a whole by begin_frame
+			break;
+	}
+}
+
+size_t MemoryAllocators::get_system_size(void* mem)
+{
+#ifdef WIN64
+	return _msize(mem);
+#else
+	return malloc_usable_size(mem);
+#endif
+}
+
+void MemoryAllocators::begin_frame()
+{
+	if (!s_allocators_initialised)
+	{
+		return;
+	}
+
+	// The arena we switch to was last used c_NumFrameArenas frames ago, every frame in flight that used it has been presented.
+	AllocatorState* state = s_allocator_state;
+	u32 next = (state->current_frame_arena.load(std::memory_order_relaxed) + 1) % c_NumFrameArenas;
+	state->frame_arenas[next].reset();
+	state->current_frame_arena.store(next, std::memory_order_relaxed);
+}
+
+void MemoryAllocators::set_budget(MemoryCategory category, u64 bytes)
+{
+	s_allocator_state->budgets[*category].store(bytes, std::memory_order_relaxed);
+}
+
+MemoryBudgetStats MemoryAllocators::get_budget_stats(MemoryCategory category)
+{
+	AllocatorState* state = s_allocator_state;
+	if (!state)
+	{
+		return {};
+	}
+
+	MemoryBudgetStats stats{};
+	stats.budget = state->budgets[*category].load(std::memory_order_relaxed);
+	stats.used = state->used[*category].load(std::memory_order_relaxed);
+	stats.failed_allocations = state->failed_allocations[*category].load(std::memory_order_relaxed);
+	return stats;
+}
+
+LinearArena const& MemoryAllocators::get_frame_arena()
+{
+	return s_allocator_state->frame_arenas[s_allocator_state->current_frame_arena.load(std::memory_order_relaxed)];
+}
+
+FixedBlockPool const& MemoryAllocators::get_pool(MemoryCategory category, u8 pool)
+{
+	return s_allocator_state->pools[*category][pool];
+}
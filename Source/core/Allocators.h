@@ -0,0 +1,220 @@
+#pragma once
+
+#include "Memory.h"
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+
+// Bump allocator that is reset as a whole. Individual frees are a no-op.
+// Allocating is a single atomic add so it is safe to use from multiple threads.
+class CORE_API LinearArena final
+{
+public:
+	LinearArena() = default;
+	~LinearArena();
+
+	LinearArena(LinearArena const&) = delete;
+	LinearArena& operator=(LinearArena const&) = delete;
+
+	void init(size_t capacity);
+	void deinit();
+
+	// Returns nullptr when the arena is exhausted
+	void* allocate(size_t size, size_t alignment = 16);
+
+	// Invalidates all memory handed out by this arena
+	void reset();
+
+	bool owns(void const* mem) const { return mem >= _base && mem < _base + _capacity; }
+
+	size_t get_used() const { return std::min<size_t>(_offset.load(std::memory_order_relaxed), _capacity); }
+	size_t get_capacity() const { return _capacity; }
+	size_t get_high_water_mark() const { return _high_water_mark; }
+
+private:
+	u8* _base = nullptr;
+	size_t _capacity = 0;
+	std::atomic<size_t> _offset = 0;
+	size_t _high_water_mark = 0;
+};
+
+// Contiguous range of pages shared by all pools. Every page remembers which pool it was handed to so a free can find
+// the pool of a block from its address alone.
+class CORE_API PageRegion final
+{
+public:
+	static constexpr u8 c_NoOwner = 0xFF;
+
+	PageRegion() = default;
+	~PageRegion();
+
+	PageRegion(PageRegion const&) = delete;
+	PageRegion& operator=(PageRegion const&) = delete;
+
+	void init(size_t capacity, size_t page_size);
+	void deinit();
+
+	// Returns nullptr once the region is exhausted
+	u8* allocate_page(u8 owner);
+
+	bool owns(void const* mem) const { return mem >= _base && mem < _base + _capacity; }
+	u8 get_owner(void const* mem) const { return _owners[size_t((u8 const*)mem - _base) / _page_size]; }
+
+	size_t get_used() const { return std::min<size_t>(_used.load(std::memory_order_relaxed), _capacity); }
+	size_t get_capacity() const { return _capacity; }
+
+private:
+	u8* _base = nullptr;
+	u8* _owners = nullptr;
+	size_t _capacity = 0;
+	size_t _page_size = 0;
+	std::atomic<size_t> _used = 0;
+};
+
+// Pool of equally sized blocks. Standalone pools malloc their pages and release them on deinit, pools that share a region
+// carve their pages out of it and never give them back.
+class CORE_API FixedBlockPool final
+{
+public:
+	static constexpr size_t c_PageSize = 64 * 1024;
+
+	FixedBlockPool() = default;
+	~FixedBlockPool();
+
+	FixedBlockPool(FixedBlockPool const&) = delete;
+	FixedBlockPool& operator=(FixedBlockPool const&) = delete;
+
+	void init(size_t block_size, PageRegion* region = nullptr, u8 owner = PageRegion::c_NoOwner);
+	void deinit();
+
+	// Returns nullptr once the region is exhausted
+	void* allocate();
+	void free(void* mem);
+
+	// Moves up to 'count' blocks into 'blocks' under a single lock, returns the number of blocks handed out
+	u32 allocate_batch(void** blocks, u32 count);
+	void free_batch(void* const* blocks, u32 count);
+
+	size_t get_block_size() const { return _block_size; }
+	// Includes the blocks sitting in the thread caches of MemoryAllocators
+	size_t get_blocks_in_use() const { return _blocks_in_use; }
+	size_t get_num_pages() const { return _num_pages; }
+
+private:
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	void grow();
+
+	std::mutex _lock;
+	size_t _block_size = 0;
+	size_t _blocks_in_use = 0;
+	FreeBlock* _free_list = nullptr;
+
+	PageRegion* _region = nullptr;
+	u8 _owner = PageRegion::c_NoOwner;
+	size_t _num_pages = 0;
+
+	// Pages of a standalone pool, stored in a plain malloc'd array to avoid going through operator new
+	u8** _pages = nullptr;
+	size_t _pages_capacity = 0;
+};
+
+// Identifies which allocator served an allocation
+enum class AllocatorType : u8
+{
+	// Plain malloc, untagged or allocated before the allocators were initialised
+	System,
+	Heap,
+	Pool,
+	Frame
+};
+
+struct MemoryAllocatorCfg
+{
+	// Serve small tagged allocations from per category pools
+	bool m_EnablePools = true;
+
+	// Address range reserved up front for the pools of all categories, pools fall back to the heap once it is used up
+	size_t m_PoolRegionSize = 64 * 1024 * 1024;
+
+	// Size of each of the frame arenas used by MemoryCategory::Frame
+	size_t m_FrameArenaSize = 8 * 1024 * 1024;
+
+	// Hard limits per category in bytes. 0 means unlimited. MemoryCategory::None is never budgeted.
+	u64 m_Budgets[*MemoryCategory::Count] = {};
+};
+
+struct MemoryBudgetStats
+{
+	// Only counted while a budget is set for the category
+	u64 used;
+	u64 budget;
+
+	// Allocations refused because of the budget. For MemoryCategory::Frame this counts arena overflows that went to the heap instead.
+	u64 failed_allocations;
+};
+
+// Routes allocations to the allocator matching the current MEMORY_TAG category.
+//	MemoryCategory::None      -> plain malloc, untagged allocations don't pay for any routing
+//	MemoryCategory::Frame     -> frame arena, reclaimed c_NumFrameArenas frames later by begin_frame()
+//	size <= c_MaxPoolSize     -> fixed block pool of the category, through a per thread cache
+//	otherwise                 -> general heap
+// Blocks carry no header, frees find the allocator from the address instead: pools and arenas by their address range,
+// tagged heap blocks through a side table and anything else is a System block.
+// In the DLL build other modules release Core allocations with their own CRT free(), only malloc blocks survive that so
+// the pools and frame arenas are not used there.
+class CORE_API MemoryAllocators final
+{
+public:
+	static constexpr size_t c_PoolBlockSizes[] = { 16, 32, 64, 128, 256, 512 };
+	static constexpr u8 c_NumPools = u8(std::size(c_PoolBlockSizes));
+	static constexpr size_t c_MaxPoolSize = c_PoolBlockSizes[c_NumPools - 1];
+
+	// Frame memory allocated on the main thread is consumed by the graphics thread up to three frames later (the maximum amount of frames in flight).
+	//	An arena can only be reclaimed once every frame that used it has been presented.
+	static constexpr u32 c_NumFrameArenas = 4;
+
+	struct Allocation
+	{
+		void* mem;
+		AllocatorType type;
+		MemoryCategory category;
+
+		// Bytes accounted for the block, the same value is returned when the block is released
+		size_t size;
+
+		// Counted against the category budget
+		bool budgeted;
+	};
+
+	// Pools and arenas are never released, memory handed out can still be freed after deinit.
+	static void init(MemoryAllocatorCfg const& cfg);
+	static void deinit();
+	static bool is_initialised();
+
+	// Allocates 'size' bytes for the category. Returns a null allocation when over budget.
+	static Allocation allocate(MemoryCategory category, size_t size);
+
+	// Looks up the allocator of 'mem' and unregisters it, the memory stays valid until it is passed to free().
+	//	Safe to call with memory that didn't come from allocate().
+	static Allocation release(void* mem);
+	static void free(Allocation const& allocation);
+
+	// Size malloc reserved for a block, System blocks are accounted with it as nothing else records their size
+	static size_t get_system_size(void* mem);
+
+	// Switches to the next frame arena and reclaims it. Must be called at the main/graphics thread sync point.
+	static void begin_frame();
+
+	static void set_budget(MemoryCategory category, u64 bytes);
+	static MemoryBudgetStats get_budget_stats(MemoryCategory category);
+
+	// Returns the arena currently serving MemoryCategory::Frame
+	static LinearArena const& get_frame_arena();
+	static FixedBlockPool const& get_pool(MemoryCategory category, u8 pool);
+};
+
+#pragma warning(pop)
@@ -0,0 +1,243 @@
+#include "core.pch.h"
+#include "Compression.h"
+
+namespace Compression
+{
+
+namespace
+{
+
+constexpr size_t c_MinMatch = 4;
+constexpr size_t c_MaxOffset = 65535;
+
+// The last bytes are always stored as literals so matches never read past the end
+constexpr size_t c_LastLiterals = 5;
+constexpr size_t c_MatchLimit = 12;
+
+constexpr u32 c_HashLog = 12;
+
+u32 hash4(u8 const* p)
+{
+	u32 v;
+	memcpy(&v, p, sizeof(v));
+	return (v * 2654435761u) >> (32 - c_HashLog);
+}
+
+bool write_length(u8*& op, u8 const* oend, size_t length)
+{
+	for (; length >= 255; length -= 255)
+	{
+		if (op == oend)
+		{
+			return false;
+		}
+		*op++ = 255;
+	}
+
+	if (op == oend)
+	{
+		return false;
+	}
+	*op++ = u8(length);
+	return true;
+}
+
+bool read_length(u8 const*& ip, u8 const* iend, size_t& length)
+{
+	u8 b;
+	do
+	{
+		if (ip == iend)
+		{
+			return false;
+		}
+		b = *ip++;
+		length += b;
+	} while (b == 255);
+	return true;
+}
+
+// Writes a sequence, a match length of 0 writes the trailing literals without a match
+bool write_sequence(u8*& op, u8 const* oend, u8 const* literals, size_t n_literals, size_t offset, size_t match_length)
+{
+	if (op == oend)
+	{
+		return false;
+	}
+
+	u8* token = op++;
+	*token = u8(std::min<size_t>(n_literals, 15) << 4);
+	if (n_literals >= 15 && !write_length(op, oend, n_literals - 15))
+	{
+		return false;
+	}
+
+	if (size_t(oend - op) < n_literals)
+	{
+		return false;
+	}
+	if (n_literals > 0)
+	{
+		memcpy(op, literals, n_literals);
+		op += n_literals;
+	}
+
+	if (match_length == 0)
+	{
+		return true;
+	}
+
+	if (oend - op < 2)
+	{
+		return false;
+	}
+	*op++ = u8(offset);
+	*op++ = u8(offset >> 8);
+
+	size_t length = match_length - c_MinMatch;
+	*token |= u8(std::min<size_t>(length, 15));
+	return length < 15 || write_length(op, oend, length - 15);
+}
+
+} // namespace
+
+size_t get_max_compressed_size(size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+size_t compress(u8 const* src, size_t size, u8* dst, size_t capacity)
+{
+	u8* op = dst;
+	u8 const* oend = dst + capacity;
+
+	u8 const* ip = src;
+	u8 const* anchor = src;
+	u8 const* iend = src + size;
+
+	if (size >= c_MatchLimit)
+	{
+		u8 const* mflimit = iend - c_MatchLimit;
+		u8 const* matchlimit = iend - c_LastLiterals;
+
+		// Offsets of the last position with a given hash
+		std::vector<u32> table(size_t(1) << c_HashLog, 0);
+
+		while (ip <= mflimit)
+		{
+			u32 h = hash4(ip);
+			u8 const* ref = src + table[h];
+			table[h] = u32(ip - src);
+
+			if (ref >= ip || size_t(ip - ref) > c_MaxOffset || memcmp(ref, ip, c_MinMatch) != 0)
+			{
+				++ip;
+				continue;
+			}
+
+			// Extend the match in both directions
+			while (ip > anchor && ref > src && ip[-1] == ref[-1])
+			{
+				--ip;
+				--ref;
+			}
+
+			u8 const* match_end = ip + c_MinMatch;
+			for (u8 const* r = ref + c_MinMatch; match_end < matchlimit && *match_end == *r; ++r)
+			{
+				++match_end;
+			}
+
+			if (!write_sequence(op, oend, anchor, size_t(ip - anchor), size_t(ip - ref), size_t(match_end - ip)))
+			{
+				return 0;
+			}
+
+			ip = match_end;
+			anchor = ip;
+		}
+	}
+
+	if (!write_sequence(op, oend, anchor, size_t(iend - anchor), 0, 0))
+	{
+		return 0;
+	}
+	return size_t(op - dst);
+}
+
+bool decompress(u8 const* src, size_t size, u8* dst, size_t dst_size)
+{
+	u8 const* ip = src;
+	u8 const* iend = src + size;
+	u8* op = dst;
+	u8* oend = dst + dst_size;
+
+	while (ip < iend)
+	{
+		u8 token = *ip++;
+
+		size_t n_literals = token >> 4;
+		if (n_literals == 15 && !read_length(ip, iend, n_literals))
+		{
+			return false;
+		}
+
+		if (n_literals > size_t(iend - ip) || n_literals > size_t(oend - op))
+		{
+			return false;
+		}
+		if (n_literals > 0)
+		{
+			memcpy(op, ip, n_literals);
+			ip += n_literals;
+			op += n_literals;
+		}
+
+		// The last sequence only has literals
+		if (ip == iend)
+		{
+			break;
+		}
+
+		if (iend - ip < 2)
+		{
+			return false;
+		}
+		size_t offset = size_t(ip[0]) | (size_t(ip[1]) << 8);
+		ip += 2;
+		if (offset == 0 || offset > size_t(op - dst))
+		{
+			return false;
+		}
+
+		size_t length = token & 15;
+		if (length == 15 && !read_length(ip, iend, length))
+		{
+			return false;
+		}
+		length += c_MinMatch;
+		if (length > size_t(oend - op))
+		{
+			return false;
+		}
+
+		// Matches can overlap the output they produce
+		u8 const* match = op - offset;
+		if (offset >= length)
+		{
+			memcpy(op, match, length);
+		}
+		else
+		{
+			for (size_t i = 0; i < length; ++i)
+			{
+				op[i] = match[i];
+			}
+		}
+		op += length;
+	}
+
+	return op == oend;
+}
+
+} // namespace Compression
@@ -0,0 +1,18 @@
+#pragma once
+
+// Byte oriented LZ77 codec used for packed resources.
+//	The block layout follows LZ4: a token with the literal and match lengths, the literals and a 16 bit match offset.
+//	Decompression is a single pass without allocations, which makes it cheap enough to run while loading.
+namespace Compression
+{
+
+// Upper bound of the compressed size, used to size the destination buffer
+CORE_API size_t get_max_compressed_size(size_t size);
+
+// Returns the compressed size or 0 if 'dst' is too small
+CORE_API size_t compress(u8 const* src, size_t size, u8* dst, size_t capacity);
+
+// Returns false if the data is corrupt or doesn't decompress to exactly 'dst_size' bytes
+CORE_API bool decompress(u8 const* src, size_t size, u8* dst, size_t dst_size);
+
+} // namespace Compression
@@ -57,8 +57,6 @@
 #include <fmt/printf.h>
 #include <fmt/xchar.h>
 
-#include <TaskScheduler.h>
-
 #include <cassert>
 #include <filesystem>
 
@@ -101,19 +99,20 @@
 #define CORE_API
 #endif
 
-namespace Tasks
-{
-
-CORE_API enki::TaskScheduler* get_scheduler();
-
-}
-
 #include "Asserts.h"
 #include "Hash.h"
 #include "Math.h"
 #include "Types.h"
 #include "Identifier.h"
 #include "Thread.h"
+#include "Jobs.h"
+
+namespace Tasks
+{
+
+CORE_API JobSystem* get_scheduler();
+
+}
 #include <chrono>
 #include <semaphore>
 
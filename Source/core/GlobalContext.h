@@ -5,14 +5,14 @@ namespace IO
 class IPlatformIO;
 }
 
-namespace enki
+namespace Tasks
 {
-class TaskScheduler;
+class JobSystem;
 }
 
 struct GlobalContext
 {
-	enki::TaskScheduler*  m_TaskScheduler;
+	Tasks::JobSystem*     m_TaskScheduler;
 	IO::IPlatformIO*      m_PlatformIO;
 	class GameEngine*     m_Engine;
 	class InputManager*   m_InputManager;
@@ -49,4 +49,25 @@ inline uint32_t fnv1a(std::string const& data, uint32_t hash = Seed)
 	return fnv1a(data.data(), data.size() * sizeof(data[0]), hash);
 }
 
+// 64 bit variant for keys where collisions of the 32 bit hash are likely, e.g. large sets of call stacks
+const uint64_t Prime64 = 0x00000100000001B3;
+const uint64_t Seed64 = 0xCBF29CE484222325;
+
+inline uint64_t fnv1a64(const void* data, size_t numBytes, uint64_t hash = Seed64)
+{
+	assert(data);
+	const unsigned char* ptr = reinterpret_cast<const unsigned char*>(data);
+	while (numBytes--)
+	{
+		hash = (*ptr++ ^ hash) * Prime64;
+	}
+	return hash;
+}
+
+template <typename T>
+inline uint64_t fnv1a64(T const& data, uint64_t hash = Seed64)
+{
+	return fnv1a64((void*)&data, sizeof(T), hash);
+}
+
 } // namespace Hash
\ No newline at end of file
@@ -0,0 +1,280 @@
+#include "core.pch.h"
+#include "Jobs.h"
+#include "Memory.h"
+
+namespace Tasks
+{
+
+thread_local static JobSystem* s_current_system = nullptr;
+thread_local static u32 s_current_worker = JobSystem::c_InvalidWorker;
+
+JobSystem::~JobSystem()
+{
+	shutdown();
+}
+
+void JobSystem::init(JobSystemCfg const& cfg)
+{
+	ASSERT(!_running);
+
+	u32 num_workers = cfg.m_NumWorkers;
+	if (num_workers == 0)
+	{
+		num_workers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	}
+
+	_num_queues = num_workers + 1;
+	_queues = std::make_unique<JobQueue[]>(_num_queues);
+	_running = true;
+
+	_workers.reserve(num_workers);
+	for (u32 i = 0; i < num_workers; ++i)
+	{
+		_workers.emplace_back([this, i, on_start = cfg.m_OnWorkerStart]() { worker_main(i, on_start); });
+	}
+}
+
+void JobSystem::shutdown()
+{
+	if (!_running)
+	{
+		return;
+	}
+
+	wait_for_all();
+
+	{
+		std::lock_guard lock{ _sleep_lock };
+		_running = false;
+	}
+	_sleep_cv.notify_all();
+
+	for (std::thread& worker : _workers)
+	{
+		worker.join();
+	}
+	_workers.clear();
+	_queues.reset();
+	_num_queues = 0;
+}
+
+void JobSystem::run(JobFn fn, JobCounter* counter)
+{
+	if (counter)
+	{
+		counter->_pending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Job job{ std::move(fn), counter };
+	if (!_running)
+	{
+		_pending_jobs.fetch_add(1, std::memory_order_relaxed);
+		execute(job);
+		return;
+	}
+
+	_pending_jobs.fetch_add(1, std::memory_order_relaxed);
+	{
+		JobQueue& queue = _queues[get_queue_index()];
+		std::lock_guard lock{ queue.lock };
+		queue.jobs.push_back(std::move(job));
+	}
+
+	// Either the sleeping worker sees the queued job or we see the sleeping worker, both are sequentially consistent
+	_queued_jobs.fetch_add(1);
+	if (_sleeping_workers.load() > 0)
+	{
+		{
+			std::lock_guard lock{ _sleep_lock };
+		}
+		_sleep_cv.notify_one();
+	}
+	// A waiting thread might be able to help with the new job
+	notify_progress();
+}
+
+void JobSystem::parallel_for(u32 count, u32 batch_size, std::function<void(u32 begin, u32 end)> fn, JobCounter* counter)
+{
+	ASSERT(batch_size > 0);
+
+	// Every batch shares the same function object instead of copying it
+	auto shared_fn = std::make_shared<std::function<void(u32, u32)>>(std::move(fn));
+	for (u32 begin = 0; begin < count; begin += batch_size)
+	{
+		u32 end = std::min(count, begin + batch_size);
+		run([shared_fn, begin, end]() { (*shared_fn)(begin, end); }, counter);
+	}
+}
+
+void JobSystem::wait(JobCounter const& counter)
+{
+	u32 queue = _running ? get_queue_index() : 0;
+	while (!counter.is_done())
+	{
+		if (!_running || !try_execute(queue, &counter))
+		{
+			sleep_until_progress([&counter]() { return counter.is_done(); });
+		}
+	}
+}
+
+void JobSystem::wait_for_all()
+{
+	u32 queue = _running ? get_queue_index() : 0;
+	auto is_done = [this]() { return _pending_jobs.load(std::memory_order_acquire) == 0; };
+	while (!is_done())
+	{
+		if (!_running || !try_execute(queue))
+		{
+			sleep_until_progress(is_done);
+		}
+	}
+}
+
+template<typename Fn>
+void JobSystem::sleep_until_progress(Fn const& is_done)
+{
+	// Same handshake as the sleeping workers: either notify_progress sees the waiting thread or the new progress value is seen here
+	_waiting_threads.fetch_add(1);
+	u32 progress = _progress.load();
+	if (!is_done())
+	{
+		_progress.wait(progress);
+	}
+	_waiting_threads.fetch_sub(1);
+}
+
+void JobSystem::notify_progress()
+{
+	_progress.fetch_add(1);
+	if (_waiting_threads.load() > 0)
+	{
+		_progress.notify_all();
+	}
+}
+
+u32 JobSystem::get_current_worker()
+{
+	return s_current_worker;
+}
+
+void JobSystem::worker_main(u32 worker, std::function<void(u32)> on_start)
+{
+	s_current_system = this;
+	s_current_worker = worker;
+
+	if (on_start)
+	{
+		on_start(worker);
+	}
+
+	while (_running)
+	{
+		if (try_execute(worker))
+		{
+			continue;
+		}
+
+		std::unique_lock lock{ _sleep_lock };
+		_sleeping_workers.fetch_add(1);
+		_sleep_cv.wait(lock, [this]() { return _queued_jobs.load() > 0 || !_running; });
+		_sleeping_workers.fetch_sub(1);
+	}
+
+	s_current_system = nullptr;
+	s_current_worker = c_InvalidWorker;
+}
+
+u32 JobSystem::get_queue_index() const
+{
+	if (s_current_system == this)
+	{
+		return s_current_worker;
+	}
+	return _num_queues - 1;
+}
+
+bool JobSystem::try_execute(u32 queue, JobCounter const* counter)
+{
+	Job job;
+	if (pop(queue, counter, job) || steal(queue, counter, job))
+	{
+		execute(job);
+		return true;
+	}
+	return false;
+}
+
+bool JobSystem::pop(u32 queue, JobCounter const* counter, Job& job)
+{
+	JobQueue& q = _queues[queue];
+	std::lock_guard lock{ q.lock };
+	auto matches = [counter](Job const& j) { return counter == nullptr || j.counter == counter; };
+
+	// The shared queue is FIFO, worker queues are LIFO as the newest job is the most likely to be in cache
+	std::deque<Job>::iterator it;
+	if (queue == _num_queues - 1)
+	{
+		it = std::find_if(q.jobs.begin(), q.jobs.end(), matches);
+	}
+	else
+	{
+		auto rit = std::find_if(q.jobs.rbegin(), q.jobs.rend(), matches);
+		it = rit == q.jobs.rend() ? q.jobs.end() : std::prev(rit.base());
+	}
+
+	if (it == q.jobs.end())
+	{
+		return false;
+	}
+
+	job = std::move(*it);
+	q.jobs.erase(it);
+	_queued_jobs.fetch_sub(1);
+	return true;
+}
+
+bool JobSystem::steal(u32 queue, JobCounter const* counter, Job& job)
+{
+	// Start at the next queue so thieves spread out over the victims, this also visits the shared queue
+	for (u32 i = 1; i < _num_queues; ++i)
+	{
+		JobQueue& victim = _queues[(queue + i) % _num_queues];
+		std::unique_lock lock{ victim.lock, std::try_to_lock };
+		if (!lock.owns_lock())
+		{
+			continue;
+		}
+
+		auto it = std::find_if(victim.jobs.begin(), victim.jobs.end(), [counter](Job const& j) { return counter == nullptr || j.counter == counter; });
+		if (it == victim.jobs.end())
+		{
+			continue;
+		}
+
+		job = std::move(*it);
+		victim.jobs.erase(it);
+		_queued_jobs.fetch_sub(1);
+		return true;
+	}
+	return false;
+}
+
+void JobSystem::execute(Job& job)
+{
+	// Jobs don't inherit the memory tag of whichever thread happens to execute them
+	{
+		MEMORY_TAG(MemoryCategory::None);
+		job.fn();
+	}
+
+	// The counter can be destroyed as soon as it reaches zero, don't touch the job afterwards
+	if (job.counter)
+	{
+		job.counter->_pending.fetch_sub(1, std::memory_order_release);
+	}
+	_pending_jobs.fetch_sub(1, std::memory_order_release);
+	notify_progress();
+}
+
+} // namespace Tasks
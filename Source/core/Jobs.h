@@ -0,0 +1,136 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+
+namespace Tasks
+{
+
+// Counts outstanding jobs. A single counter can be shared by many jobs, it reaches zero once all of them have executed.
+class JobCounter final
+{
+public:
+	JobCounter() = default;
+
+	JobCounter(JobCounter const&) = delete;
+	JobCounter& operator=(JobCounter const&) = delete;
+
+	bool is_done() const { return _pending.load(std::memory_order_acquire) == 0; }
+	u32 get_pending() const { return _pending.load(std::memory_order_relaxed); }
+
+private:
+	friend class JobSystem;
+
+	std::atomic<u32> _pending = 0;
+};
+
+using JobFn = std::function<void()>;
+
+struct JobSystemCfg
+{
+	// Number of worker threads. 0 uses all hardware threads except the calling one.
+	u32 m_NumWorkers = 0;
+
+	// Called on every worker thread before it starts executing jobs
+	std::function<void(u32 worker)> m_OnWorkerStart;
+};
+
+// Work stealing job system.
+//	Every worker owns a queue, jobs scheduled from a worker go to its own queue and are executed LIFO for cache locality.
+//	Idle workers steal the oldest jobs from the other queues. Threads outside of the job system (main, graphics) push to a shared queue.
+//	Waiting on a counter executes jobs of that counter on the waiting thread instead of blocking it. Unrelated jobs (e.g. long
+//	resource loads) are left to the workers so a waiting frame isn't stalled by them.
+class CORE_API JobSystem final
+{
+public:
+	static constexpr u32 c_InvalidWorker = ~0u;
+
+	JobSystem() = default;
+	~JobSystem();
+
+	JobSystem(JobSystem const&) = delete;
+	JobSystem& operator=(JobSystem const&) = delete;
+
+	void init(JobSystemCfg const& cfg = {});
+
+	// Finishes all pending jobs and joins the workers
+	void shutdown();
+
+	// Schedules a job. The counter is incremented immediately and decremented once the job has executed.
+	// Without workers (before init or after shutdown) the job is executed inline.
+	void run(JobFn fn, JobCounter* counter = nullptr);
+
+	// Splits [0, count) into batches of 'batch_size' and executes fn(begin, end) for every batch in parallel.
+	void parallel_for(u32 count, u32 batch_size, std::function<void(u32 begin, u32 end)> fn, JobCounter* counter);
+
+	// Executes jobs of the counter on the calling thread until it reaches zero. Safe to call from within a job.
+	//	Once there is nothing left to help with the thread sleeps until another job is queued or finishes.
+	void wait(JobCounter const& counter);
+
+	// Executes jobs on the calling thread until every scheduled job has finished
+	void wait_for_all();
+
+	u32 get_num_workers() const { return u32(_workers.size()); }
+
+	// Index of the calling worker thread, c_InvalidWorker when called from a thread that isn't part of the job system
+	static u32 get_current_worker();
+
+private:
+	struct Job
+	{
+		JobFn fn;
+		JobCounter* counter;
+	};
+
+	struct alignas(64) JobQueue
+	{
+		std::mutex lock;
+		std::deque<Job> jobs;
+	};
+
+	void worker_main(u32 worker, std::function<void(u32)> on_start);
+
+	// Queue the calling thread pushes to and pops from first
+	u32 get_queue_index() const;
+
+	// A 'counter' only takes jobs of that counter, nullptr takes any job
+	bool try_execute(u32 queue, JobCounter const* counter = nullptr);
+	bool pop(u32 queue, JobCounter const* counter, Job& job);
+	bool steal(u32 queue, JobCounter const* counter, Job& job);
+	void execute(Job& job);
+
+	// Blocks until a job is queued or finishes, 'is_done' is checked after registering so no wake up is missed
+	template<typename Fn>
+	void sleep_until_progress(Fn const& is_done);
+	void notify_progress();
+
+	std::vector<std::thread> _workers;
+
+	// One queue per worker followed by the shared queue
+	std::unique_ptr<JobQueue[]> _queues;
+	u32 _num_queues = 0;
+
+	// Scheduled jobs that haven't finished yet
+	std::atomic<u32> _pending_jobs = 0;
+
+	// Jobs sitting in a queue, workers only go to sleep when this is zero
+	std::atomic<u32> _queued_jobs = 0;
+
+	// Bumped whenever a job is queued or finishes, threads in wait() sleep on it
+	std::atomic<u32> _progress = 0;
+	std::atomic<u32> _waiting_threads = 0;
+
+	std::atomic<u32> _sleeping_workers = 0;
+	std::mutex _sleep_lock;
+	std::condition_variable _sleep_cv;
+
+	std::atomic<bool> _running = false;
+};
+
+} // namespace Tasks
+
+#pragma warning(pop)
@@ -1,11 +1,38 @@
 #include "Core.pch.h"
 #include "Memory.h"
+#include "Allocators.h"
 #include <source_location>
 
+#ifdef WIN64
+#include <DbgHelp.h>
+#pragma comment(lib, "dbghelp.lib")
+#endif
+
 std::atomic<bool> s_initialised = false;
 char g_reserved_memory[sizeof(MemoryTracker)] = {};
 thread_local bool s_should_track = true;
 thread_local static MemoryTracker* g_tracker = nullptr;
+thread_local static MemoryCategory s_current_category = MemoryCategory::None;
+
+// Binds a shard to the current thread and hands it back when the thread exits
+struct MemoryShardBinding
+{
+	~MemoryShardBinding()
+	{
+		if (_shard)
+		{
+			_shard->_in_use.store(false, std::memory_order_release);
+			_shard = nullptr;
+		}
+		_released = true;
+	}
+
+	MemoryTrackerShard* _shard = nullptr;
+
+	// Set once the thread gave its shard back, later frees on this thread must not acquire a new one
+	bool _released = false;
+};
+thread_local static MemoryShardBinding s_shard_binding;
 
 bool is_tracker_initialised()
 {
@@ -22,45 +49,76 @@ MemoryTracker* get_memory_tracker()
 	return  g_tracker;
 }
 
-void* operator new(size_t size)
+// Pointers are handed out exactly as the backing allocator returned them, see MemoryAllocators.
+//	Frame arena blocks aren't tracked, they are freed as a whole and the arena reports its own usage.
+static void* tracked_alloc(size_t size)
 {
-	void* result = std::malloc(size);
+	MemoryAllocators::Allocation allocation{};
+	if (MemoryAllocators::is_initialised())
+	{
+		allocation = MemoryAllocators::allocate(s_current_category, size);
+	}
+	else if (void* mem = std::malloc(size); mem)
+	{
+		allocation = { mem, AllocatorType::System, MemoryCategory::None, MemoryAllocators::get_system_size(mem), false };
+	}
+
+	if (!allocation.mem)
+	{
+		throw std::bad_alloc();
+	}
 
-	if(s_initialised)
+	if (s_initialised && allocation.type != AllocatorType::Frame && get_memory_tracker()->should_track())
 	{
-		get_memory_tracker()->TrackAllocation(result, size);
+		get_memory_tracker()->TrackAllocation(allocation.mem, allocation.size, allocation.category);
 	}
-	return result;
+	return allocation.mem;
 }
 
-void* operator new[](size_t size)
+static void tracked_free(void* mem)
 {
-	void* result = std::malloc(size);
+	if (!mem)
+		return;
 
-	if (s_initialised)
+	// Memory might have been allocated by another module, release() falls back to a System block for anything it doesn't know
+	MemoryAllocators::Allocation allocation = MemoryAllocators::release(mem);
+	if (s_initialised && allocation.type != AllocatorType::Frame)
 	{
-		get_memory_tracker()->TrackAllocation(result, size);
+		get_memory_tracker()->TrackDeallocation(mem, allocation.size, allocation.category);
 	}
-	return result;
+	MemoryAllocators::free(allocation);
 }
 
+void* operator new(size_t size)
+{
+	return tracked_alloc(size);
+}
 
-void operator delete(void* mem) 
+void* operator new[](size_t size)
 {
-	if (s_initialised)
-	{
-		get_memory_tracker()->TrackDeallocation(mem);
-	}
-	std::free(mem);
+	return tracked_alloc(size);
 }
 
-void operator delete[](void* mem) 
+
+void operator delete(void* mem)
 {
-	if (s_initialised)
-	{
-		get_memory_tracker()->TrackDeallocation(mem);
-	}
-	std::free(mem);
+	tracked_free(mem);
+}
+
+void operator delete[](void* mem)
+{
+	tracked_free(mem);
+}
+
+// Sized deletes have to end up in the same place, compilers are free to call them instead of the unsized ones
+void operator delete(void* mem, size_t)
+{
+	tracked_free(mem);
+}
+
+void operator delete[](void* mem, size_t)
+{
+	tracked_free(mem);
 }
 
 
@@ -72,17 +130,53 @@ const char* MemoryCategoryToString(MemoryCategory category)
 		"Graphics",
 		"Game",
 		"ResourceLoading",
-		"Debug"
+		"Debug",
+		"Frame"
 	};
+	static_assert(std::size(s_values) == *MemoryCategory::Count);
 	return s_values[*category];
 }
 
+void MemoryTrackerShard::record_allocation(MemoryCategory category, size_t size)
+{
+	Counters& c = _counters[*category];
+	if (_shared)
+	{
+		c.allocated.fetch_add(size, std::memory_order_relaxed);
+		c.n_allocs.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	// Only the owning thread writes to the shard so a relaxed load/store pair is enough, no locked instructions required.
+	c.allocated.store(c.allocated.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+	c.n_allocs.store(c.n_allocs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
 
-void MemoryTracker::init()
+void MemoryTrackerShard::record_deallocation(MemoryCategory category, size_t size)
+{
+	Counters& c = _counters[*category];
+	if (_shared)
+	{
+		c.freed.fetch_add(size, std::memory_order_relaxed);
+		c.n_frees.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	c.freed.store(c.freed.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+	c.n_frees.store(c.n_frees.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void MemoryTracker::init(MemoryTrackingMode mode)
 {
 	if (!s_initialised)
 	{
-		new (g_reserved_memory) MemoryTracker();
+		MemoryTracker* tracker = new (g_reserved_memory) MemoryTracker();
+		tracker->_mode = mode;
+
+		// The fallback shard is permanently in use so it is never adopted by a thread
+		tracker->_fallback_shard._shared = true;
+		tracker->_fallback_shard._in_use.store(true, std::memory_order_relaxed);
+		tracker->_fallback_shard._next = nullptr;
+		tracker->_shards.store(&tracker->_fallback_shard, std::memory_order_release);
 		s_initialised = true;
 	}
 }
@@ -92,45 +186,221 @@ bool MemoryTracker::should_track() const
 	return s_initialised&& s_should_track;
 }
 
+MemoryCategory MemoryTracker::get_current_category()
+{
+	return s_current_category;
+}
+
+void MemoryTracker::set_current_category(MemoryCategory category)
+{
+	s_current_category = category;
+}
+
+// Used while the tracker touches its own containers. The category is reset as well so those allocations never come from
+// the caller's tagged allocator (e.g. the recycled frame arena).
 struct ScopedMemTrackDisable
 {
 	ScopedMemTrackDisable()
+			: _prev_track(s_should_track)
+			, _prev_category(s_current_category)
 	{
 		s_should_track = false;
+		s_current_category = MemoryCategory::None;
 	}
 	~ScopedMemTrackDisable()
 	{
-	
-		s_should_track = true;
+		s_should_track = _prev_track;
+		s_current_category = _prev_category;
 	}
 
+	bool _prev_track;
+	MemoryCategory _prev_category;
 };
-void MemoryTracker::TrackAllocation(void* mem, size_t size)
+
+// Captures the stack of the code calling operator new. Returns the number of frames and a hash of the stack.
+static u32 capture_call_stack(void** frames, u64& hash)
+{
+	hash = 0;
+#ifdef WIN64
+	// Skips this function, TrackAllocation and tracked_alloc. operator new remains the top frame when tracked_alloc is inlined.
+	constexpr u32 c_SkipFrames = 3;
+	u32 n_frames = RtlCaptureStackBackTrace(c_SkipFrames, MemoryCallSite::c_MaxFrames, frames, nullptr);
+
+	// Hash module relative offsets so the same site gets the same hash between runs, this allows reports to be diffed
+	u64 result = Hash::Seed64;
+	for (u32 i = 0; i < n_frames; ++i)
+	{
+		void* module_base = nullptr;
+		RtlPcToFileHeader(frames[i], &module_base);
+		result = Hash::fnv1a64(u64(frames[i]) - u64(module_base), result);
+	}
+	hash = result;
+	return n_frames;
+#else
+	return 0;
+#endif
+}
+
+static void symbolise(void* address, char* buffer, size_t buffer_size)
+{
+#ifdef WIN64
+	// Only called with the tracking lock held, DbgHelp is not thread safe
+	static bool s_symbols_initialised = false;
+	HANDLE process = GetCurrentProcess();
+	if (!s_symbols_initialised)
+	{
+		SymSetOptions(SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES);
+		SymInitialize(process, nullptr, TRUE);
+		s_symbols_initialised = true;
+	}
+
+	u64 storage[(sizeof(SYMBOL_INFO) + MAX_SYM_NAME + sizeof(u64) - 1) / sizeof(u64)] = {};
+	SYMBOL_INFO* symbol = (SYMBOL_INFO*)storage;
+	symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+	symbol->MaxNameLen = MAX_SYM_NAME;
+
+	DWORD64 displacement = 0;
+	if (SymFromAddr(process, DWORD64(address), &displacement, symbol))
+	{
+		IMAGEHLP_LINE64 line{};
+		line.SizeOfStruct = sizeof(IMAGEHLP_LINE64);
+		DWORD line_displacement = 0;
+		if (SymGetLineFromAddr64(process, DWORD64(address), &line_displacement, &line))
+		{
+			snprintf(buffer, buffer_size, "%s (%s:%lu)", symbol->Name, line.FileName, line.LineNumber);
+		}
+		else
+		{
+			snprintf(buffer, buffer_size, "%s", symbol->Name);
+		}
+		return;
+	}
+#endif
+	snprintf(buffer, buffer_size, "%p", address);
+}
+
+static void write_json_string(FILE* file, const char* str)
+{
+	fputc('"', file);
+	for (; *str; ++str)
+	{
+		if (*str == '"' || *str == '\\')
+		{
+			fputc('\\', file);
+		}
+		fputc(*str, file);
+	}
+	fputc('"', file);
+}
+
+MemoryTrackerShard* MemoryTracker::get_thread_shard()
+{
+	if (s_shard_binding._shard == nullptr)
+	{
+		if (s_shard_binding._released)
+		{
+			return get_fallback_shard();
+		}
+		s_shard_binding._shard = acquire_shard();
+	}
+	return s_shard_binding._shard;
+}
+
+MemoryTrackerShard* MemoryTracker::get_fallback_shard()
+{
+	return &_fallback_shard;
+}
+
+MemoryTrackerShard* MemoryTracker::acquire_shard()
+{
+	// Try to adopt a shard from a thread that exited. The counters are kept as is, this keeps the merged totals exact.
+	for (MemoryTrackerShard* shard = _shards.load(std::memory_order_acquire); shard; shard = shard->_next)
+	{
+		bool expected = false;
+		if (shard->_in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+		{
+			return shard;
+		}
+	}
+
+	// Shards are allocated with malloc directly to avoid recursing into operator new
+	MemoryTrackerShard* shard = new (std::malloc(sizeof(MemoryTrackerShard))) MemoryTrackerShard();
+	shard->_in_use.store(true, std::memory_order_relaxed);
+
+	MemoryTrackerShard* head = _shards.load(std::memory_order_relaxed);
+	do
+	{
+		shard->_next = head;
+	} while (!_shards.compare_exchange_weak(head, shard, std::memory_order_release, std::memory_order_relaxed));
+
+	return shard;
+}
+
+void MemoryTracker::TrackAllocation(void* mem, size_t size, MemoryCategory category)
 {
 	if (!should_track())
 		return;
 
+	if (_mode == MemoryTrackingMode::Sharded)
+	{
+		get_thread_shard()->record_allocation(category, size);
+		return;
+	}
+
+	// Capture outside of the lock, walking the stack is the expensive part
+	void* frames[MemoryCallSite::c_MaxFrames];
+	u32 n_frames = 0;
+	u64 site_hash = 0;
+	if (_mode == MemoryTrackingMode::CallSites)
+	{
+		n_frames = capture_call_stack(frames, site_hash);
+	}
+
 	std::lock_guard lock{ _tracking_lock };
 	ScopedMemTrackDisable mem_track_disable;
 
 	// If this is not in a category then we didn't track this allocation
 	{
-		_allocation_to_category[mem] = _current_category;
+		_allocation_to_category[mem] = category;
 
 		_current_allocs += 1;
 		_total_memory_usage += size;
 		_total_allocated += size;
-		_total_per_category[*_current_category] += size;
+		_total_per_category[*category] += size;
 
 		MemoryAllocationInfo info{};
 		info.size = size;
-		_allocation_map[*_current_category][mem] = std::move(info);
+		info.site = site_hash;
+		_allocation_map[*category][mem] = std::move(info);
+
+		if (n_frames > 0)
+		{
+			auto [it, inserted] = _call_sites.try_emplace(site_hash);
+			MemoryCallSite& site = it->second;
+			if (inserted)
+			{
+				std::copy(frames, frames + n_frames, site.frames);
+				site.n_frames = n_frames;
+				site.category = category;
+			}
+			site.live_bytes += size;
+			site.live_count += 1;
+			site.frame_bytes += size;
+			site.frame_count += 1;
+		}
 	}
 
 }
 
-void MemoryTracker::TrackDeallocation(void* mem)
+void MemoryTracker::TrackDeallocation(void* mem, size_t size, MemoryCategory category)
 {
+	if (_mode == MemoryTrackingMode::Sharded)
+	{
+		// Frees are recorded on the freeing thread's shard, merging the shards balances cross-thread frees.
+		get_thread_shard()->record_deallocation(category, size);
+		return;
+	}
+
 	if (!should_track())
 		return;
 
@@ -147,34 +417,220 @@ void MemoryTracker::TrackDeallocation(void* mem)
 		_total_per_category[*category] -= info.size;
 		_current_allocs -= 1;
 
+		if (auto site = _call_sites.find(info.site); info.site != 0 && site != _call_sites.end())
+		{
+			site->second.live_bytes -= info.size;
+			site->second.live_count -= 1;
+		}
+
 		_allocation_map[*category].erase(mem);
 		_allocation_to_category.erase(mem);
 	}
 }
 
+MemoryStats MemoryTracker::get_stats()
+{
+	MemoryStats stats{};
+	if (_mode != MemoryTrackingMode::Sharded)
+	{
+		std::lock_guard lock{ _tracking_lock };
+		stats.current_allocs = _current_allocs;
+		stats.total_memory_usage = _total_memory_usage;
+		stats.total_allocated = _total_allocated;
+		stats.total_freed = _total_freed;
+		for (u32 i = 0; i < *MemoryCategory::Count; ++i)
+		{
+			stats.total_per_category[i] = _total_per_category[i];
+		}
+		return stats;
+	}
+
+	// Sum up the signed deltas first, a single shard can have more frees than allocations when memory crosses threads.
+	s64 per_category[*MemoryCategory::Count] = {};
+	for (MemoryTrackerShard* shard = _shards.load(std::memory_order_acquire); shard; shard = shard->_next)
+	{
+		for (u32 i = 0; i < *MemoryCategory::Count; ++i)
+		{
+			MemoryTrackerShard::Counters const& c = shard->_counters[i];
+			u64 allocated = c.allocated.load(std::memory_order_relaxed);
+			u64 freed = c.freed.load(std::memory_order_relaxed);
+
+			per_category[i] += s64(allocated) - s64(freed);
+			stats.total_allocated += allocated;
+			stats.total_freed += freed;
+			stats.current_allocs += s64(c.n_allocs.load(std::memory_order_relaxed)) - s64(c.n_frees.load(std::memory_order_relaxed));
+		}
+	}
+
+	for (u32 i = 0; i < *MemoryCategory::Count; ++i)
+	{
+		stats.total_per_category[i] = u64(std::max<s64>(per_category[i], 0));
+		stats.total_memory_usage += stats.total_per_category[i];
+	}
+	return stats;
+}
+
+void MemoryTracker::set_report_path(const char* path)
+{
+	std::lock_guard lock{ _tracking_lock };
+	if (_report)
+	{
+		fclose(_report);
+		_report = nullptr;
+	}
+	snprintf(_report_path, sizeof(_report_path), "%s", path);
+}
+
+FILE* MemoryTracker::get_report_file()
+{
+	if (!_report)
+	{
+#ifdef WIN64
+		fopen_s(&_report, _report_path, "w");
+#else
+		_report = fopen(_report_path, "w");
+#endif
+	}
+	return _report;
+}
+
+void MemoryTracker::write_call_site(FILE* file, u64 hash, MemoryCallSite& site)
+{
+	if (site.written)
+	{
+		return;
+	}
+	site.written = true;
+
+	fprintf(file, "{\"type\":\"site\",\"site\":\"%016llx\",\"category\":\"%s\",\"stack\":[", (unsigned long long)hash, MemoryCategoryToString(site.category));
+	for (u32 i = 0; i < site.n_frames; ++i)
+	{
+		char symbol[512];
+		symbolise(site.frames[i], symbol, sizeof(symbol));
+		if (i > 0)
+		{
+			fputc(',', file);
+		}
+		write_json_string(file, symbol);
+	}
+	fprintf(file, "]}\n");
+}
+
+void MemoryTracker::end_frame()
+{
+	if (_mode != MemoryTrackingMode::CallSites)
+	{
+		return;
+	}
+
+	std::lock_guard lock{ _tracking_lock };
+	ScopedMemTrackDisable mem_track_disable;
+
+	++_frame;
+
+	u64 frame_bytes = 0;
+	u64 frame_count = 0;
+	std::vector<std::pair<u64, MemoryCallSite*>> active;
+	for (auto& [hash, site] : _call_sites)
+	{
+		if (site.frame_count > 0)
+		{
+			frame_bytes += site.frame_bytes;
+			frame_count += site.frame_count;
+			active.push_back({ hash, &site });
+		}
+	}
+
+	FILE* file = get_report_file();
+	if (file && !active.empty())
+	{
+		size_t n = std::min<size_t>(c_ReportTopN, active.size());
+
+		std::partial_sort(active.begin(), active.begin() + n, active.end(), [](auto const& lhs, auto const& rhs) { return lhs.second->frame_bytes > rhs.second->frame_bytes; });
+		std::vector<std::pair<u64, MemoryCallSite*>> top_bytes{ active.begin(), active.begin() + n };
+
+		std::partial_sort(active.begin(), active.begin() + n, active.end(), [](auto const& lhs, auto const& rhs) { return lhs.second->frame_count > rhs.second->frame_count; });
+		std::vector<std::pair<u64, MemoryCallSite*>> top_count{ active.begin(), active.begin() + n };
+
+		// Sites are written once so the frame records can refer to them by hash
+		for (auto const& [hash, site] : top_bytes)
+		{
+			write_call_site(file, hash, *site);
+		}
+		for (auto const& [hash, site] : top_count)
+		{
+			write_call_site(file, hash, *site);
+		}
+
+		auto write_ranking = [file](const char* name, std::vector<std::pair<u64, MemoryCallSite*>> const& ranking)
+		{
+			fprintf(file, ",\"%s\":[", name);
+			for (size_t i = 0; i < ranking.size(); ++i)
+			{
+				fprintf(file, "%s{\"site\":\"%016llx\",\"bytes\":%llu,\"count\":%llu}", i > 0 ? "," : "",
+						(unsigned long long)ranking[i].first, (unsigned long long)ranking[i].second->frame_bytes, (unsigned long long)ranking[i].second->frame_count);
+			}
+			fprintf(file, "]");
+		};
+
+		fprintf(file, "{\"type\":\"frame\",\"frame\":%llu,\"bytes\":%llu,\"count\":%llu", (unsigned long long)_frame, (unsigned long long)frame_bytes, (unsigned long long)frame_count);
+		write_ranking("top_bytes", top_bytes);
+		write_ranking("top_count", top_count);
+		fprintf(file, "}\n");
+	}
+
+	for (auto& [hash, site] : active)
+	{
+		site->frame_bytes = 0;
+		site->frame_count = 0;
+	}
+}
+
 void MemoryTracker::DumpLeakInfo()
 {
-	//for(u32 i = 0; i < *MemoryCategory::Count; ++i)
-	//{
-	//	if (!_allocation_map[i].empty())
-	//	{
-	//		std::vector<std::pair<void*, MemoryAllocationInfo>> sorted;
-	//		sorted.reserve(_allocation_map[i].size());
-	//		std::for_each(_allocation_map[i].begin(), _allocation_map[i].end(), [&sorted](auto const& pair)
-	//			{ sorted.push_back(pair); });
-
-	//		std::sort(sorted.begin(), sorted.end(), [](auto const& lhs, auto const& rhs) {
-	//					return lhs.second.size < rhs.second.size;
-	//		});
-
-	//		FAILMSG("Memory leaks detected.");
-
-	//		fmt::print("Total Allocations: {}\n", _current_allocs);
-	//		// Dump memory leaks
-	//		for (std::pair<void*, MemoryAllocationInfo> mem : sorted)
-	//		{
-	//			fmt::print("Add: {} | Size: {} \n", mem.first, mem.second.size);
-	//		}
-	//	}
-	//}
+	if (_mode == MemoryTrackingMode::Sharded)
+	{
+		MemoryStats stats = get_stats();
+		if (stats.current_allocs > 0)
+		{
+			fmt::print("Live allocations at shutdown: {} ({} bytes). Run with -memtrack-callsites to group them by call site.\n", stats.current_allocs, stats.total_memory_usage);
+		}
+		return;
+	}
+
+	std::lock_guard lock{ _tracking_lock };
+	ScopedMemTrackDisable mem_track_disable;
+
+	if (_mode == MemoryTrackingMode::Detailed)
+	{
+		for (u32 i = 0; i < *MemoryCategory::Count; ++i)
+		{
+			if (!_allocation_map[i].empty())
+			{
+				fmt::print("Live allocations at shutdown in {}: {} ({} bytes)\n", MemoryCategoryToString(MemoryCategory(i)), _allocation_map[i].size(), _total_per_category[i]);
+			}
+		}
+		return;
+	}
+
+	std::vector<std::pair<u64, MemoryCallSite*>> leaks;
+	for (auto& [hash, site] : _call_sites)
+	{
+		if (site.live_count > 0)
+		{
+			leaks.push_back({ hash, &site });
+		}
+	}
+	std::sort(leaks.begin(), leaks.end(), [](auto const& lhs, auto const& rhs) { return lhs.second->live_bytes > rhs.second->live_bytes; });
+
+	if (FILE* file = get_report_file(); file)
+	{
+		for (auto const& [hash, site] : leaks)
+		{
+			write_call_site(file, hash, *site);
+			fprintf(file, "{\"type\":\"leak\",\"site\":\"%016llx\",\"bytes\":%llu,\"count\":%llu}\n", (unsigned long long)hash, (unsigned long long)site->live_bytes, (unsigned long long)site->live_count);
+		}
+		fflush(file);
+	}
+	fmt::print("Live allocations at shutdown from {} call sites, see {}\n", leaks.size(), _report_path);
 }
@@ -3,6 +3,9 @@
 struct MemoryAllocationInfo
 {
 	size_t size;
+
+	// Hash of the allocating call stack, 0 when call sites aren't captured
+	u64 site;
 };
 
 enum class MemoryCategory : u32
@@ -13,29 +16,131 @@ enum class MemoryCategory : u32
 	Game,
 	ResourceLoading,
 	Debug,
+
+	// Transient memory that is only valid until the end of the next frame. Frees are a no-op.
+	Frame,
 	Count
 };
 ENUM_UNDERLYING_TYPE(MemoryCategory)
 
 CORE_API const char* MemoryCategoryToString(MemoryCategory category);
 
+// Controls how the tracker records allocations
+enum class MemoryTrackingMode : u32
+{
+	// Every thread records into its own shard without taking any locks. Totals are merged when requested.
+	Sharded,
+
+	// Every allocation is recorded per address under a single lock. Slow but allows inspecting individual allocations.
+	Detailed,
+
+	// Detailed tracking that also captures the call stack of every allocation. Writes per frame hotspots and leaks to a report file.
+	CallSites
+};
+
+// Merged view of the tracker counters
+struct MemoryStats
+{
+	s64 current_allocs = 0;
+	u64 total_memory_usage = 0;
+	u64 total_allocated = 0;
+	u64 total_freed = 0;
+	u64 total_per_category[*MemoryCategory::Count] = {};
+};
+
 #pragma warning(push)
 #pragma warning(disable: 4251)
 
+// Per thread counters. A shard is only written by the thread that currently owns it, other threads only read from it when
+// merging the stats. Shards are never freed, when a thread exits the shard is released and adopted by the next new thread.
+// The shared shard is written by several threads and uses atomic adds instead.
+struct MemoryTrackerShard
+{
+	struct Counters
+	{
+		std::atomic<u64> allocated;
+		std::atomic<u64> freed;
+		std::atomic<u64> n_allocs;
+		std::atomic<u64> n_frees;
+	};
+
+	void record_allocation(MemoryCategory category, size_t size);
+	void record_deallocation(MemoryCategory category, size_t size);
+
+	Counters _counters[*MemoryCategory::Count];
+
+	std::atomic<bool> _in_use;
+	bool _shared;
+	MemoryTrackerShard* _next;
+};
+
+// Allocations grouped by their call stack
+struct MemoryCallSite
+{
+	static constexpr u32 c_MaxFrames = 16;
+
+	// Return addresses, only valid for the current run. The site hash is built from module relative offsets instead.
+	void* frames[c_MaxFrames];
+	u32 n_frames;
+	MemoryCategory category;
+
+	u64 live_bytes;
+	u64 live_count;
+
+	// Reset by MemoryTracker::end_frame
+	u64 frame_bytes;
+	u64 frame_count;
+
+	// Set once the symbolised stack has been written to the report
+	bool written;
+};
+
 class CORE_API MemoryTracker final
 {
 public:
-	static void init();
+	static void init(MemoryTrackingMode mode = MemoryTrackingMode::Sharded);
 	bool should_track() const;
 
+	MemoryTrackingMode get_mode() const { return _mode; }
+
+	void TrackAllocation(void* mem, size_t size, MemoryCategory category);
+	void TrackDeallocation(void* mem, size_t size, MemoryCategory category);
+
+	// Merges all the shards (or the detailed maps) into a single view
+	MemoryStats get_stats();
+
+	// Number of call sites written per frame for both the bytes and the count ranking
+	static constexpr u32 c_ReportTopN = 10;
 
-	void TrackAllocation(void* mem, size_t size);
-	void TrackDeallocation(void* mem);
+	// Report file for MemoryTrackingMode::CallSites. Every line is a single json object.
+	void set_report_path(const char* path);
 
+	// Writes the top call sites of the frame to the report and resets the frame counters
+	void end_frame();
+
+	// Writes the live allocations grouped by call site to the report
 	void DumpLeakInfo();
 
-	MemoryCategory _current_category = MemoryCategory::None;
+	static MemoryCategory get_current_category();
+	static void set_current_category(MemoryCategory category);
+
+private:
+	MemoryTrackerShard* get_thread_shard();
+	MemoryTrackerShard* acquire_shard();
+	MemoryTrackerShard* get_fallback_shard();
+
+	FILE* get_report_file();
+	void write_call_site(FILE* file, u64 hash, MemoryCallSite& site);
+
+	MemoryTrackingMode _mode = MemoryTrackingMode::Sharded;
+
+	// Sharded mode
+	std::atomic<MemoryTrackerShard*> _shards = nullptr;
 
+	// Frees that run after a thread released its shard (e.g. from other thread_local destructors) are recorded here
+	MemoryTrackerShard _fallback_shard{};
+
+	// Detailed mode
 	std::mutex _tracking_lock;
 	std::unordered_map<void*, MemoryAllocationInfo> _allocation_map[*MemoryCategory::Count];
 	u64 _total_per_category[*MemoryCategory::Count];
@@ -46,6 +151,14 @@ public:
 
 	std::atomic<u64> _total_allocated = 0;
 	std::atomic<u64> _total_freed = 0;
+
+	// Call site mode
+	std::unordered_map<u64, MemoryCallSite> _call_sites;
+	char _report_path[260] = "MemoryReport.jsonl";
+	FILE* _report = nullptr;
+	u64 _frame = 0;
+
+	friend struct MemoryShardBinding;
 };
 
 CORE_API MemoryTracker* get_memory_tracker();
@@ -55,18 +168,16 @@ struct MemoryTag final
 	MemoryCategory _prev;
 	MemoryTag(MemoryCategory category)
 	{
-		_prev = get_memory_tracker()->_current_category;
-		get_memory_tracker()->_current_category = category;
-		
+		_prev = MemoryTracker::get_current_category();
+		MemoryTracker::set_current_category(category);
 	}
 
 	~MemoryTag()
 	{
-		get_memory_tracker()->_current_category = _prev;
+		MemoryTracker::set_current_category(_prev);
 	}
 };
 #define MEMORY_TAG(cat) MemoryTag _mem_tag##__COUNTER__ = MemoryTag(cat)
 
 #pragma warning(pop)
 
-
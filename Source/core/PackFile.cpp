@@ -0,0 +1,257 @@
+#include "core.pch.h"
+#include "PackFile.h"
+
+#include "Compression.h"
+
+namespace IO
+{
+
+namespace
+{
+
+// View on a stored entry, keeps the pack mapping alive
+class PackView final : public IMappedFile
+{
+public:
+	PackView(IMappedFileRef const& pack, u8 const* data, u64 size)
+			: _pack(pack)
+			, _data(data)
+			, _size(size)
+	{
+	}
+
+	virtual Span<u8 const> get_data() const override { return Span<u8 const>(_data, size_t(_size)); }
+
+private:
+	IMappedFileRef _pack;
+	u8 const* _data;
+	u64 _size;
+};
+
+// Decompressed entry
+class PackBuffer final : public IMappedFile
+{
+public:
+	PackBuffer(std::vector<u8>&& data)
+			: _data(std::move(data))
+	{
+	}
+
+	virtual Span<u8 const> get_data() const override { return Span<u8 const>(_data.data(), _data.size()); }
+
+private:
+	std::vector<u8> _data;
+};
+
+u64 align_up(u64 offset, u64 alignment)
+{
+	return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+bool PackFile::open(IMappedFileRef const& file)
+{
+	_header = nullptr;
+	if (!file)
+	{
+		return false;
+	}
+
+	Span<u8 const> data = file->get_data();
+	u64 size = data.size();
+	if (size < sizeof(PackHeader))
+	{
+		return false;
+	}
+
+	PackHeader const* header = reinterpret_cast<PackHeader const*>(data.begin());
+	if (header->magic != PackHeader::c_Magic || header->version != PackHeader::c_Version)
+	{
+		return false;
+	}
+
+	auto fits = [size](u64 offset, u64 length)
+	{
+		return offset <= size && length <= size - offset;
+	};
+
+	if (!fits(header->entries_offset, u64(header->n_entries) * sizeof(PackEntry))
+			|| !fits(header->string_table_offset, header->string_table_size)
+			|| header->string_table_size == 0
+			|| data.begin()[header->string_table_offset + header->string_table_size - 1] != '\0')
+	{
+		return false;
+	}
+
+	PackEntry const* entries = reinterpret_cast<PackEntry const*>(data.begin() + header->entries_offset);
+	for (u32 i = 0; i < header->n_entries; ++i)
+	{
+		PackEntry const& entry = entries[i];
+		if (!fits(entry.offset, entry.stored_size) || entry.path >= header->string_table_size || (i > 0 && entries[i - 1].hash > entry.hash))
+		{
+			return false;
+		}
+
+		// Uncompressed entries are mapped in place, 'size' bytes have to be stored for them
+		if ((entry.flags & PackEntry_Compressed) == 0 && entry.size != entry.stored_size)
+		{
+			return false;
+		}
+	}
+
+	_file = file;
+	_header = header;
+	_entries = entries;
+	_strings = reinterpret_cast<char const*>(data.begin() + header->string_table_offset);
+	return true;
+}
+
+PackEntry const* PackFile::find(std::string_view path) const
+{
+	std::string normalized = normalize_path(path);
+	u32 hash = Hash::fnv1a(normalized);
+
+	PackEntry const* end = _entries + _header->n_entries;
+	PackEntry const* it = std::lower_bound(_entries, end, hash, [](PackEntry const& entry, u32 hash) { return entry.hash < hash; });
+	for (; it != end && it->hash == hash; ++it)
+	{
+		if (normalized == get_path(*it))
+		{
+			return it;
+		}
+	}
+	return nullptr;
+}
+
+IMappedFileRef PackFile::map(PackEntry const& entry) const
+{
+	u8 const* data = _file->get_data().begin() + entry.offset;
+	if ((entry.flags & PackEntry_Compressed) == 0)
+	{
+		return std::make_shared<PackView>(_file, data, entry.size);
+	}
+
+	std::vector<u8> result(entry.size);
+	if (!Compression::decompress(data, size_t(entry.stored_size), result.data(), result.size()))
+	{
+		fmt::print("Failed to decompress {} from pack.\n", get_path(entry));
+		return nullptr;
+	}
+	return std::make_shared<PackBuffer>(std::move(result));
+}
+
+std::string PackFile::normalize_path(std::string_view path)
+{
+	if (path.starts_with("res:"))
+	{
+		path.remove_prefix(sizeof("res:") - 1);
+	}
+
+	std::string result;
+	result.reserve(path.size());
+	for (char c : path)
+	{
+		c = c == '\\' ? '/' : char(std::tolower(u8(c)));
+
+		// Collapse separators and drop the leading one
+		if (c == '/' && (result.empty() || result.back() == '/'))
+		{
+			continue;
+		}
+		result.push_back(c);
+	}
+
+	while (result.starts_with("./"))
+	{
+		result.erase(0, 2);
+	}
+	return result;
+}
+
+PackWriter::PackWriter(u32 alignment)
+		: _alignment(alignment)
+{
+	ASSERTMSG(alignment > 0 && (alignment & (alignment - 1)) == 0, "Pack alignment {} must be a power of two.", alignment);
+}
+
+void PackWriter::add(std::string_view path, Span<u8 const> data, bool compress)
+{
+	PendingEntry entry{};
+	entry.path = PackFile::normalize_path(path);
+	entry.flags = PackEntry_None;
+	entry.size = data.size();
+
+	if (compress && data.size() > 0)
+	{
+		entry.data.resize(Compression::get_max_compressed_size(data.size()));
+		size_t compressed_size = Compression::compress(data.begin(), data.size(), entry.data.data(), entry.data.size());
+		if (compressed_size > 0 && compressed_size <= size_t(f32(data.size()) * (1.0f - c_MinCompressionGain)))
+		{
+			entry.data.resize(compressed_size);
+			entry.flags |= PackEntry_Compressed;
+		}
+	}
+
+	if ((entry.flags & PackEntry_Compressed) == 0)
+	{
+		entry.data.assign(data.begin(), data.end());
+	}
+
+	_entries.push_back(std::move(entry));
+}
+
+void PackWriter::write(std::vector<u8>& out) const
+{
+	std::vector<char> strings;
+	std::vector<PackEntry> table;
+	table.reserve(_entries.size());
+
+	PackHeader header{};
+	header.magic = PackHeader::c_Magic;
+	header.version = PackHeader::c_Version;
+	header.n_entries = u32(_entries.size());
+	header.entries_offset = align_up(sizeof(PackHeader), alignof(PackEntry));
+
+	u64 offset = header.entries_offset + _entries.size() * sizeof(PackEntry);
+	for (PendingEntry const& pending : _entries)
+	{
+		PackEntry entry{};
+		entry.hash = Hash::fnv1a(pending.path);
+		entry.path = u32(strings.size());
+		entry.flags = pending.flags;
+		entry.size = pending.size;
+		entry.stored_size = pending.data.size();
+		entry.offset = align_up(offset, _alignment);
+		offset = entry.offset + entry.stored_size;
+		table.push_back(entry);
+
+		strings.insert(strings.end(), pending.path.begin(), pending.path.end());
+		strings.push_back('\0');
+	}
+	strings.push_back('\0');
+
+	header.string_table_offset = offset;
+	header.string_table_size = u32(strings.size());
+
+	out.assign(size_t(offset + strings.size()), 0);
+	for (size_t i = 0; i < _entries.size(); ++i)
+	{
+		if (!_entries[i].data.empty())
+		{
+			memcpy(out.data() + table[i].offset, _entries[i].data.data(), _entries[i].data.size());
+		}
+	}
+
+	// The data keeps the order the files were added in, only the table is sorted for lookups
+	std::stable_sort(table.begin(), table.end(), [](PackEntry const& lhs, PackEntry const& rhs) { return lhs.hash < rhs.hash; });
+
+	memcpy(out.data(), &header, sizeof(header));
+	if (!table.empty())
+	{
+		memcpy(out.data() + header.entries_offset, table.data(), table.size() * sizeof(PackEntry));
+	}
+	memcpy(out.data() + header.string_table_offset, strings.data(), strings.size());
+}
+
+} // namespace IO
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "PlatformIO.h"
+
+namespace IO
+{
+
+// Archive of resource files.
+//	The file starts with a header followed by the entry table, sorted on the hash of the path so lookups are a binary search.
+//	Entry data is stored back to back in the order the files were added, each entry starts aligned. Compressed entries
+//	are decompressed when mapped, stored entries are views into the mapped pack.
+struct PackHeader
+{
+	static constexpr u32 c_Magic = 0x4B41504A; // 'JPAK'
+	static constexpr u32 c_Version = 1;
+
+	u32 magic;
+	u32 version;
+	u32 n_entries;
+	u32 string_table_size;
+	u64 entries_offset;
+	u64 string_table_offset;
+};
+
+enum PackEntryFlags : u32
+{
+	PackEntry_None = 0,
+	PackEntry_Compressed = 1 << 0,
+};
+
+struct PackEntry
+{
+	u32 hash;
+
+	// Offset of the normalized path in the string table
+	u32 path;
+
+	u32 flags;
+	u32 padding;
+
+	u64 offset;
+	u64 size;
+	u64 stored_size;
+};
+
+class CORE_API PackFile final
+{
+public:
+	static constexpr const char* c_Extension = ".pak";
+
+	// Validates the pack, the mapping is kept alive by the pack and the files mapped from it
+	bool open(IMappedFileRef const& file);
+
+	PackEntry const* find(std::string_view path) const;
+
+	// Returns a view on the entry, decompressing it when needed
+	IMappedFileRef map(PackEntry const& entry) const;
+
+	u32 get_num_entries() const { return _header->n_entries; }
+	PackEntry const& get_entry(u32 idx) const { return _entries[idx]; }
+	const char* get_path(PackEntry const& entry) const { return _strings + entry.path; }
+
+	// Paths in a pack are relative to the mounted folder, lower case and use forward slashes
+	static std::string normalize_path(std::string_view path);
+
+private:
+	IMappedFileRef _file;
+	PackHeader const* _header = nullptr;
+	PackEntry const* _entries = nullptr;
+	char const* _strings = nullptr;
+};
+
+class CORE_API PackWriter final
+{
+public:
+	// Only compress entries when it saves at least this fraction of the size
+	static constexpr f32 c_MinCompressionGain = 0.1f;
+
+	PackWriter(u32 alignment = 64);
+
+	void add(std::string_view path, Span<u8 const> data, bool compress);
+
+	void write(std::vector<u8>& out) const;
+
+private:
+	struct PendingEntry
+	{
+		std::string path;
+		u32 flags;
+		u64 size;
+		std::vector<u8> data;
+	};
+
+	u32 _alignment;
+	std::vector<PendingEntry> _entries;
+};
+
+} // namespace IO
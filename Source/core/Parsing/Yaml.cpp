@@ -46,22 +46,19 @@ struct TextReadStream
 };
 
 Document::Document(const char* path)
-: m_Data(nullptr)
+: m_IsValid(false)
 {
 	IO::IPlatformIO* io = GetGlobalContext()->m_PlatformIO;
 
-	IO::IFileRef file = io->OpenFile(path, IO::Mode::Read, false);
+	// The parser copies what it needs, the file is only mapped while parsing
+	IO::IMappedFileRef file = io->MapFile(path);
 	if(file)
 	{
-		u64 size = file->GetSize();
-
-		m_Data = new char[size + 1];
-		memset(m_Data, 0, size + 1);
-		u32 readBytes = file->read(m_Data, (u32)size);
+		Span<u8 const> data = file->get_data();
 
 		try
 		{
-			Yaml::Parse(m_Root, m_Data, readBytes);
+			Yaml::Parse(m_Root, reinterpret_cast<const char*>(data.begin()), data.size());
 			m_IsValid = true;
 		}
 		catch(Yaml::ParsingException e)
@@ -76,10 +73,6 @@ Document::Document(const char* path)
 
 Document::~Document()
 {
-	if (m_Data)
-	{
-		m_Data = nullptr;
-	}
 }
 
 }
@@ -16,7 +16,6 @@ class Document final
 
 		bool IsValid() const { return m_IsValid; }
 	private:
-		char* m_Data;
 		bool m_IsValid;
 		Yaml::Node m_Root;
 };
@@ -1,9 +1,201 @@
 #include "core.pch.h"
 #include "PlatformIO.h"
+#include "VirtualFileSystem.h"
+
+#include <condition_variable>
+#include <deque>
+
+#ifndef WIN64
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace IO
 {
 
+namespace
+{
+
+// Resolves 'res:/' paths against the mounted root
+std::string resolve_path(std::string const& root, std::string const& path)
+{
+	// Absolute paths just get resolved straight
+	if (std::filesystem::path(path).is_absolute())
+	{
+		return path;
+	}
+
+	// Relative paths need to be resolved to the root
+	if (path.starts_with("res:"))
+	{
+		return fmt::format("{}/{}", root, path.substr(sizeof("res:")));
+	}
+	return path;
+}
+
+const char* get_open_mode(Mode mode, bool binary)
+{
+	if (mode == Mode::Read)
+	{
+		return binary ? "rb" : "r";
+	}
+	return binary ? "wb" : "w";
+}
+
+} // namespace
+
+// Worker pool serving IPlatformIO::ReadFileAsync
+class AsyncReader final
+{
+public:
+	static constexpr u32 c_NumWorkers = 2;
+
+	// Pages are touched on the worker so the consumer doesn't take the page faults
+	static constexpr size_t c_PageSize = 4096;
+
+	AsyncReader(IPlatformIO* io)
+			: _io(io)
+	{
+		for (u32 i = 0; i < c_NumWorkers; ++i)
+		{
+			_workers.emplace_back([this]() { run(); });
+		}
+	}
+
+	~AsyncReader()
+	{
+		{
+			std::lock_guard lock{ _lock };
+			_running = false;
+		}
+		_cv.notify_all();
+
+		for (std::thread& worker : _workers)
+		{
+			worker.join();
+		}
+	}
+
+	ReadFuture submit(std::string path, ReadCallback callback)
+	{
+		std::lock_guard lock{ _lock };
+		ASSERTMSG(_running, "Async read of '{}' submitted after the reader stopped.", path);
+
+		// Coalesce with a read of the same file that hasn't completed yet
+		if (auto it = _in_flight.find(path); it != _in_flight.end())
+		{
+			if (callback)
+			{
+				it->second->callbacks.push_back(std::move(callback));
+			}
+			return it->second->future;
+		}
+
+		auto request = std::make_shared<Request>();
+		request->path = path;
+		request->future = request->promise.get_future().share();
+		if (callback)
+		{
+			request->callbacks.push_back(std::move(callback));
+		}
+
+		_in_flight.emplace(std::move(path), request);
+		_queue.push_back(request);
+		_cv.notify_one();
+		return request->future;
+	}
+
+private:
+	struct Request
+	{
+		std::string path;
+		std::promise<IMappedFileRef> promise;
+		ReadFuture future;
+		std::vector<ReadCallback> callbacks;
+	};
+
+	void run()
+	{
+		JONO_THREAD("IOWorker");
+
+		while (true)
+		{
+			std::shared_ptr<Request> request;
+			{
+				std::unique_lock lock{ _lock };
+				_cv.wait(lock, [this]() { return !_running || !_queue.empty(); });
+
+				// Queued reads are finished before shutting down so no future is left without a value
+				if (_queue.empty())
+				{
+					return;
+				}
+				request = std::move(_queue.front());
+				_queue.pop_front();
+			}
+
+			IMappedFileRef file = _io->MapFile(request->path.c_str());
+			if (file)
+			{
+				JONO_EVENT("Prefault");
+				Span<u8 const> data = file->get_data();
+				u8 touched = 0;
+				for (size_t i = 0; i < data.size(); i += c_PageSize)
+				{
+					touched += data.begin()[i];
+				}
+				u8 volatile sink = touched;
+				(void)sink;
+			}
+
+			// Once removed from the in flight list no more callbacks can be added to this request
+			std::vector<ReadCallback> callbacks;
+			{
+				std::lock_guard lock{ _lock };
+				_in_flight.erase(request->path);
+				callbacks.swap(request->callbacks);
+			}
+
+			request->promise.set_value(file);
+			for (ReadCallback const& callback : callbacks)
+			{
+				callback(file);
+			}
+		}
+	}
+
+	IPlatformIO* _io;
+
+	std::mutex _lock;
+	std::condition_variable _cv;
+	std::deque<std::shared_ptr<Request>> _queue;
+	std::unordered_map<std::string, std::shared_ptr<Request>> _in_flight;
+	std::vector<std::thread> _workers;
+	bool _running = true;
+};
+
+IPlatformIO::IPlatformIO()
+{
+}
+
+IPlatformIO::~IPlatformIO()
+{
+	ASSERTMSG(!_async_reader, "Implementations of IPlatformIO need to call StopAsyncReads before they are destroyed.");
+}
+
+ReadFuture IPlatformIO::ReadFileAsync(const char* path, ReadCallback callback)
+{
+	std::call_once(_async_reader_init, [this]() { _async_reader = std::make_unique<AsyncReader>(this); });
+	return _async_reader->submit(path, std::move(callback));
+}
+
+void IPlatformIO::StopAsyncReads()
+{
+	_async_reader.reset();
+}
+
 #ifdef WIN64
 
 class Win64File final : public IFile
@@ -52,10 +244,16 @@ public:
 		{
 			m = SEEK_END;
 		}
-		fseek(_stream, long(offset), m);
+		_fseeki64(_stream, offset, m);
 	}
 
-	virtual u64 tell() const { return ftell(_stream); }
+	virtual u64 tell() const { return _ftelli64(_stream); }
+
+	virtual u64 GetSize() override
+	{
+		fflush(_stream);
+		return _filelengthi64(_fileno(_stream));
+	}
 
 	virtual void* get_raw_handle() const { return _stream; }
 
@@ -66,6 +264,30 @@ public:
 	bool _binary;
 };
 
+class Win64MappedFile final : public IMappedFile
+{
+public:
+	Win64MappedFile(void const* view, u64 size)
+			: _view(view)
+			, _size(size)
+	{
+	}
+
+	virtual ~Win64MappedFile()
+	{
+		if (_view)
+		{
+			UnmapViewOfFile(_view);
+		}
+	}
+
+	virtual Span<u8 const> get_data() const override { return Span<u8 const>(static_cast<u8 const*>(_view), size_t(_size)); }
+
+private:
+	void const* _view;
+	u64 _size;
+};
+
 class Win64IO final : public IPlatformIO
 {
 public:
@@ -74,6 +296,11 @@ public:
 	{
 	}
 
+	virtual ~Win64IO()
+	{
+		StopAsyncReads();
+	}
+
 	virtual bool CreateDirectory(const char* path) override
 	{
 		std::error_code ec;
@@ -89,30 +316,23 @@ public:
 		return std::filesystem::exists(tmp);
 	}
 
-	virtual void Mount(const char* path) override
+	// The platform IO only has a single root, mounting replaces it
+	virtual void Mount(const char* path, s32 priority) override
 	{
 		_root = path;
 	}
 
-	virtual std::string ResolvePath(std::string const& path) override
+	virtual void Unmount(const char* path) override
 	{
-		// Check if path is relative
-		std::filesystem::path p{ path };
-
-		// Absolute paths just get resolved straight
-		if (p.is_absolute())
+		if (_root == path)
 		{
-			return path;
+			_root = ".";
 		}
+	}
 
-		// Relative paths need to be resolved to the root
-		if (path.starts_with("res:"))
-		{
-			char tmp[512];
-			sprintf_s(tmp, "%s/%s", _root.c_str(), path.substr(sizeof("res:")).c_str());
-			return tmp;
-		}
-		return path;
+	virtual std::string ResolvePath(std::string const& path) override
+	{
+		return resolve_path(_root, path);
 	}
 
 	virtual std::shared_ptr<IFile> OpenFile(const char* path, Mode mode, bool binary) override
@@ -170,6 +390,252 @@ public:
 		winFile->_stream = nullptr;
 	}
 
+	virtual IMappedFileRef MapFile(const char* path) override
+	{
+		std::string tmp = ResolvePath(path);
+		HANDLE file = CreateFileA(tmp.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return nullptr;
+		}
+
+		LARGE_INTEGER size{};
+		GetFileSizeEx(file, &size);
+
+		// Empty files can't be mapped
+		void const* view = nullptr;
+		if (size.QuadPart > 0)
+		{
+			// The view keeps the mapping alive, both handles can be closed straight away
+			HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping)
+			{
+				view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);
+			}
+
+			if (!view)
+			{
+				fmt::print("Failed to map file {}. Error: {}\n", tmp, GetLastError());
+				CloseHandle(file);
+				return nullptr;
+			}
+		}
+
+		CloseHandle(file);
+		return std::make_shared<Win64MappedFile>(view, u64(size.QuadPart));
+	}
+
+private:
+	std::string _root;
+};
+
+#else
+
+class PosixFile final : public IFile
+{
+public:
+	PosixFile(const char* path, FILE* s, Mode m, bool binary)
+			: _path(path)
+			, _stream(s)
+			, _mode(m)
+			, _binary(binary)
+	{
+	}
+
+	virtual ~PosixFile()
+	{
+		// When a file goes out of scope force a close
+		if (_stream)
+		{
+			fclose(_stream);
+			_stream = nullptr;
+		}
+	}
+
+	virtual bool is_binary() const { return _binary; }
+
+	virtual Mode get_mode() const { return _mode; }
+
+	virtual u32 write(void* src, u32 size)
+	{
+		return static_cast<u32>(fwrite(src, sizeof(u8), size, _stream));
+	}
+
+	virtual u32 read(void* dst, u32 size)
+	{
+		return static_cast<u32>(fread(dst, sizeof(u8), size, _stream));
+	}
+
+	virtual void seek(s64 offset, SeekMode mode)
+	{
+		int m = SEEK_CUR;
+		if (mode == SeekMode::FromBeginning)
+		{
+			m = SEEK_SET;
+		}
+		if (mode == SeekMode::FromEnd)
+		{
+			m = SEEK_END;
+		}
+		fseeko(_stream, off_t(offset), m);
+	}
+
+	virtual u64 tell() const { return u64(ftello(_stream)); }
+
+	virtual u64 GetSize() override
+	{
+		fflush(_stream);
+
+		struct stat info{};
+		fstat(fileno(_stream), &info);
+		return u64(info.st_size);
+	}
+
+	virtual void* get_raw_handle() const { return _stream; }
+
+	std::string _path;
+	FILE* _stream;
+	Mode _mode;
+	bool _binary;
+};
+
+class PosixMappedFile final : public IMappedFile
+{
+public:
+	PosixMappedFile(void* view, u64 size)
+			: _view(view)
+			, _size(size)
+	{
+	}
+
+	virtual ~PosixMappedFile()
+	{
+		if (_view)
+		{
+			munmap(_view, size_t(_size));
+		}
+	}
+
+	virtual Span<u8 const> get_data() const override { return Span<u8 const>(static_cast<u8 const*>(_view), size_t(_size)); }
+
+private:
+	void* _view;
+	u64 _size;
+};
+
+class PosixIO final : public IPlatformIO
+{
+public:
+	PosixIO()
+			: _root(".")
+	{
+	}
+
+	virtual ~PosixIO()
+	{
+		StopAsyncReads();
+	}
+
+	virtual bool CreateDirectory(const char* path) override
+	{
+		std::error_code ec;
+		std::filesystem::path p{ path };
+
+		auto parent = p.parent_path();
+		return std::filesystem::create_directories(parent, ec);
+	}
+
+	virtual bool Exists(const char* path) override
+	{
+		std::string tmp = ResolvePath(path);
+		return std::filesystem::exists(tmp);
+	}
+
+	// The platform IO only has a single root, mounting replaces it
+	virtual void Mount(const char* path, s32 priority) override
+	{
+		_root = path;
+	}
+
+	virtual void Unmount(const char* path) override
+	{
+		if (_root == path)
+		{
+			_root = ".";
+		}
+	}
+
+	virtual std::string ResolvePath(std::string const& path) override
+	{
+		return resolve_path(_root, path);
+	}
+
+	virtual std::shared_ptr<IFile> OpenFile(const char* path, Mode mode, bool binary) override
+	{
+		if (!Exists(path) && mode == Mode::Write)
+		{
+			CreateDirectory(path);
+		}
+
+		if (!Exists(path) && mode == Mode::Read)
+		{
+			return nullptr;
+		}
+
+		std::string tmp = ResolvePath(path);
+		FILE* s = fopen(tmp.c_str(), get_open_mode(mode, binary));
+		if (s == nullptr)
+		{
+			fmt::print("Failed to open file. Error: {}", strerror(errno));
+			return nullptr;
+		}
+		return std::make_shared<PosixFile>(tmp.c_str(), s, mode, binary);
+	}
+
+	virtual void CloseFile(IFileRef const& file) override
+	{
+		PosixFile* posixFile = (PosixFile*)file.get();
+		if (posixFile->_stream)
+		{
+			fclose(posixFile->_stream);
+		}
+
+		// Clear out the stream on the file
+		posixFile->_stream = nullptr;
+	}
+
+	virtual IMappedFileRef MapFile(const char* path) override
+	{
+		std::string tmp = ResolvePath(path);
+		int fd = open(tmp.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			return nullptr;
+		}
+
+		struct stat info{};
+		fstat(fd, &info);
+		u64 size = u64(info.st_size);
+
+		// Empty files can't be mapped, the mapping stays valid after closing the descriptor
+		void* view = nullptr;
+		if (size > 0)
+		{
+			view = mmap(nullptr, size_t(size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (view == MAP_FAILED)
+			{
+				fmt::print("Failed to map file {}. Error: {}\n", tmp, strerror(errno));
+				close(fd);
+				return nullptr;
+			}
+			madvise(view, size_t(size), MADV_SEQUENTIAL);
+		}
+
+		close(fd);
+		return std::make_shared<PosixMappedFile>(view, size);
+	}
+
 private:
 	std::string _root;
 };
@@ -179,11 +645,11 @@ private:
 IPlatformIORef create()
 {
 #if defined(WIN64)
-	return std::make_shared<Win64IO>();
+	IPlatformIORef platform = std::make_shared<Win64IO>();
 #else
-	throw std::exception("Platform not supported!");
-	return nullptr;
+	IPlatformIORef platform = std::make_shared<PosixIO>();
 #endif
+	return std::make_shared<VirtualFileSystem>(platform);
 }
 
 static IPlatformIORef s_io;
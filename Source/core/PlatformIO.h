@@ -2,6 +2,9 @@
 
 #include "Core.h"
 
+#include <functional>
+#include <future>
+
 namespace IO
 {
 
@@ -41,7 +44,8 @@ struct IFile
 
 	virtual void* get_raw_handle() const = 0;
 
-	u64 GetSize() 
+	// Platforms query the size from the file system, the fallback seeks to the end and back
+	virtual u64 GetSize() 
 	{
 		u64 curr = tell();
 
@@ -54,13 +58,34 @@ struct IFile
 };
 using IFileRef = std::shared_ptr<IFile>;
 
+// IMappedFile
+//
+// Read only view on the whole contents of a file. The data stays valid for as long as the object is alive,
+// platforms map the file into memory so no copies are made.
+struct IMappedFile
+{
+	virtual ~IMappedFile() {}
+
+	virtual Span<u8 const> get_data() const = 0;
+
+	u64 get_size() const { return get_data().size(); }
+};
+using IMappedFileRef = std::shared_ptr<IMappedFile>;
+
+// Invoked on an IO worker thread once an async read finished, 'file' is null when the file couldn't be read
+using ReadCallback = std::function<void(IMappedFileRef const& file)>;
+using ReadFuture = std::shared_future<IMappedFileRef>;
+
+class AsyncReader;
+
 // IPlatformIO
 //
 // Interface defining the available operations to interact with the file system.
 class CORE_API IPlatformIO
 {
 public:
-	virtual ~IPlatformIO() = default;
+	IPlatformIO();
+	virtual ~IPlatformIO();
 
 	virtual string ResolvePath(string const& path) = 0;
 
@@ -68,14 +93,34 @@ public:
 
 	virtual bool Exists(const char* path) = 0;
 
-	virtual void Mount(const char* path) = 0;
+	// Adds a root for 'res:/' paths, see VirtualFileSystem for how multiple mounts are resolved
+	virtual void Mount(const char* path, s32 priority = 0) = 0;
+
+	virtual void Unmount(const char* path) = 0;
 
 	virtual IFileRef OpenFile(const char* path, Mode mode, bool binary = false) = 0;
 
 	virtual void CloseFile(IFileRef const& file) = 0;
+
+	// Maps the whole file for reading, returns nullptr if the file doesn't exist
+	virtual IMappedFileRef MapFile(const char* path) = 0;
+
+	// Maps the file on one of the IO worker threads and faults its pages in so the caller can decode without stalling.
+	// Requests for a file that is already in flight share the same read.
+	ReadFuture ReadFileAsync(const char* path, ReadCallback callback = {});
+
+protected:
+	// Finishes the queued reads and stops the workers, implementations call this from their destructor
+	// as the workers call back into MapFile.
+	void StopAsyncReads();
+
+private:
+	std::once_flag _async_reader_init;
+	std::unique_ptr<AsyncReader> _async_reader;
 };
 using IPlatformIORef = std::shared_ptr<IPlatformIO>;
 
+// Creates the virtual file system on top of the platform IO
 CORE_API IPlatformIORef create();
 
 CORE_API void set(IPlatformIORef io);
@@ -0,0 +1,244 @@
+#include "core.pch.h"
+#include "VirtualFileSystem.h"
+
+namespace IO
+{
+
+namespace
+{
+
+// Read only file on top of a mapped pack entry
+class PackedFile final : public IFile
+{
+public:
+	PackedFile(IMappedFileRef const& file, bool binary)
+			: _file(file)
+			, _binary(binary)
+			, _position(0)
+	{
+	}
+
+	virtual bool is_binary() const override { return _binary; }
+
+	virtual Mode get_mode() const override { return Mode::Read; }
+
+	virtual u32 write(void* src, u32 size) override { return 0; }
+
+	virtual u32 read(void* dst, u32 size) override
+	{
+		Span<u8 const> data = _file->get_data();
+		u64 n_bytes = std::min<u64>(size, data.size() - _position);
+		memcpy(dst, data.begin() + _position, size_t(n_bytes));
+		_position += n_bytes;
+		return u32(n_bytes);
+	}
+
+	virtual void seek(s64 offset, SeekMode mode) override
+	{
+		s64 base = 0;
+		if (mode == SeekMode::FromCurrent)
+		{
+			base = s64(_position);
+		}
+		if (mode == SeekMode::FromEnd)
+		{
+			base = s64(_file->get_size());
+		}
+		_position = u64(std::clamp<s64>(base + offset, 0, s64(_file->get_size())));
+	}
+
+	virtual u64 tell() const override { return _position; }
+
+	virtual u64 GetSize() override { return _file->get_size(); }
+
+	virtual void* get_raw_handle() const override { return nullptr; }
+
+private:
+	IMappedFileRef _file;
+	bool _binary;
+	u64 _position;
+};
+
+} // namespace
+
+VirtualFileSystem::VirtualFileSystem(IPlatformIORef const& platform)
+		: _platform(platform)
+{
+}
+
+VirtualFileSystem::~VirtualFileSystem()
+{
+	StopAsyncReads();
+}
+
+std::string VirtualFileSystem::ResolvePath(std::string const& path)
+{
+	if (!is_resource_path(path))
+	{
+		return path;
+	}
+
+	std::shared_lock lock{ _lock };
+	std::string_view relative = get_relative_path(path);
+
+	std::string fallback;
+	for (MountPoint const& mount : _mounts)
+	{
+		if (mount.pack)
+		{
+			continue;
+		}
+
+		std::string candidate = fmt::format("{}/{}", mount.path, relative);
+		if (_platform->Exists(candidate.c_str()))
+		{
+			return candidate;
+		}
+
+		if (fallback.empty())
+		{
+			fallback = std::move(candidate);
+		}
+	}
+
+	return fallback.empty() ? std::string(relative) : fallback;
+}
+
+bool VirtualFileSystem::CreateDirectory(const char* path)
+{
+	return _platform->CreateDirectory(ResolvePath(path).c_str());
+}
+
+bool VirtualFileSystem::Exists(const char* path)
+{
+	if (!is_resource_path(path))
+	{
+		return _platform->Exists(path);
+	}
+
+	std::shared_lock lock{ _lock };
+	PackEntry const* entry = nullptr;
+	std::string loose_path;
+	return find(get_relative_path(path), entry, loose_path) != nullptr;
+}
+
+void VirtualFileSystem::Mount(const char* path, s32 priority)
+{
+	MountPoint mount{};
+	mount.path = path;
+	mount.priority = priority;
+
+	if (mount.path.ends_with(PackFile::c_Extension))
+	{
+		mount.pack = std::make_unique<PackFile>();
+		if (!mount.pack->open(_platform->MapFile(path)))
+		{
+			fmt::print("Failed to mount pack {}.\n", path);
+			return;
+		}
+	}
+	else
+	{
+		while (mount.path.ends_with('/') || mount.path.ends_with('\\'))
+		{
+			mount.path.pop_back();
+		}
+	}
+
+	std::unique_lock lock{ _lock };
+	auto it = std::find_if(_mounts.begin(), _mounts.end(), [priority](MountPoint const& other) { return other.priority <= priority; });
+	_mounts.insert(it, std::move(mount));
+}
+
+void VirtualFileSystem::Unmount(const char* path)
+{
+	std::unique_lock lock{ _lock };
+	std::erase_if(_mounts, [path](MountPoint const& mount) { return mount.path == path; });
+}
+
+IFileRef VirtualFileSystem::OpenFile(const char* path, Mode mode, bool binary)
+{
+	if (!is_resource_path(path) || mode == Mode::Write)
+	{
+		return _platform->OpenFile(ResolvePath(path).c_str(), mode, binary);
+	}
+
+	std::shared_lock lock{ _lock };
+	PackEntry const* entry = nullptr;
+	std::string loose_path;
+	MountPoint const* mount = find(get_relative_path(path), entry, loose_path);
+	if (!mount)
+	{
+		return nullptr;
+	}
+
+	if (mount->pack)
+	{
+		IMappedFileRef file = mount->pack->map(*entry);
+		return file ? std::make_shared<PackedFile>(file, binary) : nullptr;
+	}
+	return _platform->OpenFile(loose_path.c_str(), mode, binary);
+}
+
+void VirtualFileSystem::CloseFile(IFileRef const& file)
+{
+	// Pack entries don't hold on to an OS handle
+	if (!dynamic_cast<PackedFile*>(file.get()))
+	{
+		_platform->CloseFile(file);
+	}
+}
+
+IMappedFileRef VirtualFileSystem::MapFile(const char* path)
+{
+	if (!is_resource_path(path))
+	{
+		return _platform->MapFile(path);
+	}
+
+	std::shared_lock lock{ _lock };
+	PackEntry const* entry = nullptr;
+	std::string loose_path;
+	MountPoint const* mount = find(get_relative_path(path), entry, loose_path);
+	if (!mount)
+	{
+		return nullptr;
+	}
+
+	return mount->pack ? mount->pack->map(*entry) : _platform->MapFile(loose_path.c_str());
+}
+
+VirtualFileSystem::MountPoint const* VirtualFileSystem::find(std::string_view relative, PackEntry const*& entry, std::string& loose_path) const
+{
+	for (MountPoint const& mount : _mounts)
+	{
+		if (mount.pack)
+		{
+			if (entry = mount.pack->find(relative); entry)
+			{
+				return &mount;
+			}
+		}
+		else
+		{
+			loose_path = fmt::format("{}/{}", mount.path, relative);
+			if (_platform->Exists(loose_path.c_str()))
+			{
+				return &mount;
+			}
+		}
+	}
+	return nullptr;
+}
+
+std::string_view VirtualFileSystem::get_relative_path(std::string_view path)
+{
+	path.remove_prefix(sizeof("res:") - 1);
+	while (path.starts_with('/'))
+	{
+		path.remove_prefix(1);
+	}
+	return path;
+}
+
+} // namespace IO
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "PlatformIO.h"
+#include "PackFile.h"
+
+#include <shared_mutex>
+
+namespace IO
+{
+
+// VirtualFileSystem
+//
+// Resolves 'res:/' paths against a list of mounted folders and pack files. Mounts are searched from the highest
+// to the lowest priority, later mounts win from earlier ones with the same priority. Other paths and all writes
+// go straight to the platform IO.
+class CORE_API VirtualFileSystem final : public IPlatformIO
+{
+public:
+	VirtualFileSystem(IPlatformIORef const& platform);
+	virtual ~VirtualFileSystem();
+
+	// Returns the loose file path of a resource, resources that only live in a pack resolve to the highest priority folder
+	virtual string ResolvePath(string const& path) override;
+
+	virtual bool CreateDirectory(const char* path) override;
+
+	virtual bool Exists(const char* path) override;
+
+	// Paths ending in '.pak' are mounted as pack files
+	virtual void Mount(const char* path, s32 priority = 0) override;
+
+	virtual void Unmount(const char* path) override;
+
+	virtual IFileRef OpenFile(const char* path, Mode mode, bool binary = false) override;
+
+	virtual void CloseFile(IFileRef const& file) override;
+
+	virtual IMappedFileRef MapFile(const char* path) override;
+
+private:
+	struct MountPoint
+	{
+		std::string path;
+		s32 priority;
+		std::unique_ptr<PackFile> pack;
+	};
+
+	// Finds the mount that contains a resource, 'entry' is set for packs and 'loose_path' for folders
+	MountPoint const* find(std::string_view relative, PackEntry const*& entry, std::string& loose_path) const;
+
+	static bool is_resource_path(std::string_view path) { return path.starts_with("res:"); }
+	static std::string_view get_relative_path(std::string_view path);
+
+	IPlatformIORef _platform;
+
+	std::shared_mutex _lock;
+	std::vector<MountPoint> _mounts;
+};
+
+} // namespace IO
@@ -3,13 +3,13 @@
 
 namespace Tasks
 {
-std::unique_ptr<enki::TaskScheduler> g_Scheduler;
+std::unique_ptr<JobSystem> g_Scheduler;
 
-enki::TaskScheduler* get_scheduler()
+JobSystem* get_scheduler()
 {
 	if (!g_Scheduler)
 	{
-		g_Scheduler = std::make_unique<enki::TaskScheduler>();
+		g_Scheduler = std::make_unique<JobSystem>();
 	}
 	return g_Scheduler.get();
 
@@ -0,0 +1,100 @@
+#include "tests.pch.h"
+
+#include "Framework/Archetype.h"
+
+using namespace framework;
+
+namespace framework {
+
+struct TestPosition
+{
+	float x, y, z;
+};
+
+struct TestVelocity
+{
+	float x, y, z;
+};
+
+struct TestName
+{
+	std::string name;
+};
+
+TEST_CLASS(ArchetypeTests)
+{
+public:
+
+	TEST_METHOD(archetype_add_get_remove)
+	{
+		auto world = World::create();
+		EntityHandle ent0 = world->create_entity();
+		EntityHandle ent1 = world->create_entity();
+
+		world->add_data<TestPosition>(ent0, 1.0f, 2.0f, 3.0f);
+		world->add_data<TestPosition>(ent1, 4.0f, 5.0f, 6.0f);
+		world->add_data<TestName>(ent0, "first");
+
+		// ent0 moved to another archetype, ent1 must still be found
+		Assert::AreEqual(4.0f, world->get_data<TestPosition>(ent1)->x);
+		Assert::AreEqual(1.0f, world->get_data<TestPosition>(ent0)->x);
+		Assert::AreEqual(std::string("first"), world->get_data<TestName>(ent0)->name);
+		Assert::IsNull(world->get_data<TestName>(ent1));
+
+		world->remove_data<TestPosition>(ent0);
+		Assert::IsNull(world->get_data<TestPosition>(ent0));
+		Assert::AreEqual(std::string("first"), world->get_data<TestName>(ent0)->name);
+
+		// Data goes away together with the entity
+		world->remove_entity(ent1);
+		world->update(0.0f);
+		EntityHandle ent2 = world->create_entity();
+		Assert::IsNull(world->get_data<TestPosition>(ent2));
+	}
+
+	TEST_METHOD(archetype_query)
+	{
+		auto world = World::create();
+
+		constexpr u32 c_Count = 5000;
+		std::vector<EntityHandle> entities;
+		for (u32 i = 0; i < c_Count; ++i)
+		{
+			EntityHandle ent = world->create_entity();
+			world->add_data<TestPosition>(ent, 0.0f, 0.0f, 0.0f);
+			if (i % 2 == 0)
+			{
+				world->add_data<TestVelocity>(ent, 1.0f, float(i), 0.0f);
+			}
+			entities.push_back(ent);
+		}
+
+		u32 n_visited = 0;
+		world->for_each<TestPosition, TestVelocity>([&](u64 entity, TestPosition& pos, TestVelocity& vel)
+		{
+			pos.x += vel.x;
+			pos.y += vel.y;
+			++n_visited;
+		});
+		Assert::AreEqual<u32>(c_Count / 2, n_visited);
+
+		// Removing data in the middle of an archetype moves the last entity into the hole
+		world->remove_data<TestVelocity>(entities[0]);
+		for (u32 i = 0; i < c_Count; ++i)
+		{
+			TestPosition const* pos = world->get_data<TestPosition>(entities[i]);
+			Assert::AreEqual(i % 2 == 0 ? 1.0f : 0.0f, pos->x);
+			Assert::AreEqual(i % 2 == 0 ? float(i) : 0.0f, pos->y);
+			Assert::AreEqual(i % 2 == 0 && i != 0, world->get_data<TestVelocity>(entities[i]) != nullptr);
+		}
+
+		u32 n_chunk_entities = 0;
+		world->for_each_chunk<TestPosition>([&](u32 count, u64 const* ids, TestPosition* positions)
+		{
+			n_chunk_entities += count;
+		});
+		Assert::AreEqual(c_Count, n_chunk_entities);
+	}
+};
+
+}
@@ -0,0 +1,79 @@
+#include "tests.pch.h"
+
+#include "Core/Math.h"
+#include "Graphics/BoundingVolumeHierarchy.h"
+
+namespace Graphics {
+
+TEST_CLASS(BoundingVolumeHierarchyTests)
+{
+public:
+
+	static Math::AABB make_box(float3 center)
+	{
+		return { center - float3(0.5f, 0.5f, 0.5f), center + float3(0.5f, 0.5f, 0.5f) };
+	}
+
+	TEST_METHOD(bvh_insert_remove)
+	{
+		BoundingVolumeHierarchy bvh{};
+
+		std::vector<BoundingVolumeHierarchy::ProxyId> proxies;
+		for (u32 i = 0; i < 256; ++i)
+		{
+			proxies.push_back(bvh.insert(make_box(float3(f32(i % 16) * 2.0f, 0.0f, f32(i / 16) * 2.0f)), nullptr));
+		}
+		Assert::IsTrue(bvh.validate());
+		Assert::AreEqual<u32>(256, bvh.get_proxy_count());
+		Assert::IsTrue(bvh.get_height() < 16, L"Tree is not balanced!");
+
+		for (u32 i = 0; i < proxies.size(); i += 2)
+		{
+			bvh.remove(proxies[i]);
+		}
+		Assert::IsTrue(bvh.validate());
+		Assert::AreEqual<u32>(128, bvh.get_proxy_count());
+	}
+
+	TEST_METHOD(bvh_move)
+	{
+		BoundingVolumeHierarchy bvh{};
+		BoundingVolumeHierarchy::ProxyId proxy = bvh.insert(make_box(float3(0.0f, 0.0f, 0.0f)), nullptr);
+		bvh.insert(make_box(float3(10.0f, 0.0f, 0.0f)), nullptr);
+
+		// Small movements stay within the fat bounds
+		Assert::IsFalse(bvh.move(proxy, make_box(float3(BoundingVolumeHierarchy::c_AABBMargin / 2.0f, 0.0f, 0.0f))));
+		Assert::IsTrue(bvh.move(proxy, make_box(float3(20.0f, 0.0f, 0.0f))));
+		Assert::IsTrue(bvh.validate());
+
+		std::vector<void*> result;
+		bvh.query(make_box(float3(20.0f, 0.0f, 0.0f)), result);
+		Assert::AreEqual<size_t>(1, result.size());
+	}
+
+	TEST_METHOD(bvh_frustum_query)
+	{
+		BoundingVolumeHierarchy bvh{};
+
+		// Row of boxes along the view direction, half of them behind the camera
+		std::vector<u32> ids(64);
+		for (u32 i = 0; i < ids.size(); ++i)
+		{
+			ids[i] = i;
+			bvh.insert(make_box(float3(0.0f, 0.0f, f32(i) * 2.0f - 64.0f)), &ids[i]);
+		}
+
+		Math::Frustum frustum = Math::Frustum::from_fov(0.1f, 100.0f, hlslpp::radians(float1(90.0f)), hlslpp::radians(float1(90.0f)));
+
+		std::vector<void*> result;
+		bvh.query(frustum, result);
+		for (void* user_data : result)
+		{
+			u32 id = *(u32*)user_data;
+			Assert::IsTrue(id >= 32, L"Box behind the camera was not culled!");
+		}
+		Assert::AreEqual<size_t>(32, result.size());
+	}
+};
+
+}
@@ -0,0 +1,88 @@
+#include "tests.pch.h"
+
+#include "Graphics/CommandList.h"
+
+namespace Graphics {
+
+TEST_CLASS(CommandListTests)
+{
+public:
+
+	// Four draws of one mesh followed by two draws of another mesh in the same buffers
+	static void make_draws(std::vector<DrawCall>& draws, std::vector<DrawSortItem>& items)
+	{
+		for (u32 i = 0; i < 6; ++i)
+		{
+			DrawCall dc{};
+			dc._index_buffer = GraphicsResourceHandle(GRT_Buffer, 0, 1);
+			dc._index_stride = sizeof(u16);
+			dc._vertex_buffer = GraphicsResourceHandle(GRT_Buffer, 0, 2);
+			dc._vertex_stride = 32;
+			dc._input_layout = GraphicsResourceHandle(GRT_InputLayout, 0, 1);
+			dc._material = nullptr;
+			dc._first_index = i < 4 ? 0 : 36;
+			dc._index_count = 36;
+			dc._first_vertex = 0;
+
+			items.push_back({ u64(i), u32(draws.size()) });
+			draws.push_back(dc);
+		}
+	}
+
+	TEST_METHOD(commandlist_instanced_batches)
+	{
+		std::vector<DrawCall> draws;
+		std::vector<DrawSortItem> items;
+		make_draws(draws, items);
+
+		std::vector<DrawBatch> batches;
+		build_draw_batches(draws, items, true, batches);
+		Assert::AreEqual<size_t>(2, batches.size());
+		Assert::AreEqual<u32>(4, batches[0].count);
+		Assert::AreEqual<u32>(4, batches[1].first);
+
+		CommandList cmds{};
+		record_draw_batches(cmds, draws, items, batches.data(), u32(batches.size()));
+		Assert::AreEqual<u32>(3, cmds.n_state_changes);
+		Assert::AreEqual<u32>(3, cmds.n_state_changes_skipped);
+
+		NullCommandBackend backend{};
+		cmds.execute(backend);
+		Assert::AreEqual<u32>(2, backend.n_draws);
+		Assert::AreEqual<u32>(6, backend.n_instances);
+		Assert::AreEqual<u32>(72, backend.n_primitives);
+		Assert::AreEqual<u32>(1, backend.n_index_buffers);
+
+		build_draw_batches(draws, items, false, batches);
+		Assert::AreEqual<size_t>(6, batches.size());
+	}
+
+	TEST_METHOD(commandlist_split_recording)
+	{
+		std::vector<DrawCall> draws;
+		std::vector<DrawSortItem> items;
+		make_draws(draws, items);
+
+		std::vector<DrawBatch> batches;
+		build_draw_batches(draws, items, true, batches);
+
+		// Lists are recorded independently, each of them binds its own state
+		CommandList lists[2];
+		record_draw_batches(lists[0], draws, items, batches.data(), 1);
+		record_draw_batches(lists[1], draws, items, batches.data() + 1, 1);
+
+		NullCommandBackend backend{};
+		for (CommandList const& cmds : lists)
+		{
+			cmds.execute(backend);
+		}
+		Assert::AreEqual<u32>(2, backend.n_draws);
+		Assert::AreEqual<u32>(2, backend.n_index_buffers);
+		Assert::AreEqual<u32>(2, backend.n_materials);
+
+		lists[0].reset();
+		Assert::AreEqual<u32>(0, lists[0].get_command_count());
+	}
+};
+
+}
@@ -0,0 +1,53 @@
+#include "tests.pch.h"
+
+#include "Graphics/DrawSort.h"
+
+namespace Graphics {
+
+TEST_CLASS(DrawSortTests)
+{
+public:
+
+	TEST_METHOD(drawsort_radix_sort)
+	{
+		std::vector<DrawSortItem> items;
+		u64 state = 0x9E3779B97F4A7C15ull;
+		for (u32 i = 0; i < 1000; ++i)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			items.push_back({ state % 64, i });
+		}
+
+		std::vector<DrawSortItem> expected = items;
+		std::stable_sort(expected.begin(), expected.end(), [](DrawSortItem const& lhs, DrawSortItem const& rhs) { return lhs.key < rhs.key; });
+
+		std::vector<DrawSortItem> scratch;
+		radix_sort(items, scratch);
+
+		for (u32 i = 0; i < items.size(); ++i)
+		{
+			Assert::AreEqual(expected[i].key, items[i].key);
+			Assert::AreEqual(expected[i].index, items[i].index, L"Radix sort is not stable!");
+		}
+	}
+
+	TEST_METHOD(drawsort_key_order)
+	{
+		int shader = 0;
+		int material = 0;
+
+		// State takes priority over depth, within the same state closer draws come first
+		u64 near_key = DrawSortKey::make(0, &shader, &material, 1, 1, 0, 1.0f);
+		u64 far_key = DrawSortKey::make(0, &shader, &material, 1, 1, 0, 100.0f);
+		u64 other_mesh = DrawSortKey::make(0, &shader, &material, 1, 1, 1, 0.5f);
+		u64 other_layout = DrawSortKey::make(0, &shader, &material, 2, 1, 0, 0.5f);
+		u64 next_pass = DrawSortKey::make(1, &shader, &material, 1, 1, 0, 0.0f);
+
+		Assert::IsTrue(near_key < far_key);
+		Assert::IsTrue(far_key < other_mesh, L"Draws of the same mesh are not adjacent!");
+		Assert::IsTrue(other_mesh < other_layout);
+		Assert::IsTrue(other_layout < next_pass);
+	}
+};
+
+}
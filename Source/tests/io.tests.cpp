@@ -0,0 +1,135 @@
+#include "tests.pch.h"
+
+#include "PlatformIO.h"
+#include "PackFile.h"
+#include "Compression.h"
+
+TEST_CLASS(IOTests)
+{
+public:
+
+	TEST_METHOD(io_map_file)
+	{
+		auto io = IO::create();
+		io->Mount("./");
+
+		std::vector<u8> data(100000);
+		for (size_t i = 0; i < data.size(); ++i)
+		{
+			data[i] = u8(i);
+		}
+
+		if (auto file = io->OpenFile("res:/io_map.bin", IO::Mode::Write, true); file)
+		{
+			file->write(data.data(), u32(data.size()));
+		}
+
+		IO::IMappedFileRef mapped = io->MapFile("res:/io_map.bin");
+		Assert::IsNotNull(mapped.get());
+		Assert::AreEqual<u64>(data.size(), mapped->get_size());
+		Assert::IsTrue(memcmp(data.data(), mapped->get_data().begin(), data.size()) == 0);
+
+		Assert::IsNull(io->MapFile("res:/io_missing.bin").get());
+	}
+
+	TEST_METHOD(io_read_async)
+	{
+		auto io = IO::create();
+		io->Mount("./");
+
+		if (auto file = io->OpenFile("res:/io_async.bin", IO::Mode::Write, true); file)
+		{
+			u32 value = 42;
+			file->write(&value, sizeof(value));
+		}
+
+		// Every request completes, reads of the same file in flight share their result
+		std::atomic<u32> n_callbacks = 0;
+		std::vector<IO::ReadFuture> reads;
+		for (u32 i = 0; i < 32; ++i)
+		{
+			reads.push_back(io->ReadFileAsync("res:/io_async.bin", [&](IO::IMappedFileRef const& file)
+			{
+				if (file && file->get_size() == sizeof(u32))
+				{
+					++n_callbacks;
+				}
+			}));
+		}
+
+		for (IO::ReadFuture const& read : reads)
+		{
+			Assert::AreEqual<u32>(42, *reinterpret_cast<u32 const*>(read.get()->get_data().begin()));
+		}
+		Assert::IsNull(io->ReadFileAsync("res:/io_missing.bin").get().get());
+
+		// Callbacks can still be running after the futures are ready, stopping the workers waits for them
+		io.reset();
+		Assert::AreEqual<u32>(32, n_callbacks);
+	}
+
+	TEST_METHOD(io_compression_roundtrip)
+	{
+		std::vector<u8> data(50000);
+		for (size_t i = 0; i < data.size(); ++i)
+		{
+			data[i] = u8((i / 7) % 13);
+		}
+
+		std::vector<u8> compressed(Compression::get_max_compressed_size(data.size()));
+		size_t size = Compression::compress(data.data(), data.size(), compressed.data(), compressed.size());
+		Assert::IsTrue(size > 0 && size < data.size() / 4);
+
+		std::vector<u8> result(data.size());
+		Assert::IsTrue(Compression::decompress(compressed.data(), size, result.data(), result.size()));
+		Assert::IsTrue(result == data);
+
+		// Truncated data is rejected
+		Assert::IsFalse(Compression::decompress(compressed.data(), size / 2, result.data(), result.size()));
+	}
+
+	TEST_METHOD(io_pack_mount)
+	{
+		auto io = IO::create();
+		io->Mount("./io_loose");
+
+		std::string loose = "loose";
+		if (auto file = io->OpenFile("res:/config/a.txt", IO::Mode::Write); file)
+		{
+			file->write(loose.data(), u32(loose.size()));
+		}
+
+		std::string packed(10000, 'p');
+		IO::PackWriter writer{};
+		writer.add("Config/A.txt", Span<u8 const>(reinterpret_cast<u8 const*>(packed.data()), packed.size()), true);
+		writer.add("config\\b.txt", Span<u8 const>(reinterpret_cast<u8 const*>(packed.data()), 16), false);
+
+		std::vector<u8> data;
+		writer.write(data);
+		if (auto file = io->OpenFile("io_test.pak", IO::Mode::Write, true); file)
+		{
+			file->write(data.data(), u32(data.size()));
+		}
+
+		auto read = [&io](const char* path)
+		{
+			IO::IMappedFileRef file = io->MapFile(path);
+			return file ? std::string(reinterpret_cast<const char*>(file->get_data().begin()), size_t(file->get_size())) : std::string();
+		};
+
+		// Lookups in packs ignore case and separators, higher priority mounts win
+		Assert::AreEqual(loose, read("res:/config/a.txt"));
+		io->Mount("io_test.pak", 1);
+		Assert::AreEqual(packed, read("res:/config/a.txt"));
+		Assert::AreEqual(packed.substr(0, 16), read("res:/Config/B.txt"));
+		Assert::IsTrue(io->Exists("res:/config/b.txt"));
+
+		IO::IFileRef file = io->OpenFile("res:/config/b.txt", IO::Mode::Read);
+		Assert::IsNotNull(file.get());
+		Assert::AreEqual<u64>(16, file->GetSize());
+
+		io->Unmount("io_test.pak");
+		Assert::AreEqual(loose, read("res:/config/a.txt"));
+		Assert::IsFalse(io->Exists("res:/config/b.txt"));
+	}
+};
@@ -0,0 +1,71 @@
+#include "tests.pch.h"
+
+#include "Core/Core.h"
+
+using namespace Tasks;
+
+namespace Tasks {
+
+TEST_CLASS(JobSystemTests)
+{
+public:
+
+	TEST_METHOD(jobs_parallel_for)
+	{
+		JobSystem jobs{};
+		jobs.init({ 4 });
+
+		std::atomic<u64> sum = 0;
+		JobCounter counter{};
+		jobs.parallel_for(10'000, 64, [&sum](u32 begin, u32 end)
+		{
+			for (u32 i = begin; i < end; ++i)
+			{
+				sum += i;
+			}
+		}, &counter);
+		jobs.wait(counter);
+
+		Assert::IsTrue(counter.is_done());
+		Assert::AreEqual<u64>(49'995'000, sum, L"Not every index was visited exactly once!");
+	}
+
+	TEST_METHOD(jobs_nested_wait)
+	{
+		JobSystem jobs{};
+		jobs.init({ 2 });
+
+		// Waiting from within a job executes the child jobs instead of deadlocking the workers
+		std::atomic<u32> executed = 0;
+		JobCounter outer{};
+		for (u32 i = 0; i < 16; ++i)
+		{
+			jobs.run([&jobs, &executed]()
+			{
+				JobCounter inner{};
+				for (u32 j = 0; j < 8; ++j)
+				{
+					jobs.run([&executed]() { ++executed; }, &inner);
+				}
+				jobs.wait(inner);
+				++executed;
+			}, &outer);
+		}
+		jobs.wait(outer);
+
+		Assert::AreEqual<u32>(16 * 9, executed);
+	}
+
+	TEST_METHOD(jobs_run_inline_without_workers)
+	{
+		JobSystem jobs{};
+
+		bool executed = false;
+		JobCounter counter{};
+		jobs.run([&executed]() { executed = true; }, &counter);
+
+		Assert::IsTrue(executed && counter.is_done());
+	}
+};
+
+}
@@ -0,0 +1,74 @@
+#include "tests.pch.h"
+
+#include "Core/Math.h"
+
+namespace Math {
+
+TEST_CLASS(FrustumCullingTests)
+{
+public:
+
+	static Frustum make_frustum()
+	{
+		return Frustum::from_fov(0.1f, 100.0f, hlslpp::radians(float1(90.0f)), hlslpp::radians(float1(60.0f)));
+	}
+
+	TEST_METHOD(frustum_planes_normalized)
+	{
+		Frustum frustum = make_frustum();
+		for (FrustumPlane const& plane : frustum._planes)
+		{
+			Assert::AreEqual(1.0f, f32(hlslpp::length(plane.normal)), 0.0001f);
+
+			// The center of the frustum is inside of every plane
+			Assert::IsTrue(plane.distance(float3(0.0f, 0.0f, 50.0f)) < 0.0f);
+		}
+	}
+
+	TEST_METHOD(frustum_aabb)
+	{
+		Frustum frustum = make_frustum();
+
+		AABB inside{ float3(-1.0f, -1.0f, 10.0f), float3(1.0f, 1.0f, 12.0f) };
+		AABB intersect{ float3(-1.0f, -1.0f, -1.0f), float3(1.0f, 1.0f, 1.0f) };
+		AABB outside{ float3(-1.0f, -1.0f, -10.0f), float3(1.0f, 1.0f, -8.0f) };
+
+		// Left of the frustum at the edge of the horizontal fov, the old unnormalized planes culled these too early
+		AABB left{ float3(-11.0f, -1.0f, 10.0f), float3(-9.5f, 1.0f, 12.0f) };
+
+		Assert::IsTrue(test_frustum_aabb(frustum, inside) == CullResult::Inside);
+		Assert::IsTrue(test_frustum_aabb(frustum, intersect) == CullResult::Intersect);
+		Assert::IsTrue(test_frustum_aabb(frustum, outside) == CullResult::Outside);
+		Assert::IsTrue(test_frustum_aabb(frustum, left) == CullResult::Intersect);
+
+		u32 mask = Frustum::c_AllPlanes;
+		test_frustum_aabb(frustum, inside, &mask);
+		Assert::AreEqual<u32>(0, mask);
+	}
+
+	TEST_METHOD(frustum_obb)
+	{
+		Frustum frustum = make_frustum();
+
+		// Long thin box that is fully inside once rotated to lie along the x axis, unrotated it crosses the near plane
+		AABB box{ float3(-0.1f, -0.1f, -10.0f), float3(0.1f, 0.1f, 10.0f) };
+		float4x4 rotated = hlslpp::mul(float4x4::rotation_y(hlslpp::radians(float1(90.0f))), float4x4::translation(0.0f, 0.0f, 20.0f));
+		Assert::IsTrue(test_frustum_obb(frustum, box, rotated) == CullResult::Inside);
+		Assert::IsTrue(test_frustum_obb(frustum, box, float4x4::translation(0.0f, 0.0f, 5.0f)) == CullResult::Intersect);
+
+		float4x4 behind = float4x4::translation(0.0f, 0.0f, -20.0f);
+		Assert::IsTrue(test_frustum_obb(frustum, box, behind) == CullResult::Outside);
+	}
+
+	TEST_METHOD(bounding_sphere_scaled)
+	{
+		AABB box{ float3(-1.0f, -1.0f, -1.0f), float3(1.0f, 1.0f, 1.0f) };
+		float4x4 transform = hlslpp::mul(float4x4::scale(1.0f, 4.0f, 1.0f), float4x4::translation(5.0f, 0.0f, 0.0f));
+
+		Sphere sphere = compute_bounding_sphere(box, transform);
+		Assert::AreEqual(5.0f, f32(sphere.center.x), 0.0001f);
+		Assert::IsTrue(sphere.radius >= 4.0f * sqrtf(3.0f) - 0.0001f, L"Sphere does not enclose the scaled box!");
+	}
+};
+
+}
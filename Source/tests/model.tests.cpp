@@ -0,0 +1,360 @@
+#include "tests.pch.h"
+
+#include "Core/ModelResource.h"
+#include "Core/VertexFormat.h"
+#include "Core/MeshOptimizer.h"
+#include "Core/CookedModel.h"
+
+TEST_CLASS(ModelTests)
+{
+public:
+
+	TEST_METHOD(vertex_format_stride)
+	{
+		VertexLayoutFlags flags = VertexLayoutFlags::Position | VertexLayoutFlags::Normal | VertexLayoutFlags::Tangent0 | VertexLayoutFlags::Tangent1 | VertexLayoutFlags::UV0;
+		Assert::AreEqual<u32>(12 + 4 + 8 + 4, VertexFormat::get_stride(flags));
+
+		// Unsupported tangent slots are dropped
+		VertexLayoutFlags supported = VertexFormat::get_supported_flags(flags | VertexLayoutFlags::Tangent2 | VertexLayoutFlags::Tangent3);
+		Assert::IsTrue(supported == flags);
+
+		std::vector<D3D11_INPUT_ELEMENT_DESC> elements;
+		VertexFormat::get_input_elements(flags, elements);
+		Assert::AreEqual<size_t>(5, elements.size());
+		Assert::IsTrue(elements[1].Format == DXGI_FORMAT_R16G16_SNORM);
+		Assert::IsTrue(elements[4].Format == DXGI_FORMAT_R16G16_FLOAT);
+	}
+
+	TEST_METHOD(vertex_format_encode)
+	{
+		ModelVertex v{};
+		v.position.x = 1.0f;
+		v.position.y = -2.0f;
+		v.position.z = 3.5f;
+		v.normal.x = 0.0f;
+		v.normal.y = -0.6f;
+		v.normal.z = -0.8f;
+		v.color[0] = Shaders::float4(1.0f, 0.5f, 0.0f, 1.0f);
+		v.uv[0].x = 0.25f;
+		v.uv[0].y = 1.5f;
+
+		VertexLayoutFlags flags = VertexLayoutFlags::Position | VertexLayoutFlags::Normal | VertexLayoutFlags::Colour0 | VertexLayoutFlags::UV0;
+		std::vector<u8> data(VertexFormat::get_stride(flags));
+		VertexFormat::encode(flags, &v, 1, data.data());
+
+		f32 position[3];
+		memcpy(position, data.data(), sizeof(position));
+		Assert::AreEqual(-2.0f, position[1]);
+
+		u32 normal;
+		memcpy(&normal, data.data() + 12, sizeof(normal));
+		f32 x, y, z;
+		VertexFormat::decode_octahedral(normal, x, y, z);
+		Assert::AreEqual(0.0f, x, 0.001f);
+		Assert::AreEqual(-0.6f, y, 0.001f);
+		Assert::AreEqual(-0.8f, z, 0.001f);
+
+		Assert::AreEqual<u32>(0xFF0080FF, *reinterpret_cast<u32 const*>(data.data() + 16));
+
+		u16 uv[2];
+		memcpy(uv, data.data() + 20, sizeof(uv));
+		Assert::AreEqual(0.25f, VertexFormat::half_to_float(uv[0]));
+		Assert::AreEqual(1.5f, VertexFormat::half_to_float(uv[1]));
+	}
+
+	TEST_METHOD(vertex_format_half)
+	{
+		// Every finite half survives a round trip through float
+		for (u32 i = 0; i < 0x10000; ++i)
+		{
+			u16 half = u16(i);
+			if ((half & 0x7C00) == 0x7C00)
+			{
+				continue;
+			}
+			Assert::AreEqual<u32>(half, VertexFormat::float_to_half(VertexFormat::half_to_float(half)));
+		}
+
+		Assert::AreEqual<u32>(0x7BFF, VertexFormat::float_to_half(65519.0f));
+		Assert::AreEqual<u32>(0x7C00, VertexFormat::float_to_half(1e6f));
+	}
+
+	// Unindexed grid of n x n quads with the triangles in a scrambled order
+	static void make_grid(u32 n, std::vector<ModelVertex>& vertices, std::vector<u32>& indices)
+	{
+		auto make_vertex = [n](u32 x, u32 y)
+		{
+			ModelVertex v{};
+			v.position.x = f32(x);
+			v.position.y = f32(y);
+			v.normal.z = 1.0f;
+			v.uv[0].x = f32(x) / f32(n);
+			v.uv[0].y = f32(y) / f32(n);
+			return v;
+		};
+
+		u32 const n_triangles = n * n * 2;
+		for (u32 i = 0; i < n_triangles; ++i)
+		{
+			// 7919 is prime so this visits every triangle once
+			u32 t = u32((u64(i) * 7919) % n_triangles);
+			u32 x = (t / 2) % n;
+			u32 y = (t / 2) / n;
+			if (t % 2 == 0)
+			{
+				vertices.push_back(make_vertex(x, y));
+				vertices.push_back(make_vertex(x + 1, y));
+				vertices.push_back(make_vertex(x, y + 1));
+			}
+			else
+			{
+				vertices.push_back(make_vertex(x + 1, y));
+				vertices.push_back(make_vertex(x + 1, y + 1));
+				vertices.push_back(make_vertex(x, y + 1));
+			}
+			indices.push_back(u32(indices.size()));
+			indices.push_back(u32(indices.size()));
+			indices.push_back(u32(indices.size()));
+		}
+	}
+
+	// Sorted triangles by position, rotations of a triangle compare equal
+	static std::vector<std::array<f32, 9>> get_triangles(std::vector<ModelVertex> const& vertices, std::vector<u32> const& indices)
+	{
+		std::vector<std::array<f32, 9>> triangles;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			std::array<f32, 9> rotations[3];
+			for (u32 r = 0; r < 3; ++r)
+			{
+				for (u32 k = 0; k < 3; ++k)
+				{
+					Shaders::float3 const& p = vertices[indices[i + (k + r) % 3]].position;
+					rotations[r][k * 3 + 0] = p.x;
+					rotations[r][k * 3 + 1] = p.y;
+					rotations[r][k * 3 + 2] = p.z;
+				}
+			}
+			triangles.push_back(std::min({ rotations[0], rotations[1], rotations[2] }));
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	TEST_METHOD(mesh_optimizer_grid)
+	{
+		std::vector<ModelVertex> vertices;
+		std::vector<u32> indices;
+		make_grid(32, vertices, indices);
+		auto triangles = get_triangles(vertices, indices);
+
+		MeshOptimizer::Report report = MeshOptimizer::optimize(vertices, indices);
+
+		// Welding leaves one vertex per grid point and the triangles are unchanged
+		Assert::AreEqual<size_t>(33 * 33, vertices.size());
+		Assert::IsTrue(triangles == get_triangles(vertices, indices));
+
+		Assert::AreEqual(3.0f, report.before.get_acmr());
+		Assert::IsTrue(report.after.get_acmr() < 0.8f);
+		Assert::IsTrue(report.after.get_atvr() < 1.5f);
+
+		// Vertices are stored in the order they are first used
+		u32 next = 0;
+		for (u32 index : indices)
+		{
+			Assert::IsTrue(index <= next);
+			next = std::max(next, index + 1);
+		}
+	}
+
+	TEST_METHOD(mesh_optimizer_unused_vertices)
+	{
+		std::vector<ModelVertex> vertices(8);
+		for (u32 i = 0; i < 8; ++i)
+		{
+			vertices[i].position.x = f32(i);
+		}
+		std::vector<u32> indices = { 6, 2, 4 };
+
+		MeshOptimizer::Options options{};
+		options.weld = false;
+		MeshOptimizer::optimize(vertices, indices, options);
+
+		Assert::AreEqual<size_t>(3, vertices.size());
+		Assert::AreEqual(6.0f, vertices[indices[0]].position.x);
+		Assert::AreEqual(2.0f, vertices[indices[1]].position.x);
+		Assert::AreEqual(4.0f, vertices[indices[2]].position.x);
+	}
+
+	// Signed area of the triangles projected on the xy plane
+	static f32 get_area(std::vector<ModelVertex> const& vertices, std::vector<u32> const& indices)
+	{
+		f32 area = 0.0f;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			Shaders::float3 const& p0 = vertices[indices[i + 0]].position;
+			Shaders::float3 const& p1 = vertices[indices[i + 1]].position;
+			Shaders::float3 const& p2 = vertices[indices[i + 2]].position;
+			area += 0.5f * ((p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x));
+		}
+		return area;
+	}
+
+	TEST_METHOD(mesh_simplifier_grid)
+	{
+		std::vector<ModelVertex> vertices;
+		std::vector<u32> indices;
+		make_grid(32, vertices, indices);
+		MeshOptimizer::optimize(vertices, indices);
+
+		// A flat grid collapses without error, the locked border keeps the outline and no triangle flips
+		std::vector<MeshOptimizer::Lod> lods;
+		MeshOptimizer::generate_lods(vertices, indices, Mesh::c_MaxLods, 0.05f, lods);
+		Assert::AreEqual<size_t>(Mesh::c_MaxLods - 1, lods.size());
+
+		size_t n_indices = indices.size();
+		for (MeshOptimizer::Lod const& lod : lods)
+		{
+			Assert::IsTrue(lod.indices.size() <= n_indices / 2);
+			Assert::AreEqual(0.0f, lod.error, 0.0001f);
+			Assert::AreEqual(32.0f * 32.0f, get_area(vertices, lod.indices), 0.01f);
+			n_indices = lod.indices.size();
+		}
+	}
+
+	TEST_METHOD(mesh_simplifier_error_limit)
+	{
+		// Bending the grid along x makes every collapse across the bend cost error, collapses along y stay free
+		std::vector<ModelVertex> vertices;
+		std::vector<u32> indices;
+		make_grid(16, vertices, indices);
+		for (ModelVertex& v : vertices)
+		{
+			v.position.z = (v.position.x - 8.0f) * (v.position.x - 8.0f) / 8.0f;
+		}
+		MeshOptimizer::optimize(vertices, indices);
+
+		std::vector<u32> result;
+		f32 error = MeshOptimizer::simplify(vertices, indices, 0, 0.0f, result);
+		Assert::AreEqual(0.0f, error, 0.0001f);
+		Assert::IsTrue(result.size() < indices.size());
+
+		// Without an error limit the simplifier also collapses across the bend
+		f32 coarse_error = MeshOptimizer::simplify(vertices, indices, 0, 100.0f, result);
+		Assert::IsTrue(coarse_error > 0.0f);
+	}
+
+	TEST_METHOD(mesh_select_lod)
+	{
+		Mesh mesh{};
+		mesh.n_lods = 4;
+		mesh.lods[1].error = 0.01f;
+		mesh.lods[2].error = 0.05f;
+		mesh.lods[3].error = 0.2f;
+
+		Assert::AreEqual<u32>(0, mesh.select_lod(1000.0f, 1.0f));
+		Assert::AreEqual<u32>(1, mesh.select_lod(100.0f, 1.0f));
+		Assert::AreEqual<u32>(2, mesh.select_lod(100.0f, 5.0f));
+		Assert::AreEqual<u32>(3, mesh.select_lod(1.0f, 1.0f));
+
+		mesh.n_lods = 2;
+		Assert::AreEqual<u32>(1, mesh.select_lod(1.0f, 1.0f));
+	}
+
+	// Quad with a coarser second LOD, written through the same builder as cook_model
+	static CookedModelBuilder make_cooked_quad()
+	{
+		VertexLayoutFlags flags = VertexLayoutFlags::Position | VertexLayoutFlags::Normal;
+
+		CookedModelBuilder builder{};
+		CookedMesh mesh{};
+		mesh.vertex_count = 4;
+		mesh.vertex_stride = VertexFormat::get_stride(flags);
+		mesh.layout_flags = u32(flags);
+		mesh.n_lods = 2;
+		builder.meshes.push_back(mesh);
+		builder.vertices.resize(size_t(mesh.vertex_count) * mesh.vertex_stride);
+		builder.n_vertices = mesh.vertex_count;
+
+		builder.indices = { 0, 1, 2, 2, 1, 3, 0, 1, 3 };
+		builder.lods.push_back({ 0, 6, 0.0f });
+		builder.lods.push_back({ 6, 3, 0.5f });
+
+		CookedMaterial material{};
+		std::fill(std::begin(material.textures), std::end(material.textures), CookedMaterial::c_NoTexture);
+		material.textures[CookedMaterial::Slot_Albedo] = builder.add_string("quad.png");
+		builder.materials.push_back(material);
+		builder.base_material = builder.add_string("res:/Engine/default.material");
+
+		CookedDependency dependency{};
+		dependency.path = builder.add_string("quad.bin");
+		dependency.size = 1024;
+		dependency.write_time = 42;
+		builder.dependencies.push_back(dependency);
+		return builder;
+	}
+
+	TEST_METHOD(cooked_model_round_trip)
+	{
+		std::vector<u8> data;
+		make_cooked_quad().write(data);
+
+		CookedModel cooked{};
+		Assert::IsTrue(cooked.open(data.data(), data.size()));
+
+		CookedModelHeader const& header = cooked.get_header();
+		Assert::AreEqual<u32>(4, header.n_vertices);
+		Assert::AreEqual<u32>(sizeof(u16), header.index_stride, L"Small meshes should use 16 bit indices!");
+		Assert::AreEqual<u32>(3, static_cast<u16 const*>(cooked.get_indices())[5]);
+		Assert::AreEqual(0.5f, cooked.get_lods()[cooked.get_meshes()[0].first_lod + 1].error);
+		Assert::AreEqual(std::string("quad.png"), std::string(cooked.get_string(cooked.get_materials()[0].textures[CookedMaterial::Slot_Albedo])));
+		Assert::AreEqual(std::string("res:/Engine/default.material"), std::string(cooked.get_string(header.base_material)));
+
+		Assert::AreEqual<u32>(1, header.n_dependencies);
+		Assert::AreEqual(std::string("quad.bin"), std::string(cooked.get_string(cooked.get_dependencies()[0].path)));
+		Assert::AreEqual<u64>(1024, cooked.get_dependencies()[0].size);
+		Assert::AreEqual<u64>(42, cooked.get_dependencies()[0].write_time);
+	}
+
+	TEST_METHOD(cooked_model_rejects_corrupt_data)
+	{
+		std::vector<u8> data;
+		make_cooked_quad().write(data);
+
+		CookedModel cooked{};
+		Assert::IsFalse(cooked.open(data.data(), sizeof(CookedModelHeader) - 1));
+		Assert::IsFalse(cooked.open(data.data(), data.size() - 1), L"Truncated string tables should be rejected!");
+
+		// Tables that point outside of the data
+		std::vector<u8> corrupt = data;
+		reinterpret_cast<CookedModelHeader*>(corrupt.data())->meshes_offset = u32(corrupt.size());
+		Assert::IsFalse(cooked.open(corrupt.data(), corrupt.size()));
+
+		corrupt = data;
+		reinterpret_cast<CookedModelHeader*>(corrupt.data())->n_dependencies = 1000;
+		Assert::IsFalse(cooked.open(corrupt.data(), corrupt.size()));
+
+		// Entries that index outside of their tables
+		CookedModelBuilder builder = make_cooked_quad();
+		builder.lods[1].index_count = 6;
+		builder.write(corrupt);
+		Assert::IsFalse(cooked.open(corrupt.data(), corrupt.size()));
+
+		builder = make_cooked_quad();
+		builder.meshes[0].material_index = 1;
+		builder.write(corrupt);
+		Assert::IsFalse(cooked.open(corrupt.data(), corrupt.size()));
+
+		builder = make_cooked_quad();
+		builder.dependencies[0].path = u32(builder.strings.size());
+		builder.write(corrupt);
+		Assert::IsFalse(cooked.open(corrupt.data(), corrupt.size()));
+
+		builder = make_cooked_quad();
+		builder.meshes[0].vertex_stride += 4;
+		builder.write(corrupt);
+		Assert::IsFalse(cooked.open(corrupt.data(), corrupt.size()), L"Streams written with another vertex format should be rejected!");
+
+		Assert::IsTrue(cooked.open(data.data(), data.size()));
+	}
+};
@@ -0,0 +1,142 @@
+#include "tests.pch.h"
+
+#include "Graphics/RenderInterface.h"
+#include "Graphics/Null/NullRenderInterface.h"
+
+namespace Graphics {
+
+namespace
+{
+
+// Built field by field so the tests don't need the D3D11 helper constructors
+Texture2DDesc MakeTextureDesc(u32 width, u32 height)
+{
+	Texture2DDesc desc{};
+	desc.Width = width;
+	desc.Height = height;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.SampleDesc.Count = 1;
+	desc.BindFlags = BindFlag_ShaderResource;
+	return desc;
+}
+
+} // namespace
+
+TEST_CLASS(NullRenderInterfaceTests)
+{
+public:
+
+	TEST_METHOD(null_rhi_buffer_upload)
+	{
+		NullRenderInterface ri{};
+		ri.Init();
+
+		std::array<u32, 16> initial{};
+		initial[0] = 42;
+
+		BufferDesc desc{};
+		desc.ByteWidth = u32(sizeof(initial));
+		desc.BindFlags = BindFlag_ConstantBuffer;
+
+		SubresourceData data{};
+		data.pSysMem = initial.data();
+		GraphicsResourceHandle buffer = ri.CreateBuffer(desc, &data);
+		Assert::AreEqual<u64>(sizeof(initial), ri.GetStats().bytes_uploaded);
+
+		NullRenderContext& ctx = ri.BeginContext();
+		u32* mapped = static_cast<u32*>(ctx.Map(buffer));
+		Assert::IsNotNull(mapped);
+		Assert::AreEqual<u32>(42, mapped[0], L"Mapped memory lost the initial data!");
+		mapped[0] = 7;
+		ctx.Unmap(buffer);
+
+		Assert::AreEqual<u32>(1, ri.GetStats().n_maps);
+		Assert::AreEqual<u64>(2 * sizeof(initial), ri.GetStats().bytes_uploaded);
+
+		// Maps are not write discard, the next map sees what the previous one wrote
+		mapped = static_cast<u32*>(ctx.Map(buffer));
+		Assert::AreEqual<u32>(7, mapped[0], L"Mapped memory lost the previous write!");
+		ctx.Unmap(buffer);
+		Assert::AreEqual<u32>(2, ri.GetStats().n_maps);
+
+		ri.Shutdown();
+	}
+
+	TEST_METHOD(null_rhi_draw_stats)
+	{
+		NullRenderInterface ri{};
+		ri.Init();
+
+		NullRenderContext& ctx = ri.BeginContext();
+		ctx.DrawIndexed(36, 0, 0);
+		ctx.DrawIndexedInstanced(36, 10, 0, 0, 0);
+		ctx.Draw(3, 0);
+
+		NullRenderStats const& stats = ri.GetStats();
+		Assert::AreEqual<u32>(3, stats.n_draws);
+		Assert::AreEqual<u32>(12, stats.n_instances);
+		Assert::AreEqual<u64>(36 + 360 + 3, stats.n_vertices);
+
+		ri.ResetStats();
+		Assert::AreEqual<u32>(0, ri.GetStats().n_draws);
+
+		ri.Shutdown();
+	}
+
+	TEST_METHOD(null_rhi_release)
+	{
+		NullRenderInterface ri{};
+		ri.Init();
+
+		GraphicsResourceHandle texture = ri.CreateTexture(MakeTextureDesc(64, 32), nullptr);
+		Assert::AreEqual<u32>(64, ri.GetTexture2DDesc(texture).Width);
+		Assert::AreEqual<u64>(64 * 32 * 4, ri.GetStats().bytes_allocated);
+
+		GraphicsResourceHandle stale = texture;
+		ri.ReleaseResource(texture);
+		Assert::IsFalse(texture.IsValid());
+		Assert::IsFalse(ri.IsAlive(stale));
+
+		// The slot is reused with a new generation, the old handle stays invalid
+		GraphicsResourceHandle reused = ri.CreateTexture(MakeTextureDesc(4, 4), nullptr);
+		Assert::IsTrue(ri.IsAlive(reused));
+		Assert::IsFalse(ri.IsAlive(stale));
+		Assert::AreEqual<u32>(1, ri.GetStats().n_resources_released);
+
+		ri.Shutdown();
+	}
+
+	TEST_METHOD(null_rhi_swapchain_buffer)
+	{
+		NullRenderInterface ri{};
+		ri.Init();
+
+		SwapChainDesc desc{};
+		desc.BufferDesc.Width = 128;
+		desc.BufferDesc.Height = 64;
+		desc.SampleDesc.Count = 1;
+		desc.BufferCount = 2;
+		SwapchainHandle swapchain = ri.CreateSwapchain(desc);
+		u32 created = ri.GetStats().n_resources_created;
+
+		// Fetching the back buffer every frame hands out the same texture, releasing the handle keeps it alive
+		GraphicsResourceHandle buffer = ri.GetSwapchainBuffer(swapchain, 0);
+		GraphicsResourceHandle again = ri.GetSwapchainBuffer(swapchain, 0);
+		Assert::IsTrue(buffer == again);
+		ri.ReleaseResource(again);
+		Assert::IsTrue(ri.IsAlive(buffer));
+		Assert::AreEqual<u32>(created, ri.GetStats().n_resources_created);
+
+		ri.ResizeSwapchain(swapchain, 256, 128);
+		Assert::IsFalse(ri.IsAlive(buffer));
+		Assert::AreEqual<u32>(256, ri.GetTexture2DDesc(ri.GetSwapchainBuffer(swapchain, 0)).Width);
+
+		ri.ReleaseSwapchain(swapchain);
+		Assert::AreEqual<u32>(ri.GetStats().n_resources_created, ri.GetStats().n_resources_released);
+
+		ri.Shutdown();
+	}
+};
+
+}
@@ -1,9 +1,25 @@
 #include "tests.pch.h"
 
+#include "Framework/Component.h"
+#include "Core/WorldSnapshot.h"
+#include "Graphics/RenderWorld.h"
+
 using namespace framework;
 
 namespace framework {
 
+class CounterComponent final : public Component
+{
+public:
+	void update(float dt) override { ++_updates; }
+
+	Component* clone(Entity* ent) const override { return ent->clone_component(*this); }
+
+	SystemAccess get_update_access() const override { return SystemAccess::parallel(0, Access_Transform); }
+
+	u32 _updates = 0;
+};
+
 TEST_CLASS(WorldTests)
 {
 public:
@@ -60,6 +76,179 @@ public:
 		}
 
 	}
+
+	TEST_METHOD(world_transform_propagation)
+	{
+		auto world = World::create();
+
+		EntityHandle parent = world->create_entity();
+		EntityHandle child = world->create_entity();
+		EntityHandle grandchild = world->create_entity();
+		world->attach_to_root(parent);
+		world->attach_to(parent, child);
+		world->attach_to(child, grandchild);
+
+		parent->set_local_position(float3(1.0f, 0.0f, 0.0f));
+		child->set_local_position(float3(0.0f, 2.0f, 0.0f));
+		grandchild->set_local_position(float3(0.0f, 0.0f, 3.0f));
+
+		auto world_position = [](EntityHandle const& ent)
+		{
+			return float3(hlslpp::mul(float4(0.0f, 0.0f, 0.0f, 1.0f), ent->get_world_transform()).xyz);
+		};
+
+		world->update(0.0f);
+
+		float3 pos = world_position(grandchild);
+		Assert::AreEqual(1.0f, float(pos.x));
+		Assert::AreEqual(2.0f, float(pos.y));
+		Assert::AreEqual(3.0f, float(pos.z));
+
+		// An entity sees its own change right away, the children keep the cached transform until the next pass
+		parent->set_local_position(float3(5.0f, 0.0f, 0.0f));
+		Assert::AreEqual(5.0f, float(world_position(parent).x));
+		Assert::AreEqual(1.0f, float(world_position(grandchild).x));
+
+		// The batched pass refreshes the cached transforms of the whole chain
+		world->update(0.0f);
+
+		pos = world_position(grandchild);
+		Assert::AreEqual(5.0f, float(pos.x));
+		Assert::AreEqual(2.0f, float(pos.y));
+		Assert::AreEqual(3.0f, float(pos.z));
+	}
+
+	TEST_METHOD(world_instantiate_batch)
+	{
+		struct Health
+		{
+			u32 value;
+		};
+
+		auto world = World::create();
+
+		EntityHandle group = world->create_entity();
+		world->attach_to_root(group);
+
+		EntityHandle prefab = world->create_entity();
+		world->attach_to(group, prefab);
+		prefab->set_local_position(float3(1.0f, 2.0f, 3.0f));
+		world->add_data<Health>(prefab, 100u);
+
+		constexpr u32 c_Count = 10000;
+		std::vector<EntityHandle> spawned;
+		world->instantiate(prefab, c_Count, spawned);
+		Assert::AreEqual<size_t>(c_Count, spawned.size());
+		Assert::AreEqual<u64>(c_Count + 3, world->get_number_of_entities());
+
+		for (EntityHandle const& ent : spawned)
+		{
+			Assert::IsTrue(ent->get_parent() == group);
+			Assert::AreEqual(2.0f, float(ent->get_local_position().y));
+			Assert::AreEqual(100u, world->get_data<Health>(ent)->value);
+		}
+
+		// Despawn the whole wave at once, the slots get reused by the next one
+		world->remove_entities(spawned);
+		world->update(0.0f);
+		Assert::AreEqual<u64>(3, world->get_number_of_entities());
+
+		std::vector<EntityHandle> respawned;
+		world->create_entities(c_Count, respawned);
+		Assert::IsTrue(respawned.back().id < c_Count + 3);
+		Assert::IsNull(world->get_data<Health>(respawned.front()));
+	}
+
+	TEST_METHOD(world_instantiate_components)
+	{
+		auto world = World::create();
+
+		EntityHandle prefab = world->create_entity();
+		world->attach_to_root(prefab);
+		CounterComponent* src = prefab->create_component<CounterComponent>();
+		src->_updates = 7;
+
+		std::vector<EntityHandle> spawned;
+		world->instantiate(prefab, 3, spawned);
+		Assert::AreEqual<size_t>(4, world->get_components<CounterComponent>().size());
+
+		for (EntityHandle const& ent : spawned)
+		{
+			CounterComponent* copy = ent->get_component<CounterComponent>();
+			Assert::IsNotNull(copy, L"Components of the prefab should be copied!");
+			Assert::IsTrue(copy != src);
+			Assert::IsTrue(copy->get_entity() == ent.get());
+			Assert::AreEqual<u32>(7, copy->_updates);
+		}
+
+		// The copies are registered with the world and updated like any other component
+		world->update(0.0f);
+		Assert::AreEqual<u32>(8, spawned.front()->get_component<CounterComponent>()->_updates);
+	}
+
+	TEST_METHOD(world_snapshot_instantiate)
+	{
+		WorldSnapshotBuilder builder{};
+		for (u32 i = 0; i < 100; ++i)
+		{
+			WorldSnapshotLocal local{ { float(i), 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f } };
+			builder.add_instance("instance_" + std::to_string(i), i % 2 == 0 ? "res:/a.glb" : "res:/b.glb", local);
+		}
+
+		WorldSnapshotLight sun{};
+		sun.type = u32(RenderWorldLight::LightType::Directional);
+		sun.casts_shadow = 1;
+		sun.colour[0] = sun.colour[1] = sun.colour[2] = 1.0f;
+		sun.target[1] = -1.0f;
+		sun.shadow_projection = u32(RenderWorldCamera::Projection::Ortographic);
+		sun.shadow_width = 10.0f;
+		sun.shadow_height = 20.0f;
+		sun.shadow_far = 25.0f;
+		builder.add_light("sun", sun);
+
+		builder.set_source_hash(0x1234'5678'9ABC'DEF0ull);
+
+		std::vector<u8> data;
+		builder.write(data);
+
+		WorldSnapshot snapshot{};
+		Assert::IsTrue(snapshot.open(data.data(), data.size()));
+		Assert::AreEqual<u64>(0x1234'5678'9ABC'DEF0ull, snapshot.get_source_hash());
+		Assert::AreEqual<u32>(100, snapshot.get_num_instances());
+		Assert::AreEqual<u32>(2, snapshot.get_num_meshes());
+		Assert::AreEqual(std::string("res:/b.glb"), std::string(snapshot.get_mesh(snapshot.get_mesh_indices()[1])));
+
+		auto world = World::create();
+		std::vector<EntityHandle> entities;
+		snapshot.instantiate(*world, &entities);
+		Assert::AreEqual<size_t>(100, entities.size());
+		Assert::AreEqual(std::string("instance_42"), std::string(entities[42]->get_name()));
+		Assert::AreEqual(42.0f, float(entities[42]->get_local_position().x));
+
+		// Lights keep the shadow camera they were compiled with
+		Assert::AreEqual<u32>(1, snapshot.get_num_lights());
+		Assert::AreEqual(std::string("sun"), std::string(snapshot.get_string(snapshot.get_lights()[0].name)));
+
+		WorldSnapshotBuilder light_builder{};
+		light_builder.add_light("sun", sun);
+		std::vector<u8> light_data;
+		light_builder.write(light_data);
+		Assert::IsTrue(snapshot.open(light_data.data(), light_data.size()));
+
+		RenderWorld render_world{};
+		snapshot.instantiate(render_world);
+		Assert::AreEqual<size_t>(1, render_world.get_lights().size());
+
+		RenderWorldLightRef light = render_world.get_light(0);
+		Assert::IsTrue(light->get_casts_shadow());
+		Assert::IsTrue(light->get_settings().projection_type == RenderWorldCamera::Projection::Ortographic);
+		Assert::AreEqual(20.0f, light->get_settings().height);
+		Assert::AreEqual(25.0f, light->get_far());
+		Assert::AreEqual(1.0f, light->get_aspect());
+
+		// Truncated data is rejected instead of read out of bounds
+		Assert::IsFalse(snapshot.open(data.data(), data.size() - 1));
+	}
 };
 
 TEST_CLASS(EntityHandleTests) {
@@ -90,6 +279,105 @@ TEST_CLASS(EntityHandleTests) {
 		Assert::IsFalse(handle.is_valid());
 
 	}
+
+	TEST_METHOD(handle_invalid_after_world_destroy) {
+		auto w = World::create();
+		EntityHandle handle = w->create_entity();
+		Assert::IsNotNull(handle.get());
+
+		w.reset();
+		Assert::IsFalse(handle.is_valid());
+		Assert::IsNull(handle.get());
+
+		// A new world reusing the registry slot doesn't revive old handles
+		auto w2 = World::create();
+		w2->create_entity();
+		Assert::IsFalse(handle.is_valid());
+	}
+
+	TEST_METHOD(handle_batch_resolve) {
+		auto w = World::create();
+		auto other = World::create();
+
+		std::vector<EntityHandle> handles;
+		for (int i = 0; i < 10; ++i) {
+			handles.push_back(w->create_entity());
+		}
+		w->remove_entity(handles[3]);
+		handles.push_back(other->create_entity());
+
+		std::vector<Entity*> entities;
+		w->resolve(handles, entities);
+		Assert::AreEqual<size_t>(handles.size(), entities.size());
+		for (size_t i = 0; i < 10; ++i) {
+			Assert::IsTrue(entities[i] == (i == 3 ? nullptr : handles[i].get()));
+		}
+		Assert::IsNull(entities[10], L"Handles of another world must not resolve!");
+	}
+};
+
+class CountingSystem final : public System
+{
+public:
+	CountingSystem(SystemAccess access, std::atomic<u32>* counter)
+			: System("CountingSystem", access)
+			, _counter(counter)
+	{
+	}
+
+	void update(World& world, float dt) override { ++(*_counter); }
+
+	std::atomic<u32>* _counter;
+};
+
+TEST_CLASS(SystemTests)
+{
+	TEST_METHOD(system_scheduler_levels)
+	{
+		std::atomic<u32> counter = 0;
+
+		SystemScheduler scheduler{};
+		scheduler.add(std::make_unique<CountingSystem>(SystemAccess::parallel(0, Access_Transform), &counter));
+		scheduler.add(std::make_unique<CountingSystem>(SystemAccess::parallel(Access_Input, Access_RenderWorld), &counter));
+		scheduler.add(std::make_unique<CountingSystem>(SystemAccess::parallel(Access_Transform, 0), &counter));
+		scheduler.add(std::make_unique<CountingSystem>(SystemAccess::exclusive(), &counter));
+
+		// Systems without conflicts share a level, readers wait for the writers added before them
+		Assert::AreEqual<u32>(0, scheduler.get_level(0));
+		Assert::AreEqual<u32>(0, scheduler.get_level(1));
+		Assert::AreEqual<u32>(1, scheduler.get_level(2));
+		Assert::AreEqual<u32>(2, scheduler.get_level(3));
+		Assert::AreEqual<u32>(3, scheduler.get_num_levels());
+
+		auto world = World::create();
+		scheduler.run(*world, 0.1f);
+		Assert::AreEqual<u32>(4, counter);
+	}
+
+	TEST_METHOD(system_component_updates)
+	{
+		auto world = World::create();
+
+		std::vector<EntityHandle> handles;
+		for (u32 i = 0; i < 200; ++i)
+		{
+			EntityHandle handle = world->create_entity();
+			handle->create_component<CounterComponent>();
+			handles.push_back(handle);
+		}
+		Assert::AreEqual<size_t>(200, world->get_components<CounterComponent>().size());
+
+		world->update(0.1f);
+		for (Component* comp : world->get_components<CounterComponent>())
+		{
+			Assert::AreEqual<u32>(1, static_cast<CounterComponent*>(comp)->_updates, L"Every component should be updated exactly once!");
+		}
+
+		// Removed entities unregister their components when they are deleted during the next update
+		world->remove_entity(handles[10]);
+		world->update(0.1f);
+		Assert::AreEqual<size_t>(199, world->get_components<CounterComponent>().size());
+	}
 };
 
 }
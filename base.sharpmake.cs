@@ -115,6 +115,18 @@ public abstract class Module : Project
         conf.Defines.Add("FEATURE_D2D");
         conf.Defines.Add("FEATURE_XAUDIO");
 
+        // Headless renderer, generate with JONO_NULL_RHI=1 to build against the null backend
+        if (System.Environment.GetEnvironmentVariable("JONO_NULL_RHI") == "1")
+        {
+            conf.Defines.Add("USE_NULL_RHI");
+        }
+
+        // Cooking models on load and writing them back, generate with JONO_SHIPPING=1 to only load models cooked offline
+        if (System.Environment.GetEnvironmentVariable("JONO_SHIPPING") != "1")
+        {
+            conf.Defines.Add("FEATURE_RUNTIME_COOKING");
+        }
+
         conf.Options.Add(Options.Vc.Compiler.CppLanguageStandard.CPP20);
         conf.Options.Add(Options.Vc.General.CharacterSet.Unicode);
 
@@ -187,6 +199,18 @@ public abstract class Application : Project
         conf.Defines.Add("FEATURE_D2D");
         conf.Defines.Add("FEATURE_XAUDIO");
 
+        // Headless renderer, generate with JONO_NULL_RHI=1 to build against the null backend
+        if (System.Environment.GetEnvironmentVariable("JONO_NULL_RHI") == "1")
+        {
+            conf.Defines.Add("USE_NULL_RHI");
+        }
+
+        // Cooking models on load and writing them back, generate with JONO_SHIPPING=1 to only load models cooked offline
+        if (System.Environment.GetEnvironmentVariable("JONO_SHIPPING") != "1")
+        {
+            conf.Defines.Add("FEATURE_RUNTIME_COOKING");
+        }
+
         conf.Options.Add(Options.Vc.Compiler.CppLanguageStandard.CPP20);
         conf.Options.Add(Options.Vc.Compiler.RTTI.Enable);
         conf.Options.Add(Options.Vc.General.CharacterSet.Unicode);
@@ -196,23 +196,6 @@ public class FmtLib : ExternalProject
     }
 }
 
-[Generate]
-public class EnkiTS : ExternalProject
-{
-    public EnkiTS() : base()
-    {
-        Name = "EnkiTS";
-        SourceRootPath = Path.Combine(ExternalDir, "enkitS/src/");
-    }
-    override public void ConfigureAll(Configuration conf, Target target)
-    {
-        base.ConfigureAll(conf, target);
-
-        conf.Output = Configuration.OutputType.Lib;
-        conf.IncludeSystemPaths.Add(Path.Combine(ExternalDir, "enkiTS/src/"));
-    }
-}
-
 [Generate]
 public class OpTick : ExternalProject
 {
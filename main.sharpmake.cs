@@ -41,7 +41,6 @@ public class CoreModule : Module
         conf.AddPublicDependency<OpTick>(target);
         conf.AddPublicDependency<Rttr>(target);
         conf.AddPublicDependency<Hlslpp>(target);
-        conf.AddPublicDependency<EnkiTS>(target);
         conf.AddPublicDependency<Box2D>(target);
         conf.AddPublicDependency<Assimp>(target);
     }
@@ -229,6 +228,30 @@ public class PathFindingProject : Application
 }
 
 
+[Generate]
+public class PackToolProject : Application
+{
+    public PackToolProject() : base()
+    {
+        Name = "PackTool";
+    }
+
+    public override void ConfigureAll(Configuration conf, Target target)
+    {
+        base.ConfigureAll(conf, target);
+        conf.SolutionFolder = "tools";
+
+        conf.AddPrivateDependency<CoreModule>(target);
+        conf.AddPrivateDependency<CliModule>(target);
+
+        conf.Options.Add(Options.Vc.Linker.SubSystem.Console);
+        conf.Output = Configuration.OutputType.Exe;
+
+        conf.IncludePaths.Add(@"[project.SourceRootPath]");
+    }
+}
+
+
 [Generate]
 public abstract class ToolsProject : Application
 {
@@ -278,6 +301,7 @@ public class EngineSolution : Solution
         conf.AddProject<EngineModule>(target);
         conf.AddProject<SceneViewerProject>(target);
         conf.AddProject<PathFindingProject>(target);
+        conf.AddProject<PackToolProject>(target);
     }
 }
 
@@ -309,6 +333,7 @@ public class ToolsOnlySolution : Solution
         conf.AddProject<SceneViewerProject>(target);
         conf.AddProject<PathFindingProject>(target);
         conf.AddProject<EngineTestProject>(target);
+        conf.AddProject<PackToolProject>(target);
     }
 }
 